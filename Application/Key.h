@@ -10,6 +10,7 @@ enum Key : uint32
 {
     KEY_A = GLFW_KEY_A,
     KEY_D = GLFW_KEY_D,
+    KEY_P = GLFW_KEY_P,
     KEY_S = GLFW_KEY_S,
     KEY_W = GLFW_KEY_W,
 };
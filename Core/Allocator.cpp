@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+#include "Allocator.h"
+#include "Debug.h"
+#include "Defines.h"
+#include "Log.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+// MallocAllocator ----------------------------
+void* MallocAllocator::allocate(sizet size, int flags)
+{
+    return allocate(size, DEFAULT_ALIGNMENT, 0, flags);
+}
+
+void* MallocAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+{
+    if (alignment < sizeof(void*))
+        alignment = sizeof(void*);
+
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, alignment, size) != 0)
+        return nullptr;
+    return pointer;
+#endif
+}
+
+void MallocAllocator::deallocate(void* pointer, sizet size)
+{
+#if defined(_MSC_VER)
+    _aligned_free(pointer);
+#else
+    free(pointer);
+#endif
+}
+
+MallocAllocator* MallocAllocator::instance()
+{
+    // Function local so containers constructed during static initialization can use it.
+    static MallocAllocator s_malloc_allocator;
+    return &s_malloc_allocator;
+}
+
+// LinearAllocator ----------------------------
+void LinearAllocator::init(Allocator* backing_allocator_, sizet size)
+{
+    backing_allocator = backing_allocator_;
+    memory = (uint8*)backing_allocator->allocate(size, DEFAULT_ALIGNMENT, 0, 0);
+    total_size = size;
+    allocated_size = 0;
+    peak_size = 0;
+}
+
+void LinearAllocator::shutdown()
+{
+    Clear();
+    backing_allocator->deallocate(memory, total_size);
+    memory = nullptr;
+    total_size = 0;
+}
+
+void* LinearAllocator::allocate(sizet size, int flags)
+{
+    return allocate(size, DEFAULT_ALIGNMENT, 0, flags);
+}
+
+void* LinearAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+{
+    ASSERT(size > 0);
+
+    const sizet new_start = MemoryAlign((sizet)(memory + allocated_size), alignment) - (sizet)memory;
+    const sizet new_allocated_size = new_start + size;
+    if (new_allocated_size > total_size)
+    {
+        ASSERT_MESSAGE(false, "[LinearAllocator]: Error: Out of memory, requested %zu bytes with %zu/%zu used.\n", size, allocated_size, total_size);
+        return nullptr;
+    }
+
+    allocated_size = new_allocated_size;
+    peak_size = MAX(peak_size, allocated_size);
+    return memory + new_start;
+}
+
+void LinearAllocator::deallocate(void* pointer, sizet size)
+{
+    // Memory is only released by Clear().
+}
+
+void LinearAllocator::Clear()
+{
+    allocated_size = 0;
+}
+
+// StackAllocator ----------------------------
+void StackAllocator::init(Allocator* backing_allocator_, sizet size)
+{
+    backing_allocator = backing_allocator_;
+    memory = (uint8*)backing_allocator->allocate(size, DEFAULT_ALIGNMENT, 0, 0);
+    total_size = size;
+    allocated_size = 0;
+    peak_size = 0;
+}
+
+void StackAllocator::shutdown()
+{
+    if (allocated_size != 0)
+        Raptor::Debug::LogWarning("[StackAllocator]: Warning: %zu bytes still allocated at shutdown.\n", allocated_size);
+
+    backing_allocator->deallocate(memory, total_size);
+    memory = nullptr;
+    total_size = 0;
+    allocated_size = 0;
+}
+
+void* StackAllocator::allocate(sizet size, int flags)
+{
+    return allocate(size, DEFAULT_ALIGNMENT, 0, flags);
+}
+
+void* StackAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+{
+    ASSERT(size > 0);
+
+    const sizet new_start = MemoryAlign((sizet)(memory + allocated_size), alignment) - (sizet)memory;
+    const sizet new_allocated_size = new_start + size;
+    if (new_allocated_size > total_size)
+    {
+        ASSERT_MESSAGE(false, "[StackAllocator]: Error: Out of memory, requested %zu bytes with %zu/%zu used.\n", size, allocated_size, total_size);
+        return nullptr;
+    }
+
+    allocated_size = new_allocated_size;
+    peak_size = MAX(peak_size, allocated_size);
+    return memory + new_start;
+}
+
+void StackAllocator::deallocate(void* pointer, sizet size)
+{
+    ASSERT(pointer >= memory && pointer < memory + total_size);
+
+    // Only the top of the stack can be popped, anything else waits for FreeMarker.
+    const sizet start = (uint8*)pointer - memory;
+    if (start + size == allocated_size)
+        allocated_size = start;
+}
+
+void StackAllocator::FreeMarker(Marker marker)
+{
+    ASSERT(marker <= allocated_size);
+    allocated_size = marker;
+}
+
+void StackAllocator::Clear()
+{
+    allocated_size = 0;
+}
+
+// DoubleBufferedAllocator ----------------------------
+void DoubleBufferedAllocator::init(Allocator* backing_allocator, sizet size_per_frame)
+{
+    arenas[0].init(backing_allocator, size_per_frame);
+    arenas[1].init(backing_allocator, size_per_frame);
+    current_arena = 0;
+}
+
+void DoubleBufferedAllocator::shutdown()
+{
+    arenas[1].shutdown();
+    arenas[0].shutdown();
+}
+
+void* DoubleBufferedAllocator::allocate(sizet size, int flags)
+{
+    return arenas[current_arena].allocate(size, flags);
+}
+
+void* DoubleBufferedAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+{
+    return arenas[current_arena].allocate(size, alignment, offset, flags);
+}
+
+void DoubleBufferedAllocator::deallocate(void* pointer, sizet size)
+{
+    // Memory is only released by SwapBuffers().
+}
+
+void DoubleBufferedAllocator::SwapBuffers()
+{
+    current_arena ^= 1;
+    arenas[current_arena].Clear();
+}
+
+// ContainerAllocator ----------------------------
+ContainerAllocator::ContainerAllocator(const char* name)
+    : allocator(MallocAllocator::instance()), name(name)
+{
+
+}
+
+ContainerAllocator::ContainerAllocator(Allocator& allocator)
+    : allocator(&allocator), name(allocator.get_name())
+{
+
+}
+
+} // namespace Core
+} // namespace Raptor
@@ -1,13 +1,166 @@
 #pragma once
 
-#include <EASTL/allocator.h>
+#include "Types.h"
+#include "Service.h"
 
 namespace Raptor
 {
 namespace Core
 {
 
-using Allocator = eastl::allocator;
+static const sizet DEFAULT_ALIGNMENT = 16;
+
+inline sizet MemoryAlign(sizet size, sizet alignment)
+{
+    const sizet alignment_mask = alignment - 1;
+    return (size + alignment_mask) & ~alignment_mask;
+}
+
+// Base interface for every engine allocator. The method names and signatures
+// follow eastl::allocator so existing call sites keep working unchanged.
+class Allocator
+{
+public:
+
+    virtual ~Allocator() {}
+
+    virtual void* allocate(sizet size, int flags = 0) = 0;
+    virtual void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) = 0;
+    virtual void deallocate(void* pointer, sizet size) = 0;
+
+    const char* get_name() const { return name; }
+    void set_name(const char* name_) { name = name_; }
+
+    const char* name = "Raptor::Core::Allocator";
+
+}; // class Allocator
+
+// General purpose allocator on top of malloc/free.
+class MallocAllocator : public Allocator
+{
+public:
+
+    void* allocate(sizet size, int flags = 0) override;
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override;
+    void deallocate(void* pointer, sizet size) override;
+
+    RAPTOR_DECLARE_SERVICE(MallocAllocator);
+
+}; // class MallocAllocator
+
+// Bump allocator. Individual deallocations are ignored, the whole arena is
+// released at once with Clear().
+class LinearAllocator : public Allocator
+{
+public:
+
+    void init(Allocator* backing_allocator, sizet size);
+    void shutdown();
+
+    void* allocate(sizet size, int flags = 0) override;
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override;
+    void deallocate(void* pointer, sizet size) override;
+
+    void Clear();
+
+    Allocator* backing_allocator = nullptr;
+    uint8* memory = nullptr;
+    sizet total_size = 0;
+    sizet allocated_size = 0;
+    sizet peak_size = 0;
+
+}; // class LinearAllocator
+
+// Linear allocator that can be rewound to a previously saved marker. Freeing
+// the most recent allocation also pops it from the stack.
+class StackAllocator : public Allocator
+{
+public:
+
+    using Marker = sizet;
+
+    void init(Allocator* backing_allocator, sizet size);
+    void shutdown();
+
+    void* allocate(sizet size, int flags = 0) override;
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override;
+    void deallocate(void* pointer, sizet size) override;
+
+    Marker GetMarker() const { return allocated_size; }
+    void FreeMarker(Marker marker);
+
+    void Clear();
+
+    Allocator* backing_allocator = nullptr;
+    uint8* memory = nullptr;
+    sizet total_size = 0;
+    sizet allocated_size = 0;
+    sizet peak_size = 0;
+
+}; // class StackAllocator
+
+// Two linear arenas used on alternate frames, so data written during frame N
+// stays valid while frame N+1 is being built. SwapBuffers() is called once per
+// frame and clears the arena that becomes current.
+class DoubleBufferedAllocator : public Allocator
+{
+public:
+
+    void init(Allocator* backing_allocator, sizet size_per_frame);
+    void shutdown();
+
+    void* allocate(sizet size, int flags = 0) override;
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override;
+    void deallocate(void* pointer, sizet size) override;
+
+    void SwapBuffers();
+
+    LinearAllocator* Current() { return &arenas[current_arena]; }
+    LinearAllocator* Previous() { return &arenas[current_arena ^ 1]; }
+
+    LinearAllocator arenas[2];
+    uint32 current_arena = 0;
+
+}; // class DoubleBufferedAllocator
+
+// Rewinds a stack allocator to the marker taken at construction.
+struct StackAllocatorScope
+{
+    StackAllocatorScope(StackAllocator& allocator) : allocator(allocator), marker(allocator.GetMarker()) {}
+    ~StackAllocatorScope() { allocator.FreeMarker(marker); }
+
+    StackAllocator& allocator;
+    StackAllocator::Marker marker;
+
+}; // struct StackAllocatorScope
+
+// Copyable handle used as the allocator type of EASTL containers. It forwards
+// to any Core::Allocator and defaults to the MallocAllocator service.
+class ContainerAllocator
+{
+public:
+
+    explicit ContainerAllocator(const char* name = "Raptor::Core::ContainerAllocator");
+    ContainerAllocator(Allocator& allocator);
+    ContainerAllocator(const ContainerAllocator& other) = default;
+    ContainerAllocator(const ContainerAllocator& other, const char* name) : allocator(other.allocator), name(name) {}
+
+    ContainerAllocator& operator = (const ContainerAllocator& other) = default;
+
+    void* allocate(sizet size, int flags = 0) { return allocator->allocate(size, flags); }
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) { return allocator->allocate(size, alignment, offset, flags); }
+    void deallocate(void* pointer, sizet size) { allocator->deallocate(pointer, size); }
+
+    const char* get_name() const { return name; }
+    void set_name(const char* name_) { name = name_; }
+
+    Allocator* allocator = nullptr;
+    const char* name = nullptr;
+
+}; // class ContainerAllocator
+
+inline bool operator == (const ContainerAllocator& lhs, const ContainerAllocator& rhs) { return lhs.allocator == rhs.allocator; }
+inline bool operator != (const ContainerAllocator& lhs, const ContainerAllocator& rhs) { return lhs.allocator != rhs.allocator; }
 
 } // namespace Core
-} // namespace Raptor
\ No newline at end of file
+} // namespace Raptor
@@ -0,0 +1,608 @@
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <errno.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define RAPTOR_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "AsyncIO.h"
+#include "Debug.h"
+#include "Defines.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+#if defined(RAPTOR_IO_URING)
+
+// Minimal io_uring wrapper on top of the raw syscalls, liburing is not a
+// dependency of the engine.
+struct IOUring
+{
+    int fd;
+
+    void* sq_memory;
+    sizet sq_memory_size;
+    void* cq_memory;
+    sizet cq_memory_size;
+    io_uring_sqe* sqes;
+    sizet sqes_size;
+
+    uint32* sq_head;
+    uint32* sq_tail;
+    uint32* sq_mask;
+    uint32* sq_array;
+
+    uint32* cq_head;
+    uint32* cq_tail;
+    uint32* cq_mask;
+    io_uring_cqe* cqes;
+
+    // One vector per request, indexed by handle.
+    iovec* io_vectors;
+
+    // Entries written since the last io_uring_enter.
+    uint32 pending;
+
+}; // struct IOUring
+
+static int IOUringSetup(uint32 entries, io_uring_params* params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int IOUringEnter(int fd, uint32 to_submit, uint32 min_complete, uint32 flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static void IOUringDestroy(IOUring* ring)
+{
+    if (ring->sqes && ring->sqes != MAP_FAILED)
+        munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_memory && ring->cq_memory != MAP_FAILED && ring->cq_memory != ring->sq_memory)
+        munmap(ring->cq_memory, ring->cq_memory_size);
+    if (ring->sq_memory && ring->sq_memory != MAP_FAILED)
+        munmap(ring->sq_memory, ring->sq_memory_size);
+    if (ring->fd >= 0)
+        close(ring->fd);
+}
+
+static bool IOUringCreate(IOUring* ring, uint32 entries)
+{
+    memset(ring, 0, sizeof(IOUring));
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    // Fails with ENOSYS on old kernels and EPERM when disabled by sysctl or seccomp.
+    ring->fd = IOUringSetup(entries, &params);
+    if (ring->fd < 0)
+        return false;
+
+    ring->sq_memory_size = params.sq_off.array + params.sq_entries * sizeof(uint32);
+    ring->cq_memory_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap)
+    {
+        ring->sq_memory_size = MAX(ring->sq_memory_size, ring->cq_memory_size);
+        ring->cq_memory_size = ring->sq_memory_size;
+    }
+
+    ring->sq_memory = mmap(nullptr, ring->sq_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_memory == MAP_FAILED)
+    {
+        IOUringDestroy(ring);
+        return false;
+    }
+
+    if (single_mmap)
+    {
+        ring->cq_memory = ring->sq_memory;
+    }
+    else
+    {
+        ring->cq_memory = mmap(nullptr, ring->cq_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_memory == MAP_FAILED)
+        {
+            IOUringDestroy(ring);
+            return false;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes = (io_uring_sqe*)mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        IOUringDestroy(ring);
+        return false;
+    }
+
+    uint8* sq = (uint8*)ring->sq_memory;
+    ring->sq_head = (uint32*)(sq + params.sq_off.head);
+    ring->sq_tail = (uint32*)(sq + params.sq_off.tail);
+    ring->sq_mask = (uint32*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (uint32*)(sq + params.sq_off.array);
+
+    uint8* cq = (uint8*)ring->cq_memory;
+    ring->cq_head = (uint32*)(cq + params.cq_off.head);
+    ring->cq_tail = (uint32*)(cq + params.cq_off.tail);
+    ring->cq_mask = (uint32*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+#else
+
+struct IOUring
+{
+    uint32 pending;
+}; // struct IOUring
+
+#endif // RAPTOR_IO_URING
+
+AsyncIOService* AsyncIOService::instance()
+{
+    static AsyncIOService s_async_io_service;
+    return &s_async_io_service;
+}
+
+void AsyncIOService::init(Allocator* allocator_, uint32 max_requests_, uint32 worker_count_, bool allow_io_uring)
+{
+    ASSERT(max_requests_ > 0);
+
+    allocator = allocator_;
+    max_requests = max_requests_;
+
+    requests = (AsyncReadRequest*)allocator->allocate(sizeof(AsyncReadRequest) * max_requests, alignof(AsyncReadRequest), 0, 0);
+    for (uint32 i = 0; i < max_requests; ++i)
+    {
+        AsyncReadRequest* request = new (&requests[i]) AsyncReadRequest();
+        request->next_free = i + 1 < max_requests ? i + 1 : InvalidAsyncRead;
+        request->status.store(AsyncReadStatus::Free, std::memory_order_relaxed);
+    }
+    free_head = 0;
+
+    batch = (AsyncReadHandle*)allocator->allocate(sizeof(AsyncReadHandle) * max_requests, alignof(AsyncReadHandle), 0, 0);
+    batch_count = 0;
+
+    completed = (AsyncReadHandle*)allocator->allocate(sizeof(AsyncReadHandle) * max_requests * 2, alignof(AsyncReadHandle), 0, 0);
+    processing = completed + max_requests;
+    completed_count = 0;
+
+#if defined(RAPTOR_IO_URING)
+    if (allow_io_uring)
+    {
+        IOUring* ring = (IOUring*)allocator->allocate(sizeof(IOUring), alignof(IOUring), 0, 0);
+        if (IOUringCreate(ring, max_requests))
+        {
+            ring->io_vectors = (iovec*)allocator->allocate(sizeof(iovec) * max_requests, alignof(iovec), 0, 0);
+            ring->pending = 0;
+            io_uring = ring;
+            Raptor::Debug::Log("[AsyncIO]: Using io_uring with %u entries.\n", max_requests);
+            return;
+        }
+
+        allocator->deallocate(ring, sizeof(IOUring));
+        Raptor::Debug::Log("[AsyncIO]: io_uring unavailable, using %u worker threads.\n", worker_count_);
+    }
+#endif
+
+    worker_count = MAX(worker_count_, 1u);
+    queue = (AsyncReadHandle*)allocator->allocate(sizeof(AsyncReadHandle) * max_requests, alignof(AsyncReadHandle), 0, 0);
+    queue_head = 0;
+    queue_count = 0;
+    stop_workers = false;
+
+    workers = (std::thread*)allocator->allocate(sizeof(std::thread) * worker_count, alignof(std::thread), 0, 0);
+    for (uint32 i = 0; i < worker_count; ++i)
+    {
+        new (&workers[i]) std::thread(&AsyncIOService::WorkerLoop, this);
+    }
+}
+
+void AsyncIOService::shutdown()
+{
+    Submit();
+
+    // Let every outstanding read finish, their buffers must not be freed under the kernel or a worker.
+    for (uint32 i = 0; i < max_requests; ++i)
+    {
+        const uint8 status = requests[i].status.load(std::memory_order_acquire);
+        if (status == AsyncReadStatus::Queued || status == AsyncReadStatus::InFlight)
+        {
+            if (io_uring)
+            {
+                while (requests[i].status.load(std::memory_order_acquire) < AsyncReadStatus::Completed)
+                    CollectIOUring(true);
+            }
+            else
+            {
+                std::unique_lock<std::mutex> lock(completed_mutex);
+                completed_condition.wait(lock, [&]() { return requests[i].status.load(std::memory_order_acquire) >= AsyncReadStatus::Completed; });
+            }
+        }
+    }
+
+    if (workers)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stop_workers = true;
+        }
+        queue_condition.notify_all();
+
+        for (uint32 i = 0; i < worker_count; ++i)
+        {
+            workers[i].join();
+            workers[i].~thread();
+        }
+
+        allocator->deallocate(workers, sizeof(std::thread) * worker_count);
+        allocator->deallocate(queue, sizeof(AsyncReadHandle) * max_requests);
+        workers = nullptr;
+        queue = nullptr;
+        worker_count = 0;
+    }
+
+#if defined(RAPTOR_IO_URING)
+    if (io_uring)
+    {
+        allocator->deallocate(io_uring->io_vectors, sizeof(iovec) * max_requests);
+        IOUringDestroy(io_uring);
+        allocator->deallocate(io_uring, sizeof(IOUring));
+        io_uring = nullptr;
+    }
+#endif
+
+    // Results nobody took are released here.
+    for (uint32 i = 0; i < max_requests; ++i)
+    {
+        AsyncReadRequest& request = requests[i];
+        if (request.status.load(std::memory_order_relaxed) != AsyncReadStatus::Free)
+        {
+            Raptor::Debug::LogWarning("[AsyncIO]: Warning: Read request %u was never collected.\n", i);
+            if (request.result.data)
+                request.allocator->deallocate(request.result.data, request.result.size + 1);
+        }
+        request.~AsyncReadRequest();
+    }
+
+    allocator->deallocate(completed, sizeof(AsyncReadHandle) * max_requests * 2);
+    allocator->deallocate(batch, sizeof(AsyncReadHandle) * max_requests);
+    allocator->deallocate(requests, sizeof(AsyncReadRequest) * max_requests);
+
+    requests = nullptr;
+    batch = nullptr;
+    completed = nullptr;
+    processing = nullptr;
+    max_requests = 0;
+    free_head = InvalidAsyncRead;
+    batch_count = 0;
+    completed_count = 0;
+}
+
+AsyncReadHandle AsyncIOService::Read(const char* filename, Allocator* data_allocator, AsyncReadCallback callback, void* user_data)
+{
+    if (free_head == InvalidAsyncRead)
+    {
+        Raptor::Debug::LogError("[AsyncIO]: Error: Out of read requests, increase max_requests (%u).\n", max_requests);
+        return InvalidAsyncRead;
+    }
+
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+    {
+        Raptor::Debug::LogError("[AsyncIO]: Error: Could not open file %s\n", filename);
+        return InvalidAsyncRead;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long end = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (end < 0)
+    {
+        Raptor::Debug::LogError("[AsyncIO]: Error: Could not get the size of %s\n", filename);
+        fclose(file);
+        return InvalidAsyncRead;
+    }
+
+    const sizet file_size = (sizet)end;
+
+    const AsyncReadHandle handle = free_head;
+    AsyncReadRequest& request = requests[handle];
+    free_head = request.next_free;
+
+    // Null terminated like FileReadBinary so text files can be used directly.
+    request.result.data = (char*)data_allocator->allocate(file_size + 1);
+    request.result.data[file_size] = 0;
+    request.result.size = file_size;
+    request.bytes_read = 0;
+    request.file = file;
+    request.allocator = data_allocator;
+    request.callback = callback;
+    request.user_data = user_data;
+    request.next_free = InvalidAsyncRead;
+    request.status.store(AsyncReadStatus::Queued, std::memory_order_relaxed);
+
+    batch[batch_count++] = handle;
+    return handle;
+}
+
+void AsyncIOService::Submit()
+{
+    if (batch_count == 0)
+        return;
+
+    if (io_uring)
+    {
+        for (uint32 i = 0; i < batch_count; ++i)
+        {
+            AsyncReadRequest& request = requests[batch[i]];
+            request.status.store(AsyncReadStatus::InFlight, std::memory_order_relaxed);
+
+            if (request.result.size == 0)
+                Complete(batch[i], true);
+            else
+                SubmitIOUring(batch[i]);
+        }
+        CollectIOUring(false);
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            for (uint32 i = 0; i < batch_count; ++i)
+            {
+                queue[(queue_head + queue_count) % max_requests] = batch[i];
+                ++queue_count;
+            }
+        }
+        queue_condition.notify_all();
+    }
+
+    batch_count = 0;
+}
+
+void AsyncIOService::Update()
+{
+    Submit();
+
+    if (io_uring)
+        CollectIOUring(false);
+
+    uint32 processing_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        memcpy(processing, completed, sizeof(AsyncReadHandle) * completed_count);
+        processing_count = completed_count;
+        completed_count = 0;
+    }
+
+    for (uint32 i = 0; i < processing_count; ++i)
+    {
+        const AsyncReadHandle handle = processing[i];
+        const AsyncReadCallback callback = requests[handle].callback;
+        void* user_data = requests[handle].user_data;
+
+        // The request is released first so the callback can queue new reads.
+        const FileReadResult result = TakeResult(handle);
+        callback(handle, result, user_data);
+    }
+}
+
+AsyncReadStatus::Enum AsyncIOService::GetStatus(AsyncReadHandle handle)
+{
+    ASSERT(handle < max_requests);
+
+    if (io_uring)
+        CollectIOUring(false);
+
+    return (AsyncReadStatus::Enum)requests[handle].status.load(std::memory_order_acquire);
+}
+
+FileReadResult AsyncIOService::TakeResult(AsyncReadHandle handle)
+{
+    ASSERT(handle < max_requests);
+
+    AsyncReadRequest& request = requests[handle];
+    const uint8 status = request.status.load(std::memory_order_acquire);
+    ASSERT(status == AsyncReadStatus::Completed || status == AsyncReadStatus::Failed);
+
+    FileReadResult result = request.result;
+    if (status == AsyncReadStatus::Failed)
+    {
+        // Buffers are released here rather than on the worker, allocators are not thread safe.
+        request.allocator->deallocate(result.data, result.size + 1);
+        result = { nullptr, 0 };
+    }
+
+    ReleaseRequest(handle);
+    return result;
+}
+
+FileReadResult AsyncIOService::Wait(AsyncReadHandle handle)
+{
+    ASSERT(handle < max_requests);
+    ASSERT_MESSAGE(requests[handle].callback == nullptr, "[AsyncIO]: Error: Request %u is completed by its callback.\n", handle);
+
+    Submit();
+
+    AsyncReadRequest& request = requests[handle];
+    if (io_uring)
+    {
+        while (request.status.load(std::memory_order_acquire) < AsyncReadStatus::Completed)
+            CollectIOUring(true);
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(completed_mutex);
+        completed_condition.wait(lock, [&]() { return request.status.load(std::memory_order_acquire) >= AsyncReadStatus::Completed; });
+    }
+
+    return TakeResult(handle);
+}
+
+void AsyncIOService::SubmitIOUring(AsyncReadHandle handle)
+{
+#if defined(RAPTOR_IO_URING)
+    AsyncReadRequest& request = requests[handle];
+
+    iovec& io_vector = io_uring->io_vectors[handle];
+    io_vector.iov_base = request.result.data + request.bytes_read;
+    io_vector.iov_len = request.result.size - request.bytes_read;
+
+    // There is one ring entry per request, so the submission queue can not overflow.
+    const uint32 tail = *io_uring->sq_tail;
+    const uint32 index = tail & *io_uring->sq_mask;
+
+    io_uring_sqe* sqe = &io_uring->sqes[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fileno(request.file);
+    sqe->off = request.bytes_read;
+    sqe->addr = (uint64)(uintptr_t)&io_vector;
+    sqe->len = 1;
+    sqe->user_data = handle;
+
+    io_uring->sq_array[index] = index;
+    __atomic_store_n(io_uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++io_uring->pending;
+#endif
+}
+
+void AsyncIOService::CollectIOUring(bool wait)
+{
+#if defined(RAPTOR_IO_URING)
+    uint32 flags = wait ? IORING_ENTER_GETEVENTS : 0;
+    if (io_uring->pending || wait)
+    {
+        const int submitted = IOUringEnter(io_uring->fd, io_uring->pending, wait ? 1 : 0, flags);
+        if (submitted >= 0)
+            io_uring->pending -= MIN((uint32)submitted, io_uring->pending);
+        else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            Raptor::Debug::LogError("[AsyncIO]: Error: io_uring_enter failed with %d.\n", errno);
+    }
+
+    uint32 head = *io_uring->cq_head;
+    const uint32 tail = __atomic_load_n(io_uring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail)
+    {
+        const io_uring_cqe& cqe = io_uring->cqes[head & *io_uring->cq_mask];
+        const AsyncReadHandle handle = (AsyncReadHandle)cqe.user_data;
+        const int result = cqe.res;
+        ++head;
+
+        AsyncReadRequest& request = requests[handle];
+        if (result == -EINTR || result == -EAGAIN)
+        {
+            SubmitIOUring(handle);
+        }
+        else if (result < 0)
+        {
+            Raptor::Debug::LogError("[AsyncIO]: Error: Read failed with %d.\n", -result);
+            Complete(handle, false);
+        }
+        else
+        {
+            request.bytes_read += (sizet)result;
+
+            // Short reads are resubmitted from the new offset, 0 means the file shrank.
+            if (result > 0 && request.bytes_read < request.result.size)
+                SubmitIOUring(handle);
+            else
+                Complete(handle, true);
+        }
+    }
+
+    __atomic_store_n(io_uring->cq_head, head, __ATOMIC_RELEASE);
+
+    if (io_uring->pending)
+    {
+        const int submitted = IOUringEnter(io_uring->fd, io_uring->pending, 0, 0);
+        if (submitted > 0)
+            io_uring->pending -= MIN((uint32)submitted, io_uring->pending);
+    }
+#endif
+}
+
+void AsyncIOService::Complete(AsyncReadHandle handle, bool success)
+{
+    AsyncReadRequest& request = requests[handle];
+
+    fclose(request.file);
+    request.file = nullptr;
+
+    // The file may have shrunk since Read() sized the buffer.
+    if (success && request.bytes_read < request.result.size)
+    {
+        request.result.data[request.bytes_read] = 0;
+        request.result.size = request.bytes_read;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        request.status.store(success ? AsyncReadStatus::Completed : AsyncReadStatus::Failed, std::memory_order_release);
+
+        if (request.callback)
+            completed[completed_count++] = handle;
+    }
+    completed_condition.notify_all();
+}
+
+void AsyncIOService::ReleaseRequest(AsyncReadHandle handle)
+{
+    AsyncReadRequest& request = requests[handle];
+    request.result = { nullptr, 0 };
+    request.allocator = nullptr;
+    request.callback = nullptr;
+    request.user_data = nullptr;
+    request.status.store(AsyncReadStatus::Free, std::memory_order_relaxed);
+
+    request.next_free = free_head;
+    free_head = handle;
+}
+
+void AsyncIOService::WorkerLoop()
+{
+    for (;;)
+    {
+        AsyncReadHandle handle = InvalidAsyncRead;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_condition.wait(lock, [this]() { return stop_workers || queue_count > 0; });
+
+            if (queue_count == 0)
+                return;
+
+            handle = queue[queue_head];
+            queue_head = (queue_head + 1) % max_requests;
+            --queue_count;
+        }
+
+        AsyncReadRequest& request = requests[handle];
+        request.status.store(AsyncReadStatus::InFlight, std::memory_order_relaxed);
+
+        request.bytes_read = fread(request.result.data, 1, request.result.size, request.file);
+        Complete(handle, ferror(request.file) == 0);
+    }
+}
+
+} // namespace Core
+} // namespace Raptor
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Allocator.h"
+#include "File.h"
+#include "Service.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+using AsyncReadHandle = uint32;
+static const AsyncReadHandle InvalidAsyncRead = 0xffffffffu;
+
+namespace AsyncReadStatus
+{
+enum Enum : uint8
+{
+    Free, Queued, InFlight, Completed, Failed
+};
+} // namespace AsyncReadStatus
+
+typedef void (*AsyncReadCallback)(AsyncReadHandle handle, const FileReadResult& result, void* user_data);
+
+struct AsyncReadRequest
+{
+    FileReadResult result;
+    sizet bytes_read;
+    FILE* file;
+    Allocator* allocator;
+    AsyncReadCallback callback;
+    void* user_data;
+    uint32 next_free;
+    std::atomic<uint8> status;
+
+}; // struct AsyncReadRequest
+
+struct IOUring;
+
+// Reads whole files in the background. Requests are batched until Submit()
+// and completed through io_uring on Linux kernels that allow it, otherwise by
+// a small pool of worker threads.
+//
+// The destination buffer is allocated on the calling thread when the request
+// is made, so allocators do not need to be thread safe. All methods must be
+// called from the same thread; callbacks run inside Update() and Wait().
+class AsyncIOService
+{
+public:
+
+    void init(Allocator* allocator, uint32 max_requests = 256, uint32 worker_count = 2, bool allow_io_uring = true);
+    void shutdown();
+
+    // Returns InvalidAsyncRead if the file can not be opened. With a callback
+    // the buffer belongs to the callback, otherwise take it with Wait() or
+    // TakeResult() once the status is Completed.
+    AsyncReadHandle Read(const char* filename, Allocator* allocator, AsyncReadCallback callback = nullptr, void* user_data = nullptr);
+    void Submit();
+
+    // Runs callbacks of finished reads.
+    void Update();
+
+    AsyncReadStatus::Enum GetStatus(AsyncReadHandle handle);
+    FileReadResult TakeResult(AsyncReadHandle handle);
+    FileReadResult Wait(AsyncReadHandle handle);
+
+    bool UsesIOUring() const { return io_uring != nullptr; }
+
+    RAPTOR_DECLARE_SERVICE(AsyncIOService);
+
+private:
+
+    void SubmitIOUring(AsyncReadHandle handle);
+    void CollectIOUring(bool wait);
+    void Complete(AsyncReadHandle handle, bool success);
+    void ReleaseRequest(AsyncReadHandle handle);
+
+    void WorkerLoop();
+
+    Allocator* allocator = nullptr;
+
+    AsyncReadRequest* requests = nullptr;
+    uint32 max_requests = 0;
+    uint32 free_head = InvalidAsyncRead;
+
+    // Requests made since the last Submit().
+    AsyncReadHandle* batch = nullptr;
+    uint32 batch_count = 0;
+
+    IOUring* io_uring = nullptr;
+
+    // Thread pool fallback, queue is a ring of handles.
+    std::thread* workers = nullptr;
+    uint32 worker_count = 0;
+    AsyncReadHandle* queue = nullptr;
+    uint32 queue_head = 0;
+    uint32 queue_count = 0;
+    bool stop_workers = false;
+    std::mutex queue_mutex;
+    std::condition_variable queue_condition;
+
+    // Finished requests waiting for their callback, processing is the copy
+    // Update() walks so callbacks run without holding the lock.
+    AsyncReadHandle* completed = nullptr;
+    AsyncReadHandle* processing = nullptr;
+    uint32 completed_count = 0;
+    std::mutex completed_mutex;
+    std::condition_variable completed_condition;
+
+}; // class AsyncIOService
+
+} // namespace Core
+} // namespace Raptor
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "BuildCache.h"
+#include "Hash.h"
+#include "Log.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+// The file is the magic and the entry count followed by pairs of output name hash and key.
+void BuildCache::init(Allocator* allocator_, const char* directory)
+{
+    allocator = allocator_;
+    dirty = false;
+    keys.set_allocator(*allocator);
+
+    snprintf(filename, sizeof(filename), "%s/build_cache.bin", directory);
+
+    sizet size = 0;
+    char* data = FileReadBinary(filename, allocator, &size);
+    if (!data)
+        return;
+
+    uint32 header[2] = {};
+    if (size >= sizeof(header))
+        memcpy(header, data, sizeof(header));
+
+    if (header[0] == MAGIC && size - sizeof(header) >= (sizet)header[1] * sizeof(uint64) * 2)
+    {
+        const char* entries = data + sizeof(header);
+        for (uint32 i = 0; i < header[1]; ++i)
+        {
+            uint64 entry[2];
+            memcpy(entry, entries + i * sizeof(entry), sizeof(entry));
+            keys[entry[0]] = entry[1];
+        }
+    }
+    else
+    {
+        Raptor::Debug::LogWarning("[BuildCache]: Warning: Ignoring invalid cache %s.\n", filename);
+    }
+
+    allocator->deallocate(data, size + 1);
+}
+
+void BuildCache::shutdown()
+{
+    if (dirty)
+    {
+        const sizet size = sizeof(uint32) * 2 + keys.size() * sizeof(uint64) * 2;
+        char* data = (char*)allocator->allocate(size, alignof(uint64), 0, 0);
+
+        uint32 header[2] = {MAGIC, (uint32)keys.size()};
+        memcpy(data, header, sizeof(header));
+
+        char* entries = data + sizeof(header);
+        for (auto it = keys.begin(); it != keys.end(); ++it)
+        {
+            const uint64 entry[2] = {it->first, it->second};
+            memcpy(entries, entry, sizeof(entry));
+            entries += sizeof(entry);
+        }
+
+        if (!FileWriteBinary(filename, data, size))
+            Raptor::Debug::LogError("[BuildCache]: Error: Could not write %s.\n", filename);
+
+        allocator->deallocate(data, size);
+    }
+
+    keys.clear(true);
+    dirty = false;
+}
+
+uint64 BuildCache::ComputeKey(const void* source_data, sizet source_size, uint64 version)
+{
+    return HashBytes((void*)source_data, source_size, version);
+}
+
+bool BuildCache::IsUpToDate(const char* output_filename, uint64 key) const
+{
+    auto it = keys.find(HashString(output_filename));
+    return it != keys.end() && it->second == key && FileExists(output_filename);
+}
+
+void BuildCache::Set(const char* output_filename, uint64 key)
+{
+    keys[HashString(output_filename)] = key;
+    dirty = true;
+}
+
+void BuildCache::Remove(const char* output_filename)
+{
+    dirty |= keys.erase(HashString(output_filename)) != 0;
+}
+
+} // namespace Core
+} // namespace Raptor
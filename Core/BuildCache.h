@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Allocator.h"
+#include "File.h"
+#include "HashMap.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+// Remembers the key each cooked output was built from, so the resource
+// compiler only cooks sources whose content, compiler or settings changed.
+// Keys are kept in a single file inside the output directory.
+class BuildCache
+{
+public:
+
+    void init(Allocator* allocator, const char* directory);
+    // Writes the cache file back if anything changed.
+    void shutdown();
+
+    // Content hash of the source seeded with the compiler version.
+    static uint64 ComputeKey(const void* source_data, sizet source_size, uint64 version);
+
+    // False as well when the output was deleted since it was built.
+    bool IsUpToDate(const char* output_filename, uint64 key) const;
+    void Set(const char* output_filename, uint64 key);
+    void Remove(const char* output_filename);
+
+private:
+
+    static const uint32 MAGIC = 0x43425252; // "RRBC"
+
+    HashMap<uint64, uint64> keys;
+    char filename[MAX_FILENAME_LENGTH];
+    Allocator* allocator = nullptr;
+    bool dirty = false;
+
+}; // class BuildCache
+
+} // namespace Core
+} // namespace Raptor
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "Types.h"
 
-static const uint32 INVALID_INDEX = 0xffffffffu;
\ No newline at end of file
+static const uint32 INVALID_INDEX = 0xffffffffu;
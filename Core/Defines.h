@@ -3,6 +3,7 @@
 #define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
 
 #define MAX(A, B) (((A) >= (B)) ? (A) : (B))
+#define MIN(A, B) (((A) <= (B)) ? (A) : (B))
 
 #define M_PI     3.14159265f
 #define M_PI_2   1.57079632f
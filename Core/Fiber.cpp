@@ -0,0 +1,270 @@
+#if defined(_WIN64)
+#include <windows.h>
+#else
+#include <ucontext.h>
+#endif
+
+#include <new>
+
+#include "Fiber.h"
+#include "Debug.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+namespace FiberState
+{
+enum Enum : uint8
+{
+    Free, Running, Waiting, Finished
+};
+} // namespace FiberState
+
+struct Fiber
+{
+#if defined(_WIN64)
+    void* handle;
+    // Whatever was running when the fiber was resumed, it switches back there.
+    void* return_handle;
+#else
+    ucontext_t context;
+    ucontext_t* return_context;
+    void* stack;
+#endif
+
+    JobFunction function;
+    void* data;
+    JobCounter* counter;
+    JobCounter* wait_counter;
+    JobAffinity::Enum affinity;
+    FiberState::Enum state;
+
+    Fiber* next_free;
+
+}; // struct Fiber
+
+// Fiber running on this thread, nullptr on a plain thread stack.
+static thread_local Fiber* s_current_fiber = nullptr;
+
+static void SwitchOut(Fiber* fiber)
+{
+#if defined(_WIN64)
+    SwitchToFiber(fiber->return_handle);
+#else
+    swapcontext(&fiber->context, fiber->return_context);
+#endif
+}
+
+// Fibers are reused, the entry never returns and runs one task per resume
+// from the Free state.
+#if defined(_WIN64)
+static void WINAPI FiberEntry(void* parameter)
+{
+    Fiber* fiber = (Fiber*)parameter;
+#else
+static void FiberEntry(uint32 pointer_low, uint32 pointer_high)
+{
+    Fiber* fiber = (Fiber*)(((uintptr_t)pointer_high << 32) | (uintptr_t)pointer_low);
+#endif
+
+    for (;;)
+    {
+        fiber->function(fiber->data);
+        fiber->state = FiberState::Finished;
+        SwitchOut(fiber);
+    }
+}
+
+FiberSystem* FiberSystem::instance()
+{
+    static FiberSystem s_fiber_system;
+    return &s_fiber_system;
+}
+
+void FiberSystem::init(Allocator* allocator_, uint32 fiber_count_, sizet stack_size_)
+{
+    allocator = allocator_;
+    fiber_count = fiber_count_;
+    stack_size = MemoryAlign(stack_size_, 4096);
+
+    fibers = (Fiber*)allocator->allocate(sizeof(Fiber) * fiber_count, alignof(Fiber), 0, 0);
+    free_fibers = nullptr;
+
+    for (uint32 i = 0; i < fiber_count; ++i)
+    {
+        Fiber* fiber = new (&fibers[fiber_count - 1 - i]) Fiber();
+        fiber->state = FiberState::Free;
+
+#if defined(_WIN64)
+        fiber->handle = CreateFiber(stack_size, FiberEntry, fiber);
+        ASSERT(fiber->handle != nullptr);
+#else
+        fiber->stack = allocator->allocate(stack_size, 16, 0, 0);
+
+        getcontext(&fiber->context);
+        fiber->context.uc_stack.ss_sp = fiber->stack;
+        fiber->context.uc_stack.ss_size = stack_size;
+        fiber->context.uc_link = nullptr;
+
+        const uintptr_t pointer = (uintptr_t)fiber;
+        makecontext(&fiber->context, (void (*)())FiberEntry, 2, (uint32)pointer, (uint32)(pointer >> 32));
+#endif
+
+        fiber->next_free = free_fibers;
+        free_fibers = fiber;
+    }
+    free_count = fiber_count;
+}
+
+void FiberSystem::shutdown()
+{
+    if (free_count != fiber_count)
+        Raptor::Debug::LogWarning("[FiberSystem]: Warning: %u tasks are still suspended.\n", fiber_count - free_count);
+
+    for (uint32 i = 0; i < fiber_count; ++i)
+    {
+#if defined(_WIN64)
+        DeleteFiber(fibers[i].handle);
+#else
+        allocator->deallocate(fibers[i].stack, stack_size);
+#endif
+        fibers[i].~Fiber();
+    }
+
+    allocator->deallocate(fibers, sizeof(Fiber) * fiber_count);
+    fibers = nullptr;
+    free_fibers = nullptr;
+    fiber_count = 0;
+    free_count = 0;
+}
+
+void FiberSystem::Run(const JobDeclaration& task, JobCounter* counter)
+{
+    if (!TryRun(task, counter))
+        JobSystem::instance()->Run(task, counter);
+}
+
+bool FiberSystem::TryRun(const JobDeclaration& task, JobCounter* counter)
+{
+    JobSystem* job_system = JobSystem::instance();
+
+    Fiber* fiber = AcquireFiber();
+    if (!fiber)
+        return false;
+
+    fiber->function = task.function;
+    fiber->data = task.data;
+    fiber->counter = counter;
+    fiber->wait_counter = nullptr;
+    fiber->affinity = task.affinity;
+
+    if (counter)
+        job_system->Increment(counter);
+
+    JobDeclaration resume;
+    resume.function = ResumeFiberJob;
+    resume.data = fiber;
+    resume.affinity = task.affinity;
+    job_system->Run(resume);
+    return true;
+}
+
+void FiberSystem::Wait(JobCounter* counter)
+{
+    Fiber* fiber = s_current_fiber;
+    if (!fiber)
+    {
+        JobSystem::instance()->Wait(counter);
+        return;
+    }
+
+    if (counter->IsDone())
+        return;
+
+    // The thread that switched in this fiber queues its resume once it is
+    // off the fiber stack.
+    fiber->wait_counter = counter;
+    fiber->state = FiberState::Waiting;
+    SwitchOut(fiber);
+}
+
+bool FiberSystem::InFiber() const
+{
+    return s_current_fiber != nullptr;
+}
+
+uint32 FiberSystem::FreeFiberCount()
+{
+    std::lock_guard<std::mutex> lock(free_mutex);
+    return free_count;
+}
+
+Fiber* FiberSystem::AcquireFiber()
+{
+    std::lock_guard<std::mutex> lock(free_mutex);
+
+    Fiber* fiber = free_fibers;
+    if (fiber)
+    {
+        free_fibers = fiber->next_free;
+        --free_count;
+    }
+    return fiber;
+}
+
+void FiberSystem::ReleaseFiber(Fiber* fiber)
+{
+    std::lock_guard<std::mutex> lock(free_mutex);
+
+    fiber->state = FiberState::Free;
+    fiber->next_free = free_fibers;
+    free_fibers = fiber;
+    ++free_count;
+}
+
+// Switches into the fiber and handles whatever made it switch back. Can run
+// nested inside another fiber that is helping in JobSystem::Wait().
+void FiberSystem::ResumeFiberJob(void* data)
+{
+    Fiber* fiber = (Fiber*)data;
+
+    Fiber* previous_fiber = s_current_fiber;
+    s_current_fiber = fiber;
+    fiber->state = FiberState::Running;
+
+#if defined(_WIN64)
+    if (!IsThreadAFiber())
+        ConvertThreadToFiber(nullptr);
+    fiber->return_handle = GetCurrentFiber();
+    SwitchToFiber(fiber->handle);
+#else
+    ucontext_t return_context;
+    fiber->return_context = &return_context;
+    swapcontext(&return_context, &fiber->context);
+#endif
+
+    s_current_fiber = previous_fiber;
+
+    JobSystem* job_system = JobSystem::instance();
+    if (fiber->state == FiberState::Waiting)
+    {
+        JobDeclaration resume;
+        resume.function = ResumeFiberJob;
+        resume.data = fiber;
+        resume.affinity = fiber->affinity;
+        job_system->RunAfter(fiber->wait_counter, resume);
+        return;
+    }
+
+    ASSERT(fiber->state == FiberState::Finished);
+    JobCounter* counter = fiber->counter;
+    instance()->ReleaseFiber(fiber);
+
+    if (counter)
+        job_system->Decrement(counter);
+}
+
+} // namespace Core
+} // namespace Raptor
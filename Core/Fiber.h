@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mutex>
+
+#include "Allocator.h"
+#include "JobSystem.h"
+#include "Service.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+struct Fiber;
+
+// Runs long tasks on fibers scheduled through the JobSystem. A task that
+// waits on a counter is switched out and its thread goes back to other
+// jobs; the task resumes as the continuation of the counter, possibly on a
+// different thread. Work that is not a job, like a file read, can be waited
+// on through a counter that its completion decrements.
+//
+// Code inside a task must not keep pointers to thread local data across a
+// Wait(). Fiber stacks have no guard pages, keep large buffers off them.
+class FiberSystem
+{
+public:
+
+    void init(Allocator* allocator, uint32 fiber_count = 32, sizet stack_size = 128 * 1024);
+    void shutdown();
+
+    // The affinity of the task holds for every resume of its fiber. When all
+    // fibers are in use the task runs as a plain job and waits by blocking.
+    void Run(const JobDeclaration& task, JobCounter* counter = nullptr);
+    // Returns false instead when all fibers are in use, for tasks that wait on
+    // work a blocked thread could hold up, like reads completed on the main thread.
+    bool TryRun(const JobDeclaration& task, JobCounter* counter = nullptr);
+
+    // Suspends the current task until the counter reaches zero. Outside of a
+    // task it is the same as JobSystem::Wait().
+    void Wait(JobCounter* counter);
+
+    bool InFiber() const;
+    uint32 FreeFiberCount();
+
+    RAPTOR_DECLARE_SERVICE(FiberSystem);
+
+private:
+
+    Fiber* AcquireFiber();
+    void ReleaseFiber(Fiber* fiber);
+
+    static void ResumeFiberJob(void* data);
+
+    Allocator* allocator = nullptr;
+
+    Fiber* fibers = nullptr;
+    uint32 fiber_count = 0;
+    sizet stack_size = 0;
+
+    Fiber* free_fibers = nullptr;
+    uint32 free_count = 0;
+    std::mutex free_mutex;
+
+}; // class FiberSystem
+
+} // namespace Core
+} // namespace Raptor
@@ -3,6 +3,10 @@
 #include <windows.h>
 #else
 #include<unistd.h> 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 #include <stdio.h>
@@ -69,16 +73,50 @@ void ChangeDirectory(const char* path)
 #if defined(_WIN64)
     if (!SetCurrentDirectoryA(path))
     {
-        Raptor::Debug::Log("Error: Could not change directory to %s\n", path);
+        Raptor::Debug::LogError("Error: Could not change directory to %s\n", path);
     }
 #else
     if (chdir(path) != 0)
     {
-        Raptor::Debug::Log("Error: Could not change directory to %s\n", path);
+        Raptor::Debug::LogError("Error: Could not change directory to %s\n", path);
     }
 #endif
 }
 
+bool PathIsAbsolute(const char* path)
+{
+#if defined(_WIN64)
+    if (path[0] && path[1] == ':')
+        return true;
+
+    return path[0] == '/' || path[0] == '\\';
+#else
+    return path[0] == '/';
+#endif
+}
+
+void PathFromDirectory(const char* directory, const char* path, char* out_path, sizet size)
+{
+    if (!directory || PathIsAbsolute(path))
+    {
+        snprintf(out_path, size, "%s", path);
+        return;
+    }
+
+    const sizet length = strlen(directory);
+    const bool separator = length && (directory[length - 1] == '/' || directory[length - 1] == '\\');
+    snprintf(out_path, size, separator ? "%s%s" : "%s/%s", directory, path);
+}
+
+bool DirectoryCreate(const char* path)
+{
+#if defined(_WIN64)
+    return CreateDirectoryA(path, nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+#endif
+}
+
 static long FileGetSize(FileHandle file)
 {
     long file_size;
@@ -130,6 +168,45 @@ char* FileReadBinary(const char* filename, Allocator* allocator, sizet* size)
     return out;
 }
 
+bool FileWriteBinary(const char* filename, const void* data, sizet size)
+{
+    FILE* file = fopen(filename, "wb");
+    if (!file)
+        return false;
+
+    const bool written = fwrite(data, 1, size, file) == size;
+    return (fclose(file) == 0) && written;
+}
+
+bool FileExists(const char* path)
+{
+#if defined(_WIN64)
+    return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat file_stat;
+    return stat(path, &file_stat) == 0;
+#endif
+}
+
+int64 FileLastWriteTime(const char* path)
+{
+#if defined(_WIN64)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+        return 0;
+
+    // FILETIME counts 100ns intervals since 1601.
+    const uint64 ticks = ((uint64)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    return (int64)(ticks / 10000000ull) - 11644473600ll;
+#else
+    struct stat file_stat;
+    if (stat(path, &file_stat) != 0)
+        return 0;
+
+    return (int64)file_stat.st_mtime;
+#endif
+}
+
 bool FileDelete(const char* path)
 {
 #if defined(_WIN64)
@@ -141,5 +218,159 @@ bool FileDelete(const char* path)
 #endif
 }
 
+// MappedFile ----------------------------
+MappedFile::MappedFile(const char* filename, FileAccessHint::Enum hint)
+{
+    Open(filename, hint);
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+    *this = static_cast<MappedFile&&>(other);
+}
+
+MappedFile& MappedFile::operator = (MappedFile&& other)
+{
+    if (this != &other)
+    {
+        Close();
+
+        data = other.data;
+        size = other.size;
+        is_open = other.is_open;
+#if defined(_WIN64)
+        file_handle = other.file_handle;
+        mapping_handle = other.mapping_handle;
+        other.file_handle = nullptr;
+        other.mapping_handle = nullptr;
+#endif
+        other.data = nullptr;
+        other.size = 0;
+        other.is_open = false;
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const char* filename, FileAccessHint::Enum hint)
+{
+    Close();
+
+#if defined(_WIN64)
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 
+        hint == FileAccessHint::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        Raptor::Debug::LogError("Error: Could not open file %s\n", filename);
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    size = (sizet)file_size.QuadPart;
+    file_handle = file;
+    is_open = true;
+
+    // Empty files can not be mapped, they are still a valid zero sized view.
+    if (size == 0)
+        return true;
+
+    mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle)
+        data = (const uint8*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+#else
+    int file = open(filename, O_RDONLY);
+    if (file < 0)
+    {
+        Raptor::Debug::LogError("Error: Could not open file %s\n", filename);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(file, &file_stat) != 0)
+    {
+        close(file);
+        return false;
+    }
+
+    size = (sizet)file_stat.st_size;
+    is_open = true;
+
+    if (size == 0)
+    {
+        close(file);
+        return true;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps its own reference to the file.
+    close(file);
+
+    if (mapping != MAP_FAILED)
+        data = (const uint8*)mapping;
+#endif
+
+    if (!data)
+    {
+        Raptor::Debug::LogError("Error: Could not map file %s\n", filename);
+        Close();
+        return false;
+    }
+
+    Advise(hint);
+    return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN64)
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping_handle)
+        CloseHandle(mapping_handle);
+    if (file_handle)
+        CloseHandle(file_handle);
+
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+#else
+    if (data)
+        munmap((void*)data, size);
+#endif
+
+    data = nullptr;
+    size = 0;
+    is_open = false;
+}
+
+void MappedFile::Advise(FileAccessHint::Enum hint, sizet offset, sizet length)
+{
+#if !defined(_WIN64)
+    if (!data || offset >= size)
+        return;
+
+    // madvise needs a page aligned start.
+    const sizet page_size = (sizet)sysconf(_SC_PAGESIZE);
+    const sizet aligned_offset = offset & ~(page_size - 1);
+    if (length == 0 || offset + length > size)
+        length = size - offset;
+
+    int advice = MADV_NORMAL;
+    switch (hint)
+    {
+        case FileAccessHint::Sequential: advice = MADV_SEQUENTIAL; break;
+        case FileAccessHint::Random: advice = MADV_RANDOM; break;
+        case FileAccessHint::WillNeed: advice = MADV_WILLNEED; break;
+        default: break;
+    }
+
+    madvise((void*)(data + aligned_offset), length + (offset - aligned_offset), advice);
+#endif
+}
+
 } // namespace Core
 } // namespace Raptor
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdio.h>
+
 #include "Allocator.h"
 #include "Types.h"
 
@@ -17,6 +19,12 @@ void FilenameFromPath(char* path);
 
 void CurrentDirectory(char* path);
 void ChangeDirectory(const char* path);
+bool PathIsAbsolute(const char* path);
+// Joins a relative path to the directory. Absolute paths and a null directory
+// leave the path as it is.
+void PathFromDirectory(const char* directory, const char* path, char* out_path, sizet size);
+// Parent directories must exist, succeeds if the directory already does.
+bool DirectoryCreate(const char* path);
 
 struct FileReadResult
 {
@@ -29,7 +37,56 @@ static long FileGetSize(FileHandle file);
 FileReadResult FileReadBinary(const char* filename, Allocator* allocator);
 char* FileReadBinary(const char* filename, Allocator* allocator, sizet* size);
 
+bool FileWriteBinary(const char* filename, const void* data, sizet size);
+bool FileExists(const char* path);
+// Seconds since the epoch, 0 if the file does not exist.
+int64 FileLastWriteTime(const char* path);
 bool FileDelete(const char* path);
 
+namespace FileAccessHint
+{
+enum Enum : uint8
+{
+    Normal, Sequential, Random, WillNeed
+};
+} // namespace FileAccessHint
+
+// Read-only view of a whole file mapped into the address space. Pages are
+// faulted in on first access and the view is unmapped when the object dies.
+class MappedFile
+{
+public:
+
+    MappedFile() {}
+    MappedFile(const char* filename, FileAccessHint::Enum hint = FileAccessHint::Sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator = (MappedFile&& other);
+
+    bool Open(const char* filename, FileAccessHint::Enum hint = FileAccessHint::Sequential);
+    void Close();
+
+    // Passes a usage hint for a byte range to the kernel, length 0 means up to the end.
+    void Advise(FileAccessHint::Enum hint, sizet offset = 0, sizet length = 0);
+
+    bool IsOpen() const { return is_open; }
+
+    const uint8* data = nullptr;
+    sizet size = 0;
+
+private:
+
+    bool is_open = false;
+#if defined(_WIN64)
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+}; // class MappedFile
+
 } // namespace Core
 } // namespace Raptor
\ No newline at end of file
@@ -0,0 +1,161 @@
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#define RAPTOR_INOTIFY 1
+#endif
+
+#include <string.h>
+
+#include "FileWatcher.h"
+#include "Defines.h"
+#include "File.h"
+#include "Hash.h"
+#include "Log.h"
+#include "TimeService.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+void FileWatcher::init(Allocator* allocator_, double debounce_seconds_)
+{
+    allocator = allocator_;
+    debounce_seconds = debounce_seconds_;
+
+    files.set_allocator(*allocator);
+    changed_files.set_allocator(*allocator);
+
+#if defined(RAPTOR_INOTIFY)
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0)
+        Raptor::Debug::LogError("[FileWatcher]: Error: inotify_init1 failed (%d), changes will not be reported.\n", errno);
+#endif
+}
+
+void FileWatcher::shutdown()
+{
+#if defined(RAPTOR_INOTIFY)
+    // Closing the descriptor removes every watch.
+    if (inotify_fd >= 0)
+        close(inotify_fd);
+#endif
+    inotify_fd = -1;
+
+    for (auto it = files.begin(); it != files.end(); ++it)
+        allocator->deallocate(it->second.path, strlen(it->second.path) + 1);
+
+    files.clear(true);
+    changed_files.clear();
+    changed_files.shrink_to_fit();
+}
+
+bool FileWatcher::Watch(const char* path)
+{
+#if defined(RAPTOR_INOTIFY)
+    if (inotify_fd < 0)
+        return false;
+
+    char directory[MAX_FILENAME_LENGTH];
+    const char* separator = strrchr(path, '/');
+    const char* filename = separator ? separator + 1 : path;
+    if (separator)
+    {
+        const sizet length = MIN((sizet)(separator - path), sizeof(directory) - 1);
+        memcpy(directory, path, length);
+        directory[length] = 0;
+    }
+    else
+    {
+        strcpy(directory, ".");
+    }
+
+    // The same directory always yields the same descriptor.
+    const int32 watch_descriptor = inotify_add_watch(inotify_fd, directory[0] ? directory : "/", IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE);
+    if (watch_descriptor < 0)
+    {
+        Raptor::Debug::LogError("[FileWatcher]: Error: Could not watch %s (%d).\n", directory, errno);
+        return false;
+    }
+
+    const uint64 key = HashString(filename, (uint64)watch_descriptor);
+    if (files.find(key) != files.end())
+        return true;
+
+    const sizet path_size = strlen(path) + 1;
+    WatchedFile watched_file;
+    watched_file.path = (char*)allocator->allocate(path_size, 1, 0, 0);
+    memcpy(watched_file.path, path, path_size);
+    watched_file.last_change = 0;
+    watched_file.changed = false;
+
+    files[key] = watched_file;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FileWatcher::Update(FileChangedCallback callback, void* user_data)
+{
+#if defined(RAPTOR_INOTIFY)
+    if (inotify_fd < 0)
+        return;
+
+    const int64 now = Time::Now();
+
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        const ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const inotify_event* event = (const inotify_event*)(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+                Raptor::Debug::LogWarning("[FileWatcher]: Warning: Event queue overflowed, some changes were lost.\n");
+
+            if (event->len == 0)
+                continue;
+
+            auto it = files.find(HashString(event->name, (uint64)event->wd));
+            if (it == files.end())
+                continue;
+
+            // Every event restarts the debounce time of the file.
+            WatchedFile& watched_file = it->second;
+            watched_file.last_change = now;
+            if (!watched_file.changed)
+            {
+                watched_file.changed = true;
+                changed_files.push_back(it->first);
+            }
+        }
+    }
+
+    // Callbacks may watch new files, so entries are looked up again each time.
+    for (sizet i = 0; i < changed_files.size();)
+    {
+        auto it = files.find(changed_files[i]);
+        if (Time::DeltaSeconds(it->second.last_change, now) < debounce_seconds)
+        {
+            ++i;
+            continue;
+        }
+
+        it->second.changed = false;
+        changed_files[i] = changed_files.back();
+        changed_files.pop_back();
+
+        callback(it->second.path, user_data);
+    }
+#endif
+}
+
+} // namespace Core
+} // namespace Raptor
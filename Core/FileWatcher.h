@@ -0,0 +1,54 @@
+#pragma once
+
+#include <EASTL/vector.h>
+
+#include "Allocator.h"
+#include "HashMap.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+typedef void (*FileChangedCallback)(const char* path, void* user_data);
+
+// Reports changes to watched files once they stopped changing for the
+// debounce time, so editors that write in several steps trigger one report
+// and nothing is read half written. Uses inotify on Linux, elsewhere changes
+// are never reported. Used from one thread.
+class FileWatcher
+{
+public:
+
+    void init(Allocator* allocator, double debounce_seconds = 0.25);
+    void shutdown();
+
+    // Watches the directory of the file, so replacing the file by renaming
+    // another one over it is seen as well. Paths are reported as given here.
+    bool Watch(const char* path);
+
+    // Reads pending events without blocking and reports the files that settled.
+    void Update(FileChangedCallback callback, void* user_data);
+
+private:
+
+    struct WatchedFile
+    {
+        char* path;
+        int64 last_change;
+        bool changed;
+    }; // struct WatchedFile
+
+    Allocator* allocator = nullptr;
+    double debounce_seconds = 0.0;
+    int32 inotify_fd = -1;
+
+    // Keyed by the file name hashed with the watch descriptor of its directory.
+    HashMap<uint64, WatchedFile> files;
+    eastl::vector<uint64, ContainerAllocator> changed_files;
+
+}; // class FileWatcher
+
+} // namespace Core
+} // namespace Raptor
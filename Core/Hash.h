@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string.h>
+
 #include "Types.h"
 #include "wyhash.h"
 
@@ -13,10 +15,191 @@ inline uint64 HashBytes(void* data, sizet length, sizet seed = 0)
     return wyhash(data, length, seed, _wyp);
 }
 
+inline uint64 HashInteger(uint64 value, uint64 seed = 0)
+{
+    return wyhash64(value, seed);
+}
+
 inline uint64 HashString(const char* string, sizet seed = 0)
 {
     return wyhash(string, strlen(string), seed, _wyp);
 }
 
-}; // namespace Core
-}; // namespace Raptor
\ No newline at end of file
+// constexpr port of wyhash() so hashes of literals can be computed by the
+// compiler. It must produce exactly the same value as HashString.
+namespace ConstexprHash
+{
+
+constexpr void Mum(uint64& a, uint64& b)
+{
+    // Portable 64x64 -> 128 bit multiply, same as wyhash without __int128.
+    const uint64 ha = a >> 32, hb = b >> 32, la = (uint32)a, lb = (uint32)b;
+    const uint64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64 t = rl + (rm0 << 32);
+    uint64 c = t < rl;
+    const uint64 lo = t + (rm1 << 32);
+    c += lo < t;
+    const uint64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#if (WYHASH_CONDOM > 1)
+    a ^= lo;
+    b ^= hi;
+#else
+    a = lo;
+    b = hi;
+#endif
+}
+
+constexpr uint64 Mix(uint64 a, uint64 b)
+{
+    Mum(a, b);
+    return a ^ b;
+}
+
+constexpr uint64 Read8(const char* p)
+{
+    return (uint64)(uint8)p[0] | (uint64)(uint8)p[1] << 8 | (uint64)(uint8)p[2] << 16 | (uint64)(uint8)p[3] << 24
+        | (uint64)(uint8)p[4] << 32 | (uint64)(uint8)p[5] << 40 | (uint64)(uint8)p[6] << 48 | (uint64)(uint8)p[7] << 56;
+}
+
+constexpr uint64 Read4(const char* p)
+{
+    return (uint64)(uint8)p[0] | (uint64)(uint8)p[1] << 8 | (uint64)(uint8)p[2] << 16 | (uint64)(uint8)p[3] << 24;
+}
+
+constexpr uint64 Read3(const char* p, sizet k)
+{
+    return (uint64)(uint8)p[0] << 16 | (uint64)(uint8)p[k >> 1] << 8 | (uint64)(uint8)p[k - 1];
+}
+
+constexpr sizet Length(const char* string)
+{
+    sizet length = 0;
+    while (string[length])
+        ++length;
+    return length;
+}
+
+// Copy of _wyp, the array in wyhash.h can not be read in constant expressions.
+#if defined(wyhash_final_version_3)
+constexpr uint64 SECRET[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+#else
+constexpr uint64 SECRET[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+#endif
+
+constexpr uint64 Hash(const char* p, sizet length, uint64 seed, const uint64* secret = SECRET)
+{
+    uint64 a = 0, b = 0;
+
+#if defined(wyhash_final_version_3)
+    seed ^= secret[0];
+#else
+    seed ^= Mix(seed ^ secret[0], secret[1]);
+#endif
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            a = (Read4(p) << 32) | Read4(p + ((length >> 3) << 2));
+            b = (Read4(p + length - 4) << 32) | Read4(p + length - 4 - ((length >> 3) << 2));
+        }
+        else if (length > 0)
+        {
+            a = Read3(p, length);
+        }
+    }
+    else
+    {
+        sizet i = length;
+#if defined(wyhash_final_version_3)
+        if (i > 48)
+#else
+        if (i >= 48)
+#endif
+        {
+            uint64 see1 = seed, see2 = seed;
+            do
+            {
+                seed = Mix(Read8(p) ^ secret[1], Read8(p + 8) ^ seed);
+                see1 = Mix(Read8(p + 16) ^ secret[2], Read8(p + 24) ^ see1);
+                see2 = Mix(Read8(p + 32) ^ secret[3], Read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+#if defined(wyhash_final_version_3)
+            while (i > 48);
+#else
+            while (i >= 48);
+#endif
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = Mix(Read8(p) ^ secret[1], Read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = Read8(p + i - 16);
+        b = Read8(p + i - 8);
+    }
+
+#if defined(wyhash_final_version_3)
+    return Mix(secret[1] ^ length, Mix(a ^ secret[1], b ^ seed));
+#else
+    a ^= secret[1];
+    b ^= seed;
+    Mum(a, b);
+    return Mix(a ^ secret[0] ^ length, b ^ secret[1]);
+#endif
+}
+
+// Test vectors of upstream wyhash (test_vector.cpp, the seed is the index of
+// the string). Both versions published them with the secret final4 started
+// out with, the final3 one, so they are checked with it.
+constexpr uint64 TEST_SECRET[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+constexpr uint64 TestVector(const char* string, uint64 seed)
+{
+    return Hash(string, Length(string), seed, TEST_SECRET);
+}
+
+#if defined(wyhash_final_version_3)
+static_assert(TestVector("", 0) == 0x42bc986dc5eec4d3ull, "wyhash final3 port does not match upstream.");
+static_assert(TestVector("a", 1) == 0x84508dc903c31551ull, "wyhash final3 port does not match upstream.");
+static_assert(TestVector("abc", 2) == 0x0bc54887cfc9ecb1ull, "wyhash final3 port does not match upstream.");
+static_assert(TestVector("message digest", 3) == 0x6e2ff3298208a67cull, "wyhash final3 port does not match upstream.");
+static_assert(TestVector("abcdefghijklmnopqrstuvwxyz", 4) == 0x9a64e42e897195b9ull, "wyhash final3 port does not match upstream.");
+static_assert(TestVector("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 5) == 0x9199383239c32554ull, "wyhash final3 port does not match upstream.");
+static_assert(TestVector("12345678901234567890123456789012345678901234567890123456789012345678901234567890", 6) == 0x7c1ccf6bba30f5a5ull, "wyhash final3 port does not match upstream.");
+#else
+static_assert(TestVector("", 0) == 0x0409638ee2bde459ull, "wyhash final4 port does not match upstream.");
+static_assert(TestVector("a", 1) == 0xa8412d091b5fe0a9ull, "wyhash final4 port does not match upstream.");
+static_assert(TestVector("abc", 2) == 0x32dd92e4b2915153ull, "wyhash final4 port does not match upstream.");
+static_assert(TestVector("message digest", 3) == 0x8619124089a3a16bull, "wyhash final4 port does not match upstream.");
+static_assert(TestVector("abcdefghijklmnopqrstuvwxyz", 4) == 0x7a43afb61d7f5f40ull, "wyhash final4 port does not match upstream.");
+static_assert(TestVector("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 5) == 0xff42329b90e50d58ull, "wyhash final4 port does not match upstream.");
+static_assert(TestVector("12345678901234567890123456789012345678901234567890123456789012345678901234567890", 6) == 0xc39cab13b115aad3ull, "wyhash final4 port does not match upstream.");
+#endif
+
+} // namespace ConstexprHash
+
+constexpr uint64 HashStringConstexpr(const char* string, sizet length, uint64 seed = 0)
+{
+    return ConstexprHash::Hash(string, length, seed);
+}
+
+constexpr uint64 HashStringConstexpr(const char* string)
+{
+    return ConstexprHash::Hash(string, ConstexprHash::Length(string), 0);
+}
+
+// "name"_hash, bring it in scope with `using Raptor::Core::operator""_hash;`.
+constexpr uint64 operator"" _hash(const char* string, sizet length)
+{
+    return ConstexprHash::Hash(string, length, 0);
+}
+
+} // namespace Core
+} // namespace Raptor
@@ -1,16 +1,503 @@
 #pragma once
 
-#include <EASTL/hash_map.h>
+#include <new>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAPTOR_HASHMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <EASTL/functional.h>
+#include <EASTL/type_traits.h>
+#include <EASTL/utility.h>
+
+#include "Allocator.h"
+#include "Debug.h"
+#include "Hash.h"
+#include "Types.h"
 
 namespace Raptor
 {
 namespace Core
 {
-template<typename Key, typename T>
-using HashMap = eastl::hash_map<Key,T>;
+
+template<typename Key, typename Enable = void>
+struct HashMapHasher
+{
+    uint64 operator()(const Key& key) const { return HashBytes((void*)&key, sizeof(Key)); }
+};
+
+template<typename Key>
+struct HashMapHasher<Key, typename eastl::enable_if<eastl::is_integral<Key>::value || eastl::is_enum<Key>::value || eastl::is_pointer<Key>::value>::type>
+{
+    uint64 operator()(const Key& key) const { return HashInteger((uint64)key); }
+};
+
+// Metadata byte per slot: the top bit marks empty/deleted, otherwise the low
+// 7 bits hold the H2 part of the hash.
+namespace HashMapControl
+{
+static const uint8 Empty = 0x80;
+static const uint8 Deleted = 0xfe;
+} // namespace HashMapControl
+
+// 16 control bytes scanned at once. Each Match* returns one bit per slot.
+struct HashMapGroup
+{
+    static const uint32 SIZE = 16;
+
+#if defined(RAPTOR_HASHMAP_SSE2)
+    explicit HashMapGroup(const uint8* control) : control(_mm_load_si128((const __m128i*)control)) {}
+
+    uint32 Match(uint8 h2) const { return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8((char)h2))); }
+    uint32 MatchEmpty() const { return Match(HashMapControl::Empty); }
+    uint32 MatchEmptyOrDeleted() const { return (uint32)_mm_movemask_epi8(control); }
+
+    __m128i control;
+#else
+    explicit HashMapGroup(const uint8* control_) { memcpy(control, control_, SIZE); }
+
+    uint32 Match(uint8 h2) const
+    {
+        uint32 mask = 0;
+        for (uint32 i = 0; i < SIZE; ++i)
+            mask |= (uint32)(control[i] == h2) << i;
+        return mask;
+    }
+
+    uint32 MatchEmpty() const { return Match(HashMapControl::Empty); }
+
+    uint32 MatchEmptyOrDeleted() const
+    {
+        uint32 mask = 0;
+        for (uint32 i = 0; i < SIZE; ++i)
+            mask |= (uint32)(control[i] >> 7) << i;
+        return mask;
+    }
+
+    uint8 control[SIZE];
+#endif
+
+    static uint32 LowestBit(uint32 mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (uint32)index;
+#else
+        return (uint32)__builtin_ctz(mask);
+#endif
+    }
+
+}; // struct HashMapGroup
+
+// Flat open-addressing hash map in the style of Swiss tables. Entries live in
+// one allocation next to their control bytes, lookups probe 16 slots at a
+// time and erasing never moves other entries, so iterators stay valid.
+// The interface follows the subset of eastl::hash_map used by the engine.
+template<typename Key, typename T, typename Hash = HashMapHasher<Key>, typename Equal = eastl::equal_to<Key>>
+class HashMap
+{
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = eastl::pair<const Key, T>;
+    using size_type = sizet;
+    using allocator_type = ContainerAllocator;
+
+    template<bool IsConst>
+    class Iterator
+    {
+    public:
+
+        using pointer = typename eastl::conditional<IsConst, const value_type*, value_type*>::type;
+        using reference = typename eastl::conditional<IsConst, const value_type&, value_type&>::type;
+
+        Iterator() {}
+        Iterator(const uint8* control, pointer slot, const uint8* control_end) : control(control), slot(slot), control_end(control_end) { SkipEmpty(); }
+        Iterator(const Iterator<false>& other) : control(other.control), slot(other.slot), control_end(other.control_end) {}
+
+        reference operator * () const { return *slot; }
+        pointer operator -> () const { return slot; }
+
+        Iterator& operator ++ () { ++control; ++slot; SkipEmpty(); return *this; }
+        Iterator operator ++ (int) { Iterator result = *this; ++(*this); return result; }
+
+        bool operator == (const Iterator& other) const { return control == other.control; }
+        bool operator != (const Iterator& other) const { return control != other.control; }
+
+        const uint8* control = nullptr;
+        pointer slot = nullptr;
+        const uint8* control_end = nullptr;
+
+    private:
+
+        void SkipEmpty()
+        {
+            while (control != control_end && (*control & HashMapControl::Empty))
+            {
+                ++control;
+                ++slot;
+            }
+        }
+
+    }; // class Iterator
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using insert_return_type = eastl::pair<iterator, bool>;
+
+    explicit HashMap(const ContainerAllocator& allocator = ContainerAllocator("Raptor::Core::HashMap")) : allocator(allocator) {}
+
+    HashMap(const HashMap& other) : allocator(other.allocator)
+    {
+        reserve(other.size_);
+        for (const value_type& value : other)
+            insert(value);
+    }
+
+    HashMap(HashMap&& other) : allocator(other.allocator)
+    {
+        swap(other);
+    }
+
+    ~HashMap()
+    {
+        clear(true);
+    }
+
+    HashMap& operator = (const HashMap& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other.size_);
+            for (const value_type& value : other)
+                insert(value);
+        }
+        return *this;
+    }
+
+    HashMap& operator = (HashMap&& other)
+    {
+        if (this != &other)
+        {
+            clear(true);
+            allocator = other.allocator;
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(HashMap& other)
+    {
+        eastl::swap(allocator, other.allocator);
+        eastl::swap(control, other.control);
+        eastl::swap(slots, other.slots);
+        eastl::swap(capacity_, other.capacity_);
+        eastl::swap(size_, other.size_);
+        eastl::swap(growth_left, other.growth_left);
+    }
+
+    // Only valid before the first insertion, memory is always returned to the
+    // allocator it came from.
+    void set_allocator(const ContainerAllocator& allocator_)
+    {
+        ASSERT(control == nullptr);
+        allocator = allocator_;
+    }
+
+    const ContainerAllocator& get_allocator() const { return allocator; }
+
+    iterator begin() { return iterator(control, slots, control + capacity_); }
+    iterator end() { return iterator(control + capacity_, slots + capacity_, control + capacity_); }
+    const_iterator begin() const { return const_iterator(control, slots, control + capacity_); }
+    const_iterator end() const { return const_iterator(control + capacity_, slots + capacity_, control + capacity_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type capacity() const { return capacity_; }
+
+    iterator find(const Key& key)
+    {
+        const sizet index = FindIndex(key, hasher(key));
+        return index == INVALID_SLOT ? end() : MakeIterator(index);
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        const sizet index = FindIndex(key, hasher(key));
+        return index == INVALID_SLOT ? end() : const_iterator(control + index, slots + index, control + capacity_);
+    }
+
+    size_type count(const Key& key) const
+    {
+        return FindIndex(key, hasher(key)) == INVALID_SLOT ? 0 : 1;
+    }
+
+    T& at(const Key& key)
+    {
+        const sizet index = FindIndex(key, hasher(key));
+        ASSERT_MESSAGE(index != INVALID_SLOT, "[HashMap]: Error: Key not found in %s.\n", allocator.get_name());
+        return slots[index].second;
+    }
+
+    const T& at(const Key& key) const
+    {
+        const sizet index = FindIndex(key, hasher(key));
+        ASSERT_MESSAGE(index != INVALID_SLOT, "[HashMap]: Error: Key not found in %s.\n", allocator.get_name());
+        return slots[index].second;
+    }
+
+    T& operator [] (const Key& key)
+    {
+        const uint64 hash = hasher(key);
+        sizet index = FindIndex(key, hash);
+        if (index == INVALID_SLOT)
+        {
+            index = PrepareInsert(hash);
+            new (slots + index) value_type(key, T());
+        }
+        return slots[index].second;
+    }
+
+    insert_return_type insert(const value_type& value)
+    {
+        const uint64 hash = hasher(value.first);
+        sizet index = FindIndex(value.first, hash);
+        if (index != INVALID_SLOT)
+            return insert_return_type(MakeIterator(index), false);
+
+        index = PrepareInsert(hash);
+        new (slots + index) value_type(value);
+        return insert_return_type(MakeIterator(index), true);
+    }
+
+    iterator erase(const_iterator position)
+    {
+        if (position == cend())
+            return end();
+
+        const sizet index = position.control - control;
+        EraseIndex(index);
+        return MakeIterator(index + 1);
+    }
+
+    iterator erase(iterator position)
+    {
+        return erase(const_iterator(position));
+    }
+
+    size_type erase(const Key& key)
+    {
+        const sizet index = FindIndex(key, hasher(key));
+        if (index == INVALID_SLOT)
+            return 0;
+
+        EraseIndex(index);
+        return 1;
+    }
+
+    void clear(bool free_memory = false)
+    {
+        if (!eastl::is_trivially_destructible<value_type>::value)
+        {
+            for (sizet i = 0; i < capacity_; ++i)
+            {
+                if (!(control[i] & HashMapControl::Empty))
+                    slots[i].~value_type();
+            }
+        }
+
+        size_ = 0;
+
+        if (free_memory)
+        {
+            FreeStorage();
+            control = nullptr;
+            slots = nullptr;
+            capacity_ = 0;
+            growth_left = 0;
+        }
+        else if (capacity_)
+        {
+            memset(control, HashMapControl::Empty, capacity_);
+            growth_left = MaxLoad(capacity_);
+        }
+    }
+
+    void reserve(size_type count)
+    {
+        if (count > MaxLoad(capacity_))
+            Resize(CapacityFor(count));
+    }
+
+private:
+
+    static const sizet INVALID_SLOT = ~(sizet)0;
+
+    static uint8 H2(uint64 hash) { return (uint8)(hash & 0x7f); }
+    static sizet H1(uint64 hash) { return (sizet)(hash >> 7); }
+
+    // 7/8 maximum load factor.
+    static sizet MaxLoad(sizet capacity) { return capacity - capacity / 8; }
+
+    static sizet CapacityFor(sizet count)
+    {
+        sizet capacity = HashMapGroup::SIZE;
+        while (MaxLoad(capacity) < count)
+            capacity *= 2;
+        return capacity;
+    }
+
+    static sizet SlotsOffset(sizet capacity) { return MemoryAlign(capacity, alignof(value_type)); }
+    static sizet StorageSize(sizet capacity) { return SlotsOffset(capacity) + capacity * sizeof(value_type); }
+
+    iterator MakeIterator(sizet index) { return iterator(control + index, slots + index, control + capacity_); }
+
+    // Groups are probed with a triangular sequence, which visits every group
+    // once when the group count is a power of two.
+    sizet FindIndex(const Key& key, uint64 hash) const
+    {
+        if (!capacity_)
+            return INVALID_SLOT;
+
+        const sizet group_mask = capacity_ / HashMapGroup::SIZE - 1;
+        const uint8 h2 = H2(hash);
+        sizet group = H1(hash) & group_mask;
+
+        for (sizet step = 1; ; ++step)
+        {
+            const sizet group_start = group * HashMapGroup::SIZE;
+            const HashMapGroup group_control(control + group_start);
+
+            for (uint32 match = group_control.Match(h2); match; match &= match - 1)
+            {
+                const sizet index = group_start + HashMapGroup::LowestBit(match);
+                if (equal(slots[index].first, key))
+                    return index;
+            }
+
+            if (group_control.MatchEmpty() || step > group_mask)
+                return INVALID_SLOT;
+
+            group = (group + step) & group_mask;
+        }
+    }
+
+    sizet FindInsertSlot(uint64 hash) const
+    {
+        const sizet group_mask = capacity_ / HashMapGroup::SIZE - 1;
+        sizet group = H1(hash) & group_mask;
+
+        for (sizet step = 1; ; ++step)
+        {
+            const sizet group_start = group * HashMapGroup::SIZE;
+            const uint32 mask = HashMapGroup(control + group_start).MatchEmptyOrDeleted();
+            if (mask)
+                return group_start + HashMapGroup::LowestBit(mask);
+
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // Returns a slot ready for placement new, growing or purging tombstones first if needed.
+    sizet PrepareInsert(uint64 hash)
+    {
+        if (growth_left == 0)
+        {
+            // Mostly tombstones: rehash in place size, otherwise double.
+            if (capacity_ && size_ <= MaxLoad(capacity_) / 2)
+                Resize(capacity_);
+            else
+                Resize(capacity_ ? capacity_ * 2 : HashMapGroup::SIZE);
+        }
+
+        const sizet index = FindInsertSlot(hash);
+        if (control[index] == HashMapControl::Empty)
+            --growth_left;
+
+        control[index] = H2(hash);
+        ++size_;
+        return index;
+    }
+
+    void EraseIndex(sizet index)
+    {
+        slots[index].~value_type();
+        --size_;
+
+        // A group that still has an empty slot never made a probe move on, so
+        // the slot can become empty again instead of a tombstone.
+        const sizet group_start = index & ~(sizet)(HashMapGroup::SIZE - 1);
+        if (HashMapGroup(control + group_start).MatchEmpty())
+        {
+            control[index] = HashMapControl::Empty;
+            ++growth_left;
+        }
+        else
+        {
+            control[index] = HashMapControl::Deleted;
+        }
+    }
+
+    void Resize(sizet new_capacity)
+    {
+        uint8* old_control = control;
+        value_type* old_slots = slots;
+        const sizet old_capacity = capacity_;
+
+        const sizet alignment = alignof(value_type) > HashMapGroup::SIZE ? alignof(value_type) : HashMapGroup::SIZE;
+        control = (uint8*)allocator.allocate(StorageSize(new_capacity), alignment, 0, 0);
+        slots = (value_type*)(control + SlotsOffset(new_capacity));
+        capacity_ = new_capacity;
+        growth_left = MaxLoad(new_capacity) - size_;
+        memset(control, HashMapControl::Empty, new_capacity);
+
+        for (sizet i = 0; i < old_capacity; ++i)
+        {
+            if (old_control[i] & HashMapControl::Empty)
+                continue;
+
+            const uint64 hash = hasher(old_slots[i].first);
+            const sizet index = FindInsertSlot(hash);
+            control[index] = H2(hash);
+            new (slots + index) value_type(eastl::move(old_slots[i]));
+            old_slots[i].~value_type();
+        }
+
+        if (old_control)
+            allocator.deallocate(old_control, StorageSize(old_capacity));
+    }
+
+    void FreeStorage()
+    {
+        if (control)
+            allocator.deallocate(control, StorageSize(capacity_));
+    }
+
+    ContainerAllocator allocator;
+    Hash hasher;
+    Equal equal;
+
+    uint8* control = nullptr;
+    value_type* slots = nullptr;
+    sizet capacity_ = 0;
+    sizet size_ = 0;
+    sizet growth_left = 0;
+
+}; // class HashMap
 
 template<typename Key, typename T>
 using Pair = eastl::pair<Key, T>;
 
 } // namespace Core
-} // namespace Raptor
\ No newline at end of file
+} // namespace Raptor
@@ -0,0 +1,464 @@
+#include <stddef.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "HeapAllocator.h"
+#include "Debug.h"
+#include "Defines.h"
+#include "Log.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+// Blocks are laid out back to back inside a pool. The header is followed by
+// the payload; while a block is free the payload holds the free list links.
+struct HeapBlock
+{
+    HeapBlock* prev_physical;
+    sizet size;
+    uint32 tag;
+    uint32 is_free;
+    uint64 reserved;
+
+    HeapBlock* next_free;
+    HeapBlock* prev_free;
+
+}; // struct HeapBlock
+
+struct HeapPool
+{
+    HeapPool* next;
+    sizet size;
+    HeapBlock* sentinel;
+    uint64 reserved;
+
+}; // struct HeapPool
+
+static const sizet BLOCK_HEADER_SIZE = offsetof(HeapBlock, next_free);
+static const sizet BLOCK_ALIGNMENT = (sizet)1 << HeapAllocator::ALIGN_SIZE_LOG2;
+static const sizet MIN_BLOCK_SIZE = sizeof(HeapBlock) - BLOCK_HEADER_SIZE;
+static const sizet SMALL_BLOCK_SIZE = (sizet)1 << HeapAllocator::FL_INDEX_SHIFT;
+static const sizet POOL_OVERHEAD = sizeof(HeapPool) + 2 * BLOCK_HEADER_SIZE;
+
+static_assert(BLOCK_HEADER_SIZE % BLOCK_ALIGNMENT == 0, "HeapBlock header must keep payloads aligned.");
+static_assert(sizeof(HeapPool) % BLOCK_ALIGNMENT == 0, "HeapPool header must keep blocks aligned.");
+
+static inline uint32 FindLastSet(sizet value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint32)index;
+#else
+    return 63 - (uint32)__builtin_clzll(value);
+#endif
+}
+
+static inline uint32 FindFirstSet(uint32 value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (uint32)index;
+#else
+    return (uint32)__builtin_ctz(value);
+#endif
+}
+
+static inline uint8* BlockPayload(HeapBlock* block)
+{
+    return (uint8*)block + BLOCK_HEADER_SIZE;
+}
+
+static inline HeapBlock* BlockFromPayload(void* pointer)
+{
+    return (HeapBlock*)((uint8*)pointer - BLOCK_HEADER_SIZE);
+}
+
+static inline HeapBlock* BlockNextPhysical(HeapBlock* block)
+{
+    return (HeapBlock*)(BlockPayload(block) + block->size);
+}
+
+static inline void MappingInsert(sizet size, uint32& fl, uint32& sl)
+{
+    if (size < SMALL_BLOCK_SIZE)
+    {
+        fl = 0;
+        sl = (uint32)(size / (SMALL_BLOCK_SIZE / HeapAllocator::SL_INDEX_COUNT));
+    }
+    else
+    {
+        fl = FindLastSet(size);
+        sl = (uint32)(size >> (fl - HeapAllocator::SL_INDEX_COUNT_LOG2)) ^ HeapAllocator::SL_INDEX_COUNT;
+        fl -= HeapAllocator::FL_INDEX_SHIFT - 1;
+    }
+}
+
+// Rounds up to the first size of the next list, the smallest block that a
+// search for size can find.
+static inline sizet RoundUpToList(sizet size)
+{
+    if (size < SMALL_BLOCK_SIZE)
+        return size;
+
+    const sizet round = ((sizet)1 << (FindLastSet(size) - HeapAllocator::SL_INDEX_COUNT_LOG2)) - 1;
+    return (size + round) & ~round;
+}
+
+// Rounds up to the next list so every block found there is large enough.
+static inline void MappingSearch(sizet size, uint32& fl, uint32& sl)
+{
+    MappingInsert(RoundUpToList(size), fl, sl);
+}
+
+namespace MemoryTag
+{
+const char* ToString(Enum tag)
+{
+    static const char* s_names[] = { "Core", "Graphics", "Assets", "UI" };
+    return tag < Count ? s_names[tag] : "Unknown";
+}
+} // namespace MemoryTag
+
+// HeapAllocator ----------------------------
+HeapAllocator::HeapAllocator(Allocator* backing_allocator, sizet pool_size)
+{
+    init(backing_allocator, pool_size);
+}
+
+HeapAllocator::~HeapAllocator()
+{
+    if (pools)
+        shutdown();
+}
+
+void HeapAllocator::init(Allocator* backing_allocator_, sizet pool_size_)
+{
+    backing_allocator = backing_allocator_;
+    pool_size = pool_size_;
+
+    AddPool(pool_size);
+}
+
+void HeapAllocator::shutdown()
+{
+    if (total_live_bytes != 0)
+    {
+        Raptor::Debug::LogWarning("[HeapAllocator]: Warning: %zu bytes still allocated at shutdown.\n", total_live_bytes);
+        LogStatistics();
+    }
+
+    HeapPool* pool = pools;
+    while (pool)
+    {
+        HeapPool* next = pool->next;
+        backing_allocator->deallocate(pool, pool->size);
+        pool = next;
+    }
+
+    pools = nullptr;
+    fl_bitmap = 0;
+    for (uint32 fl = 0; fl < FL_INDEX_COUNT; ++fl)
+    {
+        sl_bitmap[fl] = 0;
+        for (uint32 sl = 0; sl < SL_INDEX_COUNT; ++sl)
+            free_lists[fl][sl] = nullptr;
+    }
+}
+
+void* HeapAllocator::allocate(sizet size, int flags)
+{
+    return Allocate(size, DEFAULT_ALIGNMENT, default_tag);
+}
+
+void* HeapAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+{
+    return Allocate(size, alignment, default_tag);
+}
+
+void HeapAllocator::deallocate(void* pointer, sizet size)
+{
+    Free(pointer);
+}
+
+void* HeapAllocator::Allocate(sizet size, sizet alignment, MemoryTag::Enum tag)
+{
+    ASSERT(tag < MemoryTag::Count);
+
+    alignment = MAX(alignment, BLOCK_ALIGNMENT);
+    const sizet adjusted_size = MAX(MemoryAlign(size, BLOCK_ALIGNMENT), MIN_BLOCK_SIZE);
+
+    // Over-aligned requests need room to split off a free block in front.
+    sizet search_size = adjusted_size;
+    if (alignment > BLOCK_ALIGNMENT)
+        search_size += alignment + BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE;
+
+    HeapBlock* block = FindFreeBlock(search_size);
+    if (!block)
+    {
+        // The search skips the list the request falls in, so the block of the
+        // new pool has to reach the next one or the retry fails as well.
+        AddPool(MAX(pool_size, RoundUpToList(search_size) + POOL_OVERHEAD));
+        block = FindFreeBlock(search_size);
+    }
+
+    if (!block)
+    {
+        ASSERT_MESSAGE(false, "[HeapAllocator]: Error: Out of memory, requested %zu bytes.\n", size);
+        return nullptr;
+    }
+
+    RemoveFreeBlock(block);
+
+    if (alignment > BLOCK_ALIGNMENT)
+    {
+        uint8* payload = BlockPayload(block);
+        sizet gap = MemoryAlign((sizet)payload, alignment) - (sizet)payload;
+        if (gap != 0 && gap < BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE)
+            gap = MemoryAlign((sizet)payload + BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE, alignment) - (sizet)payload;
+
+        if (gap != 0)
+        {
+            HeapBlock* aligned_block = (HeapBlock*)(payload + gap - BLOCK_HEADER_SIZE);
+            aligned_block->prev_physical = block;
+            aligned_block->size = block->size - gap;
+            aligned_block->is_free = 1;
+            BlockNextPhysical(aligned_block)->prev_physical = aligned_block;
+
+            block->size = gap - BLOCK_HEADER_SIZE;
+            InsertFreeBlock(block);
+
+            block = aligned_block;
+        }
+    }
+
+    // Return the tail to the free lists if it can hold a block of its own.
+    if (block->size >= adjusted_size + BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE)
+    {
+        HeapBlock* remaining = (HeapBlock*)(BlockPayload(block) + adjusted_size);
+        remaining->prev_physical = block;
+        remaining->size = block->size - adjusted_size - BLOCK_HEADER_SIZE;
+        remaining->is_free = 1;
+        BlockNextPhysical(remaining)->prev_physical = remaining;
+
+        block->size = adjusted_size;
+        InsertFreeBlock(remaining);
+    }
+
+    block->is_free = 0;
+    block->tag = tag;
+
+    live_bytes[tag] += block->size;
+    peak_bytes[tag] = MAX(peak_bytes[tag], live_bytes[tag]);
+    ++live_allocations[tag];
+    total_live_bytes += block->size;
+    total_peak_bytes = MAX(total_peak_bytes, total_live_bytes);
+
+    return BlockPayload(block);
+}
+
+void HeapAllocator::Free(void* pointer)
+{
+    if (!pointer)
+        return;
+
+    HeapBlock* block = BlockFromPayload(pointer);
+    ASSERT_MESSAGE(!block->is_free, "[HeapAllocator]: Error: Double free of %p.\n", pointer);
+
+    live_bytes[block->tag] -= block->size;
+    --live_allocations[block->tag];
+    total_live_bytes -= block->size;
+
+    block->is_free = 1;
+
+    HeapBlock* prev = block->prev_physical;
+    if (prev && prev->is_free)
+    {
+        RemoveFreeBlock(prev);
+        prev->size += BLOCK_HEADER_SIZE + block->size;
+        BlockNextPhysical(prev)->prev_physical = prev;
+        block = prev;
+    }
+
+    HeapBlock* next = BlockNextPhysical(block);
+    if (next->is_free)
+    {
+        RemoveFreeBlock(next);
+        block->size += BLOCK_HEADER_SIZE + next->size;
+        BlockNextPhysical(block)->prev_physical = block;
+    }
+
+    InsertFreeBlock(block);
+}
+
+void HeapAllocator::QueryStatistics(HeapStatistics& out_statistics) const
+{
+    out_statistics = HeapStatistics {};
+
+    for (uint32 tag = 0; tag < MemoryTag::Count; ++tag)
+    {
+        out_statistics.live_bytes[tag] = live_bytes[tag];
+        out_statistics.peak_bytes[tag] = peak_bytes[tag];
+        out_statistics.live_allocations[tag] = live_allocations[tag];
+    }
+
+    out_statistics.total_live_bytes = total_live_bytes;
+    out_statistics.total_peak_bytes = total_peak_bytes;
+
+    for (HeapPool* pool = pools; pool; pool = pool->next)
+    {
+        ++out_statistics.pools;
+        out_statistics.pool_bytes += pool->size;
+
+        for (HeapBlock* block = (HeapBlock*)(pool + 1); block != pool->sentinel; block = BlockNextPhysical(block))
+        {
+            if (!block->is_free)
+                continue;
+
+            ++out_statistics.free_blocks;
+            out_statistics.free_bytes += block->size;
+            out_statistics.largest_free_block = MAX(out_statistics.largest_free_block, block->size);
+        }
+    }
+
+    if (out_statistics.free_bytes > 0)
+        out_statistics.fragmentation = 1.f - (float)out_statistics.largest_free_block / (float)out_statistics.free_bytes;
+}
+
+void HeapAllocator::LogStatistics() const
+{
+    HeapStatistics statistics;
+    QueryStatistics(statistics);
+
+    Raptor::Debug::Log("[HeapAllocator]: %s: %zu/%zu bytes live, peak %zu, %u pools, %u free blocks, fragmentation %.2f\n",
+        name, statistics.total_live_bytes, statistics.pool_bytes, statistics.total_peak_bytes,
+        statistics.pools, statistics.free_blocks, statistics.fragmentation);
+
+    for (uint32 tag = 0; tag < MemoryTag::Count; ++tag)
+    {
+        Raptor::Debug::Log("    %-10s %10zu bytes live in %6u allocations, peak %10zu\n",
+            MemoryTag::ToString((MemoryTag::Enum)tag), statistics.live_bytes[tag],
+            statistics.live_allocations[tag], statistics.peak_bytes[tag]);
+    }
+}
+
+HeapPool* HeapAllocator::AddPool(sizet size)
+{
+    ASSERT(size > POOL_OVERHEAD + MIN_BLOCK_SIZE);
+
+    HeapPool* pool = (HeapPool*)backing_allocator->allocate(size, BLOCK_ALIGNMENT, 0, 0);
+    if (!pool)
+        return nullptr;
+
+    pool->next = pools;
+    pool->size = size;
+    pools = pool;
+
+    // One free block spanning the pool, closed by an empty used sentinel so
+    // coalescing never walks past the end.
+    HeapBlock* block = (HeapBlock*)(pool + 1);
+    block->prev_physical = nullptr;
+    block->size = (size - POOL_OVERHEAD) & ~(BLOCK_ALIGNMENT - 1);
+    block->is_free = 1;
+
+    HeapBlock* sentinel = BlockNextPhysical(block);
+    sentinel->prev_physical = block;
+    sentinel->size = 0;
+    sentinel->is_free = 0;
+    sentinel->tag = MemoryTag::Core;
+    pool->sentinel = sentinel;
+
+    InsertFreeBlock(block);
+
+    return pool;
+}
+
+HeapBlock* HeapAllocator::FindFreeBlock(sizet size)
+{
+    uint32 fl, sl;
+    MappingSearch(size, fl, sl);
+
+    if (fl >= FL_INDEX_COUNT)
+        return nullptr;
+
+    uint32 sl_map = sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map)
+    {
+        const uint32 fl_map = (fl + 1 < 32) ? fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (!fl_map)
+            return nullptr;
+
+        fl = FindFirstSet(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+
+    sl = FindFirstSet(sl_map);
+    return free_lists[fl][sl];
+}
+
+void HeapAllocator::InsertFreeBlock(HeapBlock* block)
+{
+    uint32 fl, sl;
+    MappingInsert(block->size, fl, sl);
+
+    HeapBlock* head = free_lists[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head)
+        head->prev_free = block;
+
+    free_lists[fl][sl] = block;
+    fl_bitmap |= 1u << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+void HeapAllocator::RemoveFreeBlock(HeapBlock* block)
+{
+    uint32 fl, sl;
+    MappingInsert(block->size, fl, sl);
+
+    if (block->next_free)
+        block->next_free->prev_free = block->prev_free;
+    if (block->prev_free)
+        block->prev_free->next_free = block->next_free;
+
+    if (free_lists[fl][sl] == block)
+    {
+        free_lists[fl][sl] = block->next_free;
+        if (!free_lists[fl][sl])
+        {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (!sl_bitmap[fl])
+                fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+// TaggedAllocator ----------------------------
+TaggedAllocator::TaggedAllocator(HeapAllocator& heap, MemoryTag::Enum tag)
+    : heap(&heap), tag(tag)
+{
+    name = MemoryTag::ToString(tag);
+}
+
+void* TaggedAllocator::allocate(sizet size, int flags)
+{
+    return heap->Allocate(size, DEFAULT_ALIGNMENT, tag);
+}
+
+void* TaggedAllocator::allocate(sizet size, sizet alignment, sizet offset, int flags)
+{
+    return heap->Allocate(size, alignment, tag);
+}
+
+void TaggedAllocator::deallocate(void* pointer, sizet size)
+{
+    heap->Free(pointer);
+}
+
+} // namespace Core
+} // namespace Raptor
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Allocator.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+namespace MemoryTag
+{
+enum Enum : uint8
+{
+    Core, Graphics, Assets, UI, Count
+};
+
+const char* ToString(Enum tag);
+
+} // namespace MemoryTag
+
+struct HeapStatistics
+{
+    sizet live_bytes[MemoryTag::Count] = {};
+    sizet peak_bytes[MemoryTag::Count] = {};
+    uint32 live_allocations[MemoryTag::Count] = {};
+
+    sizet total_live_bytes = 0;
+    sizet total_peak_bytes = 0;
+
+    sizet pool_bytes = 0;
+    sizet free_bytes = 0;
+    sizet largest_free_block = 0;
+    uint32 free_blocks = 0;
+    uint32 pools = 0;
+
+    // 0 when all free memory is one block, approaching 1 as it gets scattered.
+    float fragmentation = 0.f;
+}; // struct HeapStatistics
+
+struct HeapBlock;
+struct HeapPool;
+
+// Two-Level Segregated Fit allocator: allocation and deallocation are O(1)
+// with a bounded number of bitmap scans, independent of the heap size.
+// Every block is tagged so live and peak usage can be queried per subsystem.
+class HeapAllocator : public Allocator
+{
+public:
+
+    HeapAllocator() {}
+    HeapAllocator(Allocator* backing_allocator, sizet pool_size);
+    ~HeapAllocator();
+
+    void init(Allocator* backing_allocator, sizet pool_size);
+    void shutdown();
+
+    void* allocate(sizet size, int flags = 0) override;
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override;
+    void deallocate(void* pointer, sizet size) override;
+
+    void* Allocate(sizet size, sizet alignment, MemoryTag::Enum tag);
+    void Free(void* pointer);
+
+    sizet LiveBytes(MemoryTag::Enum tag) const { return live_bytes[tag]; }
+    sizet PeakBytes(MemoryTag::Enum tag) const { return peak_bytes[tag]; }
+    sizet TotalLiveBytes() const { return total_live_bytes; }
+    sizet TotalPeakBytes() const { return total_peak_bytes; }
+
+    // Walks every block, meant for debug UI and reports rather than per frame use.
+    void QueryStatistics(HeapStatistics& out_statistics) const;
+    void LogStatistics() const;
+
+    static const uint32 ALIGN_SIZE_LOG2 = 4;
+    static const uint32 SL_INDEX_COUNT_LOG2 = 5;
+    static const uint32 SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+    static const uint32 FL_INDEX_MAX = 40;
+    static const uint32 FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+    static const uint32 FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+    MemoryTag::Enum default_tag = MemoryTag::Core;
+
+private:
+
+    HeapPool* AddPool(sizet size);
+
+    HeapBlock* FindFreeBlock(sizet size);
+    void InsertFreeBlock(HeapBlock* block);
+    void RemoveFreeBlock(HeapBlock* block);
+
+    Allocator* backing_allocator = nullptr;
+    HeapPool* pools = nullptr;
+    sizet pool_size = 0;
+
+    uint32 fl_bitmap = 0;
+    uint32 sl_bitmap[FL_INDEX_COUNT] = {};
+    HeapBlock* free_lists[FL_INDEX_COUNT][SL_INDEX_COUNT] = {};
+
+    sizet live_bytes[MemoryTag::Count] = {};
+    sizet peak_bytes[MemoryTag::Count] = {};
+    uint32 live_allocations[MemoryTag::Count] = {};
+    sizet total_live_bytes = 0;
+    sizet total_peak_bytes = 0;
+
+}; // class HeapAllocator
+
+// Routes every allocation to a HeapAllocator under a fixed tag, so a subsystem
+// can be handed a plain Allocator& and still be accounted separately.
+class TaggedAllocator : public Allocator
+{
+public:
+
+    TaggedAllocator(HeapAllocator& heap, MemoryTag::Enum tag);
+
+    void* allocate(sizet size, int flags = 0) override;
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override;
+    void deallocate(void* pointer, sizet size) override;
+
+    HeapAllocator* heap;
+    MemoryTag::Enum tag;
+
+}; // class TaggedAllocator
+
+} // namespace Core
+} // namespace Raptor
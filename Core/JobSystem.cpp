@@ -0,0 +1,486 @@
+#include <new>
+#include <thread>
+
+#include "JobSystem.h"
+#include "Debug.h"
+#include "Defines.h"
+#include "Profiler.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+namespace JobSlot
+{
+enum Enum : uint8
+{
+    Free, Queued, Parked
+};
+} // namespace JobSlot
+
+struct Job
+{
+    JobFunction function;
+    void* data;
+    JobCounter* counter;
+    JobAffinity::Enum affinity;
+
+    // JobSlot state, the slot is reused once it is free again.
+    std::atomic<uint8> slot_state;
+
+}; // struct Job
+
+// Chase-Lev deque as described in "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli). The buffer has a fixed
+// power of two size, a full deque makes the owner run the job inline.
+struct alignas(64) JobWorker
+{
+    alignas(64) std::atomic<int64> top;
+    alignas(64) std::atomic<int64> bottom;
+
+    std::atomic<Job*>* buffer;
+    int64 mask;
+
+    // Ring of job slots owned by this thread.
+    Job* jobs;
+    uint32 next_job;
+
+    uint32 random_state;
+    std::thread thread;
+
+    bool Push(Job* job)
+    {
+        const int64 b = bottom.load(std::memory_order_relaxed);
+        const int64 t = top.load(std::memory_order_acquire);
+        if (b - t > mask)
+            return false;
+
+        buffer[b & mask].store(job, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    Job* Pop()
+    {
+        const int64 b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64 t = top.load(std::memory_order_relaxed);
+
+        Job* job = nullptr;
+        if (t <= b)
+        {
+            job = buffer[b & mask].load(std::memory_order_relaxed);
+            if (t == b)
+            {
+                // Last job, race the thieves for it.
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    job = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* Steal()
+    {
+        int64 t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64 b = bottom.load(std::memory_order_acquire);
+
+        if (t < b)
+        {
+            Job* job = buffer[t & mask].load(std::memory_order_relaxed);
+            if (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return job;
+        }
+        return nullptr;
+    }
+
+}; // struct JobWorker
+
+static thread_local int32 s_thread_index = -1;
+
+static uint32 RoundUpPowerOfTwo(uint32 value)
+{
+    uint32 result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+// Continuations are stored in the counter as thread and slot of the job, plus
+// one so that zero means none.
+static const uint32 JOB_SLOT_BITS = 24;
+
+static uint32 EncodeJob(uint32 thread_index, uint32 slot)
+{
+    return ((thread_index << JOB_SLOT_BITS) | slot) + 1;
+}
+
+JobSystem* JobSystem::instance()
+{
+    static JobSystem s_job_system;
+    return &s_job_system;
+}
+
+void JobSystem::init(Allocator* allocator_, uint32 worker_count_, uint32 jobs_per_thread_)
+{
+    allocator = allocator_;
+
+    if (worker_count_ == 0)
+    {
+        const uint32 hardware_threads = std::thread::hardware_concurrency();
+        worker_count_ = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+    worker_count = MIN(worker_count_, MAX_THREADS - 1);
+    jobs_per_thread = RoundUpPowerOfTwo(MIN(MAX(jobs_per_thread_, 16u), 1u << JOB_SLOT_BITS));
+
+    stop.store(false, std::memory_order_relaxed);
+    pending_jobs.store(0, std::memory_order_relaxed);
+    sleeping_workers.store(0, std::memory_order_relaxed);
+
+    const uint32 thread_count = worker_count + 1;
+    workers = (JobWorker*)allocator->allocate(sizeof(JobWorker) * thread_count, alignof(JobWorker), 0, 0);
+    for (uint32 i = 0; i < thread_count; ++i)
+    {
+        JobWorker* worker = new (&workers[i]) JobWorker();
+        worker->top.store(0, std::memory_order_relaxed);
+        worker->bottom.store(0, std::memory_order_relaxed);
+        worker->mask = jobs_per_thread - 1;
+        worker->next_job = 0;
+        worker->random_state = 0x9e3779b9u * (i + 1);
+
+        worker->buffer = (std::atomic<Job*>*)allocator->allocate(sizeof(std::atomic<Job*>) * jobs_per_thread, alignof(std::atomic<Job*>), 0, 0);
+        worker->jobs = (Job*)allocator->allocate(sizeof(Job) * jobs_per_thread, alignof(Job), 0, 0);
+        for (uint32 j = 0; j < jobs_per_thread; ++j)
+        {
+            new (&worker->buffer[j]) std::atomic<Job*>(nullptr);
+            Job* job = new (&worker->jobs[j]) Job();
+            job->slot_state.store(JobSlot::Free, std::memory_order_relaxed);
+        }
+    }
+
+    main_thread_jobs = (Job**)allocator->allocate(sizeof(Job*) * jobs_per_thread, alignof(Job*), 0, 0);
+    main_thread_head = 0;
+    main_thread_count = 0;
+
+    // The thread calling init is the main thread.
+    s_thread_index = 0;
+
+    for (uint32 i = 1; i < thread_count; ++i)
+    {
+        workers[i].thread = std::thread(&JobSystem::WorkerLoop, this, i);
+    }
+
+    Raptor::Debug::Log("[JobSystem]: Started %u worker threads.\n", worker_count);
+}
+
+void JobSystem::shutdown()
+{
+    ASSERT(s_thread_index == 0);
+
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stop.store(true, std::memory_order_seq_cst);
+    }
+    sleep_condition.notify_all();
+
+    const uint32 thread_count = worker_count + 1;
+    for (uint32 i = 1; i < thread_count; ++i)
+    {
+        workers[i].thread.join();
+    }
+
+    if (pending_jobs.load(std::memory_order_relaxed) || main_thread_count)
+        Raptor::Debug::LogWarning("[JobSystem]: Warning: %u jobs were never run.\n", pending_jobs.load(std::memory_order_relaxed) + main_thread_count);
+
+    for (uint32 i = 0; i < thread_count; ++i)
+    {
+        JobWorker& worker = workers[i];
+        allocator->deallocate(worker.jobs, sizeof(Job) * jobs_per_thread);
+        allocator->deallocate(worker.buffer, sizeof(std::atomic<Job*>) * jobs_per_thread);
+        worker.~JobWorker();
+    }
+
+    allocator->deallocate(main_thread_jobs, sizeof(Job*) * jobs_per_thread);
+    allocator->deallocate(workers, sizeof(JobWorker) * thread_count);
+
+    main_thread_jobs = nullptr;
+    main_thread_count = 0;
+    workers = nullptr;
+    worker_count = 0;
+    s_thread_index = -1;
+}
+
+uint32 JobSystem::ThreadIndex() const
+{
+    // Only the main thread and the workers can queue or wait on jobs.
+    ASSERT(s_thread_index >= 0);
+    return (uint32)s_thread_index;
+}
+
+void JobSystem::Run(const JobDeclaration* jobs, uint32 count, JobCounter* counter)
+{
+    const uint32 thread_index = ThreadIndex();
+
+    if (counter)
+        counter->state.fetch_add(count, std::memory_order_relaxed);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        QueueJob(thread_index, AllocateJob(thread_index, jobs[i], counter));
+    }
+
+    WakeWorkers(count);
+}
+
+void JobSystem::RunAfter(JobCounter* counter, const JobDeclaration& declaration)
+{
+    const uint32 thread_index = ThreadIndex();
+
+    Job* job = AllocateJob(thread_index, declaration, nullptr);
+    const uint64 encoded = EncodeJob(thread_index, (uint32)(job - workers[thread_index].jobs));
+
+    // Marked before it is published, Decrement may queue it right away.
+    job->slot_state.store(JobSlot::Parked, std::memory_order_relaxed);
+
+    uint64 state = counter->state.load(std::memory_order_acquire);
+    do
+    {
+        if ((uint32)state == 0)
+        {
+            job->slot_state.store(JobSlot::Queued, std::memory_order_relaxed);
+            QueueJob(thread_index, job);
+            WakeWorkers(1);
+            return;
+        }
+
+        // Only one continuation per counter.
+        ASSERT((state >> 32) == 0);
+    }
+    while (!counter->state.compare_exchange_weak(state, state | (encoded << 32), std::memory_order_acq_rel, std::memory_order_acquire));
+}
+
+void JobSystem::Increment(JobCounter* counter, uint32 count)
+{
+    counter->state.fetch_add(count, std::memory_order_relaxed);
+}
+
+void JobSystem::Decrement(JobCounter* counter)
+{
+    // Reaching zero also clears the continuation in the same exchange, the
+    // counter may be gone as soon as its owner sees it done.
+    uint64 state = counter->state.load(std::memory_order_relaxed);
+    uint64 desired;
+    do
+    {
+        ASSERT((uint32)state != 0);
+        desired = (uint32)state == 1 ? 0 : state - 1;
+    }
+    while (!counter->state.compare_exchange_weak(state, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    const uint32 continuation = (uint32)(state >> 32);
+    if (desired == 0 && continuation)
+    {
+        const uint32 owner = (continuation - 1) >> JOB_SLOT_BITS;
+        const uint32 slot = (continuation - 1) & ((1u << JOB_SLOT_BITS) - 1);
+
+        Job* job = &workers[owner].jobs[slot];
+        job->slot_state.store(JobSlot::Queued, std::memory_order_relaxed);
+        QueueJob(ThreadIndex(), job);
+        WakeWorkers(1);
+    }
+}
+
+// A continuation parked with RunAfter keeps its slot until its counter drains,
+// e.g. after a slow file read, while the ring wraps around it. Busy slots are
+// skipped rather than reused. With every slot busy the thread runs queued jobs
+// until one frees up, a ring full of parked continuations is an error.
+Job* JobSystem::AllocateJob(uint32 thread_index, const JobDeclaration& declaration, JobCounter* counter)
+{
+    JobWorker& worker = workers[thread_index];
+
+    Job* job = nullptr;
+    while (!job)
+    {
+        uint32 parked = 0;
+        for (uint32 i = 0; i < jobs_per_thread && !job; ++i)
+        {
+            Job* slot = &worker.jobs[worker.next_job++ & worker.mask];
+            const uint8 slot_state = slot->slot_state.load(std::memory_order_acquire);
+            if (slot_state == JobSlot::Free)
+                job = slot;
+            else if (slot_state == JobSlot::Parked)
+                ++parked;
+        }
+
+        if (job)
+            break;
+
+        ASSERT_MESSAGE(parked < jobs_per_thread, "[JobSystem]: Error: Thread %u has all %u job slots parked as continuations.\n", thread_index, jobs_per_thread);
+        if (!RunOneJob(thread_index))
+            std::this_thread::yield();
+    }
+
+    job->function = declaration.function;
+    job->data = declaration.data;
+    job->counter = counter;
+    job->affinity = declaration.affinity;
+    job->slot_state.store(JobSlot::Queued, std::memory_order_relaxed);
+
+    return job;
+}
+
+void JobSystem::QueueJob(uint32 thread_index, Job* job)
+{
+    if (job->affinity == JobAffinity::MainThread)
+    {
+        std::lock_guard<std::mutex> lock(main_thread_mutex);
+        ASSERT(main_thread_count < jobs_per_thread);
+        main_thread_jobs[(main_thread_head + main_thread_count) & (jobs_per_thread - 1)] = job;
+        ++main_thread_count;
+        return;
+    }
+
+    // Counted before the push so a thief can never see the job without it.
+    pending_jobs.fetch_add(1, std::memory_order_seq_cst);
+    if (!workers[thread_index].Push(job))
+    {
+        pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+        ExecuteJob(job);
+    }
+}
+
+void JobSystem::ExecuteJob(Job* job)
+{
+    job->function(job->data);
+
+    if (job->counter)
+        Decrement(job->counter);
+
+    job->slot_state.store(JobSlot::Free, std::memory_order_release);
+}
+
+void JobSystem::WakeWorkers(uint32 count)
+{
+    // The empty critical section orders the notification after a worker
+    // checked the pending count.
+    const uint32 sleeping = sleeping_workers.load(std::memory_order_seq_cst);
+    if (sleeping == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+
+    if (count >= sleeping)
+        sleep_condition.notify_all();
+    else
+        for (uint32 i = 0; i < count; ++i)
+            sleep_condition.notify_one();
+}
+
+bool JobSystem::RunOneJob(uint32 thread_index)
+{
+    JobWorker& worker = workers[thread_index];
+
+    Job* job = worker.Pop();
+    if (!job)
+    {
+        // Start at a random victim so thieves spread over the deques.
+        const uint32 thread_count = worker_count + 1;
+        uint32 random = worker.random_state;
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        worker.random_state = random;
+
+        for (uint32 i = 0; i < thread_count && !job; ++i)
+        {
+            const uint32 victim = (random + i) % thread_count;
+            if (victim != thread_index)
+                job = workers[victim].Steal();
+        }
+    }
+
+    if (!job)
+        return false;
+
+    pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+    ExecuteJob(job);
+    return true;
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+    const uint32 thread_index = ThreadIndex();
+
+    while (!counter->IsDone())
+    {
+        if (thread_index == 0)
+            RunMainThreadJobs();
+
+        if (!RunOneJob(thread_index))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+    ASSERT(ThreadIndex() == 0);
+
+    for (;;)
+    {
+        Job* job = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(main_thread_mutex);
+            if (main_thread_count == 0)
+                return;
+
+            job = main_thread_jobs[main_thread_head];
+            main_thread_head = (main_thread_head + 1) & (jobs_per_thread - 1);
+            --main_thread_count;
+        }
+
+        ExecuteJob(job);
+    }
+}
+
+void JobSystem::WorkerLoop(uint32 thread_index)
+{
+    s_thread_index = (int32)thread_index;
+    Profiler::instance()->SetThreadName("Job Worker");
+
+    static const uint32 SPIN_COUNT = 64;
+    uint32 idle_spins = 0;
+
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        if (RunOneJob(thread_index))
+        {
+            idle_spins = 0;
+            continue;
+        }
+
+        if (++idle_spins < SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleeping_workers.fetch_add(1, std::memory_order_seq_cst);
+        sleep_condition.wait(lock, [this]() { return stop.load(std::memory_order_relaxed) || pending_jobs.load(std::memory_order_seq_cst) > 0; });
+        sleeping_workers.fetch_sub(1, std::memory_order_relaxed);
+        idle_spins = 0;
+    }
+}
+
+} // namespace Core
+} // namespace Raptor
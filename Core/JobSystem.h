@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "Allocator.h"
+#include "Service.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+typedef void (*JobFunction)(void* data);
+
+namespace JobAffinity
+{
+enum Enum : uint8
+{
+    Any, MainThread
+};
+} // namespace JobAffinity
+
+// Number of unfinished jobs in a batch. Jobs that depend on a batch either
+// wait on its counter, running other jobs in the meantime, or are queued as
+// its continuation with RunAfter().
+struct JobCounter
+{
+    // Low 32 bits are the count, the high 32 bits the continuation job.
+    std::atomic<uint64> state {0};
+
+    bool IsDone() const { return (uint32)state.load(std::memory_order_acquire) == 0; }
+
+}; // struct JobCounter
+
+struct JobDeclaration
+{
+    JobFunction function = nullptr;
+    void* data = nullptr;
+    JobAffinity::Enum affinity = JobAffinity::Any;
+
+}; // struct JobDeclaration
+
+struct Job;
+struct JobWorker;
+
+// Work-stealing job system. Every thread owns a Chase-Lev deque: it pushes
+// and pops its own jobs at the bottom while idle threads steal from the top.
+// The main thread is thread 0; it takes part in the work only while waiting
+// on a counter, and it is the only thread running MainThread jobs.
+//
+// Jobs can be queued from the main thread and from inside other jobs.
+class JobSystem
+{
+public:
+
+    static const uint32 MAX_THREADS = 64;
+
+    // worker_count 0 uses one worker per hardware thread besides the main one.
+    void init(Allocator* allocator, uint32 worker_count = 0, uint32 jobs_per_thread = 4096);
+    void shutdown();
+
+    void Run(const JobDeclaration* jobs, uint32 count, JobCounter* counter = nullptr);
+    void Run(const JobDeclaration& job, JobCounter* counter = nullptr) { Run(&job, 1, counter); }
+
+    // Runs queued jobs on the calling thread until the counter reaches zero.
+    void Wait(JobCounter* counter);
+
+    // Queues the job once the counter reaches zero, or right away if it already
+    // is. A counter holds a single continuation at a time.
+    void RunAfter(JobCounter* counter, const JobDeclaration& job);
+
+    // Counts work that is not a job, e.g. a file read, and marks it finished.
+    void Increment(JobCounter* counter, uint32 count = 1);
+    void Decrement(JobCounter* counter);
+
+    // Runs the MainThread jobs queued so far, call once per frame.
+    void RunMainThreadJobs();
+
+    // Runs one queued job on the calling thread, false if there was none.
+    bool RunJob() { return RunOneJob(ThreadIndex()); }
+
+    // Calls function(start, end) over [0, count) in ranges of batch_size and
+    // returns once all of them are done. The calling thread takes part.
+    template<typename Function>
+    void ParallelFor(uint32 count, uint32 batch_size, const Function& function);
+
+    uint32 ThreadCount() const { return worker_count + 1; }
+    uint32 ThreadIndex() const;
+
+    RAPTOR_DECLARE_SERVICE(JobSystem);
+
+private:
+
+    Job* AllocateJob(uint32 thread_index, const JobDeclaration& declaration, JobCounter* counter);
+    void QueueJob(uint32 thread_index, Job* job);
+    void ExecuteJob(Job* job);
+    void WakeWorkers(uint32 count);
+    bool RunOneJob(uint32 thread_index);
+
+    void WorkerLoop(uint32 thread_index);
+
+    Allocator* allocator = nullptr;
+
+    JobWorker* workers = nullptr;
+    uint32 worker_count = 0;
+    uint32 jobs_per_thread = 0;
+
+    // Jobs that are ready to be taken from any deque, sleeping workers wait for it to become non zero.
+    std::atomic<uint32> pending_jobs {0};
+    std::atomic<uint32> sleeping_workers {0};
+    std::atomic<bool> stop {false};
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_condition;
+
+    // MainThread jobs, a ring guarded by the mutex since any thread can add to it.
+    Job** main_thread_jobs = nullptr;
+    uint32 main_thread_head = 0;
+    uint32 main_thread_count = 0;
+    std::mutex main_thread_mutex;
+
+}; // class JobSystem
+
+// JobSystem::ParallelFor ----------------------------
+template<typename Function>
+struct ParallelForContext
+{
+    const Function* function;
+    uint32 count;
+    uint32 batch_size;
+    std::atomic<uint32> next;
+
+}; // struct ParallelForContext
+
+// Ranges are claimed from a shared index, so a thread that finishes early
+// simply takes more of them.
+template<typename Function>
+static void ParallelForJob(void* data)
+{
+    ParallelForContext<Function>* context = (ParallelForContext<Function>*)data;
+
+    for (;;)
+    {
+        const uint32 start = context->next.fetch_add(context->batch_size, std::memory_order_relaxed);
+        if (start >= context->count)
+            break;
+
+        const uint32 end = context->count - start > context->batch_size ? start + context->batch_size : context->count;
+        (*context->function)(start, end);
+    }
+}
+
+template<typename Function>
+void JobSystem::ParallelFor(uint32 count, uint32 batch_size, const Function& function)
+{
+    if (count == 0)
+        return;
+
+    batch_size = batch_size ? batch_size : 1;
+    const uint32 batch_count = (count + batch_size - 1) / batch_size;
+
+    if (batch_count == 1 || worker_count == 0)
+    {
+        function(0, count);
+        return;
+    }
+
+    ParallelForContext<Function> context;
+    context.function = &function;
+    context.count = count;
+    context.batch_size = batch_size;
+    context.next.store(0, std::memory_order_relaxed);
+
+    const uint32 helper_count = batch_count - 1 < worker_count ? batch_count - 1 : worker_count;
+
+    JobDeclaration jobs[MAX_THREADS];
+    for (uint32 i = 0; i < helper_count; ++i)
+    {
+        jobs[i].function = ParallelForJob<Function>;
+        jobs[i].data = &context;
+    }
+
+    JobCounter counter;
+    Run(jobs, helper_count, &counter);
+
+    ParallelForJob<Function>(&context);
+    Wait(&counter);
+}
+
+} // namespace Core
+} // namespace Raptor
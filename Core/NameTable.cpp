@@ -0,0 +1,140 @@
+#include <string.h>
+
+#include "NameTable.h"
+#include "Debug.h"
+#include "Defines.h"
+#include "Hash.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+struct NamePage
+{
+    NamePage* next;
+    sizet size;
+}; // struct NamePage
+
+static const sizet PAGE_HEADER_SIZE = sizeof(NamePage);
+
+NameTable* NameTable::instance()
+{
+    static NameTable s_name_table;
+    return &s_name_table;
+}
+
+void NameTable::init(Allocator* allocator_, uint32 initial_capacity, sizet page_size_)
+{
+    allocator = allocator_;
+    page_size = page_size_;
+    page_offset = page_size;
+
+    lookup.set_allocator(*allocator);
+    lookup.reserve(initial_capacity);
+
+    capacity = MAX(initial_capacity, 16u);
+    entries = (Entry*)allocator->allocate(sizeof(Entry) * capacity, alignof(Entry), 0, 0);
+
+    // Entry 0 is the null name returned for invalid ids.
+    entries[0] = { nullptr, 0, 0 };
+    count = 1;
+}
+
+void NameTable::shutdown()
+{
+    while (pages)
+    {
+        NamePage* next = pages->next;
+        allocator->deallocate(pages, pages->size);
+        pages = next;
+    }
+
+    allocator->deallocate(entries, sizeof(Entry) * capacity);
+    entries = nullptr;
+    count = 0;
+    capacity = 0;
+    reserved_bytes = 0;
+
+    lookup.clear(true);
+}
+
+NameId NameTable::Intern(const char* string)
+{
+    if (!string)
+        return NameId {};
+
+    const sizet length = strlen(string);
+    return Intern(string, length, HashString(string));
+}
+
+NameId NameTable::Intern(const char* string, sizet length, uint64 hash)
+{
+    ASSERT(allocator != nullptr);
+
+    auto it = lookup.find(hash);
+    if (it != lookup.end())
+    {
+        ASSERT_MESSAGE(strcmp(entries[it->second].string, string) == 0, "[NameTable]: Error: Hash collision between %s and %s.\n", entries[it->second].string, string);
+        return NameId {it->second};
+    }
+
+    if (count == capacity)
+    {
+        const uint32 new_capacity = capacity * 2;
+        Entry* new_entries = (Entry*)allocator->allocate(sizeof(Entry) * new_capacity, alignof(Entry), 0, 0);
+        memcpy(new_entries, entries, sizeof(Entry) * count);
+        allocator->deallocate(entries, sizeof(Entry) * capacity);
+
+        entries = new_entries;
+        capacity = new_capacity;
+    }
+
+    char* stored = AllocateString(length + 1);
+    memcpy(stored, string, length);
+    stored[length] = 0;
+
+    const uint32 index = count++;
+    entries[index] = { stored, hash, (uint32)length };
+
+    Pair<uint64, uint32> pair(hash, index);
+    lookup.insert(pair);
+
+    return NameId {index};
+}
+
+NameId NameTable::Find(const char* string) const
+{
+    if (!string)
+        return NameId {};
+
+    auto it = lookup.find(HashString(string));
+    return it != lookup.end() ? NameId {it->second} : NameId {};
+}
+
+sizet NameTable::MemoryUsed() const
+{
+    return reserved_bytes + sizeof(Entry) * capacity + lookup.capacity() * (sizeof(Pair<uint64, uint32>) + 1);
+}
+
+char* NameTable::AllocateString(sizet size)
+{
+    if (page_offset + size > page_size)
+    {
+        // Oversized names get a page of their own.
+        const sizet new_page_size = MAX(page_size, size + PAGE_HEADER_SIZE);
+        NamePage* page = (NamePage*)allocator->allocate(new_page_size, DEFAULT_ALIGNMENT, 0, 0);
+        page->next = pages;
+        page->size = new_page_size;
+        pages = page;
+        page_offset = PAGE_HEADER_SIZE;
+        reserved_bytes += new_page_size;
+    }
+
+    char* string = (char*)pages + page_offset;
+    page_offset += size;
+    return string;
+}
+
+} // namespace Core
+} // namespace Raptor
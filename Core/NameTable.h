@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Allocator.h"
+#include "HashMap.h"
+#include "Service.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+// Handle to an interned string. Index 0 is the null name.
+struct NameId
+{
+    uint32 index = 0;
+
+    bool IsValid() const { return index != 0; }
+
+    bool operator == (const NameId& other) const { return index == other.index; }
+    bool operator != (const NameId& other) const { return index != other.index; }
+
+}; // struct NameId
+
+struct NamePage;
+
+// Stores every distinct name once in arena pages together with its hash.
+// Strings are never freed or moved until shutdown, so the pointers returned
+// by GetString() stay valid for the lifetime of the table.
+class NameTable
+{
+public:
+
+    void init(Allocator* allocator, uint32 initial_capacity = 1024, sizet page_size = 64 * 1024);
+    void shutdown();
+
+    NameId Intern(const char* string);
+    NameId Intern(const char* string, sizet length, uint64 hash);
+
+    // Returns an invalid id when the string was never interned.
+    NameId Find(const char* string) const;
+
+    const char* GetString(NameId id) const { return entries[id.index].string; }
+    uint64 GetHash(NameId id) const { return entries[id.index].hash; }
+    uint32 GetLength(NameId id) const { return entries[id.index].length; }
+
+    uint32 Count() const { return count - 1; }
+    sizet MemoryUsed() const;
+
+    RAPTOR_DECLARE_SERVICE(NameTable);
+
+private:
+
+    struct Entry
+    {
+        const char* string;
+        uint64 hash;
+        uint32 length;
+    }; // struct Entry
+
+    char* AllocateString(sizet size);
+
+    Allocator* allocator = nullptr;
+    HashMap<uint64, uint32> lookup;
+
+    Entry* entries = nullptr;
+    uint32 count = 0;
+    uint32 capacity = 0;
+
+    // Arena pages, newest first.
+    NamePage* pages = nullptr;
+    sizet page_size = 0;
+    sizet page_offset = 0;
+    sizet reserved_bytes = 0;
+
+}; // class NameTable
+
+} // namespace Core
+} // namespace Raptor
@@ -2,12 +2,22 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #else
-// TODO
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
 #endif
 
 #include <stdio.h>
+#include <string.h>
 
 #include "Process.h"
+#include "Debug.h"
+#include "Defines.h"
 #include "Types.h"
 #include "Log.h"
 
@@ -20,6 +30,65 @@ static const uint32 PROCESS_LOG_BUFFER_SIZE = 256;
 char s_process_log_buffer[PROCESS_LOG_BUFFER_SIZE];
 static char k_process_output_buffer[1025];
 
+static const sizet PROCESS_READ_SIZE = 4096;
+
+struct Process
+{
+    Allocator* allocator;
+
+    char* output;
+    sizet output_size;
+    sizet output_capacity;
+
+    int32 exit_code;
+    bool exited;
+
+#if defined(_WIN64)
+    HANDLE process_handle;
+    HANDLE output_pipe;
+#else
+    pid_t pid;
+    int output_pipe;
+#endif
+
+}; // struct Process
+
+// Keeps room for PROCESS_READ_SIZE more bytes plus the terminator.
+static void ProcessReserveOutput(Process* process)
+{
+    if (process->output_size + PROCESS_READ_SIZE + 1 <= process->output_capacity)
+        return;
+
+    const sizet new_capacity = MAX(process->output_capacity * 2, process->output_size + PROCESS_READ_SIZE + 1);
+    char* new_output = (char*)process->allocator->allocate(new_capacity, 1, 0, 0);
+    if (process->output)
+    {
+        memcpy(new_output, process->output, process->output_size);
+        process->allocator->deallocate(process->output, process->output_capacity);
+    }
+
+    process->output = new_output;
+    process->output_capacity = new_capacity;
+}
+
+static Process* ProcessCreate(Allocator* allocator)
+{
+    Process* process = (Process*)allocator->allocate(sizeof(Process), alignof(Process), 0, 0);
+    memset(process, 0, sizeof(Process));
+    process->allocator = allocator;
+
+    ProcessReserveOutput(process);
+    process->output[0] = 0;
+    return process;
+}
+
+static void ProcessFree(Process* process)
+{
+    Allocator* allocator = process->allocator;
+    allocator->deallocate(process->output, process->output_capacity);
+    allocator->deallocate(process, sizeof(Process));
+}
+
 #if defined(_WIN64)
 
 void Win32GetError(char* buffer, uint32 size)
@@ -36,7 +105,7 @@ void Win32GetError(char* buffer, uint32 size)
     LocalFree(error_string);
 }
 
-bool ProcessExecute(const char* cwd, const char* path, const char* args, const char* search_error_string)
+Process* ProcessStart(const char* cwd, const char* path, const char* args, Allocator* allocator)
 {
     HANDLE handle_stdin_pipe_read = NULL;
     HANDLE handle_stdin_pipe_write = NULL;
@@ -47,11 +116,19 @@ bool ProcessExecute(const char* cwd, const char* path, const char* args, const c
 
     BOOL ok = CreatePipe(&handle_stdin_pipe_read, &handle_stdin_pipe_write, &security_attributes, 0);
     if (ok == FALSE)
-        return false;
-    
+        return nullptr;
+
     ok = CreatePipe( &handle_stdout_pipe_read, &handle_std_pipe_write, &security_attributes, 0 );
     if (ok == FALSE)
-        return false;
+    {
+        CloseHandle(handle_stdin_pipe_read);
+        CloseHandle(handle_stdin_pipe_write);
+        return nullptr;
+    }
+
+    // Only the write ends belong to the child, otherwise concurrent children keep each other's pipes open.
+    SetHandleInformation(handle_stdout_pipe_read, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(handle_stdin_pipe_write, HANDLE_FLAG_INHERIT, 0);
 
     STARTUPINFOA startup_info {};
     startup_info.cb = sizeof(startup_info);
@@ -61,65 +138,398 @@ bool ProcessExecute(const char* cwd, const char* path, const char* args, const c
     startup_info.hStdOutput = handle_std_pipe_write;
     startup_info.wShowWindow = SW_SHOW;
 
-    bool execution_success = false;
+    // The command line starts with the program name.
+    const sizet command_line_size = strlen(path) + strlen(args) + 4;
+    char* command_line = (char*)allocator->allocate(command_line_size, 1, 0, 0);
+    snprintf(command_line, command_line_size, "\"%s\" %s", path, args);
+
+    Process* process = nullptr;
     PROCESS_INFORMATION process_info {};
     BOOL inherit_handles = TRUE;
 
-    if (CreateProcessA(path, (char*)args, 0, 0, inherit_handles, 0, 0, cwd, &startup_info, &process_info))
+    if (CreateProcessA(path, command_line, 0, 0, inherit_handles, 0, 0, cwd, &startup_info, &process_info))
     {
         CloseHandle(process_info.hThread);
-        CloseHandle(process_info.hProcess);
-        execution_success = true;
+
+        process = ProcessCreate(allocator);
+        process->process_handle = process_info.hProcess;
+        process->output_pipe = handle_stdout_pipe_read;
     }
     else
     {
         Win32GetError(&s_process_log_buffer[0], PROCESS_LOG_BUFFER_SIZE);
 
-        Raptor::Debug::Log("Execute process error: %s %s %s\n", path, args, cwd);
-        Raptor::Debug::Log("Message: %s\n", s_process_log_buffer);
+        Raptor::Debug::LogError("Execute process error: %s %s %s\n", path, args, cwd);
+        Raptor::Debug::LogError("Message: %s\n", s_process_log_buffer);
+
+        CloseHandle(handle_stdout_pipe_read);
     }
 
+    allocator->deallocate(command_line, command_line_size);
+
     CloseHandle(handle_stdin_pipe_read);
+    CloseHandle(handle_stdin_pipe_write);
     CloseHandle(handle_std_pipe_write);
 
-    DWORD bytes_read;
-    ok = ReadFile(handle_stdout_pipe_read, k_process_output_buffer, 1024, &bytes_read, nullptr);
+    return process;
+}
 
-    while (ok == TRUE)
+// Drains the pipe without blocking, the handle is closed once the child closed its end.
+static void ProcessReadAvailable(Process* process)
+{
+    while (process->output_pipe)
     {
-        k_process_output_buffer[bytes_read] = 0;
-        Raptor::Debug::Log("%s", k_process_output_buffer);
+        DWORD available = 0;
+        if (!PeekNamedPipe(process->output_pipe, nullptr, 0, nullptr, &available, nullptr))
+        {
+            CloseHandle(process->output_pipe);
+            process->output_pipe = NULL;
+            break;
+        }
+
+        if (available == 0)
+            break;
+
+        ProcessReserveOutput(process);
 
-        ok = ReadFile(handle_stdout_pipe_read, k_process_output_buffer, 1024, &bytes_read, nullptr);
+        DWORD bytes_read = 0;
+        if (!ReadFile(process->output_pipe, process->output + process->output_size, (DWORD)MIN((sizet)available, PROCESS_READ_SIZE), &bytes_read, nullptr))
+        {
+            CloseHandle(process->output_pipe);
+            process->output_pipe = NULL;
+            break;
+        }
+
+        process->output_size += bytes_read;
     }
 
-    if (strlen(search_error_string) > 0 && strstr(k_process_output_buffer, search_error_string))
+    process->output[process->output_size] = 0;
+}
+
+static void ProcessReap(Process* process, bool block)
+{
+    if (process->exited || WaitForSingleObject(process->process_handle, block ? INFINITE : 0) != WAIT_OBJECT_0)
+        return;
+
+    DWORD exit_code = 0;
+    GetExitCodeProcess(process->process_handle, &exit_code);
+    CloseHandle(process->process_handle);
+
+    process->process_handle = NULL;
+    process->exit_code = (int32)exit_code;
+    process->exited = true;
+}
+
+void ProcessWaitAll(Process** processes, uint32 count)
+{
+    // Anonymous pipes can not be waited on together, poll them instead.
+    for (;;)
     {
-        execution_success = false;
+        bool open_pipes = false;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            ProcessReadAvailable(processes[i]);
+            open_pipes |= processes[i]->output_pipe != NULL;
+        }
+
+        if (!open_pipes)
+            break;
+
+        Sleep(1);
     }
 
-    Raptor::Debug::Log("\n");
+    for (uint32 i = 0; i < count; ++i)
+    {
+        ProcessReap(processes[i], true);
+    }
+}
 
-    CloseHandle(handle_stdout_pipe_read);
-    CloseHandle(handle_stdin_pipe_write);
+#else
 
-    DWORD process_exit_code = 0;
-    GetExitCodeProcess(process_info.hProcess, &process_exit_code);
+// Splits args at spaces, double quotes group words. Returns the argument
+// count, argv and strings share one allocation.
+static uint32 ProcessParseArguments(const char* path, const char* args, Allocator* allocator, char*** out_argv, sizet* out_size)
+{
+    const sizet args_length = strlen(args);
+    const uint32 max_arguments = (uint32)(args_length / 2 + 3);
+    const sizet size = sizeof(char*) * max_arguments + args_length + 1;
 
-    return execution_success;
+    char** argv = (char**)allocator->allocate(size, alignof(char*), 0, 0);
+    char* strings = (char*)(argv + max_arguments);
+    memcpy(strings, args, args_length + 1);
 
+    uint32 argc = 0;
+    argv[argc++] = (char*)path;
+
+    char* read = strings;
+    char* write = strings;
+    while (*read)
+    {
+        while (*read == ' ' || *read == '\t')
+            ++read;
+        if (*read == 0)
+            break;
+
+        argv[argc++] = write;
+        bool quoted = false;
+        while (*read && (quoted || (*read != ' ' && *read != '\t')))
+        {
+            if (*read == '"')
+                quoted = !quoted;
+            else
+                *write++ = *read;
+            ++read;
+        }
+
+        if (*read)
+            ++read;
+        *write++ = 0;
+    }
+    argv[argc] = nullptr;
+
+    *out_argv = argv;
+    *out_size = size;
+    return argc;
 }
 
-const char* ProcessGetOutput()
+Process* ProcessStart(const char* cwd, const char* path, const char* args, Allocator* allocator)
 {
-    return k_process_output_buffer;
-}
+    // Both ends are close-on-exec, so concurrent children do not keep each
+    // other's pipes open; the child gets the write end through the dup2 below.
+    // pipe2 sets the flag atomically, with pipe() and fcntl() a process spawned
+    // by another thread in between would still inherit the pipe.
+    int pipe_fds[2];
+#if defined(__linux__)
+    const int pipe_result = pipe2(pipe_fds, O_CLOEXEC);
+#else
+    const int pipe_result = pipe(pipe_fds);
+#endif
+    if (pipe_result != 0)
+    {
+        Raptor::Debug::LogError("Execute process error: Could not create pipe for %s (%s)\n", path, strerror(errno));
+        return nullptr;
+    }
+
+#if !defined(__linux__)
+    fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+    fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK);
 
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDERR_FILENO);
+
+    bool valid_cwd = true;
+    if (cwd && *cwd && strcmp(cwd, ".") != 0)
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+        posix_spawn_file_actions_addchdir_np(&actions, cwd);
 #else
+        Raptor::Debug::LogError("Execute process error: Working directory %s is not supported on this platform\n", cwd);
+        valid_cwd = false;
+#endif
+    }
+
+    char** argv = nullptr;
+    sizet argv_size = 0;
+    ProcessParseArguments(path, args, allocator, &argv, &argv_size);
+
+    pid_t pid = 0;
+    int result = ENOENT;
+    if (valid_cwd)
+    {
+        // Bare program names are looked up in PATH.
+        result = strchr(path, '/') ? posix_spawn(&pid, path, &actions, nullptr, argv, environ)
+                                   : posix_spawnp(&pid, path, &actions, nullptr, argv, environ);
+    }
+
+    allocator->deallocate(argv, argv_size);
+    posix_spawn_file_actions_destroy(&actions);
+    close(pipe_fds[1]);
+
+    if (result != 0)
+    {
+        Raptor::Debug::LogError("Execute process error: %s %s %s\n", path, args, cwd);
+        Raptor::Debug::LogError("Message: %s\n", strerror(result));
+
+        close(pipe_fds[0]);
+        return nullptr;
+    }
+
+    Process* process = ProcessCreate(allocator);
+    process->pid = pid;
+    process->output_pipe = pipe_fds[0];
+    return process;
+}
+
+// Drains the pipe without blocking, the descriptor is closed at end of file.
+static void ProcessReadAvailable(Process* process)
+{
+    while (process->output_pipe >= 0)
+    {
+        ProcessReserveOutput(process);
+
+        const ssize_t bytes_read = read(process->output_pipe, process->output + process->output_size, PROCESS_READ_SIZE);
+        if (bytes_read > 0)
+        {
+            process->output_size += (sizet)bytes_read;
+            continue;
+        }
+
+        if (bytes_read < 0 && errno == EINTR)
+            continue;
+
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+
+        close(process->output_pipe);
+        process->output_pipe = -1;
+    }
+
+    process->output[process->output_size] = 0;
+}
+
+static void ProcessReap(Process* process, bool block)
+{
+    if (process->exited)
+        return;
 
-// TODO
+    int status = 0;
+    pid_t result;
+    do
+    {
+        result = waitpid(process->pid, &status, block ? 0 : WNOHANG);
+    }
+    while (result < 0 && errno == EINTR);
+
+    if (result == 0)
+        return;
+
+    if (result < 0)
+        process->exit_code = -1;
+    else if (WIFEXITED(status))
+        process->exit_code = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status))
+        process->exit_code = -WTERMSIG(status);
+
+    process->exited = true;
+}
+
+void ProcessWaitAll(Process** processes, uint32 count)
+{
+    static const uint32 MAX_POLL = 64;
+    pollfd poll_fds[MAX_POLL];
+    Process* polled[MAX_POLL];
+
+    for (;;)
+    {
+        uint32 poll_count = 0;
+        for (uint32 i = 0; i < count && poll_count < MAX_POLL; ++i)
+        {
+            if (processes[i]->output_pipe < 0)
+                continue;
+
+            poll_fds[poll_count] = { processes[i]->output_pipe, POLLIN, 0 };
+            polled[poll_count] = processes[i];
+            ++poll_count;
+        }
+
+        if (poll_count == 0)
+            break;
+
+        if (poll(poll_fds, poll_count, -1) < 0 && errno != EINTR)
+            break;
+
+        for (uint32 i = 0; i < poll_count; ++i)
+        {
+            if (poll_fds[i].revents)
+                ProcessReadAvailable(polled[i]);
+        }
+    }
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        ProcessReap(processes[i], true);
+    }
+}
 
 #endif
 
+bool ProcessPoll(Process* process)
+{
+    ProcessReadAvailable(process);
+    ProcessReap(process, false);
+    return process->exited;
+}
+
+void ProcessWait(Process* process)
+{
+    ProcessWaitAll(&process, 1);
+}
+
+bool ProcessSucceeded(const Process* process, const char* search_error_string)
+{
+    if (!process->exited || process->exit_code != 0)
+        return false;
+
+    return !(search_error_string && strlen(search_error_string) > 0 && strstr(process->output, search_error_string));
+}
+
+int32 ProcessGetExitCode(const Process* process)
+{
+    return process->exit_code;
+}
+
+const char* ProcessGetOutput(const Process* process)
+{
+    return process->output;
+}
+
+void ProcessDestroy(Process* process)
+{
+    if (!process->exited)
+        ProcessWait(process);
+
+#if defined(_WIN64)
+    if (process->output_pipe)
+        CloseHandle(process->output_pipe);
+#else
+    if (process->output_pipe >= 0)
+        close(process->output_pipe);
+#endif
+
+    ProcessFree(process);
+}
+
+bool ProcessExecute(const char* cwd, const char* path, const char* args, const char* search_error_string)
+{
+    Process* process = ProcessStart(cwd, path, args, MallocAllocator::instance());
+    if (!process)
+    {
+        k_process_output_buffer[0] = 0;
+        return false;
+    }
+
+    ProcessWait(process);
+
+    const bool execution_success = ProcessSucceeded(process, search_error_string);
+    Raptor::Debug::Log("%s\n", process->output);
+
+    // Keeps the last 1024 bytes, that is where compilers print their errors.
+    const sizet offset = process->output_size > 1024 ? process->output_size - 1024 : 0;
+    memcpy(k_process_output_buffer, process->output + offset, process->output_size - offset + 1);
+
+    ProcessDestroy(process);
+    return execution_success;
+}
+
+const char* ProcessGetOutput()
+{
+    return k_process_output_buffer;
+}
+
 }; // namespace Core
-}; // namespace Raptor
\ No newline at end of file
+}; // namespace Raptor
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Allocator.h"
+#include "Types.h"
+
 namespace Raptor
 {
 namespace Core
@@ -8,5 +11,30 @@ namespace Core
 bool ProcessExecute(const char* cwd, const char* path, const char* args, const char* search_error_string = "");
 const char* ProcessGetOutput();
 
+// Child process started without waiting for it. Stdout and stderr go to a
+// pipe that is drained into an output buffer owned by the process, so any
+// number of processes can run at once. A process is used from one thread.
+struct Process;
+
+// args does not include the program name. Returns nullptr if the process
+// could not be started.
+Process* ProcessStart(const char* cwd, const char* path, const char* args, Allocator* allocator);
+
+// Reads pending output without blocking, returns true once the process exited.
+bool ProcessPoll(Process* process);
+
+// Blocks until the processes exit, reading all of their pipes meanwhile.
+void ProcessWait(Process* process);
+void ProcessWaitAll(Process** processes, uint32 count);
+
+// Valid once the process exited. Succeeded means exit code 0 and no
+// search_error_string in the output.
+bool ProcessSucceeded(const Process* process, const char* search_error_string = "");
+int32 ProcessGetExitCode(const Process* process);
+const char* ProcessGetOutput(const Process* process);
+
+// Waits for the process if it is still running.
+void ProcessDestroy(Process* process);
+
 }; // namespace Core
-}; // namespace Raptor
\ No newline at end of file
+}; // namespace Raptor
@@ -0,0 +1,158 @@
+#include <stdio.h>
+
+#include <new>
+
+#include "Profiler.h"
+#include "Debug.h"
+#include "Defines.h"
+
+namespace Raptor
+{
+namespace Core
+{
+
+Profiler* Profiler::instance()
+{
+    static Profiler s_profiler;
+    return &s_profiler;
+}
+
+void Profiler::init(Allocator* allocator_, uint32 max_threads_, uint32 events_per_thread_)
+{
+    allocator = allocator_;
+    max_threads = max_threads_;
+    events_per_thread = events_per_thread_;
+
+    // Allocated up front, threads start recording without touching the allocator.
+    threads = (ProfilerThread*)allocator->allocate(sizeof(ProfilerThread) * max_threads, alignof(ProfilerThread), 0, 0);
+    events = (ProfilerEvent*)allocator->allocate(sizeof(ProfilerEvent) * max_threads * events_per_thread, alignof(ProfilerEvent), 0, 0);
+    for (uint32 i = 0; i < max_threads; ++i)
+    {
+        ProfilerThread* thread = new (&threads[i]) ProfilerThread();
+        thread->events = events + (sizet)i * events_per_thread;
+        thread->count.store(0, std::memory_order_relaxed);
+        thread->name = nullptr;
+    }
+    thread_count.store(0, std::memory_order_relaxed);
+
+    calibration_ticks = ProfilerTicks();
+    calibration_time = Time::Now();
+}
+
+void Profiler::shutdown()
+{
+    capturing.store(false, std::memory_order_relaxed);
+
+    for (uint32 i = 0; i < max_threads; ++i)
+        threads[i].~ProfilerThread();
+
+    allocator->deallocate(events, sizeof(ProfilerEvent) * max_threads * events_per_thread);
+    allocator->deallocate(threads, sizeof(ProfilerThread) * max_threads);
+    threads = nullptr;
+    events = nullptr;
+    max_threads = 0;
+}
+
+// Owners of the buffers are not inside a zone here, see the header.
+void Profiler::BeginCapture()
+{
+    const uint32 count = MIN(thread_count.load(std::memory_order_acquire), max_threads);
+    for (uint32 i = 0; i < count; ++i)
+        threads[i].count.store(0, std::memory_order_relaxed);
+
+    capture_begin_ticks = ProfilerTicks();
+    capturing.store(true, std::memory_order_release);
+}
+
+void Profiler::EndCapture()
+{
+    capturing.store(false, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ProfilerThread* thread = GetThread();
+    if (thread)
+        thread->name = name;
+}
+
+ProfilerThread* Profiler::GetThread()
+{
+    ProfilerThread* thread = current_thread;
+    if (thread || !threads)
+        return thread;
+
+    const uint32 index = thread_count.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= max_threads)
+        return nullptr;
+
+    current_thread = &threads[index];
+    return current_thread;
+}
+
+// The longer the run, the less the error of the two clocks matters.
+double Profiler::TicksPerMicrosecond() const
+{
+    int64 time = Time::Now();
+    uint64 ticks = ProfilerTicks();
+
+    // Early in the run the two readings are too close, measure for a moment.
+    while (time - calibration_time < 10000)
+    {
+        time = Time::Now();
+        ticks = ProfilerTicks();
+    }
+
+    return (double)(ticks - calibration_ticks) / (double)(time - calibration_time);
+}
+
+bool Profiler::WriteChromeTrace(const char* filename)
+{
+    FILE* file = fopen(filename, "wb");
+    if (!file)
+    {
+        Raptor::Debug::LogError("[Profiler]: Error: Could not open %s\n", filename);
+        return false;
+    }
+
+    const double ticks_per_microsecond = TicksPerMicrosecond();
+    const uint32 count = MIN(thread_count.load(std::memory_order_acquire), max_threads);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    uint32 written = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        const ProfilerThread& thread = threads[i];
+
+        if (thread.name)
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", written++ ? ",\n" : "", i, thread.name);
+        else
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}", written++ ? ",\n" : "", i, i);
+
+        const uint32 event_count = MIN(thread.count.load(std::memory_order_acquire), events_per_thread);
+        for (uint32 e = 0; e < event_count; ++e)
+        {
+            const ProfilerEvent& event = thread.events[e];
+            // Left over from a zone that was open when the capture started.
+            if (event.begin < capture_begin_ticks)
+                continue;
+
+            const double begin = (double)(event.begin - capture_begin_ticks) / ticks_per_microsecond;
+            const double duration = (double)(event.end - event.begin) / ticks_per_microsecond;
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", event.name, i, begin, duration);
+        }
+
+        if (event_count == events_per_thread)
+            Raptor::Debug::LogWarning("[Profiler]: Warning: Thread %u ran out of events, increase events_per_thread (%u).\n", i, events_per_thread);
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    Raptor::Debug::Log("[Profiler]: Wrote %s\n", filename);
+    return true;
+}
+
+} // namespace Core
+} // namespace Raptor
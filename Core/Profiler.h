@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Allocator.h"
+#include "Service.h"
+#include "TimeService.h"
+#include "Types.h"
+
+// Zones cost nothing unless RAPTOR_PROFILER is 1, the default outside of release builds.
+#if !defined(RAPTOR_PROFILER)
+#if defined(NDEBUG)
+#define RAPTOR_PROFILER 0
+#else
+#define RAPTOR_PROFILER 1
+#endif
+#endif
+
+namespace Raptor
+{
+namespace Core
+{
+
+// CPU clock of the profiler, converted to time when a capture is written.
+inline uint64 ProfilerTicks()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64 ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (uint64)Time::Now();
+#endif
+}
+
+struct ProfilerEvent
+{
+    const char* name;
+    uint64 begin;
+    uint64 end;
+}; // struct ProfilerEvent
+
+// Written only by its thread, read by the thread writing the capture.
+struct ProfilerThread
+{
+    ProfilerEvent* events;
+    std::atomic<uint32> count;
+    const char* name;
+}; // struct ProfilerThread
+
+// Records CPU zones into per-thread buffers while a capture is running and
+// writes them as a Chrome trace, which chrome://tracing and Perfetto open.
+// Buffers are allocated at init, a thread that fills its buffer stops
+// recording until the next capture.
+class Profiler
+{
+public:
+
+    void init(Allocator* allocator, uint32 max_threads = 16, uint32 events_per_thread = 16 * 1024);
+    void shutdown();
+
+    // Captures start and stop between frames. BeginCapture() resets the
+    // buffers without synchronizing with Record(), so it has to run where no
+    // thread is inside a zone, after the frame's jobs are done. A zone still
+    // recording into the previous capture would write over the new one.
+    void BeginCapture();
+    void EndCapture();
+    bool IsCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+    bool WriteChromeTrace(const char* filename);
+
+    // The name must outlive the profiler. Threads without one are numbered.
+    void SetThreadName(const char* name);
+
+    void Record(const char* name, uint64 begin, uint64 end)
+    {
+        if (!capturing.load(std::memory_order_relaxed))
+            return;
+
+        ProfilerThread* thread = current_thread ? current_thread : GetThread();
+        if (!thread)
+            return;
+
+        const uint32 index = thread->count.load(std::memory_order_relaxed);
+        if (index < events_per_thread)
+        {
+            thread->events[index] = {name, begin, end};
+            thread->count.store(index + 1, std::memory_order_release);
+        }
+    }
+
+    RAPTOR_DECLARE_SERVICE(Profiler);
+
+private:
+
+    ProfilerThread* GetThread();
+    double TicksPerMicrosecond() const;
+
+    static inline thread_local ProfilerThread* current_thread = nullptr;
+
+    Allocator* allocator = nullptr;
+
+    ProfilerThread* threads = nullptr;
+    ProfilerEvent* events = nullptr;
+    uint32 max_threads = 0;
+    uint32 events_per_thread = 0;
+    std::atomic<uint32> thread_count {0};
+
+    std::atomic<bool> capturing {false};
+    uint64 capture_begin_ticks = 0;
+
+    // Ticks are matched against Time::Now() over the whole run.
+    uint64 calibration_ticks = 0;
+    int64 calibration_time = 0;
+
+}; // class Profiler
+
+// Outside of a capture a zone reads no clock, zones open when it starts are not recorded.
+struct ProfilerZone
+{
+    explicit ProfilerZone(const char* name_) : name(name_), begin(Profiler::instance()->IsCapturing() ? ProfilerTicks() : 0) {}
+    ~ProfilerZone() { if (begin) Profiler::instance()->Record(name, begin, ProfilerTicks()); }
+
+    const char* name;
+    uint64 begin;
+}; // struct ProfilerZone
+
+#define RAPTOR_PROFILER_CONCAT_INNER(a, b) a##b
+#define RAPTOR_PROFILER_CONCAT(a, b) RAPTOR_PROFILER_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope, name has to be a string literal.
+#if RAPTOR_PROFILER
+#define PROFILE_ZONE(name) Raptor::Core::ProfilerZone RAPTOR_PROFILER_CONCAT(profiler_zone_, __LINE__) {name}
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+} // namespace Core
+} // namespace Raptor
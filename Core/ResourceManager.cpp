@@ -1,41 +1,225 @@
 #pragma once
 
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
 #include "ResourceManager.h"
+#include "AsyncIO.h"
 #include "Hash.h"
+#include "JobSystem.h"
+#include "Log.h"
 
 namespace Raptor
 {
 namespace Core
 {
 
-using Allocator = eastl::allocator;
-
 ResourceManager::ResourceManager(Allocator& allocator, ResourceFilenameResolver* resolver)
     : allocator(&allocator), filename_resolver(resolver)
 {
     loaders.set_allocator(allocator);
     compilers.set_allocator(allocator);
+    pending_loads.set_allocator(allocator);
+    watched_resources.set_allocator(allocator);
+    watched_directories.set_allocator(allocator);
+
+    // Type hashes are computed at compile time, keys hashed at runtime must match them.
+    ASSERT(HashString("ResourceManager") == "ResourceManager"_hash);
 }
 
 ResourceManager::~ResourceManager()
 {
-
+    for (char* directory : watched_directories)
+        allocator->deallocate(directory, strlen(directory) + 1);
 }
 
 void ResourceManager::SetLoader(const char* resource_type, ResourceLoader* loader)
 {
-    const uint64 hash = HashString(resource_type);
-    Pair<uint64, ResourceLoader*> pair(hash, loader);
+    SetLoader(HashString(resource_type), loader);
+}
+
+void ResourceManager::SetLoader(uint64 resource_type_hash, ResourceLoader* loader)
+{
+    Pair<uint64, ResourceLoader*> pair(resource_type_hash, loader);
     loaders.insert(pair);
 }
 
 void ResourceManager::SetCompiler(const char* resource_type, ResourceCompiler* compiler)
 {
-    const uint64 hash = HashString(resource_type);
-    Pair<uint64, ResourceCompiler*> pair(hash, compiler);
+    SetCompiler(HashString(resource_type), compiler);
+}
+
+void ResourceManager::SetCompiler(uint64 resource_type_hash, ResourceCompiler* compiler)
+{
+    Pair<uint64, ResourceCompiler*> pair(resource_type_hash, compiler);
     compilers.insert(pair);
 }
 
+void ResourceManager::FinishLoad(Resource* resource, bool success)
+{
+    ASSERT(resource->state == ResourceState::Pending);
+    ASSERT(pending_count != 0);
+
+    resource->state = success ? ResourceState::Loaded : ResourceState::Failed;
+    --pending_count;
+
+    // Callbacks may start new loads, so the list is walked by index.
+    for (sizet i = 0; i < pending_loads.size();)
+    {
+        PendingLoad pending_load = pending_loads[i];
+        if (pending_load.resource != resource)
+        {
+            ++i;
+            continue;
+        }
+
+        pending_loads[i] = pending_loads.back();
+        pending_loads.pop_back();
+
+        pending_load.callback(resource, pending_load.user_data);
+    }
+}
+
+void ResourceManager::Update()
+{
+    if (file_watcher)
+        file_watcher->Update(FileChanged, this);
+
+    AsyncIOService::instance()->Update();
+    JobSystem::instance()->RunMainThreadJobs();
+}
+
+void ResourceManager::WaitForLoads()
+{
+    JobSystem* job_system = JobSystem::instance();
+
+    // Reads only complete inside Update(), so the job system can not wait on
+    // its own. Without workers the decode jobs run here as well.
+    while (pending_count != 0)
+    {
+        Update();
+        if (!job_system->RunJob())
+            std::this_thread::yield();
+    }
+}
+
+// Sources are watched as well, the resolver picks them over a cooked output
+// they are newer than.
+void ResourceManager::WatchResource(uint64 type_hash, const Resource* resource, const char* path)
+{
+    if (!file_watcher || !resource->name)
+        return;
+
+    char current_directory[MAX_FILENAME_LENGTH];
+    CurrentDirectory(current_directory);
+    const char* directory = WatchedDirectory(current_directory);
+
+    // The watcher reports paths as given, absolute ones match whatever the
+    // current directory is when the change comes in.
+    const char* paths[2] = {path, resource->name};
+    const uint32 path_count = strcmp(path, resource->name) ? 2 : 1;
+    for (uint32 i = 0; i < path_count; ++i)
+    {
+        char absolute_path[MAX_FILENAME_LENGTH];
+        PathFromDirectory(directory, paths[i], absolute_path, sizeof(absolute_path));
+        if (file_watcher->Watch(absolute_path))
+            watched_resources[HashString(absolute_path)] = {type_hash, resource->name, directory};
+    }
+}
+
+const char* ResourceManager::WatchedDirectory(const char* directory)
+{
+    for (const char* watched_directory : watched_directories)
+    {
+        if (!strcmp(watched_directory, directory))
+            return watched_directory;
+    }
+
+    const sizet size = strlen(directory) + 1;
+    char* watched_directory = (char*)allocator->allocate(size, 1, 0, 0);
+    memcpy(watched_directory, directory, size);
+    watched_directories.push_back(watched_directory);
+    return watched_directory;
+}
+
+void ResourceManager::ReloadChangedFile(const char* path)
+{
+    auto watched = watched_resources.find(HashString(path));
+    if (watched == watched_resources.end())
+        return;
+
+    auto loader = loaders.find(watched->second.type_hash);
+    if (loader == loaders.end())
+        return;
+
+    const char* name = watched->second.name;
+    Resource* resource = loader->second->Get(name);
+    if (!resource)
+        return;
+
+    if (resource->state == ResourceState::Pending)
+    {
+        Raptor::Debug::LogWarning("[ResourceManager]: Warning: %s changed while loading, the change is not reloaded.\n", name);
+        return;
+    }
+
+    if (!loader->second->ReloadAsync(resource, GetPath(name, watched->second.directory), this))
+    {
+        Raptor::Debug::LogWarning("[ResourceManager]: Warning: %s changed but its loader can not reload it.\n", name);
+        return;
+    }
+
+    ASSERT(resource->state == ResourceState::Pending);
+    ++pending_count;
+    Raptor::Debug::Log("[ResourceManager]: Reloading %s\n", name);
+}
+
+void ResourceManager::FileChanged(const char* path, void* user_data)
+{
+    ((ResourceManager*)user_data)->ReloadChangedFile(path);
+}
+
+// Names may contain directories, outputs are named after their hash to keep the directory flat.
+void CookedFilename(const char* directory, const char* name, char* out_filename, sizet size)
+{
+    snprintf(out_filename, size, "%s/%016llx.bin", directory, (unsigned long long)HashString(name));
+}
+
+CookedFilenameResolver::CookedFilenameResolver(const char* directory_)
+{
+    snprintf(directory, sizeof(directory), "%s", directory_);
+    path[0] = 0;
+}
+
+// The cooked filename is hashed from the name as given, only the paths it is
+// read from are moved to the base directory.
+const char* CookedFilenameResolver::GetBinaryPathFromName(const char* name, const char* base_directory)
+{
+    char cooked_filename[MAX_FILENAME_LENGTH];
+    CookedFilename(directory, name, cooked_filename, sizeof(cooked_filename));
+    PathFromDirectory(base_directory, cooked_filename, path, sizeof(path));
+    PathFromDirectory(base_directory, name, source_path, sizeof(source_path));
+
+    const int64 cooked_time = FileLastWriteTime(path);
+    if (cooked_time == 0 || FileLastWriteTime(source_path) > cooked_time)
+        return source_path;
+
+    return path;
+}
+
+// Without a resolver resource names are paths.
+const char* ResourceManager::GetPath(const char* name, const char* directory)
+{
+    if (filename_resolver)
+        return filename_resolver->GetBinaryPathFromName(name, directory);
+
+    if (!directory)
+        return name;
+
+    PathFromDirectory(directory, name, path, sizeof(path));
+    return path;
+}
 
 
 } // namespace Core
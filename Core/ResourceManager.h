@@ -1,7 +1,12 @@
 #pragma once
 
+#include <EASTL/vector.h>
+
 #include "Allocator.h"
+#include "File.h"
+#include "FileWatcher.h"
 #include "HashMap.h"
+#include "NameTable.h"
 #include "Types.h"
 #include "Debug.h"
 
@@ -12,19 +17,34 @@ namespace Core
 
 class ResourceManager;
 
+namespace ResourceState
+{
+enum Enum : uint8
+{
+    Loaded, Pending, Failed
+};
+} // namespace ResourceState
+
 struct Resource
 {
     uint64 references = 0;
     const char* name = nullptr;
+    NameId name_id;
+    // Pending resources are usable, they are bound to a placeholder until the load finishes.
+    ResourceState::Enum state = ResourceState::Loaded;
 
     void AddReference() { references++; }
     void RemoveReference() { ASSERT(references != 0); references--; }
 
 }; // struct Resource
 
+// Cooks a source asset offline into the binary its loader reads at runtime,
+// see the RaptorResourceCompiler tool.
 struct ResourceCompiler
 {
-
+    // Part of the build cache key, change it whenever the output or the settings change.
+    virtual uint64 GetVersion() = 0;
+    virtual bool Compile(const char* source_filename, const char* output_filename, Allocator* allocator) = 0;
 }; // ResourceCompiler
 
 struct ResourceLoader
@@ -33,13 +53,43 @@ struct ResourceLoader
     virtual Resource* Get(uint64 hash) = 0;
     virtual Resource* Unload(const char* name) = 0;
     virtual Resource* CreateFromFile(const char* name, const char* filename, ResourceManager* resource_manager) { return nullptr; }
+
+    // Returns a Pending resource and calls ResourceManager::FinishLoad() from the
+    // main thread once it is done, never before returning. Loaders without an
+    // asynchronous path load synchronously.
+    virtual Resource* CreateFromFileAsync(const char* name, const char* filename, ResourceManager* resource_manager) { return CreateFromFile(name, filename, resource_manager); }
+
+    // Loads the file again in the background into the existing resource, which
+    // stays usable with its old data meanwhile. The resource is Pending until
+    // the loader calls ResourceManager::FinishLoad(). False if not supported.
+    virtual bool ReloadAsync(Resource* resource, const char* filename, ResourceManager* resource_manager) { return false; }
 }; // struct ResourceLoader
 
 struct ResourceFilenameResolver
 {
-    virtual const char* GetBinaryPathFromName(const char* name) = 0;
+    // Relative names are looked up in directory, in the current one when it is null.
+    virtual const char* GetBinaryPathFromName(const char* name, const char* directory) = 0;
 }; // struct ResourceFilenameResolver
 
+// Name of the cooked output of a resource, the same for the compiler and the resolver.
+void CookedFilename(const char* directory, const char* name, char* out_filename, sizet size);
+
+// Resolves names to their cooked output when there is one, to the source
+// otherwise or when the source was edited after cooking. The returned path is
+// valid until the next call.
+struct CookedFilenameResolver : public ResourceFilenameResolver
+{
+    explicit CookedFilenameResolver(const char* directory);
+
+    const char* GetBinaryPathFromName(const char* name, const char* directory) override;
+
+    char directory[MAX_FILENAME_LENGTH];
+    char path[MAX_FILENAME_LENGTH];
+    char source_path[MAX_FILENAME_LENGTH];
+}; // struct CookedFilenameResolver
+
+typedef void (*ResourceLoadCallback)(Resource* resource, void* user_data);
+
 class ResourceManager
 {
 public:
@@ -50,6 +100,12 @@ public:
     template <typename T>
     T* Load(const char* name);
 
+    // Returns right away, the resource stays Pending until the loader finishes
+    // it. The callback runs on the main thread once the resource is Loaded or
+    // Failed, immediately if it already is.
+    template <typename T>
+    T* LoadAsync(const char* name, ResourceLoadCallback callback = nullptr, void* user_data = nullptr);
+
     template <typename T>
     T* Get(const char* name);
 
@@ -60,7 +116,25 @@ public:
     T* Reload(const char* name);
 
     void SetLoader(const char* resource_type, ResourceLoader* loader);
+    void SetLoader(uint64 resource_type_hash, ResourceLoader* loader);
     void SetCompiler(const char* resource_type, ResourceCompiler* compiler);
+    void SetCompiler(uint64 resource_type_hash, ResourceCompiler* compiler);
+
+    ResourceState::Enum GetState(const Resource* resource) const { return resource->state; }
+    uint32 PendingLoadCount() const { return pending_count; }
+
+    // Called by loaders on the main thread, runs the callbacks waiting on the resource.
+    void FinishLoad(Resource* resource, bool success);
+
+    // Resources loaded from now on are reloaded in the background when their
+    // file, cooked or source, changes on disk.
+    void EnableHotReload(FileWatcher* watcher) { file_watcher = watcher; }
+
+    // Pumps file changes, async reads and main thread jobs so loads make
+    // progress, call once per frame before recording.
+    void Update();
+    // Blocks until every pending load finished, running jobs meanwhile.
+    void WaitForLoads();
 
     HashMap<uint64, ResourceLoader*> loaders;
     HashMap<uint64, ResourceCompiler*> compilers;
@@ -68,6 +142,41 @@ public:
     Allocator* allocator;
     ResourceFilenameResolver* filename_resolver;
 
+private:
+
+    struct PendingLoad
+    {
+        Resource* resource;
+        ResourceLoadCallback callback;
+        void* user_data;
+    }; // struct PendingLoad
+
+    // Names are relative to the directory that was current when the resource
+    // was loaded, which is not the current one anymore once it changes.
+    struct WatchedResource
+    {
+        uint64 type_hash;
+        const char* name;
+        const char* directory;
+    }; // struct WatchedResource
+
+    const char* GetPath(const char* name, const char* directory = nullptr);
+    const char* WatchedDirectory(const char* directory);
+
+    void WatchResource(uint64 type_hash, const Resource* resource, const char* path);
+    void ReloadChangedFile(const char* path);
+    static void FileChanged(const char* path, void* user_data);
+
+    eastl::vector<PendingLoad, ContainerAllocator> pending_loads;
+    uint32 pending_count = 0;
+
+    FileWatcher* file_watcher = nullptr;
+    // Keyed by the hash of the absolute watched path.
+    HashMap<uint64, WatchedResource> watched_resources;
+    // Every directory resources were watched from, shared by their entries.
+    eastl::vector<char*, ContainerAllocator> watched_directories;
+    char path[MAX_FILENAME_LENGTH];
+
 }; // class ResourceManager
 
 template<typename T>
@@ -80,12 +189,50 @@ inline T* ResourceManager::Load(const char* name)
         if (resource)
             return resource;
 
-        const char* path = filename_resolver->GetBinaryPathFromName(name);
-        return (T*)loader->CreateFromFile(name, path, this);
+        const char* path = GetPath(name);
+        resource = (T*)loader->CreateFromFile(name, path, this);
+        if (resource)
+            WatchResource(T::type_hash, resource, path);
+
+        return resource;
     }
     return nullptr;
 }
 
+template<typename T>
+inline T* ResourceManager::LoadAsync(const char* name, ResourceLoadCallback callback, void* user_data)
+{
+    ResourceLoader* loader = loaders.at(T::type_hash);
+    if (!loader)
+        return nullptr;
+
+    T* resource = (T*)loader->Get(name);
+    if (!resource)
+    {
+        const char* path = GetPath(name);
+        resource = (T*)loader->CreateFromFileAsync(name, path, this);
+        if (!resource)
+            return nullptr;
+
+        WatchResource(T::type_hash, resource, path);
+
+        if (resource->state == ResourceState::Pending)
+            ++pending_count;
+    }
+
+    if (resource->state == ResourceState::Pending)
+    {
+        if (callback)
+            pending_loads.push_back({resource, callback, user_data});
+    }
+    else if (callback)
+    {
+        callback(resource, user_data);
+    }
+
+    return resource;
+}
+
 template <typename T>
 inline T* ResourceManager::Get(const char* name)
 {
@@ -117,7 +264,7 @@ inline T* ResourceManager::Reload(const char* name)
         {
             loader->Unload(name);
 
-            const char* path = filename_resolver->GetBinaryPathFromName(name);
+            const char* path = GetPath(name);
             return (T*)loader->CreateFromFile(name, path, this);
         }
     }
@@ -14,7 +14,8 @@ namespace Debug
 #endif
 
 #define ASSERT(condition) if (!(condition)) { DEBUG_BREAK }
-#define ASSERT_MESSAGE(condition, message, ...) if (!(condition)) { Raptor::Debug::Log(message, __VA_ARGS__); DEBUG_BREAK }
+// The message is flushed before breaking, it would be lost in the log ring otherwise.
+#define ASSERT_MESSAGE(condition, message, ...) if (!(condition)) { Raptor::Debug::LogError(message, __VA_ARGS__); Raptor::Debug::LogFlush(); DEBUG_BREAK }
 
 } // namespace Debug
 } // namespace Raptor
\ No newline at end of file
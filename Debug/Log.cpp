@@ -1,25 +1,479 @@
 #include "Log.h"
-#include <EAStdC/EASprintf.h>
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <thread>
 
 namespace Raptor
 {
 namespace Debug
 {
 
-void Log(char* message)
+// A ring per thread that logs, written only by that thread and read only by
+// the log thread, so logging takes no lock. Positions count bytes and never
+// wrap, records are 8 byte aligned and never split at the end of the ring.
+static const uint32_t LOG_RING_SIZE = 64 * 1024;
+static const uint32_t LOG_MAX_RECORD_SIZE = LOG_RING_SIZE / 4;
+static const uint32_t LOG_MAX_THREADS = 64;
+static const uint8_t LOG_RECORD_WRAP = 0xFF;
+
+struct LogRecord
+{
+    uint32_t size;
+    uint8_t level;
+    uint8_t argument_count;
+    const char* format;
+}; // struct LogRecord
+
+struct LogRing
+{
+    char data[LOG_RING_SIZE];
+
+    alignas(64) std::atomic<uint64_t> write {0};
+    alignas(64) std::atomic<uint64_t> read {0};
+    std::atomic<uint32_t> dropped {0};
+    // Set when the thread exits, the ring is reused by another thread once drained.
+    std::atomic<bool> released {false};
+}; // struct LogRing
+
+struct LogThreadRing
+{
+    ~LogThreadRing();
+
+    LogRing* ring = nullptr;
+}; // struct LogThreadRing
+
+// Rings are never freed. A thread that saw the logger running can still be
+// writing into its ring after LogShutdown(), so they outlive it and are
+// drained by the next LogInit().
+static std::atomic<LogRing*> s_rings[LOG_MAX_THREADS];
+static std::atomic<uint32_t> s_ring_count {0};
+static std::mutex s_register_mutex;
+// Only taken when records are written on the calling thread.
+static std::mutex s_write_mutex;
+
+static std::thread s_thread;
+static std::atomic<bool> s_running {false};
+static std::atomic<bool> s_stop {false};
+
+static thread_local LogThreadRing s_thread_ring;
+static thread_local bool s_is_log_thread = false;
+
+LogThreadRing::~LogThreadRing()
+{
+    if (ring)
+        ring->released.store(true, std::memory_order_release);
+}
+
+static inline uint32_t AlignRecordSize(uint32_t size)
+{
+    return (size + 7) & ~7u;
+}
+
+// Output -----------------------------------------
+// Formatted text is batched and written with one call per drained ring.
+struct LogOutput
+{
+    void Append(const char* text, size_t length)
+    {
+        while (length)
+        {
+            if (used == sizeof(buffer))
+                Flush();
+
+            const size_t count = length < sizeof(buffer) - used ? length : sizeof(buffer) - used;
+            memcpy(buffer + used, text, count);
+            used += count;
+            text += count;
+            length -= count;
+        }
+    }
+
+    void Flush()
+    {
+        if (used)
+            fwrite(buffer, 1, used, stderr);
+        used = 0;
+    }
+
+    char buffer[16 * 1024];
+    size_t used = 0;
+}; // struct LogOutput
+
+static inline bool IsIntegerConversion(char conversion)
+{
+    return strchr("diouxXc", conversion) != nullptr;
+}
+
+static inline bool IsFloatConversion(char conversion)
+{
+    return strchr("fFeEgGaA", conversion) != nullptr;
+}
+
+// printf semantics, each conversion is formatted from its stored argument.
+// Length modifiers in the format are ignored, arguments are stored 64 bit.
+static void FormatRecord(LogOutput& output, const char* format, const LogArgument* arguments, uint32_t argument_count)
+{
+    uint32_t argument_index = 0;
+    const char* text = format;
+
+    while (*text)
+    {
+        const char* percent = strchr(text, '%');
+        if (!percent)
+        {
+            output.Append(text, strlen(text));
+            break;
+        }
+
+        output.Append(text, percent - text);
+        const char* spec = percent + 1;
+
+        if (*spec == '%')
+        {
+            output.Append("%", 1);
+            text = spec + 1;
+            continue;
+        }
+
+        // Flags, width and precision are kept, a '*' takes its value from the arguments.
+        char sub_format[64];
+        size_t sub_length = 0;
+        sub_format[sub_length++] = '%';
+
+        while (*spec && strchr("-+ #0", *spec) && sub_length < 16)
+            sub_format[sub_length++] = *spec++;
+
+        for (int32_t part = 0; part < 2; ++part)
+        {
+            if (part == 1)
+            {
+                if (*spec != '.')
+                    break;
+                sub_format[sub_length++] = *spec++;
+            }
+
+            if (*spec == '*')
+            {
+                ++spec;
+                const int64_t value = argument_index < argument_count ? arguments[argument_index++].int_value : 0;
+                sub_length += snprintf(sub_format + sub_length, sizeof(sub_format) - sub_length - 8, "%d", (int32_t)value);
+            }
+            else
+            {
+                while (*spec >= '0' && *spec <= '9' && sub_length < 40)
+                    sub_format[sub_length++] = *spec++;
+            }
+        }
+
+        while (*spec && strchr("hljztL", *spec))
+            ++spec;
+
+        const char conversion = *spec;
+        text = conversion ? spec + 1 : spec;
+
+        if (!conversion || argument_index >= argument_count)
+        {
+            output.Append(percent, text - percent);
+            continue;
+        }
+
+        const LogArgument& argument = arguments[argument_index++];
+        const bool plain = sub_length == 1;
+        char formatted[512];
+        int32_t length = 0;
+
+        switch (argument.type)
+        {
+            case LogArgumentType::String:
+            {
+                const char* string = argument.string ? argument.string : "(null)";
+                const size_t string_length = argument.string ? argument.length : 6;
+                if (plain || conversion != 's')
+                {
+                    output.Append(string, string_length);
+                    continue;
+                }
+                memcpy(sub_format + sub_length, "s", 2);
+                length = snprintf(formatted, sizeof(formatted), sub_format, string);
+                break;
+            }
+            case LogArgumentType::Double:
+            {
+                sub_format[sub_length++] = IsFloatConversion(conversion) ? conversion : 'g';
+                sub_format[sub_length] = 0;
+                length = snprintf(formatted, sizeof(formatted), sub_format, argument.double_value);
+                break;
+            }
+            case LogArgumentType::Pointer:
+            {
+                if (conversion == 'p')
+                {
+                    memcpy(sub_format + sub_length, "p", 2);
+                    length = snprintf(formatted, sizeof(formatted), sub_format, argument.pointer);
+                    break;
+                }
+                // A pointer printed as a number.
+                [[fallthrough]];
+            }
+            case LogArgumentType::Int:
+            case LogArgumentType::Uint:
+            {
+                if (IsFloatConversion(conversion))
+                {
+                    sub_format[sub_length++] = conversion;
+                    sub_format[sub_length] = 0;
+                    const double value = argument.type == LogArgumentType::Int ? (double)argument.int_value : (double)argument.uint_value;
+                    length = snprintf(formatted, sizeof(formatted), sub_format, value);
+                }
+                else if (conversion == 'c')
+                {
+                    memcpy(sub_format + sub_length, "c", 2);
+                    length = snprintf(formatted, sizeof(formatted), sub_format, (int32_t)argument.int_value);
+                }
+                else
+                {
+                    const char integer_conversion = IsIntegerConversion(conversion) ? conversion :
+                        (argument.type == LogArgumentType::Int ? 'd' : 'u');
+                    sub_format[sub_length++] = 'l';
+                    sub_format[sub_length++] = 'l';
+                    sub_format[sub_length++] = integer_conversion;
+                    sub_format[sub_length] = 0;
+                    length = snprintf(formatted, sizeof(formatted), sub_format, (long long)argument.int_value);
+                }
+                break;
+            }
+        }
+
+        if (length > 0)
+            output.Append(formatted, (size_t)length < sizeof(formatted) ? (size_t)length : sizeof(formatted) - 1);
+    }
+}
+
+static void WriteNow(const char* format, const LogArgument* arguments, uint32_t argument_count)
+{
+    std::lock_guard<std::mutex> lock(s_write_mutex);
+
+    static LogOutput output;
+    FormatRecord(output, format, arguments, argument_count);
+    output.Flush();
+}
+
+// Rings ------------------------------------------
+static LogRing* AcquireRing()
+{
+    if (s_thread_ring.ring)
+        return s_thread_ring.ring;
+
+    std::lock_guard<std::mutex> lock(s_register_mutex);
+
+    LogRing* ring = nullptr;
+    const uint32_t ring_count = s_ring_count.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < ring_count && !ring; ++i)
+    {
+        LogRing* candidate = s_rings[i].load(std::memory_order_relaxed);
+        if (candidate->released.load(std::memory_order_acquire) &&
+            candidate->read.load(std::memory_order_acquire) == candidate->write.load(std::memory_order_relaxed))
+        {
+            candidate->released.store(false, std::memory_order_relaxed);
+            ring = candidate;
+        }
+    }
+
+    if (!ring && ring_count < LOG_MAX_THREADS)
+    {
+        ring = new LogRing();
+        s_rings[ring_count].store(ring, std::memory_order_relaxed);
+        s_ring_count.store(ring_count + 1, std::memory_order_release);
+    }
+
+    s_thread_ring.ring = ring;
+    return ring;
+}
+
+void LogWrite(LogLevel::Enum level, const char* format, const LogArgument* arguments, uint32_t argument_count)
 {
-    EA::StdC::Fprintf(stderr, message);
+    LogRing* ring = s_running.load(std::memory_order_acquire) ? AcquireRing() : nullptr;
+    if (!ring)
+    {
+        WriteNow(format, arguments, argument_count);
+        return;
+    }
+
+    // Strings are copied null terminated after the arguments, cut to fit the largest record.
+    const uint32_t fixed_size = sizeof(LogRecord) + argument_count * sizeof(LogArgument);
+    // Terminators are reserved up front, they always fit.
+    uint32_t string_budget = LOG_MAX_RECORD_SIZE - fixed_size - argument_count;
+    uint32_t string_size = 0;
+    for (uint32_t i = 0; i < argument_count; ++i)
+    {
+        if (arguments[i].type == LogArgumentType::String)
+        {
+            const uint32_t length = arguments[i].length < string_budget ? arguments[i].length : string_budget;
+            string_size += length + 1;
+            string_budget -= length;
+        }
+    }
+
+    const uint32_t size = AlignRecordSize(fixed_size + string_size);
+    const uint64_t write = ring->write.load(std::memory_order_relaxed);
+    const uint32_t offset = (uint32_t)(write % LOG_RING_SIZE);
+    const uint32_t contiguous = LOG_RING_SIZE - offset;
+    const uint32_t needed = size <= contiguous ? size : contiguous + size;
+
+    uint64_t read = ring->read.load(std::memory_order_acquire);
+    while (LOG_RING_SIZE - (write - read) < needed)
+    {
+        // Errors wait for the log thread, anything else is dropped rather than stalling the caller.
+        if (level < LogLevel::Error || !s_running.load(std::memory_order_relaxed))
+        {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+        read = ring->read.load(std::memory_order_acquire);
+    }
+
+    uint64_t position = write;
+    if (size > contiguous)
+    {
+        LogRecord* wrap = (LogRecord*)(ring->data + offset);
+        wrap->size = contiguous;
+        wrap->level = LOG_RECORD_WRAP;
+        position += contiguous;
+    }
+
+    char* data = ring->data + position % LOG_RING_SIZE;
+    LogRecord* record = (LogRecord*)data;
+    record->size = size;
+    record->level = level;
+    record->argument_count = (uint8_t)argument_count;
+    record->format = format;
+
+    LogArgument* stored_arguments = (LogArgument*)(data + sizeof(LogRecord));
+    char* strings = data + fixed_size;
+    string_budget = LOG_MAX_RECORD_SIZE - fixed_size - argument_count;
+    for (uint32_t i = 0; i < argument_count; ++i)
+    {
+        stored_arguments[i] = arguments[i];
+        if (arguments[i].type == LogArgumentType::String && arguments[i].string)
+        {
+            const uint32_t length = arguments[i].length < string_budget ? arguments[i].length : string_budget;
+            memcpy(strings, arguments[i].string, length);
+            strings[length] = 0;
+            stored_arguments[i].string = strings;
+            stored_arguments[i].length = length;
+            strings += length + 1;
+            string_budget -= length;
+        }
+    }
+
+    ring->write.store(position + size, std::memory_order_release);
+}
+
+// Log thread -------------------------------------
+static bool DrainRing(LogRing* ring, LogOutput& output)
+{
+    const uint32_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped)
+    {
+        const LogArgument argument = MakeLogArgument(dropped);
+        FormatRecord(output, "[Log]: Warning: %u messages were dropped, the log ring was full.\n", &argument, 1);
+    }
+
+    const uint64_t write = ring->write.load(std::memory_order_acquire);
+    uint64_t read = ring->read.load(std::memory_order_relaxed);
+    if (read == write)
+    {
+        output.Flush();
+        return dropped != 0;
+    }
+
+    while (read != write)
+    {
+        const LogRecord* record = (const LogRecord*)(ring->data + read % LOG_RING_SIZE);
+        if (record->level != LOG_RECORD_WRAP)
+        {
+            const LogArgument* arguments = (const LogArgument*)((const char*)record + sizeof(LogRecord));
+            FormatRecord(output, record->format, arguments, record->argument_count);
+        }
+        read += record->size;
+    }
+
+    // Written before the space is handed back, LogFlush() relies on it.
+    output.Flush();
+    ring->read.store(read, std::memory_order_release);
+    return true;
+}
+
+static void LogThreadLoop()
+{
+    s_is_log_thread = true;
+    static LogOutput output;
+
+    for (;;)
+    {
+        // Checked before draining, so records written before the stop are written.
+        const bool stop = s_stop.load(std::memory_order_acquire);
+
+        bool written = false;
+        const uint32_t ring_count = s_ring_count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < ring_count; ++i)
+            written |= DrainRing(s_rings[i].load(std::memory_order_relaxed), output);
+
+        if (written)
+            continue;
+        if (stop)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void LogInit()
+{
+    if (s_running.load(std::memory_order_relaxed))
+        return;
+
+    s_stop.store(false, std::memory_order_relaxed);
+    s_thread = std::thread(LogThreadLoop);
+    s_running.store(true, std::memory_order_release);
+}
+
+void LogShutdown()
+{
+    if (!s_running.load(std::memory_order_relaxed))
+        return;
+
+    // Records logged from here on are written directly. Records of threads
+    // that are still logging meanwhile stay in their rings until the next
+    // LogInit(), join them first for everything to be written.
+    s_running.store(false, std::memory_order_release);
+    s_stop.store(true, std::memory_order_release);
+    s_thread.join();
 }
 
-void Log(const char* message...)
+void LogFlush()
 {
-	va_list arguments;
-	va_start(arguments, message);
+    if (!s_running.load(std::memory_order_acquire) || s_is_log_thread)
+        return;
 
-    EA::StdC::Vfprintf(stderr, message, arguments);
+    uint64_t targets[LOG_MAX_THREADS];
+    const uint32_t ring_count = s_ring_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < ring_count; ++i)
+        targets[i] = s_rings[i].load(std::memory_order_relaxed)->write.load(std::memory_order_acquire);
 
-	va_end(arguments);
+    for (uint32_t i = 0; i < ring_count; ++i)
+    {
+        LogRing* ring = s_rings[i].load(std::memory_order_relaxed);
+        while (ring->read.load(std::memory_order_acquire) < targets[i] && s_running.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
 }
 
 } // namespace Debug
-} // namespace Raptor
\ No newline at end of file
+} // namespace Raptor
@@ -1,12 +1,151 @@
 #pragma once
 
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
 namespace Raptor
 {
 namespace Debug
 {
 
-void Log(char* message);
-void Log(const char* message, ...);
+// Levels below RAPTOR_LOG_LEVEL are compiled out, the call and its record
+// disappear. Arguments with side effects are still evaluated.
+#define RAPTOR_LOG_LEVEL_TRACE 0
+#define RAPTOR_LOG_LEVEL_INFO 1
+#define RAPTOR_LOG_LEVEL_WARNING 2
+#define RAPTOR_LOG_LEVEL_ERROR 3
+#define RAPTOR_LOG_LEVEL_NONE 4
+
+#if !defined(RAPTOR_LOG_LEVEL)
+#if defined(NDEBUG)
+#define RAPTOR_LOG_LEVEL RAPTOR_LOG_LEVEL_INFO
+#else
+#define RAPTOR_LOG_LEVEL RAPTOR_LOG_LEVEL_TRACE
+#endif
+#endif
+
+namespace LogLevel
+{
+enum Enum : uint8_t
+{
+    Trace = RAPTOR_LOG_LEVEL_TRACE,
+    Info = RAPTOR_LOG_LEVEL_INFO,
+    Warning = RAPTOR_LOG_LEVEL_WARNING,
+    Error = RAPTOR_LOG_LEVEL_ERROR
+};
+} // namespace LogLevel
+
+namespace LogArgumentType
+{
+enum Enum : uint8_t
+{
+    Int, Uint, Double, Pointer, String
+};
+} // namespace LogArgumentType
+
+struct LogArgument
+{
+    union
+    {
+        int64_t int_value;
+        uint64_t uint_value;
+        double double_value;
+        const void* pointer;
+        const char* string;
+    };
+    // Length of a string argument, copied into the record.
+    uint32_t length;
+    LogArgumentType::Enum type;
+}; // struct LogArgument
+
+// Records are formatted and written to stderr by a background thread. Until
+// LogInit() and after LogShutdown() they are written on the calling thread.
+void LogInit();
+// Writes every pending record first. Threads still logging while it runs can
+// leave records behind that are only written after the next LogInit().
+void LogShutdown();
+// Blocks until records logged before the call are written.
+void LogFlush();
+
+// Copies the arguments into the ring buffer of the calling thread without
+// formatting. The format must outlive the program, so it has to be a string
+// literal. When the ring is full errors wait for space, other records are
+// dropped and counted.
+void LogWrite(LogLevel::Enum level, const char* format, const LogArgument* arguments, uint32_t argument_count);
+
+template<typename T>
+inline LogArgument MakeLogArgument(T value)
+{
+    LogArgument argument;
+    if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+    {
+        argument.type = LogArgumentType::String;
+        argument.string = value;
+        argument.length = value ? (uint32_t)strlen(value) : 0;
+    }
+    else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>)
+    {
+        argument.type = LogArgumentType::Pointer;
+        argument.pointer = (const void*)value;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        argument.type = LogArgumentType::Double;
+        argument.double_value = (double)value;
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        argument.type = LogArgumentType::Int;
+        argument.int_value = (int64_t)value;
+    }
+    else
+    {
+        static_assert(std::is_integral_v<T>, "Log arguments must be numbers, pointers or strings.");
+        if constexpr (std::is_signed_v<T>)
+        {
+            argument.type = LogArgumentType::Int;
+            argument.int_value = (int64_t)value;
+        }
+        else
+        {
+            argument.type = LogArgumentType::Uint;
+            argument.uint_value = (uint64_t)value;
+        }
+    }
+    return argument;
+}
+
+template<LogLevel::Enum level, typename... Args>
+inline void LogAt(const char* format, Args... args)
+{
+    if constexpr (level >= RAPTOR_LOG_LEVEL)
+    {
+        if constexpr (sizeof...(Args) == 0)
+        {
+            LogWrite(level, format, nullptr, 0);
+        }
+        else
+        {
+            // Arrays decay here, char buffers are passed as strings.
+            const LogArgument arguments[] = {MakeLogArgument(args)...};
+            LogWrite(level, format, arguments, sizeof...(Args));
+        }
+    }
+}
+
+template<typename... Args>
+inline void LogTrace(const char* format, Args... args) { LogAt<LogLevel::Trace>(format, args...); }
+
+template<typename... Args>
+inline void Log(const char* format, Args... args) { LogAt<LogLevel::Info>(format, args...); }
+
+template<typename... Args>
+inline void LogWarning(const char* format, Args... args) { LogAt<LogLevel::Warning>(format, args...); }
+
+template<typename... Args>
+inline void LogError(const char* format, Args... args) { LogAt<LogLevel::Error>(format, args...); }
 
 } // namespace Debug
-} // namespace Raptor
\ No newline at end of file
+} // namespace Raptor
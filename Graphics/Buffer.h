@@ -1,6 +1,7 @@
 #pragma once
 #include <vk_mem_alloc.h>
 #include "Types.h"
+#include "Hash.h"
 #include "Resources.h"
 #include "ResourceManager.h"
 
@@ -30,6 +31,17 @@ struct Buffer
     const char* name = nullptr;
 }; // struct Buffer
 
+// What binding a buffer reads while recording. GPUDevice keeps it in the hot
+// array of the buffer pool, away from the rest of Buffer, and writes it where
+// the matching Buffer fields change. Buffers inside a parent hold the parent
+// VkBuffer, binding them takes no second lookup.
+struct BufferHot
+{
+    VkBuffer vk_buffer = VK_NULL_HANDLE;
+    BufferHandle parent_buffer;
+    uint32 global_offset = 0;
+}; // struct BufferHot
+
 struct CreateBufferParams
 {
     ResourceUsageType usage = ResourceUsageType::Immutable;
@@ -69,8 +81,8 @@ struct BufferResource : public Resource
     uint32 pool_index;
     BufferDescription desc;
 
-    static constexpr char* type = "BufferType";
-    static uint64 type_hash;
+    static constexpr const char* type = "BufferType";
+    static constexpr uint64 type_hash = Raptor::Core::HashStringConstexpr(type);
 }; // struct BufferResource
 
 } // namespace Graphics
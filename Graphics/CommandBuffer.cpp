@@ -61,7 +61,7 @@ void CommandBuffer::BindPass(RenderPassHandle handle)
 
 void CommandBuffer::BindPipeline(PipelineHandle handle)
 {
-    Pipeline* pipeline = gpu_device->AccessPipeline(handle);
+    PipelineHot* pipeline = gpu_device->AccessPipelineHot(handle);
     vkCmdBindPipeline(vk_command_buffer, pipeline->vk_pipeline_bind_point, pipeline->vk_pipeline);
 
     current_pipeline = pipeline;
@@ -69,14 +69,13 @@ void CommandBuffer::BindPipeline(PipelineHandle handle)
 
 void CommandBuffer::BindVertexBuffer(BufferHandle handle, uint32 binding, uint32 offset)
 {
-    Buffer* buffer = gpu_device->AccessBuffer(handle);
+    // Only the hot part of the buffer is read, it already holds the parent VkBuffer.
+    const BufferHot* buffer = gpu_device->AccessBufferHot(handle);
     VkDeviceSize offsets[] = {offset};
     
     VkBuffer vk_buffer = buffer->vk_buffer;
     if (buffer->parent_buffer != InvalidBuffer)
     {
-        Buffer* parent_buffer = gpu_device->AccessBuffer(buffer->parent_buffer);
-        vk_buffer = parent_buffer->vk_buffer;
         offsets[0] = buffer->global_offset;
     }
 
@@ -85,14 +84,12 @@ void CommandBuffer::BindVertexBuffer(BufferHandle handle, uint32 binding, uint32
 
 void CommandBuffer::BindIndexBuffer(BufferHandle handle, uint32 _offset, VkIndexType index_type)
 {
-    Buffer* buffer = gpu_device->AccessBuffer(handle);
+    const BufferHot* buffer = gpu_device->AccessBufferHot(handle);
     VkDeviceSize offset = _offset;
 
     VkBuffer vk_buffer = buffer->vk_buffer;
     if (buffer->parent_buffer != InvalidBuffer)
     {
-        Buffer* parent_buffer = gpu_device->AccessBuffer(buffer->parent_buffer);
-        vk_buffer = parent_buffer->vk_buffer;
         offset = buffer->global_offset;
     }
 
@@ -118,7 +115,7 @@ void CommandBuffer::BindDescriptorSet(DescriptorSetHandle* handles, uint32 num_l
             {
                 const uint32 resource_index = descriptor_set->bindings[j];
                 ResourceHandle buffer_handle = descriptor_set->resources[resource_index];
-                Buffer* buffer = gpu_device->AccessBuffer(buffer_handle);
+                const BufferHot* buffer = gpu_device->AccessBufferHot(buffer_handle);
 
                 offset_cache[num_offsets++] = buffer->global_offset;
             }
@@ -65,7 +65,7 @@ public:
     VkDescriptorSet vk_descriptor_sets[16];
 
     RenderPass* current_render_pass;
-    Pipeline* current_pipeline;
+    PipelineHot* current_pipeline;
 
     VkClearValue vk_clears[2]; // 0 color, 1 depth
 
@@ -25,6 +25,8 @@
 #include "CommandBuffer.h"
 #include "CommandBufferRing.h"
 #include "Hash.h"
+#include "HashMap.h"
+#include "Profiler.h"
 
 namespace Raptor
 {
@@ -32,8 +34,10 @@ namespace Graphics
 {
 
 using eastl::clamp;
-template<typename Key, typename T> using HashMap = eastl::hash_map<Key, T>;
-template<typename Key, typename T> using Pair = eastl::pair<Key, T>;
+using Raptor::Core::HashMap;
+using Raptor::Core::Pair;
+using Raptor::Core::StackAllocatorScope;
+using String = eastl::basic_string<char, ContainerAllocator>;
 using EA::StdC::Snprintf;
 
 static const char* s_requested_layers[] = {
@@ -60,11 +64,13 @@ PFN_vkCmdBeginDebugUtilsLabelEXT pfnCmdBeginDebugUtilsLabelEXT;
 PFN_vkCmdEndDebugUtilsLabelEXT pfnCmdEndDebugUtilsLabelEXT;
 
 static CommandBufferRing* command_buffer_ring;
-static HashMap<uint64, VkRenderPass> render_pass_cache;
 
 static sizet uboAlignment = 256;
 static sizet ssboAlignment = 256;
 
+static const sizet TEMPORARY_ALLOCATOR_SIZE = 1024 * 1024;
+static const sizet FRAME_ALLOCATOR_SIZE = 1024 * 1024;
+
 //------------------------------------------------------------------------------
 GPUDevice::GPUDevice(Window& window, Allocator& allocator, uint32 flags, uint32 gpu_time_queries_per_frame)
     : window(&window), allocator(&allocator), m_uFlags(flags)
@@ -85,6 +91,7 @@ GPUDevice::~GPUDevice()
 //------------------------------------------------------------------------------
 void GPUDevice::Init(uint32 gpu_time_queries_per_frame)
 {
+    CreateAllocators();
     CreateInstance();
     CreateDebugUtilsMessenger();
     CreateSurface();
@@ -202,6 +209,7 @@ void GPUDevice::Shutdown()
     DestroySurface();
     DestroyDebugUtilsMessenger();
     DestroyInstance();
+    DestroyAllocators();
 }
 
 
@@ -268,11 +276,11 @@ void GPUDevice::CreateDebugUtilsMessenger()
         if (vkCreateDebugUtilsMessengerEXT != nullptr)
             vkCreateDebugUtilsMessengerEXT(vk_instance, &debugCreateInfo, vk_allocation_callbacks, &vk_debug_utils_messenger);
         else
-            Raptor::Debug::Log("[Vulkan] Warning: Failed to setup debug messenger.");
+            Raptor::Debug::LogWarning("[Vulkan] Warning: Failed to setup debug messenger.");
     }
     else
     {
-        Raptor::Debug::Log("[Vulkan] Warning: Extension %s for debugging does not exist!", VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        Raptor::Debug::LogWarning("[Vulkan] Warning: Extension %s for debugging does not exist!", VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 #endif
 }
@@ -465,7 +473,7 @@ bool GPUDevice::SetPresentMode(VkPresentModeKHR requestedPresentMode)
 
     // Default to VK_PRESENT_MODE_FIFO_KHR if the requested present mode is not found.
     vk_present_mode = VK_PRESENT_MODE_FIFO_KHR;
-    Raptor::Debug::Log("[Vulkan] Warning: Could not set present mode to requested present mode: %d, defaulting to present mode: %d.", requestedPresentMode, vk_present_mode);
+    Raptor::Debug::LogWarning("[Vulkan] Warning: Could not set present mode to requested present mode: %d, defaulting to present mode: %d.", requestedPresentMode, vk_present_mode);
     return false;
 }
 
@@ -565,6 +573,23 @@ void GPUDevice::DestroyVmaAllocator()
     vmaDestroyAllocator(vma_allocator);
 }
 
+//------------------------------------------------------------------------------
+void GPUDevice::CreateAllocators()
+{
+    temporary_allocator.init(allocator, TEMPORARY_ALLOCATOR_SIZE);
+    temporary_allocator.set_name("GPUDevice Temporary");
+
+    frame_allocator.init(allocator, FRAME_ALLOCATOR_SIZE);
+    frame_allocator.set_name("GPUDevice Frame");
+}
+
+//------------------------------------------------------------------------------
+void GPUDevice::DestroyAllocators()
+{
+    frame_allocator.shutdown();
+    temporary_allocator.shutdown();
+}
+
 //------------------------------------------------------------------------------
 void GPUDevice::CreatePools(uint32 gpu_time_queries_per_frame)
 {
@@ -608,17 +633,45 @@ void GPUDevice::CreatePools(uint32 gpu_time_queries_per_frame)
     result = vkCreateQueryPool(vk_device, &queryPoolInfo, vk_allocation_callbacks, &vk_query_pool);
     ASSERT_MESSAGE(result == VK_SUCCESS, "[Vulkan] Error: Failed to create query pool.");
 
-    // init pools
-    buffers.init(allocator, 4096, sizeof(Buffer));
-    textures.init(allocator, 512, sizeof(Texture));
-    render_passes.init(allocator, 256, sizeof(RenderPass));
-    descriptor_set_layouts.init(allocator, 128, sizeof(DescriptorSetLayout));
-    pipelines.init(allocator, 128, sizeof(Pipeline));
-    shaders.init(allocator, 128, sizeof(ShaderState));
+    // init pools, sizes are per page
+    buffers.init(allocator, 1024, sizeof(Buffer), sizeof(BufferHot));
+    textures.init(allocator, 256, sizeof(Texture), sizeof(TextureHot));
+    render_passes.init(allocator, 64, sizeof(RenderPass));
+    descriptor_set_layouts.init(allocator, 64, sizeof(DescriptorSetLayout));
+    pipelines.init(allocator, 64, sizeof(Pipeline), sizeof(PipelineHot));
+    shaders.init(allocator, 64, sizeof(ShaderState));
     descriptor_sets.init(allocator, 256, sizeof(DescriptorSet));
     samplers.init(allocator, 32, sizeof(Sampler));
 }
 
+//------------------------------------------------------------------------------
+void GPUDevice::ReserveResources(uint32 buffer_count, uint32 texture_count, uint32 sampler_count, uint32 descriptor_set_count)
+{
+    // Counts are on top of what the device already created for itself.
+    buffers.reserve(buffers.usedIndices + buffer_count);
+    textures.reserve(textures.usedIndices + texture_count);
+    samplers.reserve(samplers.usedIndices + sampler_count);
+    descriptor_sets.reserve(descriptor_sets.usedIndices + descriptor_set_count);
+}
+
+//------------------------------------------------------------------------------
+void GPUDevice::LogPoolStatistics() const
+{
+    const struct { const char* name; const ResourcePool* pool; } pools[] =
+    {
+        {"Buffers", &buffers}, {"Textures", &textures}, {"Pipelines", &pipelines}, {"Samplers", &samplers},
+        {"DescriptorSetLayouts", &descriptor_set_layouts}, {"DescriptorSets", &descriptor_sets},
+        {"RenderPasses", &render_passes}, {"Shaders", &shaders},
+    };
+
+    for (uint32 i = 0; i < ARRAY_SIZE(pools); ++i)
+    {
+        const ResourcePoolStatistics statistics = pools[i].pool->getStatistics();
+        Raptor::Debug::Log("[Vulkan] Info: %-20s %6u used, high water %6u, capacity %6u in %u pages, %zu bytes\n",
+            pools[i].name, statistics.used, statistics.high_water_mark, statistics.capacity, statistics.page_count, statistics.memory_bytes);
+    }
+}
+
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyPools()
 {
@@ -719,12 +772,18 @@ BufferHandle GPUDevice::CreateBuffer(const CreateBufferParams& params)
     buffer->global_offset = 0;
     buffer->parent_buffer = InvalidBuffer;
 
+    BufferHot* buffer_hot = AccessBufferHot(handle);
+    buffer_hot->global_offset = 0;
+    buffer_hot->parent_buffer = InvalidBuffer;
+
     static const VkBufferUsageFlags DYNAMIC_BUFFER_MASK = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
     const bool USE_GLOBAL_BUFFER = (params.flags & DYNAMIC_BUFFER_MASK) != 0;
 
     if (params.usage == ResourceUsageType::Dynamic && USE_GLOBAL_BUFFER)
     {
         buffer->parent_buffer = dynamic_buffer;
+        buffer_hot->parent_buffer = dynamic_buffer;
+        buffer_hot->vk_buffer = AccessBufferHot(dynamic_buffer)->vk_buffer;
         return handle;
     }
 
@@ -743,6 +802,7 @@ BufferHandle GPUDevice::CreateBuffer(const CreateBufferParams& params)
     ASSERT_MESSAGE(result == VK_SUCCESS, "[Vulkan] Error: Failed to allocate buffer.");
 
     SetResourceName(VK_OBJECT_TYPE_BUFFER, (uint64)buffer->vk_buffer, params.name);
+    buffer_hot->vk_buffer = buffer->vk_buffer;
 
     buffer->vk_device_memory = alloc_info.deviceMemory;
 
@@ -824,13 +884,14 @@ static void CreateTexture(GPUDevice& gpu_device, const CreateTextureParams& para
         view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     }
 
-    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.levelCount = params.mipmaps;
     view_info.subresourceRange.layerCount = 1;
 
     result = vkCreateImageView(gpu_device.vk_device, &view_info, gpu_device.vk_allocation_callbacks, &texture->vk_image_view);
     ASSERT_MESSAGE(result == VK_SUCCESS, "[Vulkan] Error: Failed to create Image View for Texture.");
 
     gpu_device.SetResourceName(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64)texture->vk_image_view, params.name);
+    gpu_device.AccessTextureHot(handle)->vk_image_view = texture->vk_image_view;
 
     texture->vk_image_layout = VK_IMAGE_LAYOUT_UNDEFINED;
 }
@@ -852,7 +913,8 @@ TextureHandle GPUDevice::CreateTexture(const CreateTextureParams& params)
         VkBufferCreateInfo buffer_info {};
         buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        buffer_info.size = params.width * params.height * 4;
+        // With more than one mip the data holds the whole chain, tightly packed from level 0.
+        buffer_info.size = TextureMipChainSize(params.width, params.height, params.mipmaps);
         
         VmaAllocationCreateInfo alloc_create_info {};
         alloc_create_info.flags = VMA_ALLOCATION_CREATE_STRATEGY_BEST_FIT_BIT;
@@ -878,19 +940,30 @@ TextureHandle GPUDevice::CreateTexture(const CreateTextureParams& params)
         CommandBuffer* command_buffer = GetInstantCommandBuffer();
         vkBeginCommandBuffer(command_buffer->vk_command_buffer, &begin_info);
 
-        VkBufferImageCopy region = {};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {params.width, params.height, params.depth};
+        VkBufferImageCopy regions[MAX_TEXTURE_MIPMAPS] = {};
+        const uint32 region_count = MIN(params.mipmaps, MAX_TEXTURE_MIPMAPS);
+        VkDeviceSize region_offset = 0;
+        for (uint32 mip = 0; mip < region_count; ++mip)
+        {
+            const uint32 mip_width = MAX(params.width >> mip, 1);
+            const uint32 mip_height = MAX(params.height >> mip, 1);
+
+            VkBufferImageCopy& region = regions[mip];
+            region.bufferOffset = region_offset;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = mip;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {mip_width, mip_height, params.depth};
+
+            region_offset += mip_width * mip_height * 4;
+        }
 
         TransitionImageLayout(command_buffer->vk_command_buffer, texture->vk_image, texture->vk_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, false);
-        vkCmdCopyBufferToImage(command_buffer->vk_command_buffer, staging_buffer, texture->vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        vkCmdCopyBufferToImage(command_buffer->vk_command_buffer, staging_buffer, texture->vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, region_count, regions);
         TransitionImageLayout(command_buffer->vk_command_buffer, texture->vk_image, texture->vk_format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false);
 
         vkEndCommandBuffer(command_buffer->vk_command_buffer);
@@ -1150,6 +1223,11 @@ PipelineHandle GPUDevice::CreatePipeline(const CreatePipelineParams& params)
         pipeline->vk_pipeline_bind_point = VkPipelineBindPoint::VK_PIPELINE_BIND_POINT_COMPUTE;
     }
 
+    PipelineHot* pipeline_hot = AccessPipelineHot(handle);
+    pipeline_hot->vk_pipeline = pipeline->vk_pipeline;
+    pipeline_hot->vk_pipeline_layout = pipeline->vk_pipeline_layout;
+    pipeline_hot->vk_pipeline_bind_point = pipeline->vk_pipeline_bind_point;
+
     return handle;
 }
 //------------------------------------------------------------------------------
@@ -1274,7 +1352,7 @@ static void FillWriteDescriptorSets(GPUDevice& gpu_device, const DescriptorSetLa
                 }
 
                 image_info[i].imageLayout = TextureFormat::HasDepthOrStencil(texture_data->vk_format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                image_info[i].imageView = texture_data->vk_image_view;
+                image_info[i].imageView = gpu_device.AccessTextureHot(texture_handle)->vk_image_view;
 
                 descriptor_write[i].pImageInfo = &image_info[i];
 
@@ -1285,11 +1363,10 @@ static void FillWriteDescriptorSets(GPUDevice& gpu_device, const DescriptorSetLa
                 descriptor_write[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 
                 TextureHandle texture_handle = resources[i];
-                Texture* texture_data = gpu_device.AccessTexture(texture_handle);
 
                 image_info[i].sampler = nullptr;
                 image_info[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-                image_info[i].imageView = texture_data->vk_image_view;
+                image_info[i].imageView = gpu_device.AccessTextureHot(texture_handle)->vk_image_view;
 
                 descriptor_write[i].pImageInfo = &image_info[i];
 
@@ -1302,16 +1379,7 @@ static void FillWriteDescriptorSets(GPUDevice& gpu_device, const DescriptorSetLa
 
                 descriptor_write[i].descriptorType = (buffer->usage == ResourceUsageType::Dynamic) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 
-                if (buffer->parent_buffer != InvalidBuffer)
-                {
-                    Buffer* parent_buffer = gpu_device.AccessBuffer(buffer->parent_buffer);
-
-                    buffer_info[i].buffer = parent_buffer->vk_buffer;
-                }
-                else
-                {
-                    buffer_info[i].buffer = buffer->vk_buffer;
-                }
+                buffer_info[i].buffer = gpu_device.AccessBufferHot(buffer_handle)->vk_buffer;
 
                 buffer_info[i].offset = 0;
                 buffer_info[i].range = buffer->size;
@@ -1327,16 +1395,7 @@ static void FillWriteDescriptorSets(GPUDevice& gpu_device, const DescriptorSetLa
 
                 descriptor_write[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 
-                if (buffer->parent_buffer != InvalidBuffer)
-                {
-                    Buffer* parent_buffer = gpu_device.AccessBuffer(buffer->parent_buffer);
-                    
-                    buffer_info[i].buffer = parent_buffer->vk_buffer;
-                }
-                else
-                {
-                    buffer_info[i].buffer = buffer->vk_buffer;
-                }
+                buffer_info[i].buffer = gpu_device.AccessBufferHot(buffer_handle)->vk_buffer;
 
                 buffer_info[i].offset = 0;
                 buffer_info[i].range = buffer->size;
@@ -1534,8 +1593,9 @@ VkRenderPass GPUDevice::GetVkRenderPass(const RenderPassOutput& output, const ch
 {
     uint64 hash = Raptor::Core::HashBytes((void*)&output, sizeof(RenderPassOutput));
 
-    if (render_pass_cache.count(hash) > 0)
-        return render_pass_cache.at(hash);
+    auto it = render_pass_cache.find(hash);
+    if (it != render_pass_cache.end())
+        return it->second;
         
     VkRenderPass vk_render_pass = CreateVkRenderPass(*this, output, name);
     Pair<uint64, VkRenderPass> pair(hash, vk_render_pass);
@@ -1767,7 +1827,7 @@ ShaderStateHandle GPUDevice::CreateShaderState( const CreateShaderStateParams& p
 
     if (params.stages_count == 0 || params.stages == nullptr)
     {
-        Raptor::Debug::Log("[Vulkan] Warning: Shader %s does not contain shader stages.\n", params.name);
+        Raptor::Debug::LogWarning("[Vulkan] Warning: Shader %s does not contain shader stages.\n", params.name);
         return handle;
     }
 
@@ -1777,10 +1837,32 @@ ShaderStateHandle GPUDevice::CreateShaderState( const CreateShaderStateParams& p
 
     uint32 compiled_shaders = 0;
 
+    // Compiler arguments and SPIR-V binaries are only needed until the modules are created.
+    StackAllocatorScope temporary_scope(temporary_allocator);
+
     ShaderState* shader_state = AccessShaderState(handle);
     shader_state->graphics_pipeline = true;
     shader_state->active_shaders = 0;
 
+    // Every stage is handed to its own compiler process before waiting on any of them.
+    ShaderCompilation compilations[MAX_SHADER_STAGES];
+    if (!params.spv_input)
+    {
+        Raptor::Core::Process* processes[MAX_SHADER_STAGES];
+        uint32 process_count = 0;
+
+        for (uint32 i = 0; i < params.stages_count; i++)
+        {
+            const ShaderStage& stage = params.stages[i];
+            StartShaderCompilation(stage.code, stage.code_size, stage.type, params.name, compilations[i]);
+
+            if (compilations[i].process)
+                processes[process_count++] = compilations[i].process;
+        }
+
+        Raptor::Core::ProcessWaitAll(processes, process_count);
+    }
+
     for (compiled_shaders = 0; compiled_shaders < params.stages_count; compiled_shaders++)
     {
         const ShaderStage& stage = params.stages[compiled_shaders];
@@ -1800,7 +1882,7 @@ ShaderStateHandle GPUDevice::CreateShaderState( const CreateShaderStateParams& p
         }
         else
         {
-            shader_create_info = CompileShader(stage.code, stage.code_size, stage.type, params.name);
+            shader_create_info = FinishShaderCompilation(compilations[compiled_shaders], stage.code, stage.type, params.name);
         }
 
         VkPipelineShaderStageCreateInfo& shader_stage_info = shader_state->shader_stage_info[compiled_shaders];
@@ -1820,11 +1902,11 @@ ShaderStateHandle GPUDevice::CreateShaderState( const CreateShaderStateParams& p
         DestroyShaderState(handle);
         handle = InvalidShaderState;
 
-        Raptor::Debug::Log("Error creating shader %s.\n", params.name);
+        Raptor::Debug::LogError("Error creating shader %s.\n", params.name);
         for (compiled_shaders = 0; compiled_shaders < params.stages_count; compiled_shaders++)
         {
             const ShaderStage& stage = params.stages[compiled_shaders];
-            Raptor::Debug::Log("%u:\n%s\n", stage.type, stage.code);
+            Raptor::Debug::LogError("%u:\n%s\n", stage.type, stage.code);
         }
 
         return handle;
@@ -1839,25 +1921,66 @@ ShaderStateHandle GPUDevice::CreateShaderState( const CreateShaderStateParams& p
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyBuffer(BufferHandle handle)
 {
-    if (handle < buffers.poolSize)
+    if (buffers.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::Buffer, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid Buffer %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid Buffer %u\n", handle);
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyTexture(TextureHandle handle)
 {
-    if (handle < textures.poolSize)
+    if (textures.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::Texture, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid Texture %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid Texture %u\n", handle);
+}
+
+//------------------------------------------------------------------------------
+void GPUDevice::ReplaceTexture(TextureHandle handle, TextureHandle new_texture)
+{
+    Texture* texture = AccessTexture(handle);
+    Texture* replacement = AccessTexture(new_texture);
+
+    // The handle keeps its slot and takes the new image, the old one leaves
+    // with new_texture through the deletion queue.
+    const Texture old_texture = *texture;
+    *texture = *replacement;
+    *replacement = old_texture;
+    texture->handle = handle;
+    texture->name = old_texture.name;
+    replacement->handle = new_texture;
+
+    TextureHot* texture_hot = AccessTextureHot(handle);
+    TextureHot* replacement_hot = AccessTextureHot(new_texture);
+    const TextureHot old_texture_hot = *texture_hot;
+    *texture_hot = *replacement_hot;
+    *replacement_hot = old_texture_hot;
+
+    DestroyTexture(new_texture);
+
+    for (uint32 i = 0; i < descriptor_sets.poolSize; ++i)
+    {
+        const DescriptorSetHandle descriptor_set_handle = descriptor_sets.handleFromIndex(i);
+        const DescriptorSet* descriptor_set = AccessDescriptorSet(descriptor_set_handle);
+        if (!descriptor_set->layout)
+            continue;
+
+        for (uint32 r = 0; r < descriptor_set->num_resources; ++r)
+        {
+            if (descriptor_set->resources[r] == handle)
+            {
+                descriptor_set_updates.push_back({descriptor_set_handle, current_frame});
+                break;
+            }
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyPipeline(PipelineHandle handle)
 {
-    if (handle < pipelines.poolSize)
+    if (pipelines.isValid(handle))
     {
         resource_deletion_queue.push_back({ResourceDeletionType::Pipeline, handle, current_frame});
         Pipeline* pipeline = AccessPipeline(handle);
@@ -1865,53 +1988,53 @@ void GPUDevice::DestroyPipeline(PipelineHandle handle)
     }
     else
     {
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid Pipeline %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid Pipeline %u\n", handle);
     }
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroySampler(SamplerHandle handle)
 {
-    if (handle < samplers.poolSize)
+    if (samplers.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::Sampler, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid Sampler %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid Sampler %u\n", handle);
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyDescriptorSetLayout(DescriptorSetLayoutHandle handle)
 {
-    if (handle < descriptor_set_layouts.poolSize)
+    if (descriptor_set_layouts.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::DescriptorSetLayout, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid DescriptorSetLayout %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid DescriptorSetLayout %u\n", handle);
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyDescriptorSet(DescriptorSetHandle handle)
 {
-    if (handle < descriptor_sets.poolSize)
+    if (descriptor_sets.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::DescriptorSet, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid DescriptorSet %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid DescriptorSet %u\n", handle);
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyRenderPass(RenderPassHandle handle)
 {
-    if (handle < render_passes.poolSize)
+    if (render_passes.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::RenderPass, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid RenderPass %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid RenderPass %u\n", handle);
 }
 
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyShaderState(ShaderStateHandle handle)
 {
-    if (handle < shaders.poolSize)
+    if (shaders.isValid(handle))
         resource_deletion_queue.push_back({ResourceDeletionType::ShaderState, handle, current_frame});
     else
-        Raptor::Debug::Log("[Vulkan] Error: Trying to free invalid ShaderState %u\n", handle);
+        Raptor::Debug::LogError("[Vulkan] Error: Trying to free invalid ShaderState %u\n", handle);
 }
 
 //------------------------------------------------------------------------------
@@ -2036,6 +2159,7 @@ void* GPUDevice::MapBuffer(const MapBufferParams& params)
     if (buffer->parent_buffer == dynamic_buffer)
     {
         buffer->global_offset = dynamic_allocated_size;
+        AccessBufferHot(params.buffer)->global_offset = dynamic_allocated_size;
         return DynamicAllocate((params.size == 0) ? buffer->size : params.size);
     }
 
@@ -2164,6 +2288,8 @@ CommandBuffer* GPUDevice::GetInstantCommandBuffer()
 //------------------------------------------------------------------------------
 void GPUDevice::NewFrame()
 {
+    PROFILE_ZONE("GPUDevice::NewFrame");
+
     VkFence* render_complete_fence = &vk_command_buffer_executed_fence[current_frame];
 
     if (vkGetFenceStatus(vk_device, *render_complete_fence) != VK_SUCCESS)
@@ -2171,6 +2297,65 @@ void GPUDevice::NewFrame()
         vkWaitForFences(vk_device, 1, render_complete_fence, VK_TRUE, UINT64_MAX);
     }
 
+    // Deletions queued while recording this frame index run once its fence
+    // signaled, so no frame in flight uses the resources anymore.
+    for (uint32 i = (uint32)resource_deletion_queue.size(); i-- > 0;)
+    {
+        ResourceUpdate& resource_deletion = resource_deletion_queue[i];
+        if (resource_deletion.current_frame != current_frame)
+            continue;
+
+        switch (resource_deletion.type)
+        {
+            case ResourceDeletionType::Buffer:
+            {
+                DestroyBufferInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::Pipeline:
+            {
+                DestroyPipelineInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::RenderPass:
+            {
+                DestroyRenderPassInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::DescriptorSet:
+            {
+                DestroyDescriptorSetInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::DescriptorSetLayout:
+            {
+                DestroyDescriptorSetLayoutInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::Sampler:
+            {
+                DestroySamplerInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::ShaderState:
+            {
+                DestroyShaderStateInstant(resource_deletion.handle);
+            } break;
+
+            case ResourceDeletionType::Texture:
+            {
+                DestroyTextureInstant(resource_deletion.handle);
+            } break;
+
+            default:
+                break;
+        }
+
+        // Entries after i were already visited, order does not matter.
+        resource_deletion_queue[i] = resource_deletion_queue.back();
+        resource_deletion_queue.pop_back();
+    }
+
     vkResetFences(vk_device, 1, render_complete_fence);
 
     VkResult result = vkAcquireNextImageKHR(vk_device, vk_swapchain, UINT64_MAX, vk_image_acquired_semaphore, VK_NULL_HANDLE, &image_index );
@@ -2178,24 +2363,23 @@ void GPUDevice::NewFrame()
         ResizeSwapchain();
     
     command_buffer_ring->ResetPools(current_frame);
+    frame_allocator.SwapBuffers();
+
     const uint32 used_size = dynamic_allocated_size - (dynamic_per_frame_size * previous_frame);
     dynamic_max_per_frame_size = MAX(used_size, dynamic_max_per_frame_size);
     dynamic_allocated_size = dynamic_per_frame_size * current_frame;
 
-    if (descriptor_set_updates.size())
-    {
-        for (auto it = descriptor_set_updates.end(); it != descriptor_set_updates.begin(); it--)
-        {
-            UpdateDescriptorSetInstant(it);
-            it->frame_issued = UINT32_MAX;
-            descriptor_set_updates.erase(it);
-        }
-    }
+    // Sets are reallocated rather than written, the old ones may still be in use by frames in flight.
+    for (DescriptorSetUpdate& update : descriptor_set_updates)
+        UpdateDescriptorSetInstant(&update);
+    descriptor_set_updates.clear();
 
 }
 
 void GPUDevice::Present()
 {
+    PROFILE_ZONE("GPUDevice::Present");
+
     VkFence* render_complete_fence = &vk_command_buffer_executed_fence[current_frame];
     VkSemaphore* render_complete_semaphore = &vk_render_complete_semaphore[current_frame];
 
@@ -2254,63 +2438,6 @@ void GPUDevice::Present()
     }
 
     FrameCountersAdvance();
-
-    if (resource_deletion_queue.size() > 0)
-    {
-        for (uint32 i = resource_deletion_queue.size() - 1; i >= 0; i--)
-        {
-            ResourceUpdate& resource_deletion = resource_deletion_queue[i];
-
-            if (resource_deletion.current_frame == current_frame)
-            {
-                switch (resource_deletion.type)
-                {
-                    case ResourceDeletionType::Buffer:
-                    {
-                        DestroyBufferInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::Pipeline:
-                    {
-                        DestroyPipelineInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::RenderPass:
-                    {
-                        DestroyRenderPassInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::DescriptorSet:
-                    {
-                        DestroyDescriptorSetInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::DescriptorSetLayout:
-                    {
-                        DestroyDescriptorSetLayoutInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::Sampler:
-                    {
-                        DestroySamplerInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::ShaderState:
-                    {
-                        DestroyShaderStateInstant(resource_deletion.handle);
-                    } break;
-
-                    case ResourceDeletionType::Texture:
-                    {
-                        DestroyTextureInstant(resource_deletion.handle);
-                    } break;
-                }
-
-                resource_deletion.current_frame = UINT32_MAX;
-                resource_deletion_queue.pop_back();
-            }
-        }
-    }
 }
 
 void GPUDevice::Resize(uint16 width, uint16 height)
@@ -2351,7 +2478,18 @@ void GPUDevice::PopGPUTimestamp(CommandBuffer* command_buffer)
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyBufferInstant(ResourceHandle buffer){}
 //------------------------------------------------------------------------------
-void GPUDevice::DestroyTextureInstant(ResourceHandle texture){}
+void GPUDevice::DestroyTextureInstant(ResourceHandle texture)
+{
+    Texture* vk_texture = AccessTexture(texture);
+    if (vk_texture->vk_image_view != VK_NULL_HANDLE)
+        vkDestroyImageView(vk_device, vk_texture->vk_image_view, vk_allocation_callbacks);
+    if (vk_texture->vk_image != VK_NULL_HANDLE)
+        vmaDestroyImage(vma_allocator, vk_texture->vk_image, vk_texture->vma_allocation);
+
+    vk_texture->vk_image_view = VK_NULL_HANDLE;
+    vk_texture->vk_image = VK_NULL_HANDLE;
+    textures.releaseResource(texture);
+}
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyPipelineInstant(ResourceHandle pipeline){}
 //------------------------------------------------------------------------------
@@ -2359,7 +2497,20 @@ void GPUDevice::DestroySamplerInstant(ResourceHandle sampler){}
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyDescriptorSetLayoutInstant(ResourceHandle layout){}
 //------------------------------------------------------------------------------
-void GPUDevice::DestroyDescriptorSetInstant(ResourceHandle set){}
+void GPUDevice::DestroyDescriptorSetInstant(ResourceHandle set)
+{
+    DescriptorSet* descriptor_set = AccessDescriptorSet(set);
+    vkFreeDescriptorSets(vk_device, vk_descriptor_pool, 1, &descriptor_set->vk_descriptor_set);
+
+    if (descriptor_set->resources)
+        allocator->deallocate(descriptor_set->resources, (sizeof(ResourceHandle) + sizeof(SamplerHandle) + sizeof(uint16)) * descriptor_set->num_resources);
+
+    // Free slots have no layout, ReplaceTexture() skips them.
+    descriptor_set->resources = nullptr;
+    descriptor_set->layout = nullptr;
+    descriptor_set->num_resources = 0;
+    descriptor_sets.releaseResource(set);
+}
 //------------------------------------------------------------------------------
 void GPUDevice::DestroyRenderPassInstant(ResourceHandle render_pass){}
 //------------------------------------------------------------------------------
@@ -2379,6 +2530,7 @@ void GPUDevice::UpdateDescriptorSetInstant(DescriptorSetUpdate* update)
     dummy_delete_descriptor_set->resources = nullptr;
     dummy_delete_descriptor_set->samplers = nullptr;
     dummy_delete_descriptor_set->num_resources = 0;
+    dummy_delete_descriptor_set->layout = nullptr;
 
     DestroyDescriptorSet(dummy_delete_descriptor_set_handle);
 
@@ -2419,7 +2571,7 @@ static void TransitionImageLayout(VkCommandBuffer command_buffer, VkImage vk_ima
     barrier.image = vk_image;
     barrier.subresourceRange.aspectMask = (isDepth) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
 
@@ -2458,36 +2610,58 @@ void GPUDevice::GetVulkanBinariesPath(char* path, sizet size)
 
 VkShaderModuleCreateInfo GPUDevice::CompileShader(const char* code, uint32 code_size, VkShaderStageFlagBits stage, const char* name)
 {
-    VkShaderModuleCreateInfo shader_create_info {};
-    shader_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    ShaderCompilation compilation;
+    StartShaderCompilation(code, code_size, stage, name, compilation);
 
-    const char* temp_filename = "temp.shader";
+    if (compilation.process)
+        Raptor::Core::ProcessWait(compilation.process);
 
-    FILE* temp_shader_file = fopen(temp_filename, "w");
+    return FinishShaderCompilation(compilation, code, stage, name);
+}
+
+void GPUDevice::StartShaderCompilation(const char* code, uint32 code_size, VkShaderStageFlagBits stage, const char* name, ShaderCompilation& compilation)
+{
+    // Unique file names, several compilations can be in flight.
+    const uint32 index = shader_compilation_index++;
+    snprintf(compilation.source_filename, sizeof(compilation.source_filename), "temp_%u.shader", index);
+    snprintf(compilation.spirv_filename, sizeof(compilation.spirv_filename), "shader_final_%u.spv", index);
+
+    FILE* temp_shader_file = fopen(compilation.source_filename, "w");
     fwrite(code, code_size, 1, temp_shader_file);
     fclose(temp_shader_file);
 
+    ContainerAllocator string_allocator(temporary_allocator);
 
-    eastl::string stage_define;//(allocator);
+    String stage_define(string_allocator);
     stage_define.append_sprintf("%s_%s", ToStageDefines(stage), name);
     stage_define.make_upper();
 
-    eastl::string glsl_compiler_path;//(allocator);
-    eastl::string final_spirv_filename = "shader_final.spv";
-
+    String glsl_compiler_path(string_allocator);
 #if defined(_MSC_VER)
     glsl_compiler_path.append_sprintf("%sglslangValidator.exe", vulkan_binaries_path);
-
-    eastl::string arguments;
-    arguments.append_sprintf("glslangValidator.exe %s -V --target-env vulkan1.2 -o %s -S %s --D %s --D %s", temp_filename, final_spirv_filename, ToCompilerExtension(stage), stage_define, ToStageDefines(stage));
 #else
     glsl_compiler_path.append_sprintf("%sglslangValidator", vulkan_binaries_path);
-
-    eastl::string arguments;
-    arguments.append_sprintf("%s -V --target-env vulkan1.2 -o %s -S %s --D %s --D %s", temp_filename, final_spirv_filename, ToCompilerExtension(stage), stage_define, ToStageDefines(stage));
 #endif
 
-    Raptor::Core::ProcessExecute(".", glsl_compiler_path.c_str(), arguments.c_str());
+    String arguments(string_allocator);
+    arguments.append_sprintf("%s -V --target-env vulkan1.2 -o %s -S %s --D %s --D %s", compilation.source_filename, compilation.spirv_filename, ToCompilerExtension(stage), stage_define.c_str(), ToStageDefines(stage));
+
+    compilation.process = Raptor::Core::ProcessStart(".", glsl_compiler_path.c_str(), arguments.c_str(), &temporary_allocator);
+}
+
+VkShaderModuleCreateInfo GPUDevice::FinishShaderCompilation(ShaderCompilation& compilation, const char* code, VkShaderStageFlagBits stage, const char* name)
+{
+    VkShaderModuleCreateInfo shader_create_info {};
+    shader_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+
+    if (compilation.process)
+    {
+        if (!Raptor::Core::ProcessSucceeded(compilation.process))
+            Raptor::Debug::LogError("%s\n", Raptor::Core::ProcessGetOutput(compilation.process));
+
+        Raptor::Core::ProcessDestroy(compilation.process);
+        compilation.process = nullptr;
+    }
 
     bool optimize_shaders = false;
     if (optimize_shaders)
@@ -2496,7 +2670,7 @@ VkShaderModuleCreateInfo GPUDevice::CompileShader(const char* code, uint32 code_
     }
     else
     {
-        shader_create_info.pCode = reinterpret_cast<const uint32*>(Raptor::Core::FileReadBinary(final_spirv_filename.c_str(), allocator, &shader_create_info.codeSize));
+        shader_create_info.pCode = reinterpret_cast<const uint32*>(Raptor::Core::FileReadBinary(compilation.spirv_filename, &temporary_allocator, &shader_create_info.codeSize));
     }
 
     if (shader_create_info.pCode == nullptr)
@@ -2504,8 +2678,8 @@ VkShaderModuleCreateInfo GPUDevice::CompileShader(const char* code, uint32 code_
         DumpShaderCode(code, stage, name);
     }
 
-    Raptor::Core::FileDelete(temp_filename);
-    Raptor::Core::FileDelete(final_spirv_filename.c_str());
+    Raptor::Core::FileDelete(compilation.source_filename);
+    Raptor::Core::FileDelete(compilation.spirv_filename);
 
     return shader_create_info;
 }
@@ -2517,7 +2691,7 @@ bool IsEndOfLine(char c)
 
 void DumpShaderCode(const char* code, VkShaderStageFlagBits stage, const char* name)
 {
-    Raptor::Debug::Log("Error creating shader %s, stage %s. Writing Shader:\n", name, ToStageDefines(stage));
+    Raptor::Debug::LogError("Error creating shader %s, stage %s. Writing Shader:\n", name, ToStageDefines(stage));
 
     const char* current_code = code;
     uint32 line_index = 1;
@@ -2538,7 +2712,7 @@ void DumpShaderCode(const char* code, VkShaderStageFlagBits stage, const char* n
         line.clear();
         line.append(current_code);
         line = line.substr(0, eol - current_code);        
-        Raptor::Debug::Log("%u: %s", line_index++, line.c_str());
+        Raptor::Debug::LogError("%u: %s", line_index++, line.c_str());
 
         current_code = eol;
     }
@@ -2594,6 +2768,12 @@ const Texture* GPUDevice::AccessTexture(TextureHandle handle) const
     return (const Texture*)textures.accessResource(handle);
 }
 
+//------------------------------------------------------------------------------
+TextureHot* GPUDevice::AccessTextureHot(TextureHandle handle)
+{
+    return (TextureHot*)textures.accessHot(handle);
+}
+
 //------------------------------------------------------------------------------
 Buffer* GPUDevice::AccessBuffer(BufferHandle handle)
 {
@@ -2606,6 +2786,12 @@ const Buffer* GPUDevice::AccessBuffer(BufferHandle handle) const
     return (const Buffer*)buffers.accessResource(handle);
 }
 
+//------------------------------------------------------------------------------
+BufferHot* GPUDevice::AccessBufferHot(BufferHandle handle)
+{
+    return (BufferHot*)buffers.accessHot(handle);
+}
+
 //------------------------------------------------------------------------------
 Pipeline* GPUDevice::AccessPipeline(PipelineHandle handle)
 {
@@ -2618,6 +2804,12 @@ const Pipeline* GPUDevice::AccessPipeline(PipelineHandle handle) const
     return (const Pipeline*)pipelines.accessResource(handle);
 }
 
+//------------------------------------------------------------------------------
+PipelineHot* GPUDevice::AccessPipelineHot(PipelineHandle handle)
+{
+    return (PipelineHot*)pipelines.accessHot(handle);
+}
+
 //------------------------------------------------------------------------------
 Sampler* GPUDevice::AccessSampler(SamplerHandle handle)
 {
@@ -8,16 +8,18 @@
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 
-#include <EASTL/allocator.h>
 #include <EASTL/vector.h>
 
+#include "Allocator.h"
 #include "Buffer.h"
 #include "Debug.h"
 #include "DescriptorSet.h"
 #include "DescriptorSetLayout.h"
 #include "GPUTimestampManager.h"
+#include "HashMap.h"
 #include "Log.h"
 #include "Pipeline.h"
+#include "Process.h"
 #include "RenderPass.h"
 #include "ResourcePool.h"
 #include "Resources.h"
@@ -34,7 +36,11 @@ namespace Raptor
 namespace Graphics
 {
 
-using Allocator = eastl::allocator;
+using Raptor::Core::Allocator;
+using Raptor::Core::ContainerAllocator;
+using Raptor::Core::StackAllocator;
+using Raptor::Core::DoubleBufferedAllocator;
+using Raptor::Core::HashMap;
 template <typename T, typename Allocator> using Vector = eastl::vector<T, Allocator>;
 using Raptor::Application::Window;
 
@@ -79,6 +85,16 @@ public:
     void DestroyRenderPass(RenderPassHandle handle);
     void DestroyShaderState(ShaderStateHandle handle);
 
+    // Swaps in the image of new_texture without waiting for the GPU, the handle
+    // stays valid and descriptor sets using it are rebuilt on the next frame.
+    // new_texture must not be used afterwards.
+    void ReplaceTexture(TextureHandle handle, TextureHandle new_texture);
+
+    // Pools grow a page at a time when full. Reserving from the scene counts
+    // before loading grows them once instead.
+    void ReserveResources(uint32 buffer_count, uint32 texture_count, uint32 sampler_count, uint32 descriptor_set_count);
+    void LogPoolStatistics() const;
+
     // Query Description
     void QueryBuffer(BufferHandle handle, BufferDescription& out_description);
     void QueryTexture(TextureHandle handle, TextureDescription& out_description);
@@ -142,6 +158,11 @@ public:
     Window* window;
     Allocator* allocator;
 
+    // Scratch memory for work that does not outlive the current call (rewound with a marker).
+    StackAllocator temporary_allocator;
+    // Per-frame scratch memory, valid until the end of the following frame.
+    DoubleBufferedAllocator frame_allocator;
+
 private:
 
     // Vulkan Instance
@@ -169,6 +190,9 @@ private:
     void CreatePools(uint32 gpu_time_queries_per_frame);
     void DestroyPools();
 
+    void CreateAllocators();
+    void DestroyAllocators();
+
     void CreateSemaphores();
     void DestroySemaphores();
 
@@ -184,6 +208,17 @@ private:
     void GetVulkanBinariesPath(char* path, sizet size = 512);
     VkShaderModuleCreateInfo CompileShader(const char* code, uint32 code_size, VkShaderStageFlagBits stage, const char* name);
 
+    // Compilation split in two so the compiler processes of all stages run at once.
+    struct ShaderCompilation
+    {
+        Raptor::Core::Process* process;
+        char source_filename[64];
+        char spirv_filename[64];
+    }; // struct ShaderCompilation
+
+    void StartShaderCompilation(const char* code, uint32 code_size, VkShaderStageFlagBits stage, const char* name, ShaderCompilation& compilation);
+    VkShaderModuleCreateInfo FinishShaderCompilation(ShaderCompilation& compilation, const char* code, VkShaderStageFlagBits stage, const char* name);
+
 public:
 
     VkInstance vk_instance;
@@ -234,8 +269,9 @@ public:
     uint32 previous_frame;
     uint32 absolute_frame;
 
-    Vector<ResourceUpdate, Allocator> resource_deletion_queue;
-    Vector<DescriptorSetUpdate, Allocator> descriptor_set_updates;
+    Vector<ResourceUpdate, ContainerAllocator> resource_deletion_queue;
+    Vector<DescriptorSetUpdate, ContainerAllocator> descriptor_set_updates;
+    HashMap<uint64, VkRenderPass> render_pass_cache;
     
     BufferHandle fullscreen_vertex_buffer;
     RenderPassHandle swapchain_pass;
@@ -255,6 +291,7 @@ public:
     RenderPassOutput swapchain_output;
 
     char vulkan_binaries_path[512];
+    uint32 shader_compilation_index = 0;
     
     enum Flags : uint32
     {
@@ -271,12 +308,15 @@ public:
 
     Texture* AccessTexture(TextureHandle handle);
     const Texture* AccessTexture(TextureHandle handle) const;
+    TextureHot* AccessTextureHot(TextureHandle handle);
 
     Buffer* AccessBuffer(BufferHandle handle);
     const Buffer* AccessBuffer(BufferHandle handle) const;
+    BufferHot* AccessBufferHot(BufferHandle handle);
 
     Pipeline* AccessPipeline(PipelineHandle handle);
     const Pipeline* AccessPipeline(PipelineHandle handle) const;
+    PipelineHot* AccessPipelineHot(PipelineHandle handle);
 
     Sampler* AccessSampler(SamplerHandle handle);
     const Sampler* AccessSampler(SamplerHandle handle) const;
@@ -11,7 +11,7 @@ namespace Graphics
 //template<typename Key, typename T>
 //using HashMap = eastl::hash_map<Key, T>;
 
-using Allocator = eastl::allocator;
+using Raptor::Core::Allocator;
 using Raptor::Core::HashString;
 
 eastl::hash_map<uint64,uint32> name_color;
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <EASTL/allocator.h>
+#include "Allocator.h"
 #include "Types.h"
 #include "GPUDevice.h"
 #include "GPUTimestampManager.h"
@@ -19,7 +19,7 @@ enum GPUProfilerFlags : uint32
 class GPUProfiler
 {
 
-    using Allocator = eastl::allocator;
+    using Allocator = Raptor::Core::Allocator;
 
     // TODO
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <EASTL/allocator.h>
+#include "Allocator.h"
 #include "Types.h"
 
 namespace Raptor
@@ -22,7 +22,7 @@ struct GPUTimestamp
 class GPUTimestampManager
 {
 
-    using Allocator = eastl::allocator;
+    using Allocator = Raptor::Core::Allocator;
 
 public:
     GPUTimestampManager(Allocator* allocator, uint16 queriesPerFrame, uint16 maxFrames);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 #include <vulkan/vulkan.h>
 #include "Resources.h"
 #include "Types.h"
@@ -39,91 +41,38 @@ struct MaterialData
     uint32 flags;
 }; // struct MaterialData
 
+// Copied straight into the mapped material buffer, the layout has to match the std140 block of the shaders.
+static_assert(std::is_trivially_copyable_v<MaterialData>, "MaterialData is copied with memcpy.");
+static_assert(offsetof(MaterialData, model) == 16 && offsetof(MaterialData, model_inv) == 80 && offsetof(MaterialData, emissive_factor) == 144,
+              "MaterialData has to follow the std140 layout.");
+static_assert(sizeof(MaterialData) == 176 && alignof(MaterialData) == 16, "MaterialData has to follow the std140 layout.");
+
 struct MeshDraw
 {
-    MeshDraw()
-    {
-        index_buffer = position_buffer = tangent_buffer = normal_buffer = texcoord_buffer = InvalidBuffer;
-        material_buffer = InvalidBuffer;
-        material_data = MaterialData();
-        index_offset = position_offset = tangent_offset = normal_offset = texcoord_offset = 0;
-        count = 0;
-        vk_index_type = VK_INDEX_TYPE_MAX_ENUM;
-        descriptor_set = InvalidDescriptorSet;
-    }
-
-    ~MeshDraw(){}
-    
-    MeshDraw(MeshDraw& other)
-    {
-        index_buffer = other.index_buffer;
-        position_buffer = other.position_buffer;
-        tangent_buffer = other.tangent_buffer;
-        normal_buffer = other.normal_buffer;
-        texcoord_buffer = other.texcoord_buffer;
-
-        material_buffer = other.material_buffer;
-        material_data = other.material_data;
-
-        index_offset = other.index_offset;
-        position_offset = other.position_offset;
-        tangent_offset = other.tangent_offset;
-        normal_offset = other.normal_offset;
-        texcoord_offset = other.texcoord_offset;
-
-        count = other.count;
-
-        vk_index_type = other.vk_index_type;
-
-        descriptor_set = other.descriptor_set;
-    }
+    BufferHandle index_buffer = InvalidBuffer;
+    BufferHandle position_buffer = InvalidBuffer;
+    BufferHandle tangent_buffer = InvalidBuffer;
+    BufferHandle normal_buffer = InvalidBuffer;
+    BufferHandle texcoord_buffer = InvalidBuffer;
 
-    MeshDraw(const MeshDraw& other)
-    {
-        index_buffer = other.index_buffer;
-        position_buffer = other.position_buffer;
-        tangent_buffer = other.tangent_buffer;
-        normal_buffer = other.normal_buffer;
-        texcoord_buffer = other.texcoord_buffer;
+    BufferHandle material_buffer = InvalidBuffer;
+    MaterialData material_data {};
 
-        material_buffer = other.material_buffer;
-        material_data = other.material_data;
+    uint32 index_offset = 0;
+    uint32 position_offset = 0;
+    uint32 tangent_offset = 0;
+    uint32 normal_offset = 0;
+    uint32 texcoord_offset = 0;
 
-        index_offset = other.index_offset;
-        position_offset = other.position_offset;
-        tangent_offset = other.tangent_offset;
-        normal_offset = other.normal_offset;
-        texcoord_offset = other.texcoord_offset;
+    uint32 count = 0;
 
-        count = other.count;
+    VkIndexType vk_index_type = VK_INDEX_TYPE_MAX_ENUM;
 
-        vk_index_type = other.vk_index_type;
+    DescriptorSetHandle descriptor_set = InvalidDescriptorSet;
 
-        descriptor_set = other.descriptor_set;
-    }
-
-    BufferHandle index_buffer;
-    BufferHandle position_buffer;
-    BufferHandle tangent_buffer;
-    BufferHandle normal_buffer;
-    BufferHandle texcoord_buffer;
-
-    BufferHandle material_buffer;
-    MaterialData material_data;
-
-    uint32 index_offset;
-    uint32 position_offset;
-    uint32 tangent_offset;
-    uint32 normal_offset;
-    uint32 texcoord_offset;
-
-    uint32 count;
-
-    VkIndexType vk_index_type;
-
-    DescriptorSetHandle descriptor_set;
+}; // struct MeshDraw
 
+static_assert(std::is_trivially_copyable_v<MeshDraw>, "MeshDraw is relocated with memmove when the draw array grows.");
 
-}; // struct MeshDraw
 } // namespace Graphics
 } // namespace Raptor
\ No newline at end of file
@@ -33,6 +33,15 @@ struct Pipeline
 
 }; // struct Pipeline
 
+// What binding a pipeline and its descriptor sets reads, kept in the hot
+// array of the pipeline pool.
+struct PipelineHot
+{
+    VkPipeline vk_pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout vk_pipeline_layout = VK_NULL_HANDLE;
+    VkPipelineBindPoint vk_pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+}; // struct PipelineHot
+
 enum class FillMode
 {
     Wireframe, Solid, Point, Max
@@ -1,7 +1,10 @@
 #include <stb_image.h>
 
 #include "Renderer.h"
+#include "AsyncIO.h"
+#include "Fiber.h"
 #include "Hash.h"
+#include "JobSystem.h"
 #include "Log.h"
 
 namespace Raptor
@@ -10,13 +13,24 @@ namespace Graphics
 {
 
 using Raptor::Core::Allocator;
+using Raptor::Core::AsyncIOService;
+using Raptor::Core::AsyncReadHandle;
+using Raptor::Core::FiberSystem;
+using Raptor::Core::FileReadResult;
+using Raptor::Core::JobAffinity;
+using Raptor::Core::JobDeclaration;
+using Raptor::Core::JobSystem;
 using Raptor::Core::Resource;
 using Raptor::Core::HashString;
+using Raptor::Core::NameId;
+using Raptor::Core::NameTable;
 using Raptor::Core::Pair;
 
-uint64 TextureResource::type_hash = 0;
-uint64 BufferResource::type_hash = 0;
-uint64 SamplerResource::type_hash = 0;
+static bool ParseCookedTexture(const void* file_data, sizet file_size, CreateTextureParams& params);
+static void TextureReadCallback(AsyncReadHandle handle, const FileReadResult& result, void* user_data);
+static void LoadTextureTask(void* data);
+static void DecodeTextureJob(void* data);
+static void UploadTextureJob(void* data);
 
 static BufferLoader s_buffer_loader;
 static SamplerLoader s_sampler_loader;
@@ -28,16 +42,12 @@ Renderer::Renderer(GPUDevice* gpu_device, ResourceManager* resource_manager, All
     width = gpu_device->swapchain_width;
     height = gpu_device->swapchain_height;
 
-    textures.init(&allocator, 512);
-    buffers.init(&allocator, 4096);
-    samplers.init(&allocator, 128);
+    textures.init(&allocator, 256);
+    buffers.init(&allocator, 1024);
+    samplers.init(&allocator, 32);
 
     resource_cache.init(allocator);
 
-    TextureResource::type_hash = Raptor::Core::HashString(TextureResource::type);
-    BufferResource::type_hash = Raptor::Core::HashString(BufferResource::type);
-    SamplerResource::type_hash = Raptor::Core::HashString(SamplerResource::type);
-
     s_texture_loader.renderer = this;
     s_buffer_loader.renderer = this;
     s_sampler_loader.renderer = this;
@@ -55,6 +65,15 @@ void Renderer::Init()
 
 }
 
+void Renderer::ReserveResources(uint32 buffer_count, uint32 texture_count, uint32 sampler_count, uint32 descriptor_set_count)
+{
+    buffers.reserve(buffers.usedIndices + buffer_count);
+    textures.reserve(textures.usedIndices + texture_count);
+    samplers.reserve(samplers.usedIndices + sampler_count);
+
+    gpu_device->ReserveResources(buffer_count, texture_count, sampler_count, descriptor_set_count);
+}
+
 void Renderer::Shutdown()
 {
     resource_cache.shutdown(this);
@@ -68,9 +87,9 @@ void Renderer::Shutdown()
 
 void Renderer::SetLoaders(ResourceManager* manager)
 {
-    manager->SetLoader(TextureResource::type, &s_texture_loader);
-    manager->SetLoader(BufferResource::type, &s_buffer_loader);
-    manager->SetLoader(SamplerResource::type, &s_sampler_loader);
+    manager->SetLoader(TextureResource::type_hash, &s_texture_loader);
+    manager->SetLoader(BufferResource::type_hash, &s_buffer_loader);
+    manager->SetLoader(SamplerResource::type_hash, &s_sampler_loader);
 }
 
 void Renderer::BeginFrame()
@@ -102,15 +121,20 @@ BufferResource* Renderer::CreateBuffer(const CreateBufferParams& params)
 
     if (buffer)
     {
-        BufferHandle handle = gpu_device->CreateBuffer(params);
+        NameTable* names = NameTable::instance();
+        buffer->name_id = names->Intern(params.name);
+        buffer->name = names->GetString(buffer->name_id);
+
+        CreateBufferParams interned_params = params;
+        interned_params.name = buffer->name;
+
+        BufferHandle handle = gpu_device->CreateBuffer(interned_params);
         buffer->handle = handle;
-        buffer->name = params.name;
         gpu_device->QueryBuffer(handle, buffer->desc);
 
-        if (params.name != nullptr)
+        if (buffer->name_id.IsValid())
         {
-            uint64 hash = HashString(params.name);
-            Pair<uint64, BufferResource*> pair {hash, buffer};
+            Pair<uint64, BufferResource*> pair {names->GetHash(buffer->name_id), buffer};
             resource_cache.buffers.insert(pair);
         }
         
@@ -134,15 +158,20 @@ TextureResource* Renderer::CreateTexture(const CreateTextureParams& params)
 
     if (texture)
     {
-        TextureHandle handle = gpu_device->CreateTexture(params);
+        NameTable* names = NameTable::instance();
+        texture->name_id = names->Intern(params.name);
+        texture->name = names->GetString(texture->name_id);
+
+        CreateTextureParams interned_params = params;
+        interned_params.name = texture->name;
+
+        TextureHandle handle = gpu_device->CreateTexture(interned_params);
         texture->handle = handle;
-        texture->name = params.name;
         gpu_device->QueryTexture(handle, texture->desc);
 
-        if (params.name != nullptr)
+        if (texture->name_id.IsValid())
         {
-            uint64 hash = HashString(params.name);
-            Pair<uint64, TextureResource*> pair = {hash, texture};
+            Pair<uint64, TextureResource*> pair = {names->GetHash(texture->name_id), texture};
             resource_cache.textures.insert(pair);
         }
 
@@ -160,15 +189,20 @@ TextureResource* Renderer::CreateTexture(const char* name, const char* filename)
 
     if (texture)
     {
-        TextureHandle handle = CreateTextureFromFile(*gpu_device, filename, name);
+        NameTable* names = NameTable::instance();
+        texture->name_id = names->Intern(name);
+        texture->name = names->GetString(texture->name_id);
+
+        TextureHandle handle = CreateTextureFromFile(*gpu_device, filename, texture->name);
         texture->handle = handle; 
         gpu_device->QueryTexture(handle, texture->desc);
         texture->references = 1;
-        texture->name = name;
 
-        uint64 hash = HashString(name);
-        Pair<uint64, TextureResource*> pair = {hash, texture};
-        resource_cache.textures.insert(pair);
+        if (texture->name_id.IsValid())
+        {
+            Pair<uint64, TextureResource*> pair = {names->GetHash(texture->name_id), texture};
+            resource_cache.textures.insert(pair);
+        }
 
         return texture;
     }
@@ -176,21 +210,226 @@ TextureResource* Renderer::CreateTexture(const char* name, const char* filename)
     return nullptr;
 }
 
+TextureResource* Renderer::CreateTexture(const char* name, const void* file_data, sizet file_size)
+{
+    TextureResource* texture = textures.obtain();
+
+    if (texture)
+    {
+        NameTable* names = NameTable::instance();
+        texture->name_id = names->Intern(name);
+        texture->name = names->GetString(texture->name_id);
+
+        TextureHandle handle = CreateTextureFromMemory(*gpu_device, file_data, file_size, texture->name);
+        texture->handle = handle;
+        gpu_device->QueryTexture(handle, texture->desc);
+        texture->references = 1;
+
+        if (texture->name_id.IsValid())
+        {
+            Pair<uint64, TextureResource*> pair = {names->GetHash(texture->name_id), texture};
+            resource_cache.textures.insert(pair);
+        }
+
+        return texture;
+    }
+
+    return nullptr;
+}
+
+// Async texture loads ----------------------------
+struct TextureLoad
+{
+    Renderer* renderer;
+    ResourceManager* resource_manager;
+    TextureResource* texture;
+    FileReadResult file;
+    // Points into the file for cooked textures, otherwise decoded by stb_image.
+    CreateTextureParams params;
+    bool cooked;
+    // Reaches zero when the read completes.
+    Raptor::Core::JobCounter read_counter;
+}; // struct TextureLoad
+
+// The load holds a reference until the upload, a texture destroyed meanwhile is released then.
+static bool StartTextureLoad(Renderer* renderer, TextureResource* texture, const char* filename, ResourceManager* resource_manager)
+{
+    void* memory = renderer->allocator->allocate(sizeof(TextureLoad), alignof(TextureLoad), 0, 0);
+    TextureLoad* load = new (memory) TextureLoad {renderer, resource_manager, texture, {}, {}, false};
+
+    JobSystem* job_system = JobSystem::instance();
+    job_system->Increment(&load->read_counter);
+
+    const AsyncReadHandle read = AsyncIOService::instance()->Read(filename, renderer->allocator, TextureReadCallback, load);
+    if (read == Raptor::Core::InvalidAsyncRead)
+    {
+        Raptor::Debug::LogError("[Vulkan] Error: Could not load texture %s\n", filename);
+        load->~TextureLoad();
+        renderer->allocator->deallocate(load, sizeof(TextureLoad));
+        return false;
+    }
+
+    // The task waits for the read on a fiber, so a cold start with hundreds of
+    // textures does not hold a thread per pending file. Without a free fiber
+    // the decode follows the read as a continuation instead: a plain job would
+    // block its thread, and on the main thread no read could complete.
+    JobDeclaration task;
+    task.function = LoadTextureTask;
+    task.data = load;
+    if (!FiberSystem::instance()->TryRun(task))
+    {
+        JobDeclaration decode;
+        decode.function = DecodeTextureJob;
+        decode.data = load;
+        job_system->RunAfter(&load->read_counter, decode);
+    }
+
+    texture->state = Raptor::Core::ResourceState::Pending;
+    texture->AddReference();
+    return true;
+}
+
+TextureResource* Renderer::CreateTextureAsync(const char* name, const char* filename, ResourceManager* resource_manager)
+{
+    TextureResource* texture = textures.obtain();
+
+    if (texture)
+    {
+        NameTable* names = NameTable::instance();
+        texture->name_id = names->Intern(name);
+        texture->name = names->GetString(texture->name_id);
+
+        texture->handle = gpu_device->dummy_texture;
+        gpu_device->QueryTexture(texture->handle, texture->desc);
+        texture->references = 1;
+
+        if (texture->name_id.IsValid())
+        {
+            Pair<uint64, TextureResource*> pair = {names->GetHash(texture->name_id), texture};
+            resource_cache.textures.insert(pair);
+        }
+
+        if (!StartTextureLoad(this, texture, filename, resource_manager))
+            texture->state = Raptor::Core::ResourceState::Failed;
+
+        return texture;
+    }
+
+    return nullptr;
+}
+
+bool Renderer::ReloadTextureAsync(TextureResource* texture, const char* filename, ResourceManager* resource_manager)
+{
+    return StartTextureLoad(this, texture, filename, resource_manager);
+}
+
+// Runs on the main thread inside AsyncIOService::Update().
+static void TextureReadCallback(AsyncReadHandle handle, const FileReadResult& result, void* user_data)
+{
+    TextureLoad* load = (TextureLoad*)user_data;
+    load->file = result;
+
+    JobSystem::instance()->Decrement(&load->read_counter);
+}
+
+static void LoadTextureTask(void* data)
+{
+    TextureLoad* load = (TextureLoad*)data;
+
+    FiberSystem::instance()->Wait(&load->read_counter);
+    DecodeTextureJob(load);
+}
+
+// A failed read goes straight to the upload, which reports it.
+static void DecodeTextureJob(void* data)
+{
+    TextureLoad* load = (TextureLoad*)data;
+
+    if (load->file.data)
+    {
+        load->cooked = ParseCookedTexture(load->file.data, load->file.size, load->params);
+        if (!load->cooked)
+        {
+            int comp, width, height;
+            uint8* pixels = stbi_load_from_memory((const stbi_uc*)load->file.data, (int)load->file.size, &width, &height, &comp, 4);
+            if (pixels)
+                load->params.SetData(pixels).SetFormatType(VK_FORMAT_R8G8B8A8_UNORM, TextureType::Enum::Texture2D).SetFlags(1, 0).SetSize((uint16)width, (uint16)height, 1);
+        }
+    }
+
+    JobDeclaration job;
+    job.function = UploadTextureJob;
+    job.data = load;
+    job.affinity = JobAffinity::MainThread;
+    JobSystem::instance()->Run(job);
+}
+
+static void UploadTextureJob(void* data)
+{
+    TextureLoad* load = (TextureLoad*)data;
+    Renderer* renderer = load->renderer;
+    TextureResource* texture = load->texture;
+
+    bool success = false;
+    if (load->params.data)
+    {
+        load->params.SetName(texture->name);
+        TextureHandle handle = renderer->gpu_device->CreateTexture(load->params);
+
+        if (!load->cooked)
+            stbi_image_free(load->params.data);
+
+        if (handle != InvalidTexture)
+        {
+            // A reload keeps the handle, descriptor sets using it pick up the new image on the next frame.
+            if (texture->handle == renderer->gpu_device->dummy_texture)
+                texture->handle = handle;
+            else
+                renderer->gpu_device->ReplaceTexture(texture->handle, handle);
+
+            renderer->gpu_device->QueryTexture(texture->handle, texture->desc);
+            success = true;
+        }
+    }
+    else
+    {
+        Raptor::Debug::LogError("[Vulkan] Error: Could not decode texture %s\n", texture->name);
+    }
+
+    // A failed reload keeps the previous image.
+    success |= texture->handle != renderer->gpu_device->dummy_texture;
+
+    if (load->file.data)
+        renderer->allocator->deallocate(load->file.data, load->file.size + 1);
+
+    ResourceManager* resource_manager = load->resource_manager;
+    load->~TextureLoad();
+    renderer->allocator->deallocate(load, sizeof(TextureLoad));
+
+    resource_manager->FinishLoad(texture, success);
+    renderer->DestroyTexture(texture);
+}
+
 SamplerResource* Renderer::CreateSampler(const CreateSamplerParams& params)
 {
     SamplerResource* sampler = samplers.obtain();
     
     if (sampler)
     {
-        SamplerHandle handle = gpu_device->CreateSampler(params);
+        NameTable* names = NameTable::instance();
+        sampler->name_id = names->Intern(params.name);
+        sampler->name = names->GetString(sampler->name_id);
+
+        CreateSamplerParams interned_params = params;
+        interned_params.name = sampler->name;
+
+        SamplerHandle handle = gpu_device->CreateSampler(interned_params);
         sampler->handle = handle;
-        sampler->name = params.name;
         gpu_device->QuerySampler(handle, sampler->desc);
 
-        if (params.name != nullptr)
+        if (sampler->name_id.IsValid())
         {
-            uint64 hash = HashString(params.name);
-            Pair<uint64, SamplerResource*> pair = {hash, sampler};
+            Pair<uint64, SamplerResource*> pair = {names->GetHash(sampler->name_id), sampler};
             resource_cache.samplers.insert(pair);
         }
 
@@ -211,9 +450,8 @@ void Renderer::DestroyBuffer(BufferResource* buffer)
     if (buffer->references)
         return;
     
-    uint64 hash = HashString(buffer->name);
-    auto it = resource_cache.buffers.find(hash);
-    resource_cache.buffers.erase(it);
+    if (buffer->name_id.IsValid())
+        resource_cache.buffers.erase(NameTable::instance()->GetHash(buffer->name_id));
 
     gpu_device->DestroyBuffer(buffer->handle);
     buffers.release(buffer);
@@ -228,11 +466,13 @@ void Renderer::DestroyTexture(TextureResource* texture)
     if (texture->references)
         return;
     
-    uint64 hash = HashString(texture->name);
-    auto it = resource_cache.textures.find(hash);
-    resource_cache.textures.erase(it);
+    if (texture->name_id.IsValid())
+        resource_cache.textures.erase(NameTable::instance()->GetHash(texture->name_id));
 
-    gpu_device->DestroyTexture(texture->handle);
+    // Textures that failed to load are still bound to the placeholder.
+    if (texture->handle != gpu_device->dummy_texture)
+        gpu_device->DestroyTexture(texture->handle);
+    texture->state = Raptor::Core::ResourceState::Loaded;
     textures.release(texture);
 }
 
@@ -245,11 +485,10 @@ void Renderer::DestroySampler(SamplerResource* sampler)
     if (sampler->references)
         return;
     
-    uint64 hash = HashString(sampler->name);
-    auto it = resource_cache.samplers.find(hash);
-    resource_cache.samplers.erase(it);
+    if (sampler->name_id.IsValid())
+        resource_cache.samplers.erase(NameTable::instance()->GetHash(sampler->name_id));
 
-    gpu_device->DestroyTexture(sampler->handle);
+    gpu_device->DestroySampler(sampler->handle);
     samplers.release(sampler);
 }
 
@@ -271,19 +510,18 @@ void Renderer::UnmapBuffer(BufferResource* buffer)
 // BufferLoader  ----------------------------
 Resource* BufferLoader::Get(const char* name)
 {
-    const uint64 hash = HashString(name);
-    return renderer->resource_cache.buffers.at(hash);
+    return Get(HashString(name));
 }
 
 Resource* BufferLoader::Get(uint64 hash)
 {
-    return renderer->resource_cache.buffers.at(hash);
+    auto it = renderer->resource_cache.buffers.find(hash);
+    return it != renderer->resource_cache.buffers.end() ? it->second : nullptr;
 }
 
 Resource* BufferLoader::Unload(const char* name)
 {
-    const uint64 hash = HashString(name);
-    BufferResource* buffer = renderer->resource_cache.buffers.at(hash);
+    BufferResource* buffer = (BufferResource*)Get(HashString(name));
     if (buffer)
         renderer->DestroyBuffer(buffer);
     
@@ -293,19 +531,18 @@ Resource* BufferLoader::Unload(const char* name)
 // TextureLoader ----------------------------
 Resource* TextureLoader::Get(const char* name)
 {
-    const uint64 hash = HashString(name);
-    return renderer->resource_cache.textures.at(hash);
+    return Get(HashString(name));
 }
 
 Resource* TextureLoader::Get(uint64 hash)
 {
-    return renderer->resource_cache.textures.at(hash);
+    auto it = renderer->resource_cache.textures.find(hash);
+    return it != renderer->resource_cache.textures.end() ? it->second : nullptr;
 }
 
 Resource* TextureLoader::Unload(const char* name)
 {
-    const uint64 hash = HashString(name);
-    TextureResource* texture = renderer->resource_cache.textures.at(hash);
+    TextureResource* texture = (TextureResource*)Get(HashString(name));
     if (texture)
         renderer->DestroyTexture(texture);
     
@@ -317,22 +554,31 @@ Resource* TextureLoader::CreateFromFile(const char* name, const char* filename,
     return renderer->CreateTexture(name, filename);
 }
 
+Resource* TextureLoader::CreateFromFileAsync(const char* name, const char* filename, ResourceManager* resource_manager)
+{
+    return renderer->CreateTextureAsync(name, filename, resource_manager);
+}
+
+bool TextureLoader::ReloadAsync(Resource* resource, const char* filename, ResourceManager* resource_manager)
+{
+    return renderer->ReloadTextureAsync((TextureResource*)resource, filename, resource_manager);
+}
+
 // SamplerLoader ----------------------------
 Resource* SamplerLoader::Get(const char* name)
 {
-    const uint64 hash = HashString(name);
-    return renderer->resource_cache.samplers.at(hash);
+    return Get(HashString(name));
 }
 
 Resource* SamplerLoader::Get(uint64 hash)
 {
-    return renderer->resource_cache.samplers.at(hash);
+    auto it = renderer->resource_cache.samplers.find(hash);
+    return it != renderer->resource_cache.samplers.end() ? it->second : nullptr;
 }
 
 Resource* SamplerLoader::Unload(const char* name)
 {
-    const uint64 hash = HashString(name);
-    SamplerResource* sampler = renderer->resource_cache.samplers.at(hash);
+    SamplerResource* sampler = (SamplerResource*)Get(HashString(name));
     if (sampler)
         renderer->DestroySampler(sampler);
     
@@ -352,15 +598,44 @@ static TextureHandle CreateTextureFromFile(GPUDevice& gpu_device, const char* fi
 {
     if (filename)
     {
+        sizet file_size = 0;
+        char* file_data = Raptor::Core::FileReadBinary(filename, gpu_device.allocator, &file_size);
+        if (!file_data)
+        {
+            Raptor::Debug::LogError("[Vulkan] Error: Could not load texture %s\n", filename);
+            return InvalidTexture;
+        }
+
+        TextureHandle new_texture = CreateTextureFromMemory(gpu_device, file_data, file_size, name);
+
+        gpu_device.allocator->deallocate(file_data, file_size + 1);
+
+        return new_texture;
+    }
+
+    return InvalidTexture;
+}
+
+// Decodes an image file that was already read into memory, e.g. by the async IO service.
+static TextureHandle CreateTextureFromMemory(GPUDevice& gpu_device, const void* file_data, sizet file_size, const char* name)
+{
+    if (file_data && file_size)
+    {
+        CreateTextureParams params;
+        if (ParseCookedTexture(file_data, file_size, params))
+        {
+            params.SetName(name);
+            return gpu_device.CreateTexture(params);
+        }
+
         int comp, width, height;
-        uint8* image_data = stbi_load(filename, &width, &height, &comp, 4);
+        uint8* image_data = stbi_load_from_memory((const stbi_uc*)file_data, (int)file_size, &width, &height, &comp, 4);
         if (!image_data)
         {
-            Raptor::Debug::Log("[Vulkan] Error: Could not load texture %s\n", filename);
+            Raptor::Debug::LogError("[Vulkan] Error: Could not decode texture %s\n", name);
             return InvalidTexture;
         }
 
-        CreateTextureParams params;
         params.SetData(image_data).SetFormatType(VK_FORMAT_R8G8B8A8_UNORM, TextureType::Enum::Texture2D).SetFlags(1, 0).SetSize((uint16)width, (uint16)height, 1).SetName(name);
 
         TextureHandle new_texture = gpu_device.CreateTexture(params);
@@ -368,11 +643,32 @@ static TextureHandle CreateTextureFromFile(GPUDevice& gpu_device, const char* fi
         free(image_data);
 
         return new_texture;
-
     }
 
     return InvalidTexture;
 }
 
+// Cooked textures need no decoding, the params point at the mip chain inside the file data.
+static bool ParseCookedTexture(const void* file_data, sizet file_size, CreateTextureParams& params)
+{
+    if (!file_data || file_size < sizeof(CookedTextureHeader))
+        return false;
+
+    CookedTextureHeader header;
+    memcpy(&header, file_data, sizeof(CookedTextureHeader));
+
+    if (header.magic != CookedTextureHeader::MAGIC || header.version != CookedTextureHeader::VERSION)
+        return false;
+
+    if (header.mipmaps == 0 || header.mipmaps > MAX_TEXTURE_MIPMAPS || header.data_size != TextureMipChainSize(header.width, header.height, header.mipmaps) || file_size - sizeof(CookedTextureHeader) < header.data_size)
+    {
+        Raptor::Debug::LogError("[Vulkan] Error: Cooked texture is corrupt.\n");
+        return false;
+    }
+
+    params.SetData((uint8*)file_data + sizeof(CookedTextureHeader)).SetFormatType(VK_FORMAT_R8G8B8A8_UNORM, TextureType::Enum::Texture2D).SetFlags(header.mipmaps, 0).SetSize(header.width, header.height, 1);
+    return true;
+}
+
 } // namespace Graphics
 } // namespace Raptor
\ No newline at end of file
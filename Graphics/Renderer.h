@@ -38,6 +38,9 @@ public:
 
     void SetLoaders(ResourceManager* manager);
 
+    // Sizes the renderer and device pools once from the scene, see GPUDevice::ReserveResources().
+    void ReserveResources(uint32 buffer_count, uint32 texture_count, uint32 sampler_count, uint32 descriptor_set_count);
+
     void BeginFrame();
     void EndFrame();
 
@@ -49,6 +52,12 @@ public:
 
     TextureResource* CreateTexture(const CreateTextureParams& params);
     TextureResource* CreateTexture(const char* name, const char* filename);
+    TextureResource* CreateTexture(const char* name, const void* file_data, sizet file_size);
+    // Returns a Pending texture bound to the device's dummy texture. The file is
+    // read and decoded in the background and uploaded from RunMainThreadJobs().
+    TextureResource* CreateTextureAsync(const char* name, const char* filename, ResourceManager* resource_manager);
+    // Same path for a texture that is in use, the new image is swapped in without waiting for the GPU.
+    bool ReloadTextureAsync(TextureResource* texture, const char* filename, ResourceManager* resource_manager);
 
     SamplerResource* CreateSampler(const CreateSamplerParams& params);
 
@@ -99,6 +108,8 @@ struct TextureLoader : public ResourceLoader
     Resource* Get(uint64 hash) override;
     Resource* Unload(const char* name) override;
     Resource* CreateFromFile(const char* name, const char* filename, ResourceManager* resource_manger) override;
+    Resource* CreateFromFileAsync(const char* name, const char* filename, ResourceManager* resource_manager) override;
+    bool ReloadAsync(Resource* resource, const char* filename, ResourceManager* resource_manager) override;
 
     Renderer* renderer;
 }; // struct TextureLoader
@@ -114,6 +125,7 @@ struct SamplerLoader : public ResourceLoader
 
 
 static TextureHandle CreateTextureFromFile(GPUDevice& gpu_device, const char* filename, const char* name);
+static TextureHandle CreateTextureFromMemory(GPUDevice& gpu_device, const void* file_data, sizet file_size, const char* name);
 
 } // namespace Graphics
 } // namespace Raptor
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "memory.h"
+#include <new>
 #include "ResourcePool.h"
 #include "Constants.h"
 #include "Debug.h"
+#include "Defines.h"
 #include "Log.h"
 
 namespace Raptor
@@ -9,90 +11,372 @@ namespace Raptor
 namespace Graphics
 {
 
-void ResourcePool::init(Allocator* allocator_, uint32 poolSize_, uint32 resourceSize_)
+static_assert(sizeof(std::atomic<uint16>) == sizeof(uint16), "Generations are packed like plain uint16.");
+
+sizet ResourcePool::pageMemorySize() const
+{
+    if (concurrent)
+        return nextFreeOffset + pageSize * sizeof(uint32);
+
+    return generationOffset + pageSize * sizeof(std::atomic<uint16>);
+}
+
+void ResourcePool::initPages(Allocator* allocator_, uint32 pageSize_, uint32 resourceSize_, uint32 hotSize_)
 {
     allocator = allocator_;
-    poolSize = poolSize_;
     resourceSize = resourceSize_;
+    hotSize = hotSize_;
+
+    pageShift = 0;
+    while ((1u << pageShift) < pageSize_)
+        ++pageShift;
+    pageSize = 1u << pageShift;
 
-    sizet size = poolSize * (resourceSize + sizeof(uint32));
-    memory = (uint8*)allocator->allocate(size, 1, 0, 0);
-    memset(memory, 0, size);
+    // Hot data starts on a cache line of its own, the free stack links
+    // follow the generations, aligned for the atomics.
+    hotOffset = (pageSize * resourceSize + 63) & ~63u;
+    generationOffset = hotOffset + pageSize * hotSize;
+    nextFreeOffset = (generationOffset + pageSize * sizeof(std::atomic<uint16>) + alignof(std::atomic<uint32>) - 1) & ~(uint32)(alignof(std::atomic<uint32>) - 1);
 
-    freeIndices = (uint32*)(memory + poolSize * resourceSize);
+    pages = nullptr;
+    freeIndices = nullptr;
+    pageCount = 0;
+    pageTableSize = 0;
+    poolSize.store(0, std::memory_order_relaxed);
     freeIndicesHead = 0;
+    usedIndices = 0;
+    highWaterMark = 0;
 
-    for (uint32 i = 0; i < poolSize; ++i)
-    {
-        freeIndices[i] = i;
-    }
+    freeHead.store(INVALID_INDEX, std::memory_order_relaxed);
+    concurrentUsed.store(0, std::memory_order_relaxed);
+    concurrentHighWaterMark.store(0, std::memory_order_relaxed);
+}
 
-    usedIndices = 0;
+void ResourcePool::init(Allocator* allocator_, uint32 pageSize_, uint32 resourceSize_, uint32 hotSize_)
+{
+    concurrent = false;
+    initPages(allocator_, pageSize_, resourceSize_, hotSize_);
+
+    addPage();
+}
+
+void ResourcePool::initConcurrent(Allocator* allocator_, uint32 pageSize_, uint32 resourceSize_, uint32 maxResources, uint32 hotSize_)
+{
+    concurrent = true;
+    initPages(allocator_, pageSize_, resourceSize_, hotSize_);
+
+    const uint32 max_resources = MIN(maxResources, RESOURCE_HANDLE_INDEX_MASK);
+    pageTableSize = MAX((max_resources + pageSize - 1) >> pageShift, 1u);
+    pages = (uint8**)allocator->allocate(sizeof(uint8*) * pageTableSize, alignof(uint8*), 0, 0);
+    memset(pages, 0, sizeof(uint8*) * pageTableSize);
+
+    addPage();
 }
 
 void ResourcePool::shutdown()
 {
     if (freeIndicesHead != 0)
     {
-        Raptor::Debug::Log("[ResoucePool]: Warning: Resource Pool has unfreed resouces:\n");
+        Raptor::Debug::LogWarning("[ResoucePool]: Warning: Resource Pool has unfreed resouces:\n");
 
         for (uint32 i = 0; i < freeIndicesHead; ++i)
         {
-            Raptor::Debug::Log("\tResource %u\n", freeIndices[i]);
+            Raptor::Debug::LogWarning("\tResource %u\n", freeIndices[i]);
         }
     }
 
+    if (concurrent && concurrentUsed.load(std::memory_order_acquire) != 0)
+    {
+        Raptor::Debug::LogWarning("[ResoucePool]: Warning: Resource Pool has %u unfreed resouces.\n", concurrentUsed.load(std::memory_order_relaxed));
+    }
+
     ASSERT(usedIndices == 0);
 
-    sizet size = poolSize * (resourceSize + sizeof(uint32));
-    allocator->deallocate(memory, size);
+    const sizet page_memory_size = pageMemorySize();
+    for (uint32 i = 0; i < pageCount; ++i)
+        allocator->deallocate(pages[i], page_memory_size);
+
+    allocator->deallocate(pages, sizeof(uint8*) * pageTableSize);
+    if (freeIndices)
+        allocator->deallocate(freeIndices, sizeof(uint32) * poolSize);
+    pages = nullptr;
+    freeIndices = nullptr;
+    pageCount = 0;
+    pageTableSize = 0;
+    poolSize.store(0, std::memory_order_relaxed);
+}
+
+// Only the page table and the free list move, resources stay where they are.
+// Concurrent pools call this with growMutex held and never move either.
+bool ResourcePool::addPage()
+{
+    const uint32 pool_size = poolSize.load(std::memory_order_relaxed);
+    const uint32 new_size = pool_size + pageSize;
+    // The largest index stays unused, INVALID_INDEX can never be a live handle.
+    if (new_size > RESOURCE_HANDLE_INDEX_MASK)
+        return false;
+
+    if (pageCount == pageTableSize)
+    {
+        if (concurrent)
+            return false;
+
+        const uint32 new_table_size = pageTableSize ? pageTableSize * 2 : 4;
+        uint8** new_pages = (uint8**)allocator->allocate(sizeof(uint8*) * new_table_size, alignof(uint8*), 0, 0);
+        if (pages)
+        {
+            memcpy(new_pages, pages, sizeof(uint8*) * pageCount);
+            allocator->deallocate(pages, sizeof(uint8*) * pageTableSize);
+        }
+        pages = new_pages;
+        pageTableSize = new_table_size;
+    }
+
+    const sizet page_memory_size = pageMemorySize();
+    uint8* page = (uint8*)allocator->allocate(page_memory_size, 64, 0, 0);
+    memset(page, 0, page_memory_size);
+    pages[pageCount++] = page;
+
+    if (concurrent)
+    {
+        for (uint32 i = pool_size; i < new_size; ++i)
+            new (nextFreeOf(i)) std::atomic<uint32>(INVALID_INDEX);
+
+        // Threads that find the new slots on the free stack may use handles
+        // into them right away, the size has to be visible first.
+        poolSize.store(new_size, std::memory_order_release);
+        pushFree(pool_size, new_size - 1);
+        return true;
+    }
+
+    // Entries from freeIndicesHead on are the free slots, the new ones go after them.
+    uint32* new_free_indices = (uint32*)allocator->allocate(sizeof(uint32) * new_size, alignof(uint32), 0, 0);
+    if (freeIndices)
+    {
+        memcpy(new_free_indices, freeIndices, sizeof(uint32) * pool_size);
+        allocator->deallocate(freeIndices, sizeof(uint32) * pool_size);
+    }
+    freeIndices = new_free_indices;
+
+    for (uint32 i = pool_size; i < new_size; ++i)
+    {
+        freeIndices[i] = i;
+    }
+    poolSize.store(new_size, std::memory_order_relaxed);
+    return true;
+}
+
+bool ResourcePool::reserve(uint32 count)
+{
+    std::unique_lock<std::mutex> lock(growMutex, std::defer_lock);
+    if (concurrent)
+        lock.lock();
+
+    while (poolSize.load(std::memory_order_relaxed) < count)
+    {
+        if (!addPage())
+        {
+            const uint32 limit = concurrent ? MIN(pageTableSize << pageShift, RESOURCE_HANDLE_INDEX_MASK) : RESOURCE_HANDLE_INDEX_MASK;
+            Raptor::Debug::LogError("[ResourcePool]: Error: Can not reserve %u resources, the limit is %u.\n", count, limit);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Concurrent pools report a snapshot, the counts may be moving while it is taken.
+ResourcePoolStatistics ResourcePool::getStatistics() const
+{
+    ResourcePoolStatistics statistics;
+    statistics.capacity = poolSize.load(std::memory_order_acquire);
+    statistics.page_count = statistics.capacity >> pageShift;
+    statistics.memory_bytes = statistics.page_count * pageMemorySize() + sizeof(uint8*) * pageTableSize;
+
+    if (concurrent)
+    {
+        statistics.used = concurrentUsed.load(std::memory_order_relaxed);
+        statistics.high_water_mark = concurrentHighWaterMark.load(std::memory_order_relaxed);
+    }
+    else
+    {
+        statistics.used = usedIndices;
+        statistics.high_water_mark = highWaterMark;
+        statistics.memory_bytes += sizeof(uint32) * statistics.capacity;
+    }
+    return statistics;
 }
 
 uint32 ResourcePool::obtainResource()
 {
-    if (freeIndicesHead < poolSize)
+    if (concurrent)
+        return obtainConcurrent();
+
+    if (freeIndicesHead == poolSize.load(std::memory_order_relaxed) && !addPage())
     {
-        const uint32 freeIndex = freeIndices[freeIndicesHead++];
-        ++usedIndices;
-        return freeIndex;
+        ASSERT_MESSAGE(false, "[ResourcePool]: Error: No more resources left, pool size %u.\n", poolSize.load(std::memory_order_relaxed))
+        return INVALID_INDEX;
     }
 
-    ASSERT_MESSAGE(false, "[ResourcePool]: Error: No more resources left.")
-    return INVALID_INDEX;
+    const uint32 freeIndex = freeIndices[freeIndicesHead++];
+    ++usedIndices;
+    highWaterMark = MAX(highWaterMark, usedIndices);
+    return handleFromIndex(freeIndex);
 }
 
 void ResourcePool::releaseResource(uint32 handle)
 {
-    freeIndices[--freeIndicesHead] = handle;
+    ASSERT_MESSAGE(isValid(handle), "[ResourcePool]: Error: Releasing stale or invalid handle %x.\n", handle);
+
+    if (concurrent)
+    {
+        releaseConcurrent(handle);
+        return;
+    }
+
+    const uint32 index = ResourceHandleIndex(handle);
+    bumpGeneration(index);
+
+    freeIndices[--freeIndicesHead] = index;
     --usedIndices;
 }
 
+// Not thread-safe in either mode, no other thread may use the pool meanwhile.
 void ResourcePool::freeAllResources()
 {
+    const uint32 pool_size = poolSize.load(std::memory_order_relaxed);
+
     freeIndicesHead = 0;
     usedIndices = 0;
 
-    for (uint32 i = 0; i < poolSize; ++i)
+    for (uint32 i = 0; i < pool_size; ++i)
     {
-        freeIndices[i] = i;
+        if (!concurrent)
+            freeIndices[i] = i;
+        bumpGeneration(i);
+    }
+
+    if (concurrent)
+    {
+        freeHead.store(INVALID_INDEX, std::memory_order_relaxed);
+        concurrentUsed.store(0, std::memory_order_relaxed);
+        pushFree(0, pool_size - 1);
     }
 }
 
+// Only the thread releasing a slot writes its generation, readers checking
+// handles meanwhile see either the old or the new one.
+void ResourcePool::bumpGeneration(uint32 index)
+{
+    std::atomic<uint16>* generation = generationOf(index);
+    const uint16 next = (uint16)((generation->load(std::memory_order_relaxed) + 1) & RESOURCE_HANDLE_GENERATION_MASK);
+    generation->store(next, std::memory_order_release);
+}
+
+// Concurrent mode ----------------------------------------------------------
+
+void ResourcePool::pushFree(uint32 first, uint32 last)
+{
+    for (uint32 i = first; i < last; ++i)
+        nextFreeOf(i)->store(i + 1, std::memory_order_relaxed);
+
+    uint64 head = freeHead.load(std::memory_order_relaxed);
+    uint64 new_head;
+    do
+    {
+        nextFreeOf(last)->store((uint32)head, std::memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | first;
+    } while (!freeHead.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint32 ResourcePool::obtainConcurrent()
+{
+    uint64 head = freeHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const uint32 index = (uint32)head;
+        if (index == INVALID_INDEX)
+        {
+            // Only one thread grows the pool, the others find its page on the stack.
+            std::lock_guard<std::mutex> lock(growMutex);
+            head = freeHead.load(std::memory_order_acquire);
+            if ((uint32)head != INVALID_INDEX)
+                continue;
+
+            if (!addPage())
+            {
+                ASSERT_MESSAGE(false, "[ResourcePool]: Error: No more resources left, pool size %u.\n", poolSize.load(std::memory_order_relaxed));
+                return INVALID_INDEX;
+            }
+            head = freeHead.load(std::memory_order_acquire);
+            continue;
+        }
+
+        // The slot may be taken and its link rewritten before the exchange,
+        // the tag makes the exchange fail in that case.
+        const uint32 next = nextFreeOf(index)->load(std::memory_order_relaxed);
+        const uint64 new_head = (((head >> 32) + 1) << 32) | next;
+        if (freeHead.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            const uint32 used = concurrentUsed.fetch_add(1, std::memory_order_relaxed) + 1;
+            uint32 high_water_mark = concurrentHighWaterMark.load(std::memory_order_relaxed);
+            while (used > high_water_mark && !concurrentHighWaterMark.compare_exchange_weak(high_water_mark, used, std::memory_order_relaxed))
+            {
+            }
+            return handleFromIndex(index);
+        }
+    }
+}
+
+void ResourcePool::releaseConcurrent(uint32 handle)
+{
+    const uint32 index = ResourceHandleIndex(handle);
+    bumpGeneration(index);
+
+    concurrentUsed.fetch_sub(1, std::memory_order_relaxed);
+    pushFree(index, index);
+}
+
 void* ResourcePool::accessResource(uint32 handle)
 {
-    if (handle != INVALID_INDEX)
+    if (isValid(handle))
     {
-        return &memory[handle * resourceSize];
+        return resourceAt(ResourceHandleIndex(handle));
     }
+
+    ASSERT_MESSAGE(handle == INVALID_INDEX, "[ResourcePool]: Error: Access through stale handle %x.\n", handle);
     return nullptr;
 }
 
 const void* ResourcePool::accessResource(uint32 handle) const
 {
-    if (handle != INVALID_INDEX)
+    if (isValid(handle))
     {
-        return &memory[handle * resourceSize];
+        return resourceAt(ResourceHandleIndex(handle));
     }
+
+    ASSERT_MESSAGE(handle == INVALID_INDEX, "[ResourcePool]: Error: Access through stale handle %x.\n", handle);
+    return nullptr;
+}
+
+void* ResourcePool::accessHot(uint32 handle)
+{
+    if (isValid(handle))
+    {
+        return hotAt(ResourceHandleIndex(handle));
+    }
+
+    ASSERT_MESSAGE(handle == INVALID_INDEX, "[ResourcePool]: Error: Access through stale handle %x.\n", handle);
+    return nullptr;
+}
+
+const void* ResourcePool::accessHot(uint32 handle) const
+{
+    if (isValid(handle))
+    {
+        return hotAt(ResourceHandleIndex(handle));
+    }
+
+    ASSERT_MESSAGE(handle == INVALID_INDEX, "[ResourcePool]: Error: Access through stale handle %x.\n", handle);
     return nullptr;
 }
 
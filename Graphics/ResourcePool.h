@@ -1,54 +1,163 @@
 #pragma once
-#include <EASTL/allocator.h>
+#include <atomic>
+#include <mutex>
+
+#include "Allocator.h"
+#include "Constants.h"
+#include "Log.h"
 #include "Types.h"
 
 namespace Raptor
 {
 namespace Graphics
 {
+
+// Handles carry the slot index in the low bits and the generation of the slot
+// in the high bits. Releasing a slot bumps its generation, so handles to the
+// old resource stop being valid instead of aliasing the next one.
+static const uint32 RESOURCE_HANDLE_INDEX_BITS = 20;
+static const uint32 RESOURCE_HANDLE_INDEX_MASK = (1u << RESOURCE_HANDLE_INDEX_BITS) - 1;
+static const uint32 RESOURCE_HANDLE_GENERATION_MASK = (1u << (32 - RESOURCE_HANDLE_INDEX_BITS)) - 1;
+
+inline uint32 ResourceHandleIndex(uint32 handle) { return handle & RESOURCE_HANDLE_INDEX_MASK; }
+inline uint32 ResourceHandleGeneration(uint32 handle) { return handle >> RESOURCE_HANDLE_INDEX_BITS; }
+
+struct ResourcePoolStatistics
+{
+    uint32 used = 0;
+    // Most resources used at once since init.
+    uint32 high_water_mark = 0;
+    uint32 capacity = 0;
+    uint32 page_count = 0;
+    sizet memory_bytes = 0;
+}; // struct ResourcePoolStatistics
+
+// Resources live in fixed-size pages that are never moved, so pointers to
+// them stay valid when the pool grows. A full pool adds a page instead of
+// failing, reserve() does the growing up front when the count is known.
+//
+// A pool can keep a few hot bytes per resource in a dense array of their own,
+// next to the resources in the same page. Code that runs for every draw reads
+// those instead of pulling whole resources through the cache.
+//
+// A pool made with initConcurrent() can obtain and release from any number
+// of threads at once. Its free slots form a lock-free stack, only adding a
+// page takes a lock.
 struct ResourcePool
 {
-    using Allocator = eastl::allocator;
+    using Allocator = Raptor::Core::Allocator;
 
-    uint8* memory = nullptr;
+    // Each page holds pageSize resources, then their hot data and then their
+    // generations, which are kept apart so each array stays densely packed.
+    // Concurrent pools also keep the free stack links of the page at the end.
+    uint8** pages = nullptr;
     uint32* freeIndices = nullptr;
     Allocator* allocator = nullptr;
 
     uint32 freeIndicesHead = 0;
-    uint32 poolSize = 16;
+    // Current capacity, a whole number of pages. Written only while growing.
+    std::atomic<uint32> poolSize {0};
     uint32 resourceSize = 4;
+    uint32 hotSize = 0;
+    uint32 hotOffset = 0;
+    uint32 generationOffset = 0;
     uint32 usedIndices = 0;
-
-    void init(Allocator* allocator, uint32 poolSize, uint32 resourceSize);
+    uint32 highWaterMark = 0;
+
+    uint32 pageSize = 16;
+    uint32 pageShift = 4;
+    uint32 pageCount = 0;
+    uint32 pageTableSize = 0;
+
+    // Concurrent mode ----------------------------------------------------
+    bool concurrent = false;
+    uint32 nextFreeOffset = 0;
+    // Index of the top free slot in the low bits, a tag in the high bits that
+    // changes on every push and pop. A pop that read the links of a slot
+    // someone else took and gave back in the meantime fails instead (ABA).
+    std::atomic<uint64> freeHead {INVALID_INDEX};
+    std::atomic<uint32> concurrentUsed {0};
+    std::atomic<uint32> concurrentHighWaterMark {0};
+    std::mutex growMutex;
+
+    // The page size is rounded up to a power of two, the first page is allocated here.
+    // hotSize bytes per resource go to the hot array, none by default.
+    void init(Allocator* allocator, uint32 pageSize, uint32 resourceSize, uint32 hotSize = 0);
+    // The page table is sized for maxResources up front, so it never moves
+    // under threads reading the pool.
+    void initConcurrent(Allocator* allocator, uint32 pageSize, uint32 resourceSize, uint32 maxResources, uint32 hotSize = 0);
     void shutdown();
 
     uint32 obtainResource();
     void releaseResource(uint32 handle);
     void freeAllResources();
 
+    // Grows the pool to hold at least count resources.
+    bool reserve(uint32 count);
+    ResourcePoolStatistics getStatistics() const;
+
     void* accessResource(uint32 handle);
     const void* accessResource(uint32 handle) const;
 
+    void* accessHot(uint32 handle);
+    const void* accessHot(uint32 handle) const;
+
+    // False for handles of released resources and for INVALID_INDEX. In a
+    // concurrent pool the answer only holds while no other thread releases it.
+    bool isValid(uint32 handle) const
+    {
+        const uint32 index = ResourceHandleIndex(handle);
+        return index < poolSize.load(std::memory_order_acquire) && generationOf(index)->load(std::memory_order_acquire) == ResourceHandleGeneration(handle);
+    }
+
+    // Handle of whatever occupies the slot now, for walks over every slot.
+    uint32 handleFromIndex(uint32 index) const { return ((uint32)generationOf(index)->load(std::memory_order_relaxed) << RESOURCE_HANDLE_INDEX_BITS) | index; }
+
+    uint8* resourceAt(uint32 index) const { return pages[index >> pageShift] + (index & (pageSize - 1)) * resourceSize; }
+    uint8* hotAt(uint32 index) const { return pages[index >> pageShift] + hotOffset + (index & (pageSize - 1)) * hotSize; }
+    // Atomic because concurrent pools bump them while other threads check handles.
+    std::atomic<uint16>* generationOf(uint32 index) const { return (std::atomic<uint16>*)(pages[index >> pageShift] + generationOffset) + (index & (pageSize - 1)); }
+    std::atomic<uint32>* nextFreeOf(uint32 index) const { return (std::atomic<uint32>*)(pages[index >> pageShift] + nextFreeOffset) + (index & (pageSize - 1)); }
+
+private:
+
+    void initPages(Allocator* allocator, uint32 pageSize, uint32 resourceSize, uint32 hotSize);
+    bool addPage();
+    sizet pageMemorySize() const;
+    void bumpGeneration(uint32 index);
+
+    uint32 obtainConcurrent();
+    void releaseConcurrent(uint32 handle);
+    // Links first..last into a chain and puts it on top of the free stack.
+    void pushFree(uint32 first, uint32 last);
+
 }; // struct ResourcePool
 
 template<typename T>
 struct ResourcePoolTyped : public ResourcePool
 {
-    void init(Allocator* allocator, uint32 pool_size);
+    void init(Allocator* allocator, uint32 page_size);
+    void initConcurrent(Allocator* allocator, uint32 page_size, uint32 max_resources);
     void shutdown();
 
     T* obtain();
     void release(T* resource);
 
-    T* get(uint32 index);
-    const T* get(uint32 index) const;
+    T* get(uint32 handle);
+    const T* get(uint32 handle) const;
 
 }; // struct ResourcePoolTyped
 
 template<typename T>
-inline void ResourcePoolTyped<T>::init(Allocator* allocator, uint32 pool_size)
+inline void ResourcePoolTyped<T>::init(Allocator* allocator, uint32 page_size)
+{
+    ResourcePool::init(allocator, page_size, sizeof(T));
+}
+
+template<typename T>
+inline void ResourcePoolTyped<T>::initConcurrent(Allocator* allocator, uint32 page_size, uint32 max_resources)
 {
-    ResourcePool::init(allocator, pool_size, sizeof(T));
+    ResourcePool::initConcurrent(allocator, page_size, sizeof(T), max_resources);
 }
 
 template<typename T>
@@ -56,11 +165,11 @@ inline void ResourcePoolTyped<T>::shutdown()
 {
     if (freeIndicesHead != 0)
     {
-        Raptor::Debug::Log("[ResoucePool]: Warning: Resource Pool has unfreed resouces:\n");
+        Raptor::Debug::LogWarning("[ResoucePool]: Warning: Resource Pool has unfreed resouces:\n");
 
         for (uint32 i = 0; i < freeIndicesHead; ++i)
         {
-            Raptor::Debug::Log("\tResource %u, %s\n", freeIndices[i], get(freeIndices[i])->name);
+            Raptor::Debug::LogWarning("\tResource %u, %s\n", freeIndices[i], get(handleFromIndex(freeIndices[i]))->name);
         }
     }
 
@@ -88,15 +197,15 @@ inline void ResourcePoolTyped<T>::release(T* resource)
 }
 
 template<typename T>
-inline T* ResourcePoolTyped<T>::get(uint32 index)
+inline T* ResourcePoolTyped<T>::get(uint32 handle)
 {
-    return (T*)ResourcePool::accessResource(index);
+    return (T*)ResourcePool::accessResource(handle);
 }
 
 template<typename T>
-inline const T* ResourcePoolTyped<T>::get(uint32 index) const
+inline const T* ResourcePoolTyped<T>::get(uint32 handle) const
 {
-    return (const T*)ResourcePool::accessResource(index);
+    return (const T*)ResourcePool::accessResource(handle);
 }
 
 
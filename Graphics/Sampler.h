@@ -1,5 +1,6 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include "Hash.h"
 #include "Resources.h"
 #include "ResourceManager.h"
 
@@ -59,8 +60,8 @@ struct SamplerResource : public Resource
     uint32 pool_index;
     SamplerDescription desc;
 
-    static constexpr char* type ="SamplerType";
-    static uint64 type_hash;
+    static constexpr const char* type = "SamplerType";
+    static constexpr uint64 type_hash = Raptor::Core::HashStringConstexpr(type);
 }; // struct SamplerResource
 
 
@@ -2,6 +2,7 @@
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 #include "Types.h"
+#include "Hash.h"
 #include "Resources.h"
 #include "Sampler.h"
 #include "ResourceManager.h"
@@ -70,6 +71,13 @@ struct Texture
     const char* name = nullptr;
 }; // struct Texture
 
+// Image view read by descriptor set and framebuffer writes, kept in the hot
+// array of the texture pool.
+struct TextureHot
+{
+    VkImageView vk_image_view = VK_NULL_HANDLE;
+}; // struct TextureHot
+
 struct CreateTextureParams
 {
     VkFormat vk_format = VK_FORMAT_UNDEFINED;
@@ -108,14 +116,46 @@ struct TextureDescription
     TextureType::Enum type = TextureType::Enum::Texture2D;
 }; // struct TextureDescription
 
+static const uint32 MAX_TEXTURE_MIPMAPS = 16;
+
+// Bytes of an RGBA8 mip chain with every level tightly packed.
+inline uint32 TextureMipChainSize(uint32 width, uint32 height, uint32 mipmaps)
+{
+    uint32 size = 0;
+    for (uint32 mip = 0; mip < mipmaps; ++mip)
+    {
+        const uint32 mip_width = (width >> mip) ? (width >> mip) : 1;
+        const uint32 mip_height = (height >> mip) ? (height >> mip) : 1;
+        size += mip_width * mip_height * 4;
+    }
+    return size;
+}
+
+// Texture cooked by the resource compiler: this header followed by the
+// RGBA8 mip chain, ready to be handed to CreateTexture() as it is.
+struct CookedTextureHeader
+{
+    static const uint32 MAGIC = 0x58545252; // "RRTX"
+    static const uint32 VERSION = 1;
+
+    uint32 magic;
+    uint32 version;
+    uint16 width;
+    uint16 height;
+    uint8 mipmaps;
+    uint8 padding[3];
+    uint32 data_size;
+
+}; // struct CookedTextureHeader
+
 struct TextureResource : public Resource
 {
     TextureHandle handle;
     uint32 pool_index;
     TextureDescription desc;
 
-    static constexpr char* type = "TextureType";
-    static uint64 type_hash;
+    static constexpr const char* type = "TextureType";
+    static constexpr uint64 type_hash = Raptor::Core::HashStringConstexpr(type);
 }; // struct TextureResource
 
 namespace TextureFormat
@@ -0,0 +1,167 @@
+#include "Bounds.h"
+#include "SIMD.h"
+#include <math.h>
+
+namespace Raptor
+{
+namespace Math
+{
+
+// AABB ------------------------------------------------------------------------
+
+AABB& AABB::Add(const vec3f& point)
+{
+    min = vec3f(fminf(min.x, point.x), fminf(min.y, point.y), fminf(min.z, point.z));
+    max = vec3f(fmaxf(max.x, point.x), fmaxf(max.y, point.y), fmaxf(max.z, point.z));
+    return *this;
+}
+
+AABB& AABB::Add(const AABB& box)
+{
+    min = vec3f(fminf(min.x, box.min.x), fminf(min.y, box.min.y), fminf(min.z, box.min.z));
+    max = vec3f(fmaxf(max.x, box.max.x), fmaxf(max.y, box.max.y), fmaxf(max.z, box.max.z));
+    return *this;
+}
+
+AABB AABB::Transformed(const mat4f& m) const
+{
+    // The center moves with the matrix, each extent adds what its axis
+    // covers along every world axis.
+    const vec3f center = Center();
+    const vec3f extents = Extents();
+
+    vec3f new_center(m.i[12], m.i[13], m.i[14]);
+    vec3f new_extents;
+    for (uint32 j = 0; j < 3; j++)
+    {
+        for (uint32 k = 0; k < 3; k++)
+        {
+            new_center[j] += m.i[k * 4 + j] * center[k];
+            new_extents[j] += fabsf(m.i[k * 4 + j]) * extents[k];
+        }
+    }
+
+    return AABB(new_center - new_extents, new_center + new_extents);
+}
+
+// Sphere ----------------------------------------------------------------------
+
+Sphere Sphere::FromAABB(const AABB& box)
+{
+    return Sphere(box.Center(), box.Extents().Length());
+}
+
+Sphere Sphere::Transformed(const mat4f& m) const
+{
+    vec3f new_center(m.i[12], m.i[13], m.i[14]);
+    float scale_squared = 0.f;
+    for (uint32 k = 0; k < 3; k++)
+    {
+        for (uint32 j = 0; j < 3; j++)
+        {
+            new_center[j] += m.i[k * 4 + j] * center[k];
+        }
+
+        scale_squared = fmaxf(scale_squared, m.i[k * 4] * m.i[k * 4] + m.i[k * 4 + 1] * m.i[k * 4 + 1] + m.i[k * 4 + 2] * m.i[k * 4 + 2]);
+    }
+
+    return Sphere(new_center, radius * sqrtf(scale_squared));
+}
+
+// Frustum ---------------------------------------------------------------------
+
+#if defined(RAPTOR_MATH_SSE)
+// Four planes with one register per component, back to one register per plane.
+static inline void NormalizePlanes(__m128 (&p)[4])
+{
+    const __m128 length_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[0], p[0]), _mm_mul_ps(p[1], p[1])), _mm_mul_ps(p[2], p[2]));
+    const __m128 inv_length = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(length_squared));
+    for (uint32 k = 0; k < 4; k++)
+        p[k] = _mm_mul_ps(p[k], inv_length);
+
+    _MM_TRANSPOSE4_PS(p[0], p[1], p[2], p[3]);
+}
+#endif
+
+Frustum* Frustum::FromMatrix(const mat4f& view_projection)
+{
+    // A point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w in
+    // clip space, so each plane is a sum of rows of the matrix. Component k of
+    // every plane only depends on column k.
+#if defined(RAPTOR_MATH_SSE)
+    // Left, right, bottom and top in one register per component, near and far
+    // in the first two lanes of a second set.
+    __m128 sides[4];
+    __m128 depth[4];
+    const __m128 signs = _mm_setr_ps(1.f, -1.f, 1.f, -1.f);
+    for (uint32 k = 0; k < 4; k++)
+    {
+        const __m128 column = _mm_load_ps(view_projection.i + k * 4);
+        const __m128 w = _mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128 xxyy = _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 0, 0));
+        sides[k] = _mm_add_ps(w, _mm_mul_ps(xxyy, signs));
+
+        const __m128 z = _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2));
+        depth[k] = _mm_unpacklo_ps(z, _mm_sub_ps(w, z));
+    }
+
+    NormalizePlanes(sides);
+    NormalizePlanes(depth);
+
+    for (uint32 i = 0; i < 4; i++)
+        _mm_store_ps(planes[Left + i].v, sides[i]);
+    _mm_store_ps(planes[Near].v, depth[0]);
+    _mm_store_ps(planes[Far].v, depth[1]);
+#else
+    for (uint32 k = 0; k < 4; k++)
+    {
+        const float* column = view_projection.i + k * 4;
+        planes[Left][k] = column[3] + column[0];
+        planes[Right][k] = column[3] - column[0];
+        planes[Bottom][k] = column[3] + column[1];
+        planes[Top][k] = column[3] - column[1];
+        planes[Near][k] = column[2];
+        planes[Far][k] = column[3] - column[2];
+    }
+
+    for (uint32 p = 0; p < Max; p++)
+    {
+        vec4f& plane = planes[p];
+        plane = plane / sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    }
+#endif
+
+    return this;
+}
+
+bool Frustum::Intersects(const AABB& box) const
+{
+    // Outside when even the corner furthest along the normal is behind a plane.
+    const vec3f center = box.Center();
+    const vec3f extents = box.Extents();
+    for (uint32 p = 0; p < Max; p++)
+    {
+        const vec4f& plane = planes[p];
+        const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        const float radius = fabsf(plane.x) * extents.x + fabsf(plane.y) * extents.y + fabsf(plane.z) * extents.z;
+        if (distance + radius < 0.f)
+            return false;
+    }
+
+    return true;
+}
+
+bool Frustum::Intersects(const Sphere& sphere) const
+{
+    for (uint32 p = 0; p < Max; p++)
+    {
+        const vec4f& plane = planes[p];
+        if (plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w < -sphere.radius)
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace Math
+} // namespace Raptor
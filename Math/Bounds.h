@@ -0,0 +1,89 @@
+#pragma once
+
+#include <float.h>
+
+#include "Matrix.h"
+#include "Types.h"
+#include "Vector.h"
+
+namespace Raptor
+{
+namespace Math
+{
+
+// Axis aligned box. The default one is empty, min above max, so Add can
+// start from it.
+class AABB
+{
+public:
+    constexpr AABB() : min(FLT_MAX, FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX, -FLT_MAX) {}
+    constexpr AABB(const vec3f& min, const vec3f& max) : min(min), max(max) {}
+
+    constexpr bool IsEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    constexpr vec3f Center() const { return (min + max) * 0.5f; }
+    // Half the size.
+    constexpr vec3f Extents() const { return (max - min) * 0.5f; }
+
+    AABB& Add(const vec3f& point);
+    AABB& Add(const AABB& box);
+
+    // Box around the transformed box, for moving the box of a mesh to world space.
+    AABB Transformed(const mat4f& m) const;
+
+    vec3f min;
+    vec3f max;
+
+}; // class AABB
+
+class Sphere
+{
+public:
+    constexpr Sphere() : center(), radius(0) {}
+    constexpr Sphere(const vec3f& center, float radius) : center(center), radius(radius) {}
+
+    // Sphere around the box.
+    static Sphere FromAABB(const AABB& box);
+
+    // The radius grows with the largest scale of the matrix.
+    Sphere Transformed(const mat4f& m) const;
+
+    vec3f center;
+    float radius;
+
+}; // class Sphere
+
+// The six planes of a view-projection matrix, for Vulkan clip space with
+// depth from 0 to 1. A plane is (normal, distance) with the normal pointing
+// inside, points p with dot(normal, p) + distance >= 0 are on the inner side.
+// Planes come out normalized, so sphere tests can use them as distances.
+class Frustum
+{
+public:
+    enum Plane : uint8
+    {
+        Left, Right, Bottom, Top, Near, Far, Max
+    };
+
+    // Extracting from projection * view gives world space planes, from
+    // projection * view * model the planes in the space of the model.
+    Frustum* FromMatrix(const mat4f& view_projection);
+
+    bool Intersects(const AABB& box) const;
+    bool Intersects(const Sphere& sphere) const;
+
+    vec4f planes[Max];
+
+}; // class Frustum
+
+// Writes the indices of the boxes that intersect the frustum to
+// visible_indices, in order, and returns how many there are. The array has
+// to have room for count indices. Boxes are tested 4 or 8 at a time at the
+// SIMD level of TransformBatch.h. Conservative like Frustum::Intersects:
+// boxes near a corner of the frustum can pass without being inside.
+uint32 CullAABBs(const Frustum& frustum, const AABB* boxes, uint32 count, uint32* visible_indices);
+
+static_assert(std::is_trivially_copyable_v<AABB> && std::is_standard_layout_v<AABB> && sizeof(AABB) == 24, "CullAABBs reads boxes as 6 floats.");
+static_assert(std::is_trivially_copyable_v<Frustum> && sizeof(Frustum) == 96, "Frustum has to stay a plain value.");
+
+} // namespace Math
+} // namespace Raptor
@@ -1,4 +1,5 @@
 #pragma once
+#include "Quaternion.h"
 #include "Vector.h"
 
 namespace Raptor
@@ -10,15 +11,15 @@ template<typename T>
 class mat3
 {
 public:
-    mat3()
+    constexpr mat3()
         : _11(1), _12(0), _13(0),
           _21(0), _22(1), _23(0),
           _31(0), _32(0), _33(1) {}
-    
-    mat3(vec3<T> v0, vec3<T> v1, vec3<T> v2) 
-        : v[0](v0), v[1](v1), v[2](v2), v[3](v3) {}
-    
-    mat3(T* m)
+
+    constexpr mat3(const vec3<T>& v0, const vec3<T>& v1, const vec3<T>& v2)
+        : v{v0, v1, v2} {}
+
+    mat3(const T* m)
     {
         for (uint8 i = 0; i < 9; i++)
         {
@@ -26,12 +27,10 @@ public:
         }
     }
 
-    ~mat3(){}
-
     mat3<T>* Zero();
     mat3<T>* Identity();
 
-    T Determinant();
+    T Determinant() const;
 
     union
     {
@@ -44,25 +43,25 @@ public:
 }; // class mat3
 
 template<typename T>
-class mat4
+class alignas(VEC4_ALIGNMENT<T>) mat4
 {
 public:
-    mat4()
+    constexpr mat4()
         : _11(0), _12(0), _13(0), _14(0), 
           _21(0), _22(0), _23(0), _24(0), 
           _31(0), _32(0), _33(0), _34(0), 
           _41(0), _42(0), _43(0), _44(0) {}
 
-    mat4(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l, T m, T n, T o, T p)
+    constexpr mat4(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l, T m, T n, T o, T p)
         : _11(a), _12(b), _13(c), _14(d), 
           _21(e), _22(f), _23(g), _24(h), 
           _31(i), _32(j), _33(k), _34(l), 
           _41(m), _42(n), _43(o), _44(p) {}
     
-    mat4(vec4<T> v0, vec4<T> v1, vec4<T> v2, vec4<T> v3) 
-        : v[0](v0), v[1](v1), v[2](v2), v[3](v3) {}
+    constexpr mat4(const vec4<T>& v0, const vec4<T>& v1, const vec4<T>& v2, const vec4<T>& v3)
+        : v{v0, v1, v2, v3} {}
 
-    mat4(T* m)
+    mat4(const T* m)
     {
         for (uint8 i = 0; i < 16; i++)
         {
@@ -70,16 +69,6 @@ public:
         }
     }
 
-    mat4(mat4& m)
-    {
-        for (uint8 i = 0; i < 16; i++)
-        {
-            this->i[i] = m.i[i];
-        }
-    }
-
-    ~mat4() {}
-
     vec4<T> operator [] (int i) const { return v[i]; }
     vec4<T> &operator [] (int i) { return v[i]; }
 
@@ -88,19 +77,23 @@ public:
 
     mat4<T>* Scale(const vec3<T>& scale);
 
-    mat4<T> Transpose();
-    mat4<T> Inverse();
-    mat4<T> Adjugate();
-    T Determinant();
+    // None of these allocate, float matrices use the SIMD kernels of MatrixKernels.h.
+    mat4<T> Transpose() const;
+    mat4<T> Inverse() const;
+    // Cheaper inverse for matrices with a last row of (0, 0, 0, 1), like the
+    // ones Transform builds.
+    mat4<T> InverseAffine() const;
+    mat4<T> Adjugate() const;
+    T Determinant() const;
 
-    mat3<T>* SubMat3(uint32 i, uint32 j);
+    void SubMat3(uint32 i, uint32 j, mat3<T>& out) const;
 
-    mat4<T>* FromQuaternion(const vec4<T>& q);
+    mat4<T>* FromQuaternion(const quat<T>& q);
     mat4<T>* FromPerspective(T fov, T aspect, T near_, T far_);
 
-    mat4<T>* LookAt(vec3<T>& eye, vec3<T>& center, vec3<T>& up);
+    mat4<T>* LookAt(const vec3<T>& eye, const vec3<T>& center, const vec3<T>& up);
 
-    mat4<T> operator * (const mat4<T>& rhs);
+    mat4<T> operator * (const mat4<T>& rhs) const;
 
     union 
     {
@@ -112,9 +105,29 @@ public:
 
 }; // class mat4
 
-template<typename T> mat4<T> operator * (const mat4<T>& lhs, T rhs);
-template<typename T> mat4<T> operator * (T lhs, const mat4<T>& rhs);
-template<typename T> vec3<T> operator * (mat3<T>& lhs, const vec3<T>& rhs);
+template<typename T>
+constexpr mat4<T> operator * (const mat4<T>& lhs, T rhs)
+{
+    return mat4<T>(
+        lhs.i[0]  * rhs, lhs.i[1]  * rhs, lhs.i[2]  * rhs, lhs.i[3]  * rhs,
+        lhs.i[4]  * rhs, lhs.i[5]  * rhs, lhs.i[6]  * rhs, lhs.i[7]  * rhs,
+        lhs.i[8]  * rhs, lhs.i[9]  * rhs, lhs.i[10] * rhs, lhs.i[11] * rhs,
+        lhs.i[12] * rhs, lhs.i[13] * rhs, lhs.i[14] * rhs, lhs.i[15] * rhs);
+}
+
+template<typename T>
+constexpr mat4<T> operator * (T lhs, const mat4<T>& rhs)
+{
+    return rhs * lhs;
+}
+
+template<typename T>
+constexpr vec3<T> operator * (const mat3<T>& lhs, const vec3<T>& rhs)
+{
+    return vec3<T>(lhs._11 * rhs.x + lhs._12 * rhs.y + lhs._13 * rhs.z,
+                   lhs._21 * rhs.x + lhs._22 * rhs.y + lhs._23 * rhs.z,
+                   lhs._31 * rhs.x + lhs._32 * rhs.y + lhs._33 * rhs.z);
+}
 
 typedef mat3<float> mat3f;
 typedef mat3<double> mat3d;
@@ -125,19 +138,28 @@ class Transform
 {
 public:
 
-    Transform(){}
-    Transform(vec3f scale, vec4f rotation, vec3f translation) :
+    constexpr Transform() {}
+    constexpr Transform(const vec3f& scale, const quatf& rotation, const vec3f& translation) :
         scale(scale), rotation(rotation), translation(translation) {}
-    ~Transform(){}
 
-    mat4f CalcMatrix();
+    // Translation * rotation * scale, the rotation is used as it is, without normalizing.
+    mat4f CalcMatrix() const;
+
+    // CalcMatrix of whole arrays, with the SIMD kernels of TransformBatch.h.
+    // The second version takes the three parts from separate arrays.
+    static void CalcMatrices(const Transform* transforms, mat4f* out, sizet count);
+    static void CalcMatrices(const vec3f* scales, const quatf* rotations, const vec3f* translations, mat4f* out, sizet count);
 
     vec3f scale;
-    vec4f rotation;
+    quatf rotation;
     vec3f translation;
 
 }; // class Transform
 
+static_assert(std::is_trivially_copyable_v<mat3f> && std::is_standard_layout_v<mat3f>, "mat3 has to stay a plain value.");
+static_assert(std::is_trivially_copyable_v<mat4f> && std::is_standard_layout_v<mat4f>, "mat4 has to stay a plain value.");
+static_assert(std::is_trivially_copyable_v<Transform>, "Transform has to stay a plain value.");
+static_assert(sizeof(mat4f) == 64 && alignof(mat4f) == 16, "mat4f has to match four SIMD registers.");
 
 } // namespace Math
-} // namespace Raptor
\ No newline at end of file
+} // namespace Raptor
@@ -0,0 +1,392 @@
+#pragma once
+
+#include "SIMD.h"
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Math
+{
+
+// Kernels behind mat4, on the 16 values of a matrix in mat4 layout: v[0..3]
+// are the columns, the translation lives in v[3]. None of them allocates.
+// The scalar templates serve every T, float has SIMD versions where the
+// target has SSE or NEON. Input and output may not overlap.
+
+// Scalar ----------------------------------------------------------------------
+
+template<typename T>
+inline void Mat4MultiplyScalar(const T* a, const T* b, T* out)
+{
+    for (uint32 i = 0; i < 4; i++)
+    {
+        for (uint32 j = 0; j < 4; j++)
+        {
+            out[i * 4 + j] = a[j] * b[i * 4] + a[4 + j] * b[i * 4 + 1] + a[8 + j] * b[i * 4 + 2] + a[12 + j] * b[i * 4 + 3];
+        }
+    }
+}
+
+template<typename T>
+inline void Mat4TransposeScalar(const T* m, T* out)
+{
+    for (uint32 i = 0; i < 4; i++)
+    {
+        for (uint32 j = 0; j < 4; j++)
+        {
+            out[i * 4 + j] = m[j * 4 + i];
+        }
+    }
+}
+
+// 2x2 determinants of the top two and bottom two rows, shared by the
+// determinant, adjugate and inverse.
+template<typename T>
+struct Mat4SubDeterminants
+{
+    explicit Mat4SubDeterminants(const T* a)
+    {
+        s0 = a[0] * a[5] - a[4] * a[1];
+        s1 = a[0] * a[6] - a[4] * a[2];
+        s2 = a[0] * a[7] - a[4] * a[3];
+        s3 = a[1] * a[6] - a[5] * a[2];
+        s4 = a[1] * a[7] - a[5] * a[3];
+        s5 = a[2] * a[7] - a[6] * a[3];
+
+        c0 = a[8] * a[13] - a[12] * a[9];
+        c1 = a[8] * a[14] - a[12] * a[10];
+        c2 = a[8] * a[15] - a[12] * a[11];
+        c3 = a[9] * a[14] - a[13] * a[10];
+        c4 = a[9] * a[15] - a[13] * a[11];
+        c5 = a[10] * a[15] - a[14] * a[11];
+    }
+
+    T Determinant() const { return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0; }
+
+    T s0, s1, s2, s3, s4, s5;
+    T c0, c1, c2, c3, c4, c5;
+}; // struct Mat4SubDeterminants
+
+template<typename T>
+inline T Mat4DeterminantScalar(const T* m)
+{
+    return Mat4SubDeterminants<T>(m).Determinant();
+}
+
+// Returns the determinant, out is the adjugate times scale.
+template<typename T>
+inline T Mat4AdjugateScalar(const T* a, T* out, T scale = T(1))
+{
+    const Mat4SubDeterminants<T> d(a);
+
+    out[0]  = ( a[5] * d.c5 - a[6] * d.c4 + a[7] * d.c3) * scale;
+    out[1]  = (-a[1] * d.c5 + a[2] * d.c4 - a[3] * d.c3) * scale;
+    out[2]  = ( a[13] * d.s5 - a[14] * d.s4 + a[15] * d.s3) * scale;
+    out[3]  = (-a[9] * d.s5 + a[10] * d.s4 - a[11] * d.s3) * scale;
+
+    out[4]  = (-a[4] * d.c5 + a[6] * d.c2 - a[7] * d.c1) * scale;
+    out[5]  = ( a[0] * d.c5 - a[2] * d.c2 + a[3] * d.c1) * scale;
+    out[6]  = (-a[12] * d.s5 + a[14] * d.s2 - a[15] * d.s1) * scale;
+    out[7]  = ( a[8] * d.s5 - a[10] * d.s2 + a[11] * d.s1) * scale;
+
+    out[8]  = ( a[4] * d.c4 - a[5] * d.c2 + a[7] * d.c0) * scale;
+    out[9]  = (-a[0] * d.c4 + a[1] * d.c2 - a[3] * d.c0) * scale;
+    out[10] = ( a[12] * d.s4 - a[13] * d.s2 + a[15] * d.s0) * scale;
+    out[11] = (-a[8] * d.s4 + a[9] * d.s2 - a[11] * d.s0) * scale;
+
+    out[12] = (-a[4] * d.c3 + a[5] * d.c1 - a[6] * d.c0) * scale;
+    out[13] = ( a[0] * d.c3 - a[1] * d.c1 + a[2] * d.c0) * scale;
+    out[14] = (-a[12] * d.s3 + a[13] * d.s1 - a[14] * d.s0) * scale;
+    out[15] = ( a[8] * d.s3 - a[9] * d.s1 + a[10] * d.s0) * scale;
+
+    return d.Determinant();
+}
+
+// A singular matrix gives infinities, the same as dividing by its determinant.
+template<typename T>
+inline void Mat4InverseScalar(const T* m, T* out)
+{
+    const T inverse_determinant = T(1) / Mat4DeterminantScalar(m);
+    Mat4AdjugateScalar(m, out, inverse_determinant);
+}
+
+// For matrices whose last row is (0, 0, 0, 1): rotation, scale and translation.
+template<typename T>
+inline void Mat4InverseAffineScalar(const T* m, T* out)
+{
+    // Rows of the inverse 3x3 are the cross products of its columns.
+    const T r0[3] = {m[5] * m[10] - m[6] * m[9], m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8]};
+    const T r1[3] = {m[9] * m[2] - m[10] * m[1], m[10] * m[0] - m[8] * m[2], m[8] * m[1] - m[9] * m[0]};
+    const T r2[3] = {m[1] * m[6] - m[2] * m[5], m[2] * m[4] - m[0] * m[6], m[0] * m[5] - m[1] * m[4]};
+    const T inverse_determinant = T(1) / (m[0] * r0[0] + m[1] * r0[1] + m[2] * r0[2]);
+
+    for (uint32 j = 0; j < 3; j++)
+    {
+        out[j * 4 + 0] = r0[j] * inverse_determinant;
+        out[j * 4 + 1] = r1[j] * inverse_determinant;
+        out[j * 4 + 2] = r2[j] * inverse_determinant;
+        out[j * 4 + 3] = T(0);
+    }
+
+    for (uint32 i = 0; i < 3; i++)
+    {
+        out[12 + i] = -(out[i] * m[12] + out[4 + i] * m[13] + out[8 + i] * m[14]);
+    }
+    out[15] = T(1);
+}
+
+// The generic versions pick the scalar kernels, float overloads below replace them.
+template<typename T> inline void Mat4Multiply(const T* a, const T* b, T* out) { Mat4MultiplyScalar(a, b, out); }
+template<typename T> inline void Mat4Transpose(const T* m, T* out) { Mat4TransposeScalar(m, out); }
+template<typename T> inline T Mat4Determinant(const T* m) { return Mat4DeterminantScalar(m); }
+template<typename T> inline void Mat4Inverse(const T* m, T* out) { Mat4InverseScalar(m, out); }
+template<typename T> inline void Mat4InverseAffine(const T* m, T* out) { Mat4InverseAffineScalar(m, out); }
+
+#if defined(RAPTOR_MATH_SSE)
+
+// SSE / AVX -------------------------------------------------------------------
+
+#define RAPTOR_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define RAPTOR_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, RAPTOR_SHUFFLE_MASK(x, y, z, w))
+#define RAPTOR_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, RAPTOR_SHUFFLE_MASK(x, y, z, w))
+
+inline __m128 Mat4MultiplyAdd(__m128 a, __m128 b, __m128 c)
+{
+#if defined(RAPTOR_MATH_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+inline void Mat4Multiply(const float* a, const float* b, float* out)
+{
+#if defined(RAPTOR_MATH_AVX)
+    // Two output columns per iteration, the columns of a repeat in both halves.
+    const __m256 a0 = _mm256_broadcast_ps((const __m128*)(a));
+    const __m256 a1 = _mm256_broadcast_ps((const __m128*)(a + 4));
+    const __m256 a2 = _mm256_broadcast_ps((const __m128*)(a + 8));
+    const __m256 a3 = _mm256_broadcast_ps((const __m128*)(a + 12));
+
+    for (uint32 i = 0; i < 16; i += 8)
+    {
+        const __m256 columns = _mm256_loadu_ps(b + i);
+        __m256 result = _mm256_mul_ps(a0, _mm256_shuffle_ps(columns, columns, 0x00));
+#if defined(RAPTOR_MATH_FMA)
+        result = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(columns, columns, 0x55), result);
+        result = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(columns, columns, 0xaa), result);
+        result = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(columns, columns, 0xff), result);
+#else
+        result = _mm256_add_ps(result, _mm256_mul_ps(a1, _mm256_shuffle_ps(columns, columns, 0x55)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(a2, _mm256_shuffle_ps(columns, columns, 0xaa)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(a3, _mm256_shuffle_ps(columns, columns, 0xff)));
+#endif
+        _mm256_storeu_ps(out + i, result);
+    }
+#else
+    const __m128 a0 = _mm_loadu_ps(a);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+
+    for (uint32 i = 0; i < 16; i += 4)
+    {
+        const __m128 column = _mm_loadu_ps(b + i);
+        __m128 result = _mm_mul_ps(a0, RAPTOR_SWIZZLE(column, 0, 0, 0, 0));
+        result = Mat4MultiplyAdd(a1, RAPTOR_SWIZZLE(column, 1, 1, 1, 1), result);
+        result = Mat4MultiplyAdd(a2, RAPTOR_SWIZZLE(column, 2, 2, 2, 2), result);
+        result = Mat4MultiplyAdd(a3, RAPTOR_SWIZZLE(column, 3, 3, 3, 3), result);
+        _mm_storeu_ps(out + i, result);
+    }
+#endif
+}
+
+inline void Mat4Transpose(const float* m, float* out)
+{
+    __m128 r0 = _mm_loadu_ps(m);
+    __m128 r1 = _mm_loadu_ps(m + 4);
+    __m128 r2 = _mm_loadu_ps(m + 8);
+    __m128 r3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, r3);
+}
+
+// The matrix is split into 2x2 blocks | A B |, each held in one register as
+//                                     | C D |
+// (_11 _12 _21 _22). Results hold in either layout, a transposed input gives
+// the transposed inverse.
+inline __m128 Mat2Multiply(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, RAPTOR_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(RAPTOR_SWIZZLE(a, 1, 0, 3, 2), RAPTOR_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adjugate(a) * b
+inline __m128 Mat2AdjugateMultiply(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(RAPTOR_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(RAPTOR_SWIZZLE(a, 1, 1, 2, 2), RAPTOR_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adjugate(b)
+inline __m128 Mat2MultiplyAdjugate(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, RAPTOR_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(RAPTOR_SWIZZLE(a, 1, 0, 3, 2), RAPTOR_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+struct Mat4Blocks
+{
+    explicit Mat4Blocks(const float* m)
+    {
+        const __m128 r0 = _mm_loadu_ps(m);
+        const __m128 r1 = _mm_loadu_ps(m + 4);
+        const __m128 r2 = _mm_loadu_ps(m + 8);
+        const __m128 r3 = _mm_loadu_ps(m + 12);
+
+        a = _mm_movelh_ps(r0, r1);
+        b = _mm_movehl_ps(r1, r0);
+        c = _mm_movelh_ps(r2, r3);
+        d = _mm_movehl_ps(r3, r2);
+
+        // (|A| |B| |C| |D|)
+        const __m128 determinants = _mm_sub_ps(
+            _mm_mul_ps(RAPTOR_SHUFFLE(r0, r2, 0, 2, 0, 2), RAPTOR_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+            _mm_mul_ps(RAPTOR_SHUFFLE(r0, r2, 1, 3, 1, 3), RAPTOR_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+        determinant_a = RAPTOR_SWIZZLE(determinants, 0, 0, 0, 0);
+        determinant_b = RAPTOR_SWIZZLE(determinants, 1, 1, 1, 1);
+        determinant_c = RAPTOR_SWIZZLE(determinants, 2, 2, 2, 2);
+        determinant_d = RAPTOR_SWIZZLE(determinants, 3, 3, 3, 3);
+
+        adjugate_d_c = Mat2AdjugateMultiply(d, c);
+        adjugate_a_b = Mat2AdjugateMultiply(a, b);
+    }
+
+    // |M| = |A||D| + |B||C| - tr(adjugate(A) B adjugate(D) C), in every lane.
+    __m128 Determinant() const
+    {
+        __m128 trace = _mm_mul_ps(adjugate_a_b, RAPTOR_SWIZZLE(adjugate_d_c, 0, 2, 1, 3));
+        trace = _mm_add_ps(trace, RAPTOR_SWIZZLE(trace, 2, 3, 0, 1));
+        trace = _mm_add_ps(trace, RAPTOR_SWIZZLE(trace, 1, 0, 3, 2));
+
+        const __m128 determinant = _mm_add_ps(_mm_mul_ps(determinant_a, determinant_d), _mm_mul_ps(determinant_b, determinant_c));
+        return _mm_sub_ps(determinant, trace);
+    }
+
+    __m128 a, b, c, d;
+    __m128 determinant_a, determinant_b, determinant_c, determinant_d;
+    __m128 adjugate_d_c, adjugate_a_b;
+}; // struct Mat4Blocks
+
+inline float Mat4Determinant(const float* m)
+{
+    return _mm_cvtss_f32(Mat4Blocks(m).Determinant());
+}
+
+inline void Mat4Inverse(const float* m, float* out)
+{
+    const Mat4Blocks blocks(m);
+
+    // The inverse is | X Y | / |M|, with adjugates
+    //                | Z W |
+    const __m128 x = _mm_sub_ps(_mm_mul_ps(blocks.determinant_d, blocks.a), Mat2Multiply(blocks.b, blocks.adjugate_d_c));
+    const __m128 w = _mm_sub_ps(_mm_mul_ps(blocks.determinant_a, blocks.d), Mat2Multiply(blocks.c, blocks.adjugate_a_b));
+    const __m128 y = _mm_sub_ps(_mm_mul_ps(blocks.determinant_b, blocks.c), Mat2MultiplyAdjugate(blocks.d, blocks.adjugate_a_b));
+    const __m128 z = _mm_sub_ps(_mm_mul_ps(blocks.determinant_c, blocks.b), Mat2MultiplyAdjugate(blocks.a, blocks.adjugate_d_c));
+
+    // Signs of the 2x2 adjugates, applied together with the division.
+    const __m128 scale = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), blocks.Determinant());
+    const __m128 x_scaled = _mm_mul_ps(x, scale);
+    const __m128 y_scaled = _mm_mul_ps(y, scale);
+    const __m128 z_scaled = _mm_mul_ps(z, scale);
+    const __m128 w_scaled = _mm_mul_ps(w, scale);
+
+    _mm_storeu_ps(out, RAPTOR_SHUFFLE(x_scaled, y_scaled, 3, 1, 3, 1));
+    _mm_storeu_ps(out + 4, RAPTOR_SHUFFLE(x_scaled, y_scaled, 2, 0, 2, 0));
+    _mm_storeu_ps(out + 8, RAPTOR_SHUFFLE(z_scaled, w_scaled, 3, 1, 3, 1));
+    _mm_storeu_ps(out + 12, RAPTOR_SHUFFLE(z_scaled, w_scaled, 2, 0, 2, 0));
+}
+
+inline __m128 Vec3Cross(__m128 a, __m128 b)
+{
+    const __m128 a_yzx = RAPTOR_SWIZZLE(a, 1, 2, 0, 3);
+    const __m128 b_yzx = RAPTOR_SWIZZLE(b, 1, 2, 0, 3);
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+    return RAPTOR_SWIZZLE(c, 1, 2, 0, 3);
+}
+
+inline void Mat4InverseAffine(const float* m, float* out)
+{
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 translation = _mm_loadu_ps(m + 12);
+
+    // Rows of the inverse 3x3, w stays 0 as long as the w of the columns is 0.
+    __m128 r0 = Vec3Cross(c1, c2);
+    __m128 r1 = Vec3Cross(c2, c0);
+    __m128 r2 = Vec3Cross(c0, c1);
+
+    __m128 determinant = _mm_mul_ps(c0, r0);
+    determinant = _mm_add_ps(determinant, RAPTOR_SWIZZLE(determinant, 1, 0, 3, 2));
+    determinant = _mm_add_ps(determinant, RAPTOR_SWIZZLE(determinant, 2, 3, 0, 1));
+    const __m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.f), determinant);
+
+    r0 = _mm_mul_ps(r0, inverse_determinant);
+    r1 = _mm_mul_ps(r1, inverse_determinant);
+    r2 = _mm_mul_ps(r2, inverse_determinant);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    __m128 inverse_translation = _mm_mul_ps(r0, RAPTOR_SWIZZLE(translation, 0, 0, 0, 0));
+    inverse_translation = Mat4MultiplyAdd(r1, RAPTOR_SWIZZLE(translation, 1, 1, 1, 1), inverse_translation);
+    inverse_translation = Mat4MultiplyAdd(r2, RAPTOR_SWIZZLE(translation, 2, 2, 2, 2), inverse_translation);
+    inverse_translation = _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), inverse_translation);
+
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, inverse_translation);
+}
+
+#undef RAPTOR_SHUFFLE
+#undef RAPTOR_SWIZZLE
+#undef RAPTOR_SHUFFLE_MASK
+
+#elif defined(RAPTOR_MATH_NEON)
+
+// NEON ------------------------------------------------------------------------
+// Multiply and transpose only, the inverse and determinant stay scalar.
+
+inline void Mat4Multiply(const float* a, const float* b, float* out)
+{
+    const float32x4_t a0 = vld1q_f32(a);
+    const float32x4_t a1 = vld1q_f32(a + 4);
+    const float32x4_t a2 = vld1q_f32(a + 8);
+    const float32x4_t a3 = vld1q_f32(a + 12);
+
+    for (uint32 i = 0; i < 16; i += 4)
+    {
+        const float32x4_t column = vld1q_f32(b + i);
+        float32x4_t result = vmulq_laneq_f32(a0, column, 0);
+        result = vfmaq_laneq_f32(result, a1, column, 1);
+        result = vfmaq_laneq_f32(result, a2, column, 2);
+        result = vfmaq_laneq_f32(result, a3, column, 3);
+        vst1q_f32(out + i, result);
+    }
+}
+
+inline void Mat4Transpose(const float* m, float* out)
+{
+    // De-interleaving load, lane i of each register comes from row i.
+    const float32x4x4_t columns = vld4q_f32(m);
+    vst1q_f32(out, columns.val[0]);
+    vst1q_f32(out + 4, columns.val[1]);
+    vst1q_f32(out + 8, columns.val[2]);
+    vst1q_f32(out + 12, columns.val[3]);
+}
+
+#endif
+
+} // namespace Math
+} // namespace Raptor
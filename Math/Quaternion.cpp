@@ -0,0 +1,127 @@
+#include "Quaternion.h"
+#include "Matrix.h"
+#include "Quaternion.inl"
+#include <math.h>
+
+namespace Raptor
+{
+namespace Math
+{
+
+template<typename T>
+quat<T>* quat<T>::Identity()
+{
+    x = y = z = static_cast<T>(0);
+    w = static_cast<T>(1);
+    return this;
+}
+
+template<typename T>
+quat<T>* quat<T>::FromAxisAngle(const vec3<T>& axis, T angle)
+{
+    const T s = (T)sin(angle * T(0.5)) / axis.Length();
+    x = axis.x * s;
+    y = axis.y * s;
+    z = axis.z * s;
+    w = (T)cos(angle * T(0.5));
+    return this;
+}
+
+// Shepperd's method, the square root is taken of the largest of the four
+// candidates so the divisions stay well conditioned.
+template<typename T>
+quat<T>* quat<T>::FromMatrix(const mat4<T>& m)
+{
+    // Row r, column c is m.m[c][r].
+    const T r00 = m._11, r10 = m._12, r20 = m._13;
+    const T r01 = m._21, r11 = m._22, r21 = m._23;
+    const T r02 = m._31, r12 = m._32, r22 = m._33;
+
+    const T trace = r00 + r11 + r22;
+    if (trace > 0)
+    {
+        const T s = (T)sqrt(trace + T(1)) * T(2);
+        x = (r21 - r12) / s;
+        y = (r02 - r20) / s;
+        z = (r10 - r01) / s;
+        w = s * T(0.25);
+    }
+    else if (r00 > r11 && r00 > r22)
+    {
+        const T s = (T)sqrt(T(1) + r00 - r11 - r22) * T(2);
+        x = s * T(0.25);
+        y = (r01 + r10) / s;
+        z = (r02 + r20) / s;
+        w = (r21 - r12) / s;
+    }
+    else if (r11 > r22)
+    {
+        const T s = (T)sqrt(T(1) + r11 - r00 - r22) * T(2);
+        x = (r01 + r10) / s;
+        y = s * T(0.25);
+        z = (r12 + r21) / s;
+        w = (r02 - r20) / s;
+    }
+    else
+    {
+        const T s = (T)sqrt(T(1) + r22 - r00 - r11) * T(2);
+        x = (r02 + r20) / s;
+        y = (r12 + r21) / s;
+        z = s * T(0.25);
+        w = (r10 - r01) / s;
+    }
+
+    return this;
+}
+
+template<typename T>
+T quat<T>::Length() const
+{
+    return (T)sqrt(x * x + y * y + z * z + w * w);
+}
+
+template<typename T>
+quat<T>& quat<T>::Normalize()
+{
+    const T n = T(1) / Length();
+
+    x *= n;
+    y *= n;
+    z *= n;
+    w *= n;
+
+    return *this;
+}
+
+template<typename T>
+quat<T> nlerp(const quat<T>& a, const quat<T>& b, T t)
+{
+    const T ta = T(1) - t;
+    const T tb = dot(a, b) < 0 ? -t : t;
+
+    quat<T> result(a.x * ta + b.x * tb, a.y * ta + b.y * tb, a.z * ta + b.z * tb, a.w * ta + b.w * tb);
+    result.Normalize();
+    return result;
+}
+
+template<typename T>
+quat<T> slerp(const quat<T>& a, const quat<T>& b, T t)
+{
+    T cos_angle = dot(a, b);
+    const T sign = cos_angle < 0 ? T(-1) : T(1);
+    cos_angle *= sign;
+
+    // Nearly parallel, the sine below would divide by almost zero.
+    if (cos_angle > T(0.9995))
+        return nlerp(a, b, t);
+
+    const T angle = (T)acos(cos_angle);
+    const T inv_sin = T(1) / (T)sin(angle);
+    const T ta = (T)sin((T(1) - t) * angle) * inv_sin;
+    const T tb = (T)sin(t * angle) * inv_sin * sign;
+
+    return quat<T>(a.x * ta + b.x * tb, a.y * ta + b.y * tb, a.z * ta + b.z * tb, a.w * ta + b.w * tb);
+}
+
+} // namespace Math
+} // namespace Raptor
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Vector.h"
+
+namespace Raptor
+{
+namespace Math
+{
+
+template<typename T> class mat4;
+
+// Rotation as (x, y, z, w) with w the real part, the order glTF uses.
+// Rotations are expected to be of unit length, Normalize after long chains
+// of products.
+template<typename T>
+class alignas(VEC4_ALIGNMENT<T>) quat
+{
+public:
+    constexpr quat() : x(0), y(0), z(0), w(1) {}
+    constexpr quat(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+    constexpr explicit quat(const vec4<T>& v) : x(v.x), y(v.y), z(v.z), w(v.w) {}
+
+    T operator [] (int i) const { return v[i]; }
+    T &operator [] (int i) { return v[i]; }
+
+    quat<T>* Identity();
+    quat<T>* FromAxisAngle(const vec3<T>& axis, T angle);
+    // The upper 3x3 of the matrix has to be a rotation, without scale.
+    quat<T>* FromMatrix(const mat4<T>& m);
+
+    T Length() const;
+    quat<T>& Normalize();
+
+    constexpr quat<T> Conjugate() const { return quat<T>(-x, -y, -z, w); }
+    // Same as the conjugate for unit rotations.
+    constexpr quat<T> Inverse() const
+    {
+        const T inv = T(1) / (x * x + y * y + z * z + w * w);
+        return quat<T>(-x * inv, -y * inv, -z * inv, w * inv);
+    }
+
+    union
+    {
+        T v[4];
+        struct { T x, y, z, w; };
+    };
+
+}; // class quat
+
+// Rotation by rhs followed by lhs.
+template<typename T>
+constexpr quat<T> operator * (const quat<T>& lhs, const quat<T>& rhs)
+{
+    return quat<T>(lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+                   lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+                   lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+                   lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z);
+}
+
+// Rotates v.
+template<typename T>
+constexpr vec3<T> operator * (const quat<T>& q, const vec3<T>& v)
+{
+    const vec3<T> u(q.x, q.y, q.z);
+    const vec3<T> t = cross(u, v) * T(2);
+    return v + t * q.w + cross(u, t);
+}
+
+template<typename T> constexpr T dot(const quat<T>& a, const quat<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// Both take the shorter way around. nlerp is cheaper and is close to slerp
+// for the small steps between animation keys, its speed is not constant.
+template<typename T> quat<T> nlerp(const quat<T>& a, const quat<T>& b, T t);
+template<typename T> quat<T> slerp(const quat<T>& a, const quat<T>& b, T t);
+
+typedef quat<float>  quatf;
+typedef quat<double> quatd;
+
+static_assert(std::is_trivially_copyable_v<quatf> && std::is_standard_layout_v<quatf>, "quat has to stay a plain value.");
+static_assert(sizeof(quatf) == 16 && alignof(quatf) == 16, "quatf has to match a SIMD register.");
+
+} // namespace Math
+} // namespace Raptor
@@ -0,0 +1,26 @@
+#include "Quaternion.h"
+
+namespace Raptor
+{
+namespace Math
+{
+
+template quat<float>* quat<float>::Identity();
+template quat<float>* quat<float>::FromAxisAngle(const vec3<float>& axis, float angle);
+template quat<float>* quat<float>::FromMatrix(const mat4<float>& m);
+template float quat<float>::Length() const;
+template quat<float>& quat<float>::Normalize();
+
+template quat<double>* quat<double>::Identity();
+template quat<double>* quat<double>::FromAxisAngle(const vec3<double>& axis, double angle);
+template quat<double>* quat<double>::FromMatrix(const mat4<double>& m);
+template double quat<double>::Length() const;
+template quat<double>& quat<double>::Normalize();
+
+template quat<float>  nlerp(const quat<float>& a, const quat<float>& b, float t);
+template quat<double> nlerp(const quat<double>& a, const quat<double>& b, double t);
+template quat<float>  slerp(const quat<float>& a, const quat<float>& b, float t);
+template quat<double> slerp(const quat<double>& a, const quat<double>& b, double t);
+
+} // namespace Math
+} // namespace Raptor
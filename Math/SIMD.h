@@ -0,0 +1,27 @@
+#pragma once
+
+// Instruction sets the Math kernels use, picked from the compiler target.
+// Defining RAPTOR_MATH_SCALAR before including Math headers turns them off.
+#if !defined(RAPTOR_MATH_SCALAR)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAPTOR_MATH_SSE 1
+#include <immintrin.h>
+#if defined(__AVX__)
+#define RAPTOR_MATH_AVX 1
+#endif
+#if defined(__FMA__)
+#define RAPTOR_MATH_FMA 1
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define RAPTOR_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+#endif
+
+#if defined(RAPTOR_MATH_SSE) || defined(RAPTOR_MATH_NEON)
+#define RAPTOR_MATH_SIMD 1
+#else
+#define RAPTOR_MATH_SIMD 0
+#endif
@@ -0,0 +1,617 @@
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "Bounds.h"
+#include "TransformBatch.h"
+#include "TransformBatchKernels.h"
+#include "SIMD.h"
+
+#if defined(_MSC_VER) && defined(RAPTOR_MATH_SSE)
+#include <intrin.h>
+#endif
+
+namespace Raptor
+{
+namespace Math
+{
+
+// Scalar ----------------------------------------------------------------------
+
+template<bool POINTS>
+static inline void TransformOneScalar(const float* m, float x, float y, float z, float& out_x, float& out_y, float& out_z)
+{
+    out_x = m[0] * x + m[4] * y + m[8] * z + (POINTS ? m[12] : 0.f);
+    out_y = m[1] * x + m[5] * y + m[9] * z + (POINTS ? m[13] : 0.f);
+    out_z = m[2] * x + m[6] * y + m[10] * z + (POINTS ? m[14] : 0.f);
+}
+
+template<bool POINTS>
+static void TransformScalar(const float* m, const float* in, float* out, sizet count)
+{
+    for (sizet i = 0; i < count * 3; i += 3)
+        TransformOneScalar<POINTS>(m, in[i], in[i + 1], in[i + 2], out[i], out[i + 1], out[i + 2]);
+}
+
+static void TransformPoints4Scalar(const float* m, const float* in, float* out, sizet count)
+{
+    for (sizet i = 0; i < count * 4; i += 4)
+    {
+        const float x = in[i], y = in[i + 1], z = in[i + 2], w = in[i + 3];
+        for (uint32 j = 0; j < 4; j++)
+            out[i + j] = m[j] * x + m[4 + j] * y + m[8 + j] * z + m[12 + j] * w;
+    }
+}
+
+template<bool POINTS>
+static void TransformSoAScalar(const float* m, const float* in_x, const float* in_y, const float* in_z,
+                               float* out_x, float* out_y, float* out_z, sizet count)
+{
+    for (sizet i = 0; i < count; i++)
+        TransformOneScalar<POINTS>(m, in_x[i], in_y[i], in_z[i], out_x[i], out_y[i], out_z[i]);
+}
+
+template<bool POINTS>
+static void TransformIndexedScalar(const float* matrices, const uint32* matrix_indices, const float* in, float* out, sizet count)
+{
+    for (sizet i = 0; i < count; i++)
+    {
+        const float* m = matrices + (sizet)matrix_indices[i] * 16;
+        TransformOneScalar<POINTS>(m, in[i * 3], in[i * 3 + 1], in[i * 3 + 2], out[i * 3], out[i * 3 + 1], out[i * 3 + 2]);
+    }
+}
+
+// Same result as Transform::CalcMatrix: the rotation of q with its columns
+// scaled, and the translation as the last column.
+void ComposeMatricesScalar(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                           const float* translations, sizet translation_stride, float* out, sizet count)
+{
+    for (sizet i = 0; i < count; i++, out += 16)
+    {
+        const float* s = scales + i * scale_stride;
+        const float* q = rotations + i * rotation_stride;
+        const float* t = translations + i * translation_stride;
+
+        const float x2 = q[0] + q[0], y2 = q[1] + q[1], z2 = q[2] + q[2];
+        const float xx = q[0] * x2, yy = q[1] * y2, zz = q[2] * z2;
+        const float xy = q[0] * y2, xz = q[0] * z2, yz = q[1] * z2;
+        const float wx = q[3] * x2, wy = q[3] * y2, wz = q[3] * z2;
+
+        out[0] = (1.f - yy - zz) * s[0];
+        out[1] = (xy + wz) * s[0];
+        out[2] = (xz - wy) * s[0];
+        out[3] = 0.f;
+
+        out[4] = (xy - wz) * s[1];
+        out[5] = (1.f - xx - zz) * s[1];
+        out[6] = (yz + wx) * s[1];
+        out[7] = 0.f;
+
+        out[8] = (xz + wy) * s[2];
+        out[9] = (yz - wx) * s[2];
+        out[10] = (1.f - xx - yy) * s[2];
+        out[11] = 0.f;
+
+        out[12] = t[0];
+        out[13] = t[1];
+        out[14] = t[2];
+        out[15] = 1.f;
+    }
+}
+
+// A box is outside when even its corner furthest along the normal is behind
+// one of the planes. Works on twice the center and twice the extents, like
+// the SIMD versions.
+sizet CullAABBsScalar(const float* planes, const float* boxes, sizet begin, sizet end, uint32* visible_indices)
+{
+    sizet visible = 0;
+    for (sizet i = begin; i < end; i++)
+    {
+        const float* box = boxes + i * 6;
+        const float cx = box[0] + box[3], cy = box[1] + box[4], cz = box[2] + box[5];
+        const float ex = box[3] - box[0], ey = box[4] - box[1], ez = box[5] - box[2];
+
+        bool inside = true;
+        for (uint32 p = 0; p < 6; p++)
+        {
+            const float* plane = planes + p * 4;
+            const float distance = plane[0] * cx + plane[1] * cy + plane[2] * cz + fabsf(plane[0]) * ex + fabsf(plane[1]) * ey + fabsf(plane[2]) * ez + 2.f * plane[3];
+            inside &= distance >= 0.f;
+        }
+
+        // Always written, only kept when visible.
+        visible_indices[visible] = (uint32)i;
+        visible += inside;
+    }
+
+    return visible;
+}
+
+static sizet CullAABBsScalarAll(const float* planes, const float* boxes, sizet count, uint32* visible_indices)
+{
+    return CullAABBsScalar(planes, boxes, 0, count, visible_indices);
+}
+
+static const TransformBatchKernels s_kernels_scalar =
+{
+    TransformScalar<true>,
+    TransformScalar<false>,
+    TransformPoints4Scalar,
+    TransformSoAScalar<true>,
+    TransformSoAScalar<false>,
+    TransformIndexedScalar<true>,
+    TransformIndexedScalar<false>,
+    ComposeMatricesScalar,
+    CullAABBsScalarAll,
+};
+
+#if defined(RAPTOR_MATH_SSE)
+
+// SSE -------------------------------------------------------------------------
+
+// Four packed vec3 to one register per component and back.
+static inline void LoadVec3x4(const float* p, __m128& x, __m128& y, __m128& z)
+{
+    const __m128 m0 = _mm_loadu_ps(p);     // x0 y0 z0 x1
+    const __m128 m1 = _mm_loadu_ps(p + 4); // y1 z1 x2 y2
+    const __m128 m2 = _mm_loadu_ps(p + 8); // z2 x3 y3 z3
+
+    const __m128 xy = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m128 yz = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+static inline void StoreVec3x4(float* p, __m128 x, __m128 y, __m128 z)
+{
+    const __m128 xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_ps(p, _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+// Every element of the upper 3 rows in its own register, c[column][row].
+static inline void SplatMatrix(const float* m, __m128 (&c)[4][3])
+{
+    for (uint32 k = 0; k < 4; k++)
+    {
+        for (uint32 j = 0; j < 3; j++)
+            c[k][j] = _mm_set1_ps(m[k * 4 + j]);
+    }
+}
+
+template<bool POINTS>
+static inline void TransformSoASSE(const __m128 (&c)[4][3], __m128 x, __m128 y, __m128 z, __m128& out_x, __m128& out_y, __m128& out_z)
+{
+    __m128 r[3];
+    for (uint32 j = 0; j < 3; j++)
+    {
+        r[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0][j], x), _mm_mul_ps(c[1][j], y)), _mm_mul_ps(c[2][j], z));
+        if constexpr (POINTS)
+            r[j] = _mm_add_ps(r[j], c[3][j]);
+    }
+    out_x = r[0];
+    out_y = r[1];
+    out_z = r[2];
+}
+
+template<bool POINTS>
+static void TransformSSE(const float* m, const float* in, float* out, sizet count)
+{
+    __m128 c[4][3];
+    SplatMatrix(m, c);
+
+    sizet i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        LoadVec3x4(in + i * 3, x, y, z);
+        TransformSoASSE<POINTS>(c, x, y, z, x, y, z);
+        StoreVec3x4(out + i * 3, x, y, z);
+    }
+
+    if (i < count)
+    {
+        // The last vectors go through a full block on the stack.
+        float tail[12] = {};
+        memcpy(tail, in + i * 3, (count - i) * 3 * sizeof(float));
+        __m128 x, y, z;
+        LoadVec3x4(tail, x, y, z);
+        TransformSoASSE<POINTS>(c, x, y, z, x, y, z);
+        StoreVec3x4(tail, x, y, z);
+        memcpy(out + i * 3, tail, (count - i) * 3 * sizeof(float));
+    }
+}
+
+static void TransformPoints4SSE(const float* m, const float* in, float* out, sizet count)
+{
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+
+    for (sizet i = 0; i < count * 4; i += 4)
+    {
+        const __m128 v = _mm_loadu_ps(in + i);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xaa)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xff)));
+        _mm_storeu_ps(out + i, r);
+    }
+}
+
+template<bool POINTS>
+static void TransformSoASSE(const float* m, const float* in_x, const float* in_y, const float* in_z,
+                            float* out_x, float* out_y, float* out_z, sizet count)
+{
+    __m128 c[4][3];
+    SplatMatrix(m, c);
+
+    sizet i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        TransformSoASSE<POINTS>(c, _mm_loadu_ps(in_x + i), _mm_loadu_ps(in_y + i), _mm_loadu_ps(in_z + i), x, y, z);
+        _mm_storeu_ps(out_x + i, x);
+        _mm_storeu_ps(out_y + i, y);
+        _mm_storeu_ps(out_z + i, z);
+    }
+
+    for (; i < count; i++)
+        TransformOneScalar<POINTS>(m, in_x[i], in_y[i], in_z[i], out_x[i], out_y[i], out_z[i]);
+}
+
+template<bool POINTS>
+static void TransformIndexedSSE(const float* matrices, const uint32* matrix_indices, const float* in, float* out, sizet count)
+{
+    uint32 loaded = matrix_indices[0] + 1;
+    __m128 c0 = _mm_setzero_ps(), c1 = c0, c2 = c0, c3 = c0;
+
+    for (sizet i = 0; i < count; i++)
+    {
+        if (matrix_indices[i] != loaded)
+        {
+            loaded = matrix_indices[i];
+            const float* m = matrices + (sizet)loaded * 16;
+            c0 = _mm_loadu_ps(m);
+            c1 = _mm_loadu_ps(m + 4);
+            c2 = _mm_loadu_ps(m + 8);
+            c3 = _mm_loadu_ps(m + 12);
+        }
+
+        const float* p = in + i * 3;
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(p[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+        if constexpr (POINTS)
+            r = _mm_add_ps(r, c3);
+
+        // Three floats only, a full store would reach into the next input when transforming in place.
+        _mm_storel_pi((__m64*)(out + i * 3), r);
+        _mm_store_ss(out + i * 3 + 2, _mm_movehl_ps(r, r));
+    }
+}
+
+// Component j of the same column of four matrices in r[j], transposed and
+// stored to that column of each matrix.
+static inline void StoreColumnsSSE(float* column, __m128 r0, __m128 r1, __m128 r2, __m128 r3)
+{
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(column, r0);
+    _mm_storeu_ps(column + 16, r1);
+    _mm_storeu_ps(column + 32, r2);
+    _mm_storeu_ps(column + 48, r3);
+}
+
+// Four matrices per iteration, the quaternion math runs on one register per
+// component. The columns are transposed and stored one at a time, which keeps
+// the registers from spilling. Scales and translations are read 4 floats at a
+// time, so the last element always goes through the scalar version to not
+// read past the arrays. When streaming, a block is built in a buffer first so
+// that each line is streamed whole.
+template<bool STREAM>
+static void ComposeMatricesSSE(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                               const float* translations, sizet translation_stride, float* out, sizet count)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 w_one = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+    alignas(16) float block[4 * 16];
+
+    sizet i = 0;
+    for (; i + 4 < count; i += 4)
+    {
+        __m128 qx = _mm_loadu_ps(rotations + i * rotation_stride);
+        __m128 qy = _mm_loadu_ps(rotations + (i + 1) * rotation_stride);
+        __m128 qz = _mm_loadu_ps(rotations + (i + 2) * rotation_stride);
+        __m128 qw = _mm_loadu_ps(rotations + (i + 3) * rotation_stride);
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+        __m128 sx = _mm_loadu_ps(scales + i * scale_stride);
+        __m128 sy = _mm_loadu_ps(scales + (i + 1) * scale_stride);
+        __m128 sz = _mm_loadu_ps(scales + (i + 2) * scale_stride);
+        __m128 sw = _mm_loadu_ps(scales + (i + 3) * scale_stride);
+        _MM_TRANSPOSE4_PS(sx, sy, sz, sw);
+
+        const __m128 x2 = _mm_add_ps(qx, qx), y2 = _mm_add_ps(qy, qy), z2 = _mm_add_ps(qz, qz);
+        const __m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+        const __m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+        const __m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+
+        float* matrix = STREAM ? block : out + i * 16;
+        StoreColumnsSSE(matrix, _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+                        _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero);
+        StoreColumnsSSE(matrix + 4, _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+                        _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero);
+        StoreColumnsSSE(matrix + 8, _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+                        _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero);
+
+        // Translations are one per register already, they only need their w.
+        for (uint32 n = 0; n < 4; n++)
+        {
+            const __m128 t = _mm_loadu_ps(translations + (i + n) * translation_stride);
+            _mm_storeu_ps(matrix + n * 16 + 12, _mm_or_ps(_mm_and_ps(t, xyz_mask), w_one));
+        }
+
+        if constexpr (STREAM)
+        {
+            for (sizet n = 0; n < 4 * 16; n += 4)
+                _mm_stream_ps(out + i * 16 + n, _mm_load_ps(block + n));
+        }
+    }
+
+    if constexpr (STREAM)
+        _mm_sfence();
+
+    ComposeMatricesScalar(scales + i * scale_stride, scale_stride, rotations + i * rotation_stride, rotation_stride,
+                          translations + i * translation_stride, translation_stride, out + i * 16, count - i);
+}
+
+static void ComposeMatricesSSE(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                               const float* translations, sizet translation_stride, float* out, sizet count)
+{
+    if (UseStreamingStores(out, count))
+        ComposeMatricesSSE<true>(scales, scale_stride, rotations, rotation_stride, translations, translation_stride, out, count);
+    else
+        ComposeMatricesSSE<false>(scales, scale_stride, rotations, rotation_stride, translations, translation_stride, out, count);
+}
+
+// Four boxes per iteration, read as eight vec3: min and max of each.
+static sizet CullAABBsSSE(const float* planes, const float* boxes, sizet count, uint32* visible_indices)
+{
+    // Normal, absolute normal and twice the distance of each plane, splat.
+    __m128 normals[6][3], abs_normals[6][3], distances[6];
+    const __m128 sign = _mm_set1_ps(-0.f);
+    for (uint32 p = 0; p < 6; p++)
+    {
+        for (uint32 j = 0; j < 3; j++)
+        {
+            normals[p][j] = _mm_set1_ps(planes[p * 4 + j]);
+            abs_normals[p][j] = _mm_andnot_ps(sign, normals[p][j]);
+        }
+        distances[p] = _mm_set1_ps(2.f * planes[p * 4 + 3]);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    sizet visible = 0;
+    sizet i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x01, y01, z01, x23, y23, z23;
+        LoadVec3x4(boxes + i * 6, x01, y01, z01);
+        LoadVec3x4(boxes + i * 6 + 12, x23, y23, z23);
+
+        // Mins are the even vectors, maxs the odd ones.
+        const __m128 min_x = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(2, 0, 2, 0)), max_x = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 min_y = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 2, 0)), max_y = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 min_z = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0)), max_z = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m128 cx = _mm_add_ps(min_x, max_x), cy = _mm_add_ps(min_y, max_y), cz = _mm_add_ps(min_z, max_z);
+        const __m128 ex = _mm_sub_ps(max_x, min_x), ey = _mm_sub_ps(max_y, min_y), ez = _mm_sub_ps(max_z, min_z);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (uint32 p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(normals[p][0], cx), _mm_mul_ps(normals[p][1], cy));
+            distance = _mm_add_ps(distance, _mm_mul_ps(normals[p][2], cz));
+            distance = _mm_add_ps(distance, _mm_mul_ps(abs_normals[p][0], ex));
+            distance = _mm_add_ps(distance, _mm_mul_ps(abs_normals[p][1], ey));
+            distance = _mm_add_ps(distance, _mm_mul_ps(abs_normals[p][2], ez));
+            distance = _mm_add_ps(distance, distances[p]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+        }
+
+        const uint32 mask = (uint32)_mm_movemask_ps(inside);
+        for (uint32 n = 0; n < 4; n++)
+        {
+            visible_indices[visible] = (uint32)(i + n);
+            visible += (mask >> n) & 1;
+        }
+    }
+
+    return visible + CullAABBsScalar(planes, boxes, i, count, visible_indices + visible);
+}
+
+static const TransformBatchKernels s_kernels_sse =
+{
+    TransformSSE<true>,
+    TransformSSE<false>,
+    TransformPoints4SSE,
+    TransformSoASSE<true>,
+    TransformSoASSE<false>,
+    TransformIndexedSSE<true>,
+    TransformIndexedSSE<false>,
+    ComposeMatricesSSE,
+    CullAABBsSSE,
+};
+
+static bool CPUSupportsAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // FMA, and AVX with its registers saved by the OS.
+    __cpuid(info, 1);
+    const int fma_osxsave_avx = (1 << 12) | (1 << 27) | (1 << 28);
+    if ((info[2] & fma_osxsave_avx) != fma_osxsave_avx || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif // RAPTOR_MATH_SSE
+
+// Dispatch --------------------------------------------------------------------
+
+static std::atomic<const TransformBatchKernels*> s_kernels {nullptr};
+static std::atomic<SIMDLevel> s_level {SIMDLevel::Max};
+
+static SIMDLevel DetectSIMDLevel()
+{
+#if defined(RAPTOR_MATH_SSE)
+    if (GetTransformBatchKernelsAVX2() && CPUSupportsAVX2())
+        return SIMDLevel::AVX2;
+    return SIMDLevel::SSE;
+#else
+    return SIMDLevel::Scalar;
+#endif
+}
+
+static const TransformBatchKernels* KernelsFor(SIMDLevel level)
+{
+    switch (level)
+    {
+        case SIMDLevel::AVX2:
+            return GetTransformBatchKernelsAVX2();
+#if defined(RAPTOR_MATH_SSE)
+        case SIMDLevel::SSE:
+            return &s_kernels_sse;
+#endif
+        default:
+            return &s_kernels_scalar;
+    }
+}
+
+static const TransformBatchKernels* Kernels()
+{
+    const TransformBatchKernels* kernels = s_kernels.load(std::memory_order_acquire);
+    if (kernels)
+        return kernels;
+
+    SetSIMDLevel(SIMDLevel::Max);
+    return s_kernels.load(std::memory_order_acquire);
+}
+
+const char* ToString(SIMDLevel level)
+{
+    static const char* s_names[] = {"Scalar", "SSE", "AVX2", "Max"};
+    return s_names[(uint8)level];
+}
+
+SIMDLevel GetSupportedSIMDLevel()
+{
+    static const SIMDLevel s_supported = DetectSIMDLevel();
+    return s_supported;
+}
+
+SIMDLevel GetSIMDLevel()
+{
+    Kernels();
+    return s_level.load(std::memory_order_relaxed);
+}
+
+void SetSIMDLevel(SIMDLevel level)
+{
+    const SIMDLevel supported = GetSupportedSIMDLevel();
+    if (level > supported)
+        level = supported;
+
+    s_level.store(level, std::memory_order_relaxed);
+    s_kernels.store(KernelsFor(level), std::memory_order_release);
+}
+
+// One matrix ------------------------------------------------------------------
+
+void TransformPoints(const mat4f& m, const vec3f* in, vec3f* out, sizet count)
+{
+    Kernels()->transform_points(m.i, (const float*)in, (float*)out, count);
+}
+
+void TransformVectors(const mat4f& m, const vec3f* in, vec3f* out, sizet count)
+{
+    Kernels()->transform_vectors(m.i, (const float*)in, (float*)out, count);
+}
+
+void TransformPoints(const mat4f& m, const vec4f* in, vec4f* out, sizet count)
+{
+    Kernels()->transform_points4(m.i, (const float*)in, (float*)out, count);
+}
+
+void TransformPoints(const mat4f& m, const Vec3SoA& in, const Vec3SoA& out, sizet count)
+{
+    Kernels()->transform_points_soa(m.i, in.x, in.y, in.z, out.x, out.y, out.z, count);
+}
+
+void TransformVectors(const mat4f& m, const Vec3SoA& in, const Vec3SoA& out, sizet count)
+{
+    Kernels()->transform_vectors_soa(m.i, in.x, in.y, in.z, out.x, out.y, out.z, count);
+}
+
+// One matrix per element ------------------------------------------------------
+
+void TransformPoints(const mat4f* matrices, const uint32* matrix_indices, const vec3f* in, vec3f* out, sizet count)
+{
+    if (count)
+        Kernels()->transform_points_indexed((const float*)matrices, matrix_indices, (const float*)in, (float*)out, count);
+}
+
+void TransformVectors(const mat4f* matrices, const uint32* matrix_indices, const vec3f* in, vec3f* out, sizet count)
+{
+    if (count)
+        Kernels()->transform_vectors_indexed((const float*)matrices, matrix_indices, (const float*)in, (float*)out, count);
+}
+
+// Transform -------------------------------------------------------------------
+
+static_assert(offsetof(Transform, scale) == 0 && offsetof(Transform, rotation) == 16 && offsetof(Transform, translation) == 32 && sizeof(Transform) == 48,
+              "CalcMatrices reads Transform as three strided arrays.");
+
+void Transform::CalcMatrices(const Transform* transforms, mat4f* out, sizet count)
+{
+    const float* data = (const float*)transforms;
+    const sizet stride = sizeof(Transform) / sizeof(float);
+    Kernels()->compose_matrices(data, stride, data + 4, stride, data + 8, stride, (float*)out, count);
+}
+
+void Transform::CalcMatrices(const vec3f* scales, const quatf* rotations, const vec3f* translations, mat4f* out, sizet count)
+{
+    Kernels()->compose_matrices((const float*)scales, 3, (const float*)rotations, 4, (const float*)translations, 3, (float*)out, count);
+}
+
+// Culling ---------------------------------------------------------------------
+
+static_assert(sizeof(Frustum::planes) == 6 * 4 * sizeof(float), "The cull kernels read the planes as 6 vec4.");
+
+uint32 CullAABBs(const Frustum& frustum, const AABB* boxes, uint32 count, uint32* visible_indices)
+{
+    return (uint32)Kernels()->cull_aabbs((const float*)frustum.planes, (const float*)boxes, count, visible_indices);
+}
+
+} // namespace Math
+} // namespace Raptor
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Matrix.h"
+#include "Types.h"
+#include "Vector.h"
+
+namespace Raptor
+{
+namespace Math
+{
+
+// Transforms whole arrays of points and directions, for bounds of mesh
+// accessors, CPU skinning and culling. Matrices are in mat4 layout, points
+// take the translation and directions don't. Nothing is normalized, normals
+// need the inverse transpose of the matrix and a normalize afterwards when
+// it scales.
+//
+// The kernels are picked at runtime from what the CPU supports: AVX2 + FMA,
+// SSE or scalar. Input and output arrays may be the same, otherwise they
+// may not overlap. None of the functions allocates.
+
+enum class SIMDLevel : uint8
+{
+    Scalar, SSE, AVX2, Max
+};
+
+const char* ToString(SIMDLevel level);
+
+// Best level of both the CPU and the build.
+SIMDLevel GetSupportedSIMDLevel();
+// Level the batch functions run at, the supported one unless overridden.
+SIMDLevel GetSIMDLevel();
+// Forces a lower level, for benchmarks and for comparing the paths. Clamped
+// to the supported level, Max goes back to it. Not meant to be called while
+// other threads transform.
+void SetSIMDLevel(SIMDLevel level);
+
+// Three separate streams of floats, one per component.
+struct Vec3SoA
+{
+    float* x;
+    float* y;
+    float* z;
+}; // struct Vec3SoA
+
+// One matrix ------------------------------------------------------------------
+
+void TransformPoints(const mat4f& m, const vec3f* in, vec3f* out, sizet count);
+void TransformVectors(const mat4f& m, const vec3f* in, vec3f* out, sizet count);
+// Full 4 component product, w of the input is used as it is.
+void TransformPoints(const mat4f& m, const vec4f* in, vec4f* out, sizet count);
+
+void TransformPoints(const mat4f& m, const Vec3SoA& in, const Vec3SoA& out, sizet count);
+void TransformVectors(const mat4f& m, const Vec3SoA& in, const Vec3SoA& out, sizet count);
+
+// One matrix per element ------------------------------------------------------
+
+// out[i] = matrices[matrix_indices[i]] * in[i]. Runs of the same index load
+// their matrix once.
+void TransformPoints(const mat4f* matrices, const uint32* matrix_indices, const vec3f* in, vec3f* out, sizet count);
+void TransformVectors(const mat4f* matrices, const uint32* matrix_indices, const vec3f* in, vec3f* out, sizet count);
+
+} // namespace Math
+} // namespace Raptor
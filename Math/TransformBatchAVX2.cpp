@@ -0,0 +1,388 @@
+#include <string.h>
+
+#include "SIMD.h"
+#include "TransformBatchKernels.h"
+
+// Built with AVX2 and FMA enabled, only called when the CPU has both.
+
+namespace Raptor
+{
+namespace Math
+{
+
+#if defined(__AVX2__)
+
+// Eight packed vec3 to one register per component and back, the 128-bit
+// halves hold vectors 0-3 and 4-7.
+static inline void LoadVec3x8(const float* p, __m256& x, __m256& y, __m256& z)
+{
+    __m256 m03 = _mm256_castps128_ps256(_mm_loadu_ps(p));
+    __m256 m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+    __m256 m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+    m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+    m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+    m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+
+    const __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+static inline void StoreVec3x8(float* p, __m256 x, __m256 y, __m256 z)
+{
+    const __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256 m03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 m14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256 m25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+
+    _mm_storeu_ps(p, _mm256_castps256_ps128(m03));
+    _mm_storeu_ps(p + 4, _mm256_castps256_ps128(m14));
+    _mm_storeu_ps(p + 8, _mm256_castps256_ps128(m25));
+    _mm_storeu_ps(p + 12, _mm256_extractf128_ps(m03, 1));
+    _mm_storeu_ps(p + 16, _mm256_extractf128_ps(m14, 1));
+    _mm_storeu_ps(p + 20, _mm256_extractf128_ps(m25, 1));
+}
+
+// Every element of the upper 3 rows in its own register, c[column][row].
+static inline void SplatMatrix(const float* m, __m256 (&c)[4][3])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        for (int j = 0; j < 3; j++)
+            c[k][j] = _mm256_broadcast_ss(m + k * 4 + j);
+    }
+}
+
+template<bool POINTS>
+static inline void TransformSoA(const __m256 (&c)[4][3], __m256 x, __m256 y, __m256 z, __m256& out_x, __m256& out_y, __m256& out_z)
+{
+    __m256 r[3];
+    for (int j = 0; j < 3; j++)
+    {
+        r[j] = POINTS ? _mm256_fmadd_ps(c[2][j], z, c[3][j]) : _mm256_mul_ps(c[2][j], z);
+        r[j] = _mm256_fmadd_ps(c[1][j], y, r[j]);
+        r[j] = _mm256_fmadd_ps(c[0][j], x, r[j]);
+    }
+    out_x = r[0];
+    out_y = r[1];
+    out_z = r[2];
+}
+
+template<bool POINTS>
+static void TransformAoS(const float* m, const float* in, float* out, sizet count)
+{
+    __m256 c[4][3];
+    SplatMatrix(m, c);
+
+    sizet i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z;
+        LoadVec3x8(in + i * 3, x, y, z);
+        TransformSoA<POINTS>(c, x, y, z, x, y, z);
+        StoreVec3x8(out + i * 3, x, y, z);
+    }
+
+    if (i < count)
+    {
+        // The last vectors go through a full block on the stack.
+        float tail[24] = {};
+        memcpy(tail, in + i * 3, (count - i) * 3 * sizeof(float));
+        __m256 x, y, z;
+        LoadVec3x8(tail, x, y, z);
+        TransformSoA<POINTS>(c, x, y, z, x, y, z);
+        StoreVec3x8(tail, x, y, z);
+        memcpy(out + i * 3, tail, (count - i) * 3 * sizeof(float));
+    }
+}
+
+static inline __m256 TransformPoints4x2(const __m256 (&c)[4], __m256 v)
+{
+    __m256 r = _mm256_mul_ps(c[0], _mm256_permute_ps(v, 0x00));
+    r = _mm256_fmadd_ps(c[1], _mm256_permute_ps(v, 0x55), r);
+    r = _mm256_fmadd_ps(c[2], _mm256_permute_ps(v, 0xaa), r);
+    return _mm256_fmadd_ps(c[3], _mm256_permute_ps(v, 0xff), r);
+}
+
+// Two vec4 per register, the columns repeat in both halves.
+static void TransformPoints4(const float* m, const float* in, float* out, sizet count)
+{
+    const __m256 c[4] =
+    {
+        _mm256_broadcast_ps((const __m128*)m),
+        _mm256_broadcast_ps((const __m128*)(m + 4)),
+        _mm256_broadcast_ps((const __m128*)(m + 8)),
+        _mm256_broadcast_ps((const __m128*)(m + 12)),
+    };
+
+    sizet i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m256 r0 = TransformPoints4x2(c, _mm256_loadu_ps(in + i * 4));
+        const __m256 r1 = TransformPoints4x2(c, _mm256_loadu_ps(in + i * 4 + 8));
+        _mm256_storeu_ps(out + i * 4, r0);
+        _mm256_storeu_ps(out + i * 4 + 8, r1);
+    }
+
+    for (; i < count; i++)
+    {
+        const __m256 r = TransformPoints4x2(c, _mm256_castps128_ps256(_mm_loadu_ps(in + i * 4)));
+        _mm_storeu_ps(out + i * 4, _mm256_castps256_ps128(r));
+    }
+}
+
+template<bool POINTS>
+static void TransformSoA(const float* m, const float* in_x, const float* in_y, const float* in_z,
+                         float* out_x, float* out_y, float* out_z, sizet count)
+{
+    __m256 c[4][3];
+    SplatMatrix(m, c);
+
+    sizet i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z;
+        TransformSoA<POINTS>(c, _mm256_loadu_ps(in_x + i), _mm256_loadu_ps(in_y + i), _mm256_loadu_ps(in_z + i), x, y, z);
+        _mm256_storeu_ps(out_x + i, x);
+        _mm256_storeu_ps(out_y + i, y);
+        _mm256_storeu_ps(out_z + i, z);
+    }
+
+    if (i < count)
+    {
+        // Masked loads and stores never touch the elements past count.
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(count - i)), lanes);
+
+        __m256 x, y, z;
+        TransformSoA<POINTS>(c, _mm256_maskload_ps(in_x + i, mask), _mm256_maskload_ps(in_y + i, mask), _mm256_maskload_ps(in_z + i, mask), x, y, z);
+        _mm256_maskstore_ps(out_x + i, mask, x);
+        _mm256_maskstore_ps(out_y + i, mask, y);
+        _mm256_maskstore_ps(out_z + i, mask, z);
+    }
+}
+
+template<bool POINTS>
+static void TransformIndexed(const float* matrices, const uint32* matrix_indices, const float* in, float* out, sizet count)
+{
+    uint32 loaded = matrix_indices[0] + 1;
+    __m128 c0 = _mm_setzero_ps(), c1 = c0, c2 = c0, c3 = c0;
+
+    for (sizet i = 0; i < count; i++)
+    {
+        if (matrix_indices[i] != loaded)
+        {
+            loaded = matrix_indices[i];
+            const float* m = matrices + (sizet)loaded * 16;
+            c0 = _mm_loadu_ps(m);
+            c1 = _mm_loadu_ps(m + 4);
+            c2 = _mm_loadu_ps(m + 8);
+            c3 = _mm_loadu_ps(m + 12);
+        }
+
+        const float* p = in + i * 3;
+        __m128 r = POINTS ? _mm_fmadd_ps(c2, _mm_broadcast_ss(p + 2), c3) : _mm_mul_ps(c2, _mm_broadcast_ss(p + 2));
+        r = _mm_fmadd_ps(c1, _mm_broadcast_ss(p + 1), r);
+        r = _mm_fmadd_ps(c0, _mm_broadcast_ss(p), r);
+
+        // Three floats only, a full store would reach into the next input when transforming in place.
+        _mm_storel_pi((__m64*)(out + i * 3), r);
+        _mm_store_ss(out + i * 3 + 2, _mm_movehl_ps(r, r));
+    }
+}
+
+// Transposes the 4x4 blocks of both 128-bit halves.
+static inline void Transpose4x4x2(__m256& a, __m256& b, __m256& c, __m256& d)
+{
+    const __m256 ab_lo = _mm256_unpacklo_ps(a, b);
+    const __m256 ab_hi = _mm256_unpackhi_ps(a, b);
+    const __m256 cd_lo = _mm256_unpacklo_ps(c, d);
+    const __m256 cd_hi = _mm256_unpackhi_ps(c, d);
+    a = _mm256_shuffle_ps(ab_lo, cd_lo, _MM_SHUFFLE(1, 0, 1, 0));
+    b = _mm256_shuffle_ps(ab_lo, cd_lo, _MM_SHUFFLE(3, 2, 3, 2));
+    c = _mm256_shuffle_ps(ab_hi, cd_hi, _MM_SHUFFLE(1, 0, 1, 0));
+    d = _mm256_shuffle_ps(ab_hi, cd_hi, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static inline __m256 Load4x2(const float* lo, const float* hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+// Component j of the same column of eight matrices in r[j], transposed and
+// stored to that column of each matrix. The halves are stored on their own:
+// storing the high half is a plain store, joining two columns into one 256
+// bit store would take a shuffle per store.
+static inline void StoreColumns(float* column, __m256 r0, __m256 r1, __m256 r2, __m256 r3)
+{
+    Transpose4x4x2(r0, r1, r2, r3);
+    const __m256 r[4] = {r0, r1, r2, r3};
+    for (sizet n = 0; n < 4; n++)
+    {
+        _mm_storeu_ps(column + n * 16, _mm256_castps256_ps128(r[n]));
+        _mm_storeu_ps(column + (n + 4) * 16, _mm256_extractf128_ps(r[n], 1));
+    }
+}
+
+// Eight matrices per iteration, element n of a block in the low half of
+// register n and element n + 4 in the high half. The columns are transposed
+// and stored one at a time, which keeps the registers from spilling. Scales
+// and translations are read 4 floats at a time, so the last element always
+// goes through the scalar version to not read past the arrays. When streaming,
+// a block is built in a buffer first: streamed a column at a time, the eight
+// matrices would have more lines half written than the CPU can combine.
+template<bool STREAM>
+static void ComposeMatrices(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                            const float* translations, sizet translation_stride, float* out, sizet count)
+{
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m128 one4 = _mm_set1_ps(1.f);
+    alignas(32) float block[8 * 16];
+
+    sizet i = 0;
+    for (; i + 8 < count; i += 8)
+    {
+        __m256 q[4], s[4];
+        for (sizet n = 0; n < 4; n++)
+        {
+            q[n] = Load4x2(rotations + (i + n) * rotation_stride, rotations + (i + n + 4) * rotation_stride);
+            s[n] = Load4x2(scales + (i + n) * scale_stride, scales + (i + n + 4) * scale_stride);
+        }
+        Transpose4x4x2(q[0], q[1], q[2], q[3]);
+        Transpose4x4x2(s[0], s[1], s[2], s[3]);
+
+        const __m256 x2 = _mm256_add_ps(q[0], q[0]), y2 = _mm256_add_ps(q[1], q[1]), z2 = _mm256_add_ps(q[2], q[2]);
+        const __m256 xx = _mm256_mul_ps(q[0], x2), yy = _mm256_mul_ps(q[1], y2), zz = _mm256_mul_ps(q[2], z2);
+        const __m256 xy = _mm256_mul_ps(q[0], y2), xz = _mm256_mul_ps(q[0], z2), yz = _mm256_mul_ps(q[1], z2);
+        const __m256 wx = _mm256_mul_ps(q[3], x2), wy = _mm256_mul_ps(q[3], y2), wz = _mm256_mul_ps(q[3], z2);
+
+        float* matrix = STREAM ? block : out + i * 16;
+        StoreColumns(matrix, _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(one, yy), zz), s[0]), _mm256_mul_ps(_mm256_add_ps(xy, wz), s[0]),
+                     _mm256_mul_ps(_mm256_sub_ps(xz, wy), s[0]), zero);
+        StoreColumns(matrix + 4, _mm256_mul_ps(_mm256_sub_ps(xy, wz), s[1]), _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(one, xx), zz), s[1]),
+                     _mm256_mul_ps(_mm256_add_ps(yz, wx), s[1]), zero);
+        StoreColumns(matrix + 8, _mm256_mul_ps(_mm256_add_ps(xz, wy), s[2]), _mm256_mul_ps(_mm256_sub_ps(yz, wx), s[2]),
+                     _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(one, xx), yy), s[2]), zero);
+
+        // Translations are one per register already, they only need their w.
+        for (sizet n = 0; n < 8; n++)
+            _mm_storeu_ps(matrix + n * 16 + 12, _mm_blend_ps(_mm_loadu_ps(translations + (i + n) * translation_stride), one4, 0x8));
+
+        if constexpr (STREAM)
+        {
+            for (sizet n = 0; n < 8 * 16; n += 4)
+                _mm_stream_ps(out + i * 16 + n, _mm_load_ps(block + n));
+        }
+    }
+
+    if constexpr (STREAM)
+        _mm_sfence();
+
+    ComposeMatricesScalar(scales + i * scale_stride, scale_stride, rotations + i * rotation_stride, rotation_stride,
+                          translations + i * translation_stride, translation_stride, out + i * 16, count - i);
+}
+
+static void ComposeMatrices(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                            const float* translations, sizet translation_stride, float* out, sizet count)
+{
+    if (UseStreamingStores(out, count))
+        ComposeMatrices<true>(scales, scale_stride, rotations, rotation_stride, translations, translation_stride, out, count);
+    else
+        ComposeMatrices<false>(scales, scale_stride, rotations, rotation_stride, translations, translation_stride, out, count);
+}
+
+// Eight boxes per iteration, read as sixteen vec3: min and max of each.
+static sizet CullAABBs(const float* planes, const float* boxes, sizet count, uint32* visible_indices)
+{
+    // Normal, absolute normal and twice the distance of each plane, splat.
+    __m256 normals[6][3], abs_normals[6][3], distances[6];
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    for (sizet p = 0; p < 6; p++)
+    {
+        for (sizet j = 0; j < 3; j++)
+        {
+            normals[p][j] = _mm256_broadcast_ss(planes + p * 4 + j);
+            abs_normals[p][j] = _mm256_andnot_ps(sign, normals[p][j]);
+        }
+        distances[p] = _mm256_set1_ps(2.f * planes[p * 4 + 3]);
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+
+    sizet visible = 0;
+    sizet i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // Boxes 0-1 and 2-3 in the halves of the first set, 4-5 and 6-7 in the second.
+        __m256 x03, y03, z03, x47, y47, z47;
+        LoadVec3x8(boxes + i * 6, x03, y03, z03);
+        LoadVec3x8(boxes + i * 6 + 24, x47, y47, z47);
+
+        // Mins are the even vectors, maxs the odd ones. Lanes end up in box
+        // order 0, 1, 4, 5, 2, 3, 6, 7.
+        const __m256 min_x = _mm256_shuffle_ps(x03, x47, _MM_SHUFFLE(2, 0, 2, 0)), max_x = _mm256_shuffle_ps(x03, x47, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 min_y = _mm256_shuffle_ps(y03, y47, _MM_SHUFFLE(2, 0, 2, 0)), max_y = _mm256_shuffle_ps(y03, y47, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 min_z = _mm256_shuffle_ps(z03, z47, _MM_SHUFFLE(2, 0, 2, 0)), max_z = _mm256_shuffle_ps(z03, z47, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m256 cx = _mm256_add_ps(min_x, max_x), cy = _mm256_add_ps(min_y, max_y), cz = _mm256_add_ps(min_z, max_z);
+        const __m256 ex = _mm256_sub_ps(max_x, min_x), ey = _mm256_sub_ps(max_y, min_y), ez = _mm256_sub_ps(max_z, min_z);
+
+        __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+        for (sizet p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_fmadd_ps(normals[p][0], cx, distances[p]);
+            distance = _mm256_fmadd_ps(normals[p][1], cy, distance);
+            distance = _mm256_fmadd_ps(normals[p][2], cz, distance);
+            distance = _mm256_fmadd_ps(abs_normals[p][0], ex, distance);
+            distance = _mm256_fmadd_ps(abs_normals[p][1], ey, distance);
+            distance = _mm256_fmadd_ps(abs_normals[p][2], ez, distance);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        }
+
+        // Back to box order: lanes 2-3 hold boxes 4-5 and lanes 4-5 boxes 2-3.
+        uint32 mask = (uint32)_mm256_movemask_ps(inside);
+        mask = (mask & 0xc3) | ((mask & 0x0c) << 2) | ((mask & 0x30) >> 2);
+        for (uint32 n = 0; n < 8; n++)
+        {
+            visible_indices[visible] = (uint32)(i + n);
+            visible += (mask >> n) & 1;
+        }
+    }
+
+    return visible + CullAABBsScalar(planes, boxes, i, count, visible_indices + visible);
+}
+
+static const TransformBatchKernels s_kernels_avx2 =
+{
+    TransformAoS<true>,
+    TransformAoS<false>,
+    TransformPoints4,
+    TransformSoA<true>,
+    TransformSoA<false>,
+    TransformIndexed<true>,
+    TransformIndexed<false>,
+    ComposeMatrices,
+    CullAABBs,
+};
+
+const TransformBatchKernels* GetTransformBatchKernelsAVX2()
+{
+    return &s_kernels_avx2;
+}
+
+#else
+
+const TransformBatchKernels* GetTransformBatchKernelsAVX2()
+{
+    return nullptr;
+}
+
+#endif // __AVX2__
+
+} // namespace Math
+} // namespace Raptor
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Types.h"
+
+namespace Raptor
+{
+namespace Math
+{
+
+// One instruction set's version of the TransformBatch.h functions, on raw
+// floats: a matrix is the 16 values of a mat4, vec3 and vec4 arrays are
+// tightly packed. The AVX2 table is built in its own translation unit with
+// AVX2 and FMA enabled. Nothing else of the Math headers is compiled there,
+// so no inline function built for AVX2 can end up in the rest of the program.
+struct TransformBatchKernels
+{
+    void (*transform_points)(const float* m, const float* in, float* out, sizet count);
+    void (*transform_vectors)(const float* m, const float* in, float* out, sizet count);
+    void (*transform_points4)(const float* m, const float* in, float* out, sizet count);
+
+    void (*transform_points_soa)(const float* m, const float* in_x, const float* in_y, const float* in_z,
+                                 float* out_x, float* out_y, float* out_z, sizet count);
+    void (*transform_vectors_soa)(const float* m, const float* in_x, const float* in_y, const float* in_z,
+                                  float* out_x, float* out_y, float* out_z, sizet count);
+
+    void (*transform_points_indexed)(const float* matrices, const uint32* matrix_indices, const float* in, float* out, sizet count);
+    void (*transform_vectors_indexed)(const float* matrices, const uint32* matrix_indices, const float* in, float* out, sizet count);
+
+    // Transform::CalcMatrices, strides are in floats.
+    void (*compose_matrices)(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                             const float* translations, sizet translation_stride, float* out, sizet count);
+
+    // CullAABBs, the planes are the 6 vec4 of a Frustum and a box is its min and max.
+    sizet (*cull_aabbs)(const float* planes, const float* boxes, sizet count, uint32* visible_indices);
+}; // struct TransformBatchKernels
+
+// Scalar version, also used by the SIMD ones for what is left after their last full block.
+void ComposeMatricesScalar(const float* scales, sizet scale_stride, const float* rotations, sizet rotation_stride,
+                           const float* translations, sizet translation_stride, float* out, sizet count);
+// Boxes from begin to end, the indices written are the ones of boxes.
+sizet CullAABBsScalar(const float* planes, const float* boxes, sizet begin, sizet end, uint32* visible_indices);
+
+// Transform::CalcMatrices writes its matrices with non-temporal stores from
+// this many bytes of output, far enough past the last level cache that they
+// would be evicted before they are read. It saves reading each line of the
+// destination before it is written: 16 MB of matrices were slower streamed,
+// 64 MB faster. The stores need the output 16 byte aligned, as a mat4 is.
+static const sizet COMPOSE_MATRICES_STREAM_BYTES = 32 * 1024 * 1024;
+
+inline bool UseStreamingStores(const float* out, sizet count)
+{
+    return count * 16 * sizeof(float) >= COMPOSE_MATRICES_STREAM_BYTES && ((uintptr_t)out & 15) == 0;
+}
+
+// nullptr when the build has no AVX2 version.
+const TransformBatchKernels* GetTransformBatchKernelsAVX2();
+
+} // namespace Math
+} // namespace Raptor
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 #include "Types.h"
 
 namespace Raptor
@@ -7,37 +9,45 @@ namespace Raptor
 namespace Math
 {
 
+// Vectors and matrices are plain values: trivially copyable, standard layout
+// and constexpr-constructible, so structs made of them copy with memcpy and
+// vectorized moves. vec4 and mat4 of 4-byte or wider types sit on 16 bytes,
+// which SIMD loads and the std140 layout of uniform buffers both want.
+template<typename T>
+constexpr sizet VEC4_ALIGNMENT = sizeof(T) * 4 < 16 ? sizeof(T) * 4 : 16;
+
 template<typename T>
 class vec2
 {
 public:
-    vec2() : x(0), y(0) {}
-    vec2(T x, T y) : x(x), y(y) {}
-    vec2(vec2& v) : x(v.x), y(v.y) {}
-    ~vec2() {}
+    constexpr vec2() : x(0), y(0) {}
+    constexpr vec2(T x, T y) : x(x), y(y) {}
 
     T operator [] (int i) const { return v[i]; }
     T &operator [] (int i) { return v[i]; }
 
-    T Length();
+    T Length() const;
     vec2<T>& Normalize();
 
+    vec2<T>& operator += (const vec2<T>& rhs) { x += rhs.x; y += rhs.y; return *this; }
+    vec2<T>& operator -= (const vec2<T>& rhs) { x -= rhs.x; y -= rhs.y; return *this; }
+    vec2<T>& operator *= (T rhs) { x *= rhs; y *= rhs; return *this; }
+    vec2<T>& operator /= (T rhs) { x /= rhs; y /= rhs; return *this; }
+
     union
     {
         T v[2];
         struct {T x, y; };
     };
-    
+
 }; // class vec2
 
 template<typename T>
 class vec3
 {
 public:
-    vec3() : x(0), y(0), z(0) {}
-    vec3(T x, T y, T z) : x(x), y(y), z(z) {}
-    vec3(vec3& v) : x(v.x), y(v.y), z(v.z) {}
-    ~vec3() {}
+    constexpr vec3() : x(0), y(0), z(0) {}
+    constexpr vec3(T x, T y, T z) : x(x), y(y), z(z) {}
 
     T operator [] (int i) const { return v[i]; }
     T &operator [] (int i) { return v[i]; }
@@ -51,11 +61,28 @@ public:
         struct { T x, y, z; };
     };
 
+    vec3<T>& operator += (const vec3<T>& rhs)
+    {
+        x += rhs.x;
+        y += rhs.y;
+        z += rhs.z;
+        return *this;
+    }
+
+    vec3<T>& operator -= (const vec3<T>& rhs)
+    {
+        x -= rhs.x;
+        y -= rhs.y;
+        z -= rhs.z;
+        return *this;
+    }
+
     vec3<T>& operator += (T rhs)
     {
         x += rhs;
         y += rhs;
         z += rhs;
+        return *this;
     }
 
     vec3<T>& operator -= (T rhs)
@@ -63,6 +90,7 @@ public:
         x -= rhs;
         y -= rhs;
         z -= rhs;
+        return *this;
     }
 
     vec3<T>& operator *= (T rhs)
@@ -70,6 +98,7 @@ public:
         x *= rhs;
         y *= rhs;
         z *= rhs;
+        return *this;
     }
 
     vec3<T>& operator /= (T rhs)
@@ -77,22 +106,26 @@ public:
         x /= rhs;
         y /= rhs;
         z /= rhs;
+        return *this;
     }
 
 }; // class vec3
 
 template<typename T>
-class vec4
+class alignas(VEC4_ALIGNMENT<T>) vec4
 {
 public:
-    vec4() : x(0), y(0), z(0), w(0) {}
-    vec4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
-    vec4(vec4& v) : x(v.x), y(v.y), z(v.z), w(v.w) {}
-    ~vec4() {}
+    constexpr vec4() : x(0), y(0), z(0), w(0) {}
+    constexpr vec4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
 
     T operator [] (int i) const { return v[i]; }
     T &operator [] (int i) { return v[i]; }
 
+    vec4<T>& operator += (const vec4<T>& rhs) { x += rhs.x; y += rhs.y; z += rhs.z; w += rhs.w; return *this; }
+    vec4<T>& operator -= (const vec4<T>& rhs) { x -= rhs.x; y -= rhs.y; z -= rhs.z; w -= rhs.w; return *this; }
+    vec4<T>& operator *= (T rhs) { x *= rhs; y *= rhs; z *= rhs; w *= rhs; return *this; }
+    vec4<T>& operator /= (T rhs) { x /= rhs; y /= rhs; z /= rhs; w /= rhs; return *this; }
+
     union
     {
         T v[4];
@@ -101,51 +134,56 @@ public:
 }; // class vec4
 
 // Scalar Operations
-template<typename T> inline vec2<T> operator + (T lhs, const vec2<T>& rhs);
-template<typename T> inline vec2<T> operator - (T lhs, const vec2<T>& rhs);
-template<typename T> inline vec2<T> operator * (T lhs, const vec2<T>& rhs);
-template<typename T> inline vec2<T> operator / (T lhs, const vec2<T>& rhs);
-template<typename T> inline vec2<T> operator + (const vec2<T>& lhs, T rhs);
-template<typename T> inline vec2<T> operator - (const vec2<T>& lhs, T rhs);
-template<typename T> inline vec2<T> operator * (const vec2<T>& lhs, T rhs);
-template<typename T> inline vec2<T> operator / (const vec2<T>& lhs, T rhs);
-
-template<typename T> inline vec3<T> operator + (T lhs, const vec3<T>& rhs);
-template<typename T> inline vec3<T> operator - (T lhs, const vec3<T>& rhs);
-template<typename T> inline vec3<T> operator * (T lhs, const vec3<T>& rhs);
-template<typename T> inline vec3<T> operator / (T lhs, const vec3<T>& rhs);
-template<typename T> inline vec3<T> operator + (const vec3<T>& lhs, T rhs);
-template<typename T> inline vec3<T> operator - (const vec3<T>& lhs, T rhs);
-template<typename T> inline vec3<T> operator * (const vec3<T>& lhs, T rhs);
-template<typename T> inline vec3<T> operator / (const vec3<T>& lhs, T rhs);
-
-template<typename T> inline vec4<T> operator + (T lhs, const vec4<T>& rhs);
-template<typename T> inline vec4<T> operator - (T lhs, const vec4<T>& rhs);
-template<typename T> inline vec4<T> operator * (T lhs, const vec4<T>& rhs);
-template<typename T> inline vec4<T> operator / (T lhs, const vec4<T>& rhs);
-template<typename T> inline vec4<T> operator + (const vec4<T>& lhs, T rhs);
-template<typename T> inline vec4<T> operator - (const vec4<T>& lhs, T rhs);
-template<typename T> inline vec4<T> operator * (const vec4<T>& lhs, T rhs);
-template<typename T> inline vec4<T> operator / (const vec4<T>& lhs, T rhs);
+template<typename T> constexpr vec2<T> operator + (T lhs, const vec2<T>& rhs) { return vec2<T>(lhs + rhs.x, lhs + rhs.y); }
+template<typename T> constexpr vec2<T> operator - (T lhs, const vec2<T>& rhs) { return vec2<T>(lhs - rhs.x, lhs - rhs.y); }
+template<typename T> constexpr vec2<T> operator * (T lhs, const vec2<T>& rhs) { return vec2<T>(lhs * rhs.x, lhs * rhs.y); }
+template<typename T> constexpr vec2<T> operator / (T lhs, const vec2<T>& rhs) { return vec2<T>(lhs / rhs.x, lhs / rhs.y); }
+template<typename T> constexpr vec2<T> operator + (const vec2<T>& lhs, T rhs) { return vec2<T>(lhs.x + rhs, lhs.y + rhs); }
+template<typename T> constexpr vec2<T> operator - (const vec2<T>& lhs, T rhs) { return vec2<T>(lhs.x - rhs, lhs.y - rhs); }
+template<typename T> constexpr vec2<T> operator * (const vec2<T>& lhs, T rhs) { return vec2<T>(lhs.x * rhs, lhs.y * rhs); }
+template<typename T> constexpr vec2<T> operator / (const vec2<T>& lhs, T rhs) { return vec2<T>(lhs.x / rhs, lhs.y / rhs); }
+
+template<typename T> constexpr vec3<T> operator + (T lhs, const vec3<T>& rhs) { return vec3<T>(lhs + rhs.x, lhs + rhs.y, lhs + rhs.z); }
+template<typename T> constexpr vec3<T> operator - (T lhs, const vec3<T>& rhs) { return vec3<T>(lhs - rhs.x, lhs - rhs.y, lhs - rhs.z); }
+template<typename T> constexpr vec3<T> operator * (T lhs, const vec3<T>& rhs) { return vec3<T>(lhs * rhs.x, lhs * rhs.y, lhs * rhs.z); }
+template<typename T> constexpr vec3<T> operator / (T lhs, const vec3<T>& rhs) { return vec3<T>(lhs / rhs.x, lhs / rhs.y, lhs / rhs.z); }
+template<typename T> constexpr vec3<T> operator + (const vec3<T>& lhs, T rhs) { return vec3<T>(lhs.x + rhs, lhs.y + rhs, lhs.z + rhs); }
+template<typename T> constexpr vec3<T> operator - (const vec3<T>& lhs, T rhs) { return vec3<T>(lhs.x - rhs, lhs.y - rhs, lhs.z - rhs); }
+template<typename T> constexpr vec3<T> operator * (const vec3<T>& lhs, T rhs) { return vec3<T>(lhs.x * rhs, lhs.y * rhs, lhs.z * rhs); }
+template<typename T> constexpr vec3<T> operator / (const vec3<T>& lhs, T rhs) { return vec3<T>(lhs.x / rhs, lhs.y / rhs, lhs.z / rhs); }
+
+template<typename T> constexpr vec4<T> operator + (T lhs, const vec4<T>& rhs) { return vec4<T>(lhs + rhs.x, lhs + rhs.y, lhs + rhs.z, lhs + rhs.w); }
+template<typename T> constexpr vec4<T> operator - (T lhs, const vec4<T>& rhs) { return vec4<T>(lhs - rhs.x, lhs - rhs.y, lhs - rhs.z, lhs - rhs.w); }
+template<typename T> constexpr vec4<T> operator * (T lhs, const vec4<T>& rhs) { return vec4<T>(lhs * rhs.x, lhs * rhs.y, lhs * rhs.z, lhs * rhs.w); }
+template<typename T> constexpr vec4<T> operator / (T lhs, const vec4<T>& rhs) { return vec4<T>(lhs / rhs.x, lhs / rhs.y, lhs / rhs.z, lhs / rhs.w); }
+template<typename T> constexpr vec4<T> operator + (const vec4<T>& lhs, T rhs) { return vec4<T>(lhs.x + rhs, lhs.y + rhs, lhs.z + rhs, lhs.w + rhs); }
+template<typename T> constexpr vec4<T> operator - (const vec4<T>& lhs, T rhs) { return vec4<T>(lhs.x - rhs, lhs.y - rhs, lhs.z - rhs, lhs.w - rhs); }
+template<typename T> constexpr vec4<T> operator * (const vec4<T>& lhs, T rhs) { return vec4<T>(lhs.x * rhs, lhs.y * rhs, lhs.z * rhs, lhs.w * rhs); }
+template<typename T> constexpr vec4<T> operator / (const vec4<T>& lhs, T rhs) { return vec4<T>(lhs.x / rhs, lhs.y / rhs, lhs.z / rhs, lhs.w / rhs); }
 
 
 // Vector Operations
-template<typename T> inline vec2<T> operator + (const vec2<T>& lhs, const vec2<T>& rhs);
-template<typename T> inline vec2<T> operator - (const vec2<T>& lhs, const vec2<T>& rhs);
+template<typename T> constexpr vec2<T> operator + (const vec2<T>& lhs, const vec2<T>& rhs) { return vec2<T>(lhs.x + rhs.x, lhs.y + rhs.y); }
+template<typename T> constexpr vec2<T> operator - (const vec2<T>& lhs, const vec2<T>& rhs) { return vec2<T>(lhs.x - rhs.x, lhs.y - rhs.y); }
 
-template<typename T> inline vec3<T> operator + (const vec3<T>& lhs, const vec3<T>& rhs);
-template<typename T> inline vec3<T> operator - (const vec3<T>& lhs, const vec3<T>& rhs);
+template<typename T> constexpr vec3<T> operator + (const vec3<T>& lhs, const vec3<T>& rhs) { return vec3<T>(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z); }
+template<typename T> constexpr vec3<T> operator - (const vec3<T>& lhs, const vec3<T>& rhs) { return vec3<T>(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z); }
 
-template<typename T> inline vec4<T> operator + (const vec4<T>& lhs, const vec4<T>& rhs);
-template<typename T> inline vec4<T> operator - (const vec4<T>& lhs, const vec4<T>& rhs);
+template<typename T> constexpr vec4<T> operator + (const vec4<T>& lhs, const vec4<T>& rhs) { return vec4<T>(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w); }
+template<typename T> constexpr vec4<T> operator - (const vec4<T>& lhs, const vec4<T>& rhs) { return vec4<T>(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w); }
 
 // Dot Product
-template<typename T> inline T dot(vec2<T>& v, vec2<T>& u);
-template<typename T> inline T dot(vec3<T>& v, vec3<T>& u);
-template<typename T> inline T dot(vec4<T>& v, vec4<T>& u);
+template<typename T> constexpr T dot(const vec2<T>& v, const vec2<T>& u) { return v.x * u.x + v.y * u.y; }
+template<typename T> constexpr T dot(const vec3<T>& v, const vec3<T>& u) { return v.x * u.x + v.y * u.y + v.z * u.z; }
+template<typename T> constexpr T dot(const vec4<T>& v, const vec4<T>& u) { return v.x * u.x + v.y * u.y + v.z * u.z + v.w * u.w; }
 
 // Cross Product
-template<typename T> inline vec3<T> cross(vec3<T>& v, vec3<T>& u);
+template<typename T> constexpr vec3<T> cross(const vec3<T>& v, const vec3<T>& u)
+{
+    return vec3<T>(v.y * u.z - v.z * u.y,
+                   v.z * u.x - v.x * u.z,
+                   v.x * u.y - v.y * u.x);
+}
 
 
 typedef vec2<int16>  vec2s;
@@ -175,5 +213,11 @@ typedef vec4<uint64> vec4ul;
 typedef vec4<float>  vec4f;
 typedef vec4<double> vec4d;
 
+static_assert(std::is_trivially_copyable_v<vec2f> && std::is_standard_layout_v<vec2f>, "vec2 has to stay a plain value.");
+static_assert(std::is_trivially_copyable_v<vec3f> && std::is_standard_layout_v<vec3f>, "vec3 has to stay a plain value.");
+static_assert(std::is_trivially_copyable_v<vec4f> && std::is_standard_layout_v<vec4f>, "vec4 has to stay a plain value.");
+static_assert(sizeof(vec3f) == 12 && alignof(vec3f) == 4, "vec3f is packed in vertex and uniform data.");
+static_assert(sizeof(vec4f) == 16 && alignof(vec4f) == 16, "vec4f has to match a SIMD register.");
+
 } // namespace Math
-} // namespace Raptor
\ No newline at end of file
+} // namespace Raptor
@@ -0,0 +1,1461 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <EASTL/allocator.h>
+#include <EASTL/hash_map.h>
+#include <EASTL/vector.h>
+
+#include "Allocator.h"
+#include "Defines.h"
+#include "HashMap.h"
+#include "Hash.h"
+#include "HeapAllocator.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "NameTable.h"
+#include "Profiler.h"
+#include "TimeService.h"
+
+// These new operators are required by EASTL
+void* __cdecl operator new[](size_t size, const char* pName, int flags, unsigned debugFlags, const char* file, int line)
+{
+    return new uint8_t[size];
+}
+
+void* __cdecl operator new[](size_t size, size_t alignment, size_t alignmentOffset, const char* pName, int flags, unsigned debugFlags, const char* file, int line)
+{
+    return new uint8_t[size];
+}
+
+// Microbenchmarks of the Core library.
+//
+//   RaptorCoreBench [--filter text] [--min-time seconds] [--repetitions n]
+//                   [--threads n] [--json file] [--csv file]
+//   RaptorCoreBench --check
+//
+// Runs like RaptorMathBench: every benchmark runs for at least min-time per
+// repetition, the fastest repetition is reported along with the median. The
+// first variant of a name is the baseline of the others, the EASTL or
+// malloc version of what the engine replaces. Build in release, the numbers
+// of a debug build say nothing.
+//
+// Job system benchmarks run with 1, 2, 4... threads up to the hardware
+// threads or --threads, the speedup over one thread is the scaling. The log
+// benchmarks log from 1 and 8 threads the same way. The profiler zone
+// benchmark runs on one thread, its compiled_out variant is what a zone
+// leaves with RAPTOR_PROFILER 0.
+//
+// Reports follow the table, measurements that are not a time per item like
+// latency percentiles and fragmentation. They are written to the JSON too.
+//
+// --check runs the regression checks instead and exits with 1 if one fails.
+
+using namespace Raptor::Core;
+
+template<typename T>
+using Array = eastl::vector<T, ContainerAllocator>;
+
+// Keeps the compiler from dropping or hoisting the measured work.
+#if defined(__GNUC__) || defined(__clang__)
+static inline void ClobberMemory() { asm volatile("" : : : "memory"); }
+#elif defined(_MSC_VER)
+static inline void ClobberMemory() { _ReadWriteBarrier(); }
+#else
+static inline void ClobberMemory() {}
+#endif
+
+// Data ------------------------------------------------------------------------
+
+// A frame worth of transient allocations, sized like command lists, strings
+// and small arrays, and a count that makes containers reallocate a few times.
+static const uint32 FRAME_ALLOCATION_COUNT = 1024;
+static const uint32 SCRATCH_DEPTH = 4;
+static const uint32 ARRAY_COUNT = 4 * 1024;
+
+// Hash maps from a size that stays in L1 to one that misses on every probe.
+static const uint32 MAP_SMALL_COUNT = 1024;
+static const uint32 MAP_CACHE_COUNT = 32 * 1024;
+static const uint32 MAP_MEMORY_COUNT = 1024 * 1024;
+
+// Resource names, the count of a large scene with its textures and materials.
+static const uint32 NAME_COUNT = 100 * 1000;
+
+// Job system work: a parallel loop over a large array and a fan-out of
+// jobs of a few microseconds each, that fits the job rings of the threads.
+static const uint32 PARALLEL_FOR_COUNT = 1024 * 1024;
+static const uint32 PARALLEL_FOR_BATCH_SIZE = 4 * 1024;
+static const uint32 FAN_OUT_COUNT = 2 * 1024;
+static const uint32 FAN_OUT_JOB_SIZE = 512;
+
+static_assert(FAN_OUT_COUNT * FAN_OUT_JOB_SIZE <= PARALLEL_FOR_COUNT, "Fan-out jobs work on the parallel for arrays.");
+
+// Log records per pass, shared by the threads. A thread's ring holds about
+// 800 of them, so a pass fits unless the log thread falls behind, records
+// it drops then are part of what the async variant measures.
+static const uint32 LOG_COUNT = 512;
+static const uint32 LOG_BATCH_SIZE = 64;
+
+// Zones per pass, a capturing pass fits in the buffer of its thread.
+static const uint32 ZONE_COUNT = 16 * 1024;
+
+static const sizet ARENA_SIZE = 4 * 1024 * 1024;
+static const sizet HEAP_POOL_SIZE = 16 * 1024 * 1024;
+
+struct BenchData
+{
+    uint32 allocation_sizes[FRAME_ALLOCATION_COUNT];
+    void* allocations[FRAME_ALLOCATION_COUNT];
+
+    eastl::allocator eastl_allocator;
+    HeapAllocator heap_allocator;
+    LinearAllocator linear_allocator;
+    StackAllocator stack_allocator;
+    DoubleBufferedAllocator double_buffered_allocator;
+
+    // Random keys, the ones that are looked up for misses are never inserted.
+    uint64* map_keys;
+    uint64* map_missing_keys;
+
+    const char** names;
+    char* name_storage;
+    NameId* name_ids;
+    NameTable name_table;
+
+    float* job_input;
+    float* job_output;
+
+    // Written by benchmarks whose result would be dropped otherwise.
+    volatile uint64 sink;
+}; // struct BenchData
+
+static BenchData s_data;
+
+static void InitData()
+{
+    srand(1);
+
+    for (uint32 i = 0; i < FRAME_ALLOCATION_COUNT; i++)
+        s_data.allocation_sizes[i] = 16 + (uint32)(rand() % 496);
+
+    // splitmix64, rand() has too few bits for a million distinct keys.
+    uint64 state = 1;
+    s_data.map_keys = new uint64[MAP_MEMORY_COUNT];
+    s_data.map_missing_keys = new uint64[MAP_MEMORY_COUNT];
+    for (uint32 i = 0; i < 2 * MAP_MEMORY_COUNT; i++)
+    {
+        uint64 key = (state += 0x9e3779b97f4a7c15ull);
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+        key ^= key >> 31;
+        if (i < MAP_MEMORY_COUNT)
+            s_data.map_keys[i] = key;
+        else
+            s_data.map_missing_keys[i - MAP_MEMORY_COUNT] = key;
+    }
+
+    // Paths like the ones of glTF scenes, of varying length and sharing prefixes.
+    static const char* s_name_formats[] =
+    {
+        "textures/%05u_BaseColor.png",
+        "textures/%05u_MetallicRoughness.png",
+        "models/Sponza/glTF/%05u_Normal.png",
+        "Material_%u",
+        "Node_%u.Mesh.Primitive_0.PositionBuffer",
+    };
+    static const uint32 NAME_FORMAT_COUNT = sizeof(s_name_formats) / sizeof(s_name_formats[0]);
+    static const uint32 MAX_NAME_SIZE = 64;
+
+    s_data.names = new const char*[NAME_COUNT];
+    s_data.name_storage = new char[NAME_COUNT * MAX_NAME_SIZE];
+    s_data.name_ids = new NameId[NAME_COUNT];
+    for (uint32 i = 0; i < NAME_COUNT; i++)
+    {
+        char* name = s_data.name_storage + i * MAX_NAME_SIZE;
+        snprintf(name, MAX_NAME_SIZE, s_name_formats[i % NAME_FORMAT_COUNT], i);
+        s_data.names[i] = name;
+    }
+
+    s_data.name_table.init(MallocAllocator::instance());
+    for (uint32 i = 0; i < NAME_COUNT; i++)
+        s_data.name_ids[i] = s_data.name_table.Intern(s_data.names[i]);
+
+    s_data.job_input = new float[PARALLEL_FOR_COUNT];
+    s_data.job_output = new float[PARALLEL_FOR_COUNT];
+    for (uint32 i = 0; i < PARALLEL_FOR_COUNT; i++)
+        s_data.job_input[i] = (float)rand() / (float)RAND_MAX;
+
+    s_data.heap_allocator.init(MallocAllocator::instance(), HEAP_POOL_SIZE);
+    s_data.linear_allocator.init(MallocAllocator::instance(), ARENA_SIZE);
+    s_data.stack_allocator.init(MallocAllocator::instance(), ARENA_SIZE);
+    s_data.double_buffered_allocator.init(MallocAllocator::instance(), ARENA_SIZE);
+}
+
+static void ShutdownData()
+{
+    s_data.double_buffered_allocator.shutdown();
+    s_data.stack_allocator.shutdown();
+    s_data.linear_allocator.shutdown();
+    s_data.heap_allocator.shutdown();
+
+    delete[] s_data.map_missing_keys;
+    delete[] s_data.map_keys;
+
+    delete[] s_data.job_output;
+    delete[] s_data.job_input;
+
+    s_data.name_table.shutdown();
+    delete[] s_data.name_ids;
+    delete[] s_data.name_storage;
+    delete[] s_data.names;
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// One call does a whole pass over the data set of the benchmark.
+typedef void (*BenchFunction)(uint32 count);
+
+// Frame allocations: everything allocated during a frame is released at its end.
+template<typename AllocatorType>
+static void AllocateFrame(AllocatorType& allocator, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        uint8* memory = (uint8*)allocator.allocate(s_data.allocation_sizes[i], 16, 0, 0);
+        memory[0] = (uint8)i;
+        s_data.allocations[i] = memory;
+    }
+}
+
+template<typename AllocatorType>
+static void FreeFrame(AllocatorType& allocator, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        allocator.deallocate(s_data.allocations[i], s_data.allocation_sizes[i]);
+}
+
+static void FrameEASTLBench(uint32 count)
+{
+    AllocateFrame(s_data.eastl_allocator, count);
+    FreeFrame(s_data.eastl_allocator, count);
+}
+
+static void FrameMallocBench(uint32 count)
+{
+    AllocateFrame(*MallocAllocator::instance(), count);
+    FreeFrame(*MallocAllocator::instance(), count);
+}
+
+static void FrameHeapBench(uint32 count)
+{
+    AllocateFrame(s_data.heap_allocator, count);
+    FreeFrame(s_data.heap_allocator, count);
+}
+
+static void FrameLinearBench(uint32 count)
+{
+    AllocateFrame(s_data.linear_allocator, count);
+    s_data.linear_allocator.Clear();
+}
+
+static void FrameDoubleBufferedBench(uint32 count)
+{
+    AllocateFrame(s_data.double_buffered_allocator, count);
+    s_data.double_buffered_allocator.SwapBuffers();
+}
+
+// Scratch memory: nested temporary buffers released in reverse order, like
+// the arrays of descriptor writes or of a file being parsed.
+template<typename AllocatorType>
+static void AllocateScratch(AllocatorType& allocator, uint32 count)
+{
+    for (uint32 i = 0; i < count; i += SCRATCH_DEPTH)
+    {
+        for (uint32 depth = 0; depth < SCRATCH_DEPTH; depth++)
+        {
+            uint8* memory = (uint8*)allocator.allocate(s_data.allocation_sizes[i + depth], 16, 0, 0);
+            memory[0] = (uint8)depth;
+            s_data.allocations[depth] = memory;
+        }
+        for (uint32 depth = SCRATCH_DEPTH; depth-- > 0;)
+            allocator.deallocate(s_data.allocations[depth], s_data.allocation_sizes[i + depth]);
+    }
+}
+
+static void ScratchEASTLBench(uint32 count)
+{
+    AllocateScratch(s_data.eastl_allocator, count);
+}
+
+static void ScratchMallocBench(uint32 count)
+{
+    AllocateScratch(*MallocAllocator::instance(), count);
+}
+
+static void ScratchHeapBench(uint32 count)
+{
+    AllocateScratch(s_data.heap_allocator, count);
+}
+
+// Deallocate only pops an allocation that ends at the top, alignment padding
+// included, so nested scratch memory is released with markers instead.
+static void ScratchStackBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i += SCRATCH_DEPTH)
+    {
+        StackAllocatorScope scope(s_data.stack_allocator);
+        for (uint32 depth = 0; depth < SCRATCH_DEPTH; depth++)
+        {
+            uint8* memory = (uint8*)s_data.stack_allocator.allocate(s_data.allocation_sizes[i + depth], 16, 0, 0);
+            memory[0] = (uint8)depth;
+            s_data.allocations[depth] = memory;
+        }
+    }
+}
+
+// Array growth: a container filled without reserving, reallocating on the way.
+static void ArrayEASTLBench(uint32 count)
+{
+    eastl::vector<uint32> values;
+    for (uint32 i = 0; i < count; i++)
+        values.push_back(i);
+}
+
+static void ArrayMallocBench(uint32 count)
+{
+    Array<uint32> values(ContainerAllocator(*MallocAllocator::instance()));
+    for (uint32 i = 0; i < count; i++)
+        values.push_back(i);
+}
+
+static void ArrayHeapBench(uint32 count)
+{
+    Array<uint32> values(ContainerAllocator(s_data.heap_allocator));
+    for (uint32 i = 0; i < count; i++)
+        values.push_back(i);
+}
+
+static void ArrayLinearBench(uint32 count)
+{
+    {
+        Array<uint32> values(ContainerAllocator(s_data.linear_allocator));
+        for (uint32 i = 0; i < count; i++)
+            values.push_back(i);
+    }
+    s_data.linear_allocator.Clear();
+}
+
+// Hash maps: eastl::hash_map against HashMap with the same keys. Find and
+// erase run on a map filled by the setup of the benchmark, erase puts every
+// key back so all passes start from the same map.
+typedef eastl::hash_map<uint64, uint64> EASTLMap;
+typedef HashMap<uint64, uint64> RaptorMap;
+
+template<typename Map>
+struct MapBench
+{
+    static Map* map;
+
+    static void Fill(uint32 count)
+    {
+        map = new Map();
+        for (uint32 i = 0; i < count; i++)
+            map->insert(typename Map::value_type(s_data.map_keys[i], i));
+    }
+
+    static void Destroy(uint32 count)
+    {
+        delete map;
+        map = nullptr;
+    }
+
+    static void Insert(uint32 count)
+    {
+        Map inserted;
+        for (uint32 i = 0; i < count; i++)
+            inserted.insert(typename Map::value_type(s_data.map_keys[i], i));
+    }
+
+    static void Find(uint32 count)
+    {
+        uint64 sum = 0;
+        for (uint32 i = 0; i < count; i++)
+        {
+            typename Map::iterator it = map->find(s_data.map_keys[i]);
+            if (it != map->end())
+                sum += it->second;
+        }
+        ASSERT(sum == (uint64)count * (count - 1) / 2);
+    }
+
+    static void FindMissing(uint32 count)
+    {
+        uint32 found = 0;
+        for (uint32 i = 0; i < count; i++)
+            found += map->find(s_data.map_missing_keys[i]) != map->end();
+        ASSERT(found == 0);
+    }
+
+    static void Erase(uint32 count)
+    {
+        for (uint32 i = 0; i < count; i++)
+            map->erase(s_data.map_keys[i]);
+        for (uint32 i = 0; i < count; i++)
+            map->insert(typename Map::value_type(s_data.map_keys[i], i));
+    }
+}; // struct MapBench
+
+template<typename Map>
+Map* MapBench<Map>::map = nullptr;
+
+// Names: the table against a copy of every name allocated on its own and
+// found through the same HashMap. Both hash the string to find it, the ids
+// of the table also carry the hash for the paths that only have the name.
+typedef HashMap<uint64, const char*> NameMap;
+
+static void InternNames(Allocator& allocator, NameMap& map, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        const char* name = s_data.names[i];
+        const uint64 hash = HashString(name);
+        if (map.find(hash) != map.end())
+            continue;
+
+        const sizet size = strlen(name) + 1;
+        char* copy = (char*)allocator.allocate(size, 1, 0, 0);
+        memcpy(copy, name, size);
+        map.insert(NameMap::value_type(hash, copy));
+    }
+}
+
+static void FreeNames(Allocator& allocator, NameMap& map)
+{
+    for (NameMap::iterator it = map.begin(); it != map.end(); ++it)
+        allocator.deallocate((void*)it->second, strlen(it->second) + 1);
+    map.clear(true);
+}
+
+static NameMap* s_name_map = nullptr;
+
+static void NameMapFill(uint32 count)
+{
+    s_name_map = new NameMap();
+    InternNames(*MallocAllocator::instance(), *s_name_map, count);
+}
+
+static void NameMapDestroy(uint32 count)
+{
+    FreeNames(*MallocAllocator::instance(), *s_name_map);
+    delete s_name_map;
+    s_name_map = nullptr;
+}
+
+static void NameInternMallocBench(uint32 count)
+{
+    NameMap map;
+    InternNames(*MallocAllocator::instance(), map, count);
+    FreeNames(*MallocAllocator::instance(), map);
+}
+
+static void NameInternTableBench(uint32 count)
+{
+    NameTable table;
+    table.init(MallocAllocator::instance());
+    for (uint32 i = 0; i < count; i++)
+        table.Intern(s_data.names[i]);
+    table.shutdown();
+}
+
+static void NameFindMallocBench(uint32 count)
+{
+    uint32 found = 0;
+    for (uint32 i = 0; i < count; i++)
+        found += s_name_map->find(HashString(s_data.names[i])) != s_name_map->end();
+    ASSERT(found == count);
+}
+
+static void NameFindTableBench(uint32 count)
+{
+    uint32 found = 0;
+    for (uint32 i = 0; i < count; i++)
+        found += s_data.name_table.Find(s_data.names[i]).IsValid();
+    ASSERT(found == count);
+}
+
+// What destroying a resource costs to get the key of its cache entry.
+static void NameHashRehashBench(uint32 count)
+{
+    uint64 hash = 0;
+    for (uint32 i = 0; i < count; i++)
+        hash ^= HashString(s_data.names[i]);
+    s_data.sink = hash;
+}
+
+static void NameHashTableBench(uint32 count)
+{
+    uint64 hash = 0;
+    for (uint32 i = 0; i < count; i++)
+        hash ^= s_data.name_table.GetHash(s_data.name_ids[i]);
+    s_data.sink = hash;
+}
+
+// Jobs: the work of an element is a short chain of math, enough that the
+// loop is bound by the cores rather than by memory bandwidth.
+static void ComputeRange(uint32 start, uint32 end)
+{
+    for (uint32 i = start; i < end; i++)
+    {
+        float value = s_data.job_input[i];
+        for (uint32 step = 0; step < 8; step++)
+            value = value * value * 0.5f + 0.25f;
+        s_data.job_output[i] = value;
+    }
+}
+
+// With one thread the job system is not started and ParallelFor runs the
+// whole range on the caller.
+static void ParallelForBench(uint32 count)
+{
+    JobSystem::instance()->ParallelFor(count, PARALLEL_FOR_BATCH_SIZE, ComputeRange);
+}
+
+static void FanOutJob(void* data)
+{
+    const uint32 start = (uint32)(uintptr_t)data * FAN_OUT_JOB_SIZE;
+    ComputeRange(start, start + FAN_OUT_JOB_SIZE);
+}
+
+static void FanOutBench(uint32 count)
+{
+    static JobDeclaration s_jobs[FAN_OUT_COUNT];
+    for (uint32 i = 0; i < count; i++)
+    {
+        s_jobs[i].function = FanOutJob;
+        s_jobs[i].data = (void*)(uintptr_t)i;
+    }
+
+    JobSystem* job_system = JobSystem::instance();
+    if (job_system->ThreadCount() == 1)
+    {
+        for (uint32 i = 0; i < count; i++)
+            FanOutJob(s_jobs[i].data);
+        return;
+    }
+
+    JobCounter counter;
+    job_system->Run(s_jobs, count, &counter);
+    job_system->Wait(&counter);
+}
+
+// Log: records like the loading messages, a string and two numbers. The
+// output goes to the null device, the terminal would be measured otherwise.
+static int32 s_saved_stderr = -1;
+
+static void SilenceStderr()
+{
+    fflush(stderr);
+#if defined(_WIN64)
+    s_saved_stderr = _dup(2);
+    const int32 null_device = _open("NUL", _O_WRONLY);
+    _dup2(null_device, 2);
+    _close(null_device);
+#else
+    s_saved_stderr = dup(2);
+    const int32 null_device = open("/dev/null", O_WRONLY);
+    dup2(null_device, 2);
+    close(null_device);
+#endif
+}
+
+static void RestoreStderr()
+{
+    fflush(stderr);
+#if defined(_WIN64)
+    _dup2(s_saved_stderr, 2);
+    _close(s_saved_stderr);
+#else
+    dup2(s_saved_stderr, 2);
+    close(s_saved_stderr);
+#endif
+    s_saved_stderr = -1;
+}
+
+static void LogRange(uint32 start, uint32 end)
+{
+    for (uint32 i = start; i < end; i++)
+        Raptor::Debug::Log("[Bench]: Loaded %s, %u of %u.\n", "textures/sponza_column_a_diff.png", i, end);
+}
+
+// Compiled out in release builds, trace is below the default level there.
+static void LogStrippedRange(uint32 start, uint32 end)
+{
+    for (uint32 i = start; i < end; i++)
+        Raptor::Debug::LogTrace("[Bench]: Loaded %s, %u of %u.\n", "textures/sponza_column_a_diff.png", i, end);
+}
+
+static void LogWriteBench(uint32 count)
+{
+    JobSystem::instance()->ParallelFor(count, LOG_BATCH_SIZE, LogRange);
+}
+
+static void LogStrippedBench(uint32 count)
+{
+    JobSystem::instance()->ParallelFor(count, LOG_BATCH_SIZE, LogStrippedRange);
+}
+
+// Without LogInit() records are formatted and written on the calling thread.
+static void LogDirectSetup(uint32 count)
+{
+    SilenceStderr();
+}
+
+static void LogDirectTeardown(uint32 count)
+{
+    RestoreStderr();
+}
+
+static void LogAsyncSetup(uint32 count)
+{
+    SilenceStderr();
+    Raptor::Debug::LogInit();
+}
+
+static void LogAsyncTeardown(uint32 count)
+{
+    Raptor::Debug::LogShutdown();
+    RestoreStderr();
+}
+
+// Profiler: zones around almost no work, the cost of PROFILE_ZONE itself.
+// The profiler is initialized once, threads keep pointing at their buffer.
+static bool s_profiler_initialized = false;
+
+static void ZoneCompiledOutBench(uint32 count)
+{
+    // What PROFILE_ZONE leaves of a scope with RAPTOR_PROFILER 0.
+    for (uint32 i = 0; i < count; i++)
+    {
+        ClobberMemory();
+    }
+}
+
+static void ZoneBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        ProfilerZone zone("BenchZone");
+        ClobberMemory();
+    }
+}
+
+// A capture per pass, the buffer would be full after the first one.
+static void ZoneCapturingBench(uint32 count)
+{
+    Profiler::instance()->BeginCapture();
+    ZoneBench(count);
+    Profiler::instance()->EndCapture();
+}
+
+static void ProfilerSetup(uint32 count)
+{
+    if (s_profiler_initialized)
+        return;
+
+    Profiler::instance()->init(MallocAllocator::instance(), 1, count);
+    s_profiler_initialized = true;
+}
+
+// Setup and teardown run outside of the measured passes.
+struct Benchmark
+{
+    const char* name;
+    const char* variant;
+    BenchFunction function;
+    uint32 count;
+    BenchFunction setup = nullptr;
+    BenchFunction teardown = nullptr;
+    // Runs on the job system started with this many threads, 0 for none.
+    uint32 threads = 0;
+}; // struct Benchmark
+
+#define MAP_BENCHMARKS(suffix, count) \
+    {"hash_map_insert_" suffix, "eastl", MapBench<EASTLMap>::Insert, count}, \
+    {"hash_map_insert_" suffix, "raptor", MapBench<RaptorMap>::Insert, count}, \
+    {"hash_map_find_" suffix, "eastl", MapBench<EASTLMap>::Find, count, MapBench<EASTLMap>::Fill, MapBench<EASTLMap>::Destroy}, \
+    {"hash_map_find_" suffix, "raptor", MapBench<RaptorMap>::Find, count, MapBench<RaptorMap>::Fill, MapBench<RaptorMap>::Destroy}, \
+    {"hash_map_find_missing_" suffix, "eastl", MapBench<EASTLMap>::FindMissing, count, MapBench<EASTLMap>::Fill, MapBench<EASTLMap>::Destroy}, \
+    {"hash_map_find_missing_" suffix, "raptor", MapBench<RaptorMap>::FindMissing, count, MapBench<RaptorMap>::Fill, MapBench<RaptorMap>::Destroy}, \
+    {"hash_map_erase_insert_" suffix, "eastl", MapBench<EASTLMap>::Erase, count, MapBench<EASTLMap>::Fill, MapBench<EASTLMap>::Destroy}, \
+    {"hash_map_erase_insert_" suffix, "raptor", MapBench<RaptorMap>::Erase, count, MapBench<RaptorMap>::Fill, MapBench<RaptorMap>::Destroy}
+
+#define JOB_BENCHMARKS(threads, variant) \
+    {"job_parallel_for_1m", variant, ParallelForBench, PARALLEL_FOR_COUNT, nullptr, nullptr, threads}, \
+    {"job_fan_out_2k", variant, FanOutBench, FAN_OUT_COUNT, nullptr, nullptr, threads}
+
+// The direct variant is the synchronous logger the async one replaced.
+#define LOG_BENCHMARKS(threads, suffix) \
+    {"log_write_" suffix, "direct", LogWriteBench, LOG_COUNT, LogDirectSetup, LogDirectTeardown, threads}, \
+    {"log_write_" suffix, "async", LogWriteBench, LOG_COUNT, LogAsyncSetup, LogAsyncTeardown, threads}, \
+    {"log_write_" suffix, "stripped", LogStrippedBench, LOG_COUNT, LogDirectSetup, LogDirectTeardown, threads}
+
+static const Benchmark s_benchmarks[] =
+{
+    {"allocator_frame_1k", "eastl", FrameEASTLBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_frame_1k", "malloc", FrameMallocBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_frame_1k", "heap", FrameHeapBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_frame_1k", "linear", FrameLinearBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_frame_1k", "double", FrameDoubleBufferedBench, FRAME_ALLOCATION_COUNT},
+
+    {"allocator_scratch_1k", "eastl", ScratchEASTLBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_scratch_1k", "malloc", ScratchMallocBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_scratch_1k", "heap", ScratchHeapBench, FRAME_ALLOCATION_COUNT},
+    {"allocator_scratch_1k", "stack", ScratchStackBench, FRAME_ALLOCATION_COUNT},
+
+    {"allocator_array_4k", "eastl", ArrayEASTLBench, ARRAY_COUNT},
+    {"allocator_array_4k", "malloc", ArrayMallocBench, ARRAY_COUNT},
+    {"allocator_array_4k", "heap", ArrayHeapBench, ARRAY_COUNT},
+    {"allocator_array_4k", "linear", ArrayLinearBench, ARRAY_COUNT},
+
+    MAP_BENCHMARKS("1k", MAP_SMALL_COUNT),
+    MAP_BENCHMARKS("32k", MAP_CACHE_COUNT),
+    MAP_BENCHMARKS("1m", MAP_MEMORY_COUNT),
+
+    {"name_intern_100k", "malloc", NameInternMallocBench, NAME_COUNT},
+    {"name_intern_100k", "table", NameInternTableBench, NAME_COUNT},
+    {"name_find_100k", "malloc", NameFindMallocBench, NAME_COUNT, NameMapFill, NameMapDestroy},
+    {"name_find_100k", "table", NameFindTableBench, NAME_COUNT},
+    {"name_hash_100k", "rehash", NameHashRehashBench, NAME_COUNT},
+    {"name_hash_100k", "table", NameHashTableBench, NAME_COUNT},
+
+    JOB_BENCHMARKS(1, "1t"),
+    JOB_BENCHMARKS(2, "2t"),
+    JOB_BENCHMARKS(4, "4t"),
+    JOB_BENCHMARKS(8, "8t"),
+    JOB_BENCHMARKS(16, "16t"),
+    JOB_BENCHMARKS(32, "32t"),
+    JOB_BENCHMARKS(64, "64t"),
+
+    {"profiler_zone", "compiled_out", ZoneCompiledOutBench, ZONE_COUNT, nullptr, nullptr, 1},
+    {"profiler_zone", "idle", ZoneBench, ZONE_COUNT, ProfilerSetup, nullptr, 1},
+    {"profiler_zone", "capturing", ZoneCapturingBench, ZONE_COUNT, ProfilerSetup, nullptr, 1},
+
+    LOG_BENCHMARKS(1, "1t"),
+    LOG_BENCHMARKS(8, "8t"),
+};
+
+static const uint32 BENCHMARK_COUNT = sizeof(s_benchmarks) / sizeof(s_benchmarks[0]);
+
+// Runner ----------------------------------------------------------------------
+
+struct BenchResult
+{
+    const Benchmark* benchmark;
+    uint64 passes;
+    double best_ns;             // Per element, fastest repetition.
+    double median_ns;
+    double baseline_ns;         // Best of the first variant of the same name.
+}; // struct BenchResult
+
+static const uint32 MAX_REPETITIONS = 32;
+
+// Passes a repetition takes to last at least min_time, doubling from one.
+static uint64 CalibratePasses(const Benchmark& benchmark, double min_time)
+{
+    uint64 passes = 1;
+    while (true)
+    {
+        const int64 begin = Raptor::Core::Time::Now();
+        for (uint64 pass = 0; pass < passes; pass++)
+        {
+            benchmark.function(benchmark.count);
+            ClobberMemory();
+        }
+        const double seconds = Raptor::Core::Time::DeltaSeconds(begin, Raptor::Core::Time::Now());
+
+        if (seconds >= min_time)
+            return passes;
+
+        // Jump close to the target once the time is measurable.
+        if (seconds > min_time * 0.01)
+            passes = (uint64)(passes * min_time * 1.2 / seconds) + 1;
+        else
+            passes *= 10;
+    }
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    const double lhs = *(const double*)a;
+    const double rhs = *(const double*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static BenchResult Run(const Benchmark& benchmark, double min_time, uint32 repetitions)
+{
+    if (benchmark.threads > 1)
+        JobSystem::instance()->init(MallocAllocator::instance(), benchmark.threads - 1);
+    if (benchmark.setup)
+        benchmark.setup(benchmark.count);
+
+    // Warms the caches and the branch predictors.
+    benchmark.function(benchmark.count);
+
+    BenchResult result = {&benchmark, CalibratePasses(benchmark, min_time), 0.0, 0.0, 0.0};
+
+    double ns[MAX_REPETITIONS];
+    for (uint32 repetition = 0; repetition < repetitions; repetition++)
+    {
+        const int64 begin = Raptor::Core::Time::Now();
+        for (uint64 pass = 0; pass < result.passes; pass++)
+        {
+            benchmark.function(benchmark.count);
+            ClobberMemory();
+        }
+        const double seconds = Raptor::Core::Time::DeltaSeconds(begin, Raptor::Core::Time::Now());
+        ns[repetition] = seconds * 1e9 / ((double)result.passes * benchmark.count);
+    }
+
+    if (benchmark.teardown)
+        benchmark.teardown(benchmark.count);
+    if (benchmark.threads > 1)
+        JobSystem::instance()->shutdown();
+
+    qsort(ns, repetitions, sizeof(double), CompareDoubles);
+    result.best_ns = ns[0];
+    result.median_ns = ns[repetitions / 2];
+    return result;
+}
+
+// Reports ---------------------------------------------------------------------
+
+struct ReportValue
+{
+    const char* name;
+    const char* variant;
+    char metric[32];
+    double value;
+}; // struct ReportValue
+
+static const uint32 MAX_REPORT_VALUES = 256;
+
+static ReportValue s_report_values[MAX_REPORT_VALUES];
+static uint32 s_report_value_count = 0;
+
+static void AddReportValue(const char* name, const char* variant, const char* metric, double value)
+{
+    if (s_report_value_count == MAX_REPORT_VALUES)
+        return;
+
+    ReportValue& report_value = s_report_values[s_report_value_count++];
+    report_value.name = name;
+    report_value.variant = variant;
+    snprintf(report_value.metric, sizeof(report_value.metric), "%s", metric);
+    report_value.value = value;
+
+    printf("%-28s %-8s %-24s %14.3f\n", name, variant, metric, value);
+}
+
+// Adds mean, 99th percentile and maximum of the samples, sorting them.
+static void AddLatencyValues(const char* name, const char* variant, const char* metric, double* samples, uint32 count)
+{
+    double sum = 0.0;
+    for (uint32 i = 0; i < count; i++)
+        sum += samples[i];
+
+    qsort(samples, count, sizeof(double), CompareDoubles);
+
+    char metric_name[32];
+    snprintf(metric_name, sizeof(metric_name), "%s_mean_ns", metric);
+    AddReportValue(name, variant, metric_name, sum / count);
+    snprintf(metric_name, sizeof(metric_name), "%s_p99_ns", metric);
+    AddReportValue(name, variant, metric_name, samples[(uint32)((count - 1) * 0.99)]);
+    snprintf(metric_name, sizeof(metric_name), "%s_max_ns", metric);
+    AddReportValue(name, variant, metric_name, samples[count - 1]);
+}
+
+static inline int64 NowNanoseconds()
+{
+    // Time::Now() counts microseconds, too coarse for a single allocation.
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Scene load/unload on the heap: every scene allocates a mix of small
+// records, medium buffers and large textures, then frees them in random
+// order when the next one loads. A few allocations of every scene stay
+// alive, like caches and interned names, and split the free space. The
+// latency of every call is sampled, timer overhead included, and
+// fragmentation is queried after every unload.
+static const uint32 SCENE_COUNT = 32;
+static const uint32 SCENE_SMALL_COUNT = 16 * 1024;
+static const uint32 SCENE_MEDIUM_COUNT = 512;
+static const uint32 SCENE_LARGE_COUNT = 16;
+static const uint32 SCENE_ALLOCATION_COUNT = SCENE_SMALL_COUNT + SCENE_MEDIUM_COUNT + SCENE_LARGE_COUNT;
+static const uint32 SCENE_RESIDENT_INTERVAL = 64;
+static const sizet SCENE_HEAP_POOL_SIZE = 64 * 1024 * 1024;
+
+struct SceneTrace
+{
+    uint32 sizes[SCENE_COUNT][SCENE_ALLOCATION_COUNT];
+    uint32 free_order[SCENE_COUNT][SCENE_ALLOCATION_COUNT];
+}; // struct SceneTrace
+
+static uint32 NextRandom(uint32& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static void BuildSceneTrace(SceneTrace& trace)
+{
+    uint32 state = 7;
+    for (uint32 scene = 0; scene < SCENE_COUNT; scene++)
+    {
+        uint32* sizes = trace.sizes[scene];
+        for (uint32 i = 0; i < SCENE_ALLOCATION_COUNT; i++)
+        {
+            // Interleaved in allocation order the way a loader walks the file.
+            const uint32 kind = NextRandom(state) % SCENE_ALLOCATION_COUNT;
+            if (kind < SCENE_LARGE_COUNT)
+                sizes[i] = 256 * 1024 + NextRandom(state) % (1792 * 1024);
+            else if (kind < SCENE_LARGE_COUNT + SCENE_MEDIUM_COUNT)
+                sizes[i] = 4 * 1024 + NextRandom(state) % (60 * 1024);
+            else
+                sizes[i] = 16 + NextRandom(state) % 496;
+        }
+
+        uint32* order = trace.free_order[scene];
+        for (uint32 i = 0; i < SCENE_ALLOCATION_COUNT; i++)
+            order[i] = i;
+        for (uint32 i = SCENE_ALLOCATION_COUNT - 1; i > 0; i--)
+        {
+            const uint32 j = NextRandom(state) % (i + 1);
+            const uint32 swap = order[i];
+            order[i] = order[j];
+            order[j] = swap;
+        }
+    }
+}
+
+template<typename AllocateFunction, typename FreeFunction>
+static void RunSceneTrace(const SceneTrace& trace, const char* variant, const AllocateFunction& allocate, const FreeFunction& free,
+                          HeapAllocator* heap)
+{
+    void** allocations = new void*[SCENE_ALLOCATION_COUNT];
+    void** residents = new void*[SCENE_COUNT * (SCENE_ALLOCATION_COUNT / SCENE_RESIDENT_INTERVAL + 1)];
+    double* allocate_ns = new double[SCENE_COUNT * SCENE_ALLOCATION_COUNT];
+    double* free_ns = new double[SCENE_COUNT * SCENE_ALLOCATION_COUNT];
+    uint32 resident_count = 0;
+    uint32 allocate_count = 0;
+    uint32 free_count = 0;
+    float max_fragmentation = 0.f;
+
+    for (uint32 scene = 0; scene < SCENE_COUNT; scene++)
+    {
+        for (uint32 i = 0; i < SCENE_ALLOCATION_COUNT; i++)
+        {
+            const int64 begin = NowNanoseconds();
+            uint8* memory = (uint8*)allocate(trace.sizes[scene][i]);
+            allocate_ns[allocate_count++] = (double)(NowNanoseconds() - begin);
+
+            memory[0] = (uint8)i;
+            allocations[i] = memory;
+        }
+
+        for (uint32 i = 0; i < SCENE_ALLOCATION_COUNT; i++)
+        {
+            const uint32 index = trace.free_order[scene][i];
+            if (index % SCENE_RESIDENT_INTERVAL == 0)
+            {
+                residents[resident_count++] = allocations[index];
+                continue;
+            }
+
+            const int64 begin = NowNanoseconds();
+            free(allocations[index]);
+            free_ns[free_count++] = (double)(NowNanoseconds() - begin);
+        }
+
+        if (heap)
+        {
+            HeapStatistics statistics;
+            heap->QueryStatistics(statistics);
+            max_fragmentation = MAX(max_fragmentation, statistics.fragmentation);
+        }
+    }
+
+    AddLatencyValues("heap_scene_load_unload", variant, "allocate", allocate_ns, allocate_count);
+    AddLatencyValues("heap_scene_load_unload", variant, "free", free_ns, free_count);
+
+    if (heap)
+    {
+        HeapStatistics statistics;
+        heap->QueryStatistics(statistics);
+        AddReportValue("heap_scene_load_unload", variant, "fragmentation_max", max_fragmentation);
+        AddReportValue("heap_scene_load_unload", variant, "fragmentation_last", statistics.fragmentation);
+        AddReportValue("heap_scene_load_unload", variant, "free_blocks_last", statistics.free_blocks);
+        AddReportValue("heap_scene_load_unload", variant, "resident_mb", statistics.total_live_bytes / (1024.0 * 1024.0));
+        AddReportValue("heap_scene_load_unload", variant, "peak_mb", statistics.total_peak_bytes / (1024.0 * 1024.0));
+        AddReportValue("heap_scene_load_unload", variant, "pool_mb", statistics.pool_bytes / (1024.0 * 1024.0));
+        AddReportValue("heap_scene_load_unload", variant, "pools", statistics.pools);
+    }
+
+    for (uint32 i = 0; i < resident_count; i++)
+        free(residents[i]);
+
+    delete[] free_ns;
+    delete[] allocate_ns;
+    delete[] residents;
+    delete[] allocations;
+}
+
+static void HeapSceneReport()
+{
+    SceneTrace* trace = new SceneTrace;
+    BuildSceneTrace(*trace);
+
+    RunSceneTrace(*trace, "malloc",
+                  [](sizet size) { return MallocAllocator::instance()->allocate(size, 16, 0, 0); },
+                  [](void* pointer) { MallocAllocator::instance()->deallocate(pointer, 0); },
+                  nullptr);
+
+    HeapAllocator heap;
+    heap.init(MallocAllocator::instance(), SCENE_HEAP_POOL_SIZE);
+    RunSceneTrace(*trace, "heap",
+                  [&heap](sizet size) { return heap.Allocate(size, 16, MemoryTag::Assets); },
+                  [&heap](void* pointer) { heap.Free(pointer); },
+                  &heap);
+    heap.shutdown();
+
+    delete trace;
+}
+
+// Counts what is asked of the MallocAllocator. Chunk bytes estimate what
+// glibc takes for it: the size plus an 8 byte header, rounded up to 16 bytes
+// and 32 at least.
+class CountingAllocator : public Allocator
+{
+public:
+
+    void* allocate(sizet size, int flags = 0) override { return allocate(size, DEFAULT_ALIGNMENT, 0, flags); }
+
+    void* allocate(sizet size, sizet alignment, sizet offset, int flags = 0) override
+    {
+        live_bytes += size;
+        peak_bytes = MAX(peak_bytes, live_bytes);
+        chunk_bytes += MAX(MemoryAlign(size + 8, 16), (sizet)32);
+        allocations++;
+        return MallocAllocator::instance()->allocate(size, alignment, offset, flags);
+    }
+
+    void deallocate(void* pointer, sizet size) override
+    {
+        live_bytes -= size;
+        chunk_bytes -= MAX(MemoryAlign(size + 8, 16), (sizet)32);
+        MallocAllocator::instance()->deallocate(pointer, size);
+    }
+
+    sizet live_bytes = 0;
+    sizet peak_bytes = 0;
+    sizet chunk_bytes = 0;
+    uint32 allocations = 0;
+
+}; // class CountingAllocator
+
+static void AddNameMemoryValues(const char* variant, const CountingAllocator& allocator, uint32 count)
+{
+    AddReportValue("name_memory_100k", variant, "live_bytes", (double)allocator.live_bytes);
+    AddReportValue("name_memory_100k", variant, "peak_bytes", (double)allocator.peak_bytes);
+    AddReportValue("name_memory_100k", variant, "chunk_bytes", (double)allocator.chunk_bytes);
+    AddReportValue("name_memory_100k", variant, "chunk_bytes_per_name", (double)allocator.chunk_bytes / count);
+    AddReportValue("name_memory_100k", variant, "allocations", allocator.allocations);
+}
+
+// Memory held by 100k names. Both store the map, the table adds the entry
+// array and packs the strings into pages.
+static void NameMemoryReport()
+{
+    sizet string_bytes = 0;
+    for (uint32 i = 0; i < NAME_COUNT; i++)
+        string_bytes += strlen(s_data.names[i]) + 1;
+    AddReportValue("name_memory_100k", "strings", "bytes", (double)string_bytes);
+
+    {
+        CountingAllocator allocator;
+        NameMap map {ContainerAllocator(allocator)};
+        InternNames(allocator, map, NAME_COUNT);
+        AddNameMemoryValues("malloc", allocator, NAME_COUNT);
+        FreeNames(allocator, map);
+    }
+
+    {
+        CountingAllocator allocator;
+        NameTable table;
+        table.init(&allocator);
+        for (uint32 i = 0; i < NAME_COUNT; i++)
+            table.Intern(s_data.names[i]);
+        AddNameMemoryValues("table", allocator, NAME_COUNT);
+        AddReportValue("name_memory_100k", "table", "memory_used", (double)table.MemoryUsed());
+        table.shutdown();
+    }
+}
+
+typedef void (*ReportFunction)();
+
+struct Report
+{
+    const char* name;
+    ReportFunction function;
+}; // struct Report
+
+static const Report s_reports[] =
+{
+    {"heap_scene_load_unload", HeapSceneReport},
+    {"name_memory_100k", NameMemoryReport},
+};
+
+static const uint32 REPORT_COUNT = sizeof(s_reports) / sizeof(s_reports[0]);
+
+// Checks ----------------------------------------------------------------------
+
+static uint32 s_failed_checks = 0;
+
+#define CHECK(condition) if (!(condition)) { printf("    Failed: %s (line %d)\n", #condition, __LINE__); s_failed_checks++; }
+
+// Requests close to and above the pool size need a pool of their own that is
+// large enough for the rounded up size the free lists are searched with.
+static void CheckHeapLargeAllocations()
+{
+    static const sizet POOL_SIZE = 64 * 1024 * 1024;
+    const sizet sizes[] = {POOL_SIZE - 1024 * 1024, (sizet)(63.6 * 1024 * 1024), POOL_SIZE - 1024, POOL_SIZE, POOL_SIZE + 1, 101 * 1024 * 1024};
+    const sizet alignments[] = {16, 256, 4096};
+
+    for (sizet alignment : alignments)
+    {
+        for (sizet size : sizes)
+        {
+            HeapAllocator heap;
+            heap.init(MallocAllocator::instance(), POOL_SIZE);
+
+            // Something in the first pool, so the request cannot take all of it.
+            void* small = heap.Allocate(64, 16, MemoryTag::Core);
+            uint8* memory = (uint8*)heap.Allocate(size, alignment, MemoryTag::Assets);
+            CHECK(small != nullptr);
+            CHECK(memory != nullptr);
+            if (memory)
+            {
+                CHECK(((sizet)memory & (alignment - 1)) == 0);
+                memory[0] = 1;
+                memory[size - 1] = 1;
+                CHECK(heap.LiveBytes(MemoryTag::Assets) >= size);
+                heap.Free(memory);
+            }
+            heap.Free(small);
+            CHECK(heap.TotalLiveBytes() == 0);
+
+            heap.shutdown();
+        }
+    }
+}
+
+static std::atomic<uint32> s_continuation_runs[12];
+static std::atomic<uint32> s_plain_job_runs {0};
+
+static void CountContinuationJob(void* data)
+{
+    s_continuation_runs[(uintptr_t)data].fetch_add(1, std::memory_order_relaxed);
+}
+
+static void CountPlainJob(void* data)
+{
+    s_plain_job_runs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Continuations parked on reads that are still in flight keep their job
+// slots while the ring wraps around them many times. Each of them has to
+// run once, with its own data.
+static void CheckJobParkedContinuations()
+{
+    static const uint32 JOBS_PER_THREAD = 16;
+    static const uint32 PARKED_COUNT = sizeof(s_continuation_runs) / sizeof(s_continuation_runs[0]);
+    static const uint32 ROUND_COUNT = 2000;
+
+    JobSystem* job_system = JobSystem::instance();
+    job_system->init(MallocAllocator::instance(), 2, JOBS_PER_THREAD);
+
+    for (std::atomic<uint32>& runs : s_continuation_runs)
+        runs.store(0, std::memory_order_relaxed);
+    s_plain_job_runs.store(0, std::memory_order_relaxed);
+
+    JobCounter reads[PARKED_COUNT];
+    for (uint32 i = 0; i < PARKED_COUNT; i++)
+    {
+        job_system->Increment(&reads[i]);
+        job_system->RunAfter(&reads[i], {CountContinuationJob, (void*)(uintptr_t)i});
+    }
+
+    JobCounter counter;
+    for (uint32 round = 0; round < ROUND_COUNT; round++)
+    {
+        const JobDeclaration jobs[3] = {{CountPlainJob}, {CountPlainJob}, {CountPlainJob}};
+        job_system->Run(jobs, 3, &counter);
+    }
+    job_system->Wait(&counter);
+    CHECK(s_plain_job_runs.load() == ROUND_COUNT * 3);
+
+    for (uint32 i = 0; i < PARKED_COUNT; i++)
+        job_system->Decrement(&reads[i]);
+
+    // The counters of the reads are done, their continuations are queued.
+    for (uint32 finished = 0; finished < PARKED_COUNT;)
+    {
+        finished = 0;
+        for (std::atomic<uint32>& runs : s_continuation_runs)
+            finished += runs.load() != 0;
+        if (!job_system->RunJob())
+            std::this_thread::yield();
+    }
+
+    for (std::atomic<uint32>& runs : s_continuation_runs)
+        CHECK(runs.load() == 1);
+
+    job_system->shutdown();
+}
+
+typedef void (*CheckFunction)();
+
+struct Check
+{
+    const char* name;
+    CheckFunction function;
+}; // struct Check
+
+static const Check s_checks[] =
+{
+    {"heap_large_allocations", CheckHeapLargeAllocations},
+    {"job_parked_continuations", CheckJobParkedContinuations},
+};
+
+static const uint32 CHECK_COUNT = sizeof(s_checks) / sizeof(s_checks[0]);
+
+static int RunChecks(const char* filter)
+{
+    for (uint32 i = 0; i < CHECK_COUNT; i++)
+    {
+        const Check& check = s_checks[i];
+        if (filter && !strstr(check.name, filter))
+            continue;
+
+        const uint32 failed_before = s_failed_checks;
+        check.function();
+        printf("%-28s %s\n", check.name, s_failed_checks == failed_before ? "ok" : "FAILED");
+    }
+
+    return s_failed_checks ? 1 : 0;
+}
+
+// Output ----------------------------------------------------------------------
+
+static double Speedup(const BenchResult& result)
+{
+    return result.baseline_ns / result.best_ns;
+}
+
+static bool WriteJSON(const char* filename, const BenchResult* results, uint32 count, const char* date, double min_time, uint32 repetitions)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+#if defined(NDEBUG)
+    fprintf(file, "    \"build\": \"release\",\n");
+#else
+    fprintf(file, "    \"build\": \"debug\",\n");
+#endif
+    fprintf(file, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(file, "    \"min_time\": %g,\n", min_time);
+    fprintf(file, "    \"repetitions\": %u\n", repetitions);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (uint32 i = 0; i < count; i++)
+    {
+        const BenchResult& result = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"variant\": \"%s\", \"count\": %u, \"ns_per_item\": %.4f, \"ns_per_item_median\": %.4f, "
+                      "\"items_per_second\": %.0f, \"baseline_ns_per_item\": %.4f, \"speedup\": %.3f}%s\n",
+                result.benchmark->name, result.benchmark->variant, result.benchmark->count, result.best_ns, result.median_ns,
+                1e9 / result.best_ns, result.baseline_ns, Speedup(result), i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+    fprintf(file, "  \"reports\": [\n");
+    for (uint32 i = 0; i < s_report_value_count; i++)
+    {
+        const ReportValue& report_value = s_report_values[i];
+        fprintf(file, "    {\"name\": \"%s\", \"variant\": \"%s\", \"metric\": \"%s\", \"value\": %.4f}%s\n",
+                report_value.name, report_value.variant, report_value.metric, report_value.value, i + 1 < s_report_value_count ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    fclose(file);
+    return true;
+}
+
+static bool WriteCSV(const char* filename, const BenchResult* results, uint32 count)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "name,variant,count,ns_per_item,ns_per_item_median,items_per_second,baseline_ns_per_item,speedup\n");
+    for (uint32 i = 0; i < count; i++)
+    {
+        const BenchResult& result = results[i];
+        fprintf(file, "%s,%s,%u,%.4f,%.4f,%.0f,%.4f,%.3f\n", result.benchmark->name, result.benchmark->variant, result.benchmark->count,
+                result.best_ns, result.median_ns, 1e9 / result.best_ns, result.baseline_ns, Speedup(result));
+    }
+
+    fclose(file);
+    return true;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: RaptorCoreBench [--filter text] [--min-time seconds] [--repetitions n] [--threads n] [--json file] [--csv file]\n");
+    printf("       RaptorCoreBench --check [--filter text]\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    const char* json_filename = nullptr;
+    const char* csv_filename = nullptr;
+    double min_time = 0.1;
+    uint32 repetitions = 5;
+    bool check = false;
+    uint32 max_threads = std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--filter") && has_value)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && has_value)
+            min_time = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--repetitions") && has_value)
+            repetitions = (uint32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && has_value)
+            json_filename = argv[++i];
+        else if (!strcmp(argv[i], "--csv") && has_value)
+            csv_filename = argv[++i];
+        else if (!strcmp(argv[i], "--threads") && has_value)
+            max_threads = (uint32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (repetitions < 1)
+        repetitions = 1;
+    if (repetitions > MAX_REPETITIONS)
+        repetitions = MAX_REPETITIONS;
+    if (min_time <= 0.0)
+        min_time = 0.1;
+    if (max_threads < 1)
+        max_threads = 1;
+    if (max_threads > JobSystem::MAX_THREADS)
+        max_threads = JobSystem::MAX_THREADS;
+
+    Raptor::Core::Time::Init();
+
+    if (check)
+        return RunChecks(filter);
+
+    InitData();
+
+    char date[32];
+    const time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+#if !defined(NDEBUG)
+    printf("Warning: debug build, the numbers are not representative.\n");
+#endif
+    printf("Hardware threads: %u, job benchmarks up to %u threads\n\n", std::thread::hardware_concurrency(), max_threads);
+    printf("%-28s %-8s %9s %12s %12s %14s %8s\n", "name", "variant", "count", "ns/item", "median", "items/s", "speedup");
+
+    BenchResult results[BENCHMARK_COUNT];
+    uint32 result_count = 0;
+    for (uint32 i = 0; i < BENCHMARK_COUNT; i++)
+    {
+        const Benchmark& benchmark = s_benchmarks[i];
+        if (filter && !strstr(benchmark.name, filter))
+            continue;
+        if (benchmark.threads > max_threads)
+            continue;
+
+        BenchResult result = Run(benchmark, min_time, repetitions);
+
+        // The baseline variant of a name always comes first.
+        result.baseline_ns = result.best_ns;
+        for (uint32 r = 0; r < result_count; r++)
+        {
+            if (!strcmp(results[r].benchmark->name, benchmark.name))
+            {
+                result.baseline_ns = results[r].best_ns;
+                break;
+            }
+        }
+
+        printf("%-28s %-8s %9u %12.3f %12.3f %14.0f %7.2fx\n", benchmark.name, benchmark.variant, benchmark.count,
+               result.best_ns, result.median_ns, 1e9 / result.best_ns, Speedup(result));
+        results[result_count++] = result;
+    }
+
+    printf("\n%-28s %-8s %-24s %14s\n", "report", "variant", "metric", "value");
+    for (uint32 i = 0; i < REPORT_COUNT; i++)
+    {
+        const Report& report = s_reports[i];
+        if (filter && !strstr(report.name, filter))
+            continue;
+
+        report.function();
+    }
+
+    int exit_code = 0;
+    if (json_filename && !WriteJSON(json_filename, results, result_count, date, min_time, repetitions))
+    {
+        printf("Error: Could not write %s\n", json_filename);
+        exit_code = 1;
+    }
+    if (csv_filename && !WriteCSV(csv_filename, results, result_count))
+    {
+        printf("Error: Could not write %s\n", csv_filename);
+        exit_code = 1;
+    }
+
+    ShutdownData();
+    return exit_code;
+}
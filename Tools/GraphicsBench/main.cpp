@@ -0,0 +1,809 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "Allocator.h"
+#include "Buffer.h"
+#include "Defines.h"
+#include "JobSystem.h"
+#include "Pipeline.h"
+#include "ResourcePool.h"
+#include "TimeService.h"
+
+// Microbenchmarks of the Graphics library that need no GPU.
+//
+//   RaptorGraphicsBench [--filter text] [--variant text] [--min-time seconds]
+//                       [--repetitions n] [--threads n] [--json file] [--csv file]
+//   RaptorGraphicsBench --check
+//
+// Runs like RaptorCoreBench: every benchmark runs for at least min-time per
+// repetition, the fastest repetition is reported along with the median and
+// the first variant of a name is the baseline of the others. Build in
+// release, the numbers of a debug build say nothing.
+//
+// Resource pool contention runs with 1, 2, 4... 32 threads up to the hardware
+// threads or --threads. An item is one slot obtained, written and released.
+//
+// Command recording reads the pools the way CommandBuffer does for a frame of
+// 50k draws, an item is one draw. Its cache misses are counted with perf,
+// one variant at a time so the counters are not mixed:
+//
+//   perf stat -e cycles,instructions,cache-misses,L1-dcache-load-misses RaptorGraphicsBench
+//             --filter command_record --variant whole --min-time 2
+//
+// and again with --variant hot. The counters include the setup of the
+// buffers, run both variants for the same time to compare them.
+//
+// --check runs the regression checks instead and exits with 1 if one fails.
+
+using namespace Raptor::Core;
+using namespace Raptor::Graphics;
+
+// Keeps the compiler from dropping or hoisting the measured work.
+#if defined(__GNUC__) || defined(__clang__)
+static inline void ClobberMemory() { asm volatile("" : : : "memory"); }
+#elif defined(_MSC_VER)
+static inline void ClobberMemory() { _ReadWriteBarrier(); }
+#else
+static inline void ClobberMemory() {}
+#endif
+
+typedef void (*BenchFunction)(uint32 count);
+
+// Resource pool contention ----------------------------------------------------
+
+// Every thread holds a few slots at once like a loader creating the buffers
+// of a mesh, then gives them back. The baseline is a single-threaded pool
+// behind a mutex, what the engine would do without the concurrent mode.
+static const uint32 POOL_CONTENTION_COUNT = 64 * 1024;
+static const uint32 POOL_HELD_SLOTS = 8;
+static const uint32 POOL_BATCH_SIZE = 256;
+static const uint32 POOL_PAGE_SIZE = 256;
+
+static_assert(POOL_BATCH_SIZE % POOL_HELD_SLOTS == 0, "Batches hold whole groups of slots.");
+
+// The size of a small resource, the owner is written like a creation would.
+struct PoolResource
+{
+    uint32 owner;
+    uint32 data[15];
+}; // struct PoolResource
+
+static ResourcePool s_pool;
+static std::mutex s_pool_mutex;
+
+static void WriteResource(ResourcePool& pool, uint32 handle, uint32 owner)
+{
+    PoolResource* resource = (PoolResource*)pool.accessResource(handle);
+    resource->owner = owner;
+    resource->data[0] = handle;
+}
+
+static void PoolLockFreeRange(uint32 start, uint32 end)
+{
+    uint32 handles[POOL_HELD_SLOTS];
+    for (uint32 i = start; i < end; i += POOL_HELD_SLOTS)
+    {
+        for (uint32 slot = 0; slot < POOL_HELD_SLOTS; slot++)
+        {
+            handles[slot] = s_pool.obtainResource();
+            WriteResource(s_pool, handles[slot], i);
+        }
+        for (uint32 slot = 0; slot < POOL_HELD_SLOTS; slot++)
+            s_pool.releaseResource(handles[slot]);
+    }
+}
+
+static void PoolMutexRange(uint32 start, uint32 end)
+{
+    uint32 handles[POOL_HELD_SLOTS];
+    for (uint32 i = start; i < end; i += POOL_HELD_SLOTS)
+    {
+        for (uint32 slot = 0; slot < POOL_HELD_SLOTS; slot++)
+        {
+            std::lock_guard<std::mutex> lock(s_pool_mutex);
+            handles[slot] = s_pool.obtainResource();
+            WriteResource(s_pool, handles[slot], i);
+        }
+        for (uint32 slot = 0; slot < POOL_HELD_SLOTS; slot++)
+        {
+            std::lock_guard<std::mutex> lock(s_pool_mutex);
+            s_pool.releaseResource(handles[slot]);
+        }
+    }
+}
+
+static void PoolLockFreeBench(uint32 count)
+{
+    JobSystem::instance()->ParallelFor(count, POOL_BATCH_SIZE, PoolLockFreeRange);
+}
+
+static void PoolMutexBench(uint32 count)
+{
+    JobSystem::instance()->ParallelFor(count, POOL_BATCH_SIZE, PoolMutexRange);
+}
+
+static void PoolMutexSetup(uint32 count)
+{
+    s_pool.init(MallocAllocator::instance(), POOL_PAGE_SIZE, sizeof(PoolResource));
+}
+
+// Room for every thread to hold its slots, pages are added while running.
+static void PoolLockFreeSetup(uint32 count)
+{
+    s_pool.initConcurrent(MallocAllocator::instance(), POOL_PAGE_SIZE, sizeof(PoolResource), JobSystem::MAX_THREADS * POOL_HELD_SLOTS);
+}
+
+static void PoolTeardown(uint32 count)
+{
+    s_pool.shutdown();
+}
+
+// Command recording -----------------------------------------------------------
+
+// A frame of draws sorted by pipeline, every draw with its own vertex, index
+// and uniform buffers sub-allocated from a few large ones, like the meshes of
+// a loaded scene. The buffers are bound in shuffled order, as they are once
+// draws are sorted by material rather than by load order. 300k buffers make
+// 19.2 MB of Buffer and 4.8 MB of BufferHot, more than a L2 cache holds.
+static const uint32 RECORD_DRAW_COUNT = 50 * 1000;
+static const uint32 RECORD_VERTEX_STREAMS = 4;
+static const uint32 RECORD_BUFFERS_PER_DRAW = RECORD_VERTEX_STREAMS + 2;
+static const uint32 RECORD_BUFFER_COUNT = RECORD_DRAW_COUNT * RECORD_BUFFERS_PER_DRAW;
+static const uint32 RECORD_DRAWS_PER_PIPELINE = 800;
+static const uint32 RECORD_PIPELINE_COUNT = (RECORD_DRAW_COUNT + RECORD_DRAWS_PER_PIPELINE - 1) / RECORD_DRAWS_PER_PIPELINE;
+static const uint32 RECORD_PARENT_COUNT = 3;
+// Arguments of the vkCmd calls of a draw, what a driver would write: the
+// vertex and index buffers with their offsets, the uniform offset and the
+// draw. Pipeline changes add one more.
+static const uint32 RECORD_WORDS_PER_DRAW = RECORD_VERTEX_STREAMS * 2 + 2 + 2;
+static const uint32 RECORD_COMMAND_WORDS = RECORD_WORDS_PER_DRAW * RECORD_DRAW_COUNT + RECORD_PIPELINE_COUNT;
+
+struct RecordDraw
+{
+    PipelineHandle pipeline;
+    BufferHandle vertex_buffers[RECORD_VERTEX_STREAMS];
+    BufferHandle index_buffer;
+    BufferHandle uniform_buffer;
+    uint32 index_count;
+}; // struct RecordDraw
+
+struct RecordData
+{
+    ResourcePool buffers;
+    ResourcePool pipelines;
+    RecordDraw* draws;
+    uint64* commands;
+}; // struct RecordData
+
+static RecordData s_record;
+
+static uint32 NextRandom(uint32& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Pools like the ones GPUDevice creates, with the same structs and hot data.
+static void RecordSetup(uint32 count)
+{
+    Allocator* allocator = MallocAllocator::instance();
+    s_record.buffers.init(allocator, 1024, sizeof(Buffer), sizeof(BufferHot));
+    s_record.pipelines.init(allocator, 64, sizeof(Pipeline), sizeof(PipelineHot));
+    s_record.buffers.reserve(RECORD_PARENT_COUNT + RECORD_BUFFER_COUNT);
+
+    BufferHandle parents[RECORD_PARENT_COUNT];
+    for (uint32 i = 0; i < RECORD_PARENT_COUNT; i++)
+    {
+        parents[i] = s_record.buffers.obtainResource();
+        Buffer* buffer = new (s_record.buffers.accessResource(parents[i])) Buffer();
+        buffer->vk_buffer = (VkBuffer)(uintptr_t)(0x1000 + i * 0x10);
+        buffer->handle = parents[i];
+        buffer->parent_buffer = InvalidBuffer;
+        BufferHot* buffer_hot = new (s_record.buffers.accessHot(parents[i])) BufferHot();
+        buffer_hot->vk_buffer = buffer->vk_buffer;
+        buffer_hot->parent_buffer = InvalidBuffer;
+    }
+
+    BufferHandle* handles = (BufferHandle*)allocator->allocate(sizeof(BufferHandle) * RECORD_BUFFER_COUNT, alignof(BufferHandle), 0, 0);
+    for (uint32 i = 0; i < RECORD_BUFFER_COUNT; i++)
+    {
+        const BufferHandle handle = s_record.buffers.obtainResource();
+        const uint32 parent = i % RECORD_PARENT_COUNT;
+        Buffer* buffer = new (s_record.buffers.accessResource(handle)) Buffer();
+        buffer->vk_buffer = VK_NULL_HANDLE;
+        buffer->size = 256;
+        buffer->global_offset = (i / RECORD_PARENT_COUNT) * 256;
+        buffer->handle = handle;
+        buffer->parent_buffer = parents[parent];
+        // GPUDevice stores the parent VkBuffer in the hot data of sub-allocations.
+        BufferHot* buffer_hot = new (s_record.buffers.accessHot(handle)) BufferHot();
+        buffer_hot->vk_buffer = ((const BufferHot*)s_record.buffers.accessHot(parents[parent]))->vk_buffer;
+        buffer_hot->parent_buffer = parents[parent];
+        buffer_hot->global_offset = buffer->global_offset;
+        handles[i] = handle;
+    }
+
+    uint32 random_state = 0x9e3779b9u;
+    for (uint32 i = RECORD_BUFFER_COUNT - 1; i > 0; i--)
+    {
+        const uint32 j = NextRandom(random_state) % (i + 1);
+        const BufferHandle handle = handles[i];
+        handles[i] = handles[j];
+        handles[j] = handle;
+    }
+
+    PipelineHandle pipelines[RECORD_PIPELINE_COUNT];
+    for (uint32 i = 0; i < RECORD_PIPELINE_COUNT; i++)
+    {
+        pipelines[i] = s_record.pipelines.obtainResource();
+        Pipeline* pipeline = new (s_record.pipelines.accessResource(pipelines[i])) Pipeline();
+        pipeline->vk_pipeline = (VkPipeline)(uintptr_t)(0x2000 + i * 0x10);
+        pipeline->vk_pipeline_layout = (VkPipelineLayout)(uintptr_t)(0x3000 + i * 0x10);
+        pipeline->vk_pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        pipeline->handle = pipelines[i];
+        PipelineHot* pipeline_hot = new (s_record.pipelines.accessHot(pipelines[i])) PipelineHot();
+        pipeline_hot->vk_pipeline = pipeline->vk_pipeline;
+        pipeline_hot->vk_pipeline_layout = pipeline->vk_pipeline_layout;
+        pipeline_hot->vk_pipeline_bind_point = pipeline->vk_pipeline_bind_point;
+    }
+
+    s_record.draws = (RecordDraw*)allocator->allocate(sizeof(RecordDraw) * RECORD_DRAW_COUNT, alignof(RecordDraw), 0, 0);
+    for (uint32 i = 0; i < RECORD_DRAW_COUNT; i++)
+    {
+        RecordDraw& draw = s_record.draws[i];
+        const BufferHandle* draw_buffers = handles + i * RECORD_BUFFERS_PER_DRAW;
+        draw.pipeline = pipelines[i / RECORD_DRAWS_PER_PIPELINE];
+        for (uint32 stream = 0; stream < RECORD_VERTEX_STREAMS; stream++)
+            draw.vertex_buffers[stream] = draw_buffers[stream];
+        draw.index_buffer = draw_buffers[RECORD_VERTEX_STREAMS];
+        draw.uniform_buffer = draw_buffers[RECORD_VERTEX_STREAMS + 1];
+        draw.index_count = 3 * (64 + i % 1024);
+    }
+
+    s_record.commands = (uint64*)allocator->allocate(sizeof(uint64) * RECORD_COMMAND_WORDS, alignof(uint64), 0, 0);
+    allocator->deallocate(handles, sizeof(BufferHandle) * RECORD_BUFFER_COUNT);
+}
+
+static void RecordTeardown(uint32 count)
+{
+    Allocator* allocator = MallocAllocator::instance();
+    allocator->deallocate(s_record.commands, sizeof(uint64) * RECORD_COMMAND_WORDS);
+    allocator->deallocate(s_record.draws, sizeof(RecordDraw) * RECORD_DRAW_COUNT);
+
+    s_record.buffers.freeAllResources();
+    s_record.pipelines.freeAllResources();
+    s_record.buffers.shutdown();
+    s_record.pipelines.shutdown();
+}
+
+// CommandBuffer before the hot data: whole structs and a second lookup of
+// the parent of sub-allocated buffers.
+static void RecordWholeBench(uint32 count)
+{
+    uint64* command = s_record.commands;
+    PipelineHandle current_pipeline = InvalidPipeline;
+    const Pipeline* pipeline = nullptr;
+    for (uint32 i = 0; i < count; i++)
+    {
+        const RecordDraw& draw = s_record.draws[i];
+        if (draw.pipeline != current_pipeline)
+        {
+            pipeline = (const Pipeline*)s_record.pipelines.accessResource(draw.pipeline);
+            *command++ = (uint64)(uintptr_t)pipeline->vk_pipeline | pipeline->vk_pipeline_bind_point;
+            current_pipeline = draw.pipeline;
+        }
+
+        for (uint32 stream = 0; stream < RECORD_VERTEX_STREAMS; stream++)
+        {
+            const Buffer* buffer = (const Buffer*)s_record.buffers.accessResource(draw.vertex_buffers[stream]);
+            VkBuffer vk_buffer = buffer->vk_buffer;
+            uint64 offset = 0;
+            if (buffer->parent_buffer != InvalidBuffer)
+            {
+                vk_buffer = ((const Buffer*)s_record.buffers.accessResource(buffer->parent_buffer))->vk_buffer;
+                offset = buffer->global_offset;
+            }
+            *command++ = (uint64)(uintptr_t)vk_buffer;
+            *command++ = offset;
+        }
+
+        const Buffer* index_buffer = (const Buffer*)s_record.buffers.accessResource(draw.index_buffer);
+        VkBuffer vk_index_buffer = index_buffer->vk_buffer;
+        uint64 index_offset = 0;
+        if (index_buffer->parent_buffer != InvalidBuffer)
+        {
+            vk_index_buffer = ((const Buffer*)s_record.buffers.accessResource(index_buffer->parent_buffer))->vk_buffer;
+            index_offset = index_buffer->global_offset;
+        }
+        *command++ = (uint64)(uintptr_t)vk_index_buffer;
+        *command++ = index_offset;
+
+        // The dynamic offset of the uniform buffer, like BindDescriptorSet.
+        const Buffer* uniform_buffer = (const Buffer*)s_record.buffers.accessResource(draw.uniform_buffer);
+        *command++ = (uint64)(uintptr_t)pipeline->vk_pipeline_layout | uniform_buffer->global_offset;
+        *command++ = draw.index_count;
+    }
+}
+
+// CommandBuffer now: only the hot data, which holds the parent VkBuffer.
+static void RecordHotBench(uint32 count)
+{
+    uint64* command = s_record.commands;
+    PipelineHandle current_pipeline = InvalidPipeline;
+    const PipelineHot* pipeline = nullptr;
+    for (uint32 i = 0; i < count; i++)
+    {
+        const RecordDraw& draw = s_record.draws[i];
+        if (draw.pipeline != current_pipeline)
+        {
+            pipeline = (const PipelineHot*)s_record.pipelines.accessHot(draw.pipeline);
+            *command++ = (uint64)(uintptr_t)pipeline->vk_pipeline | pipeline->vk_pipeline_bind_point;
+            current_pipeline = draw.pipeline;
+        }
+
+        for (uint32 stream = 0; stream < RECORD_VERTEX_STREAMS; stream++)
+        {
+            const BufferHot* buffer = (const BufferHot*)s_record.buffers.accessHot(draw.vertex_buffers[stream]);
+            *command++ = (uint64)(uintptr_t)buffer->vk_buffer;
+            *command++ = buffer->parent_buffer != InvalidBuffer ? buffer->global_offset : 0;
+        }
+
+        const BufferHot* index_buffer = (const BufferHot*)s_record.buffers.accessHot(draw.index_buffer);
+        *command++ = (uint64)(uintptr_t)index_buffer->vk_buffer;
+        *command++ = index_buffer->parent_buffer != InvalidBuffer ? index_buffer->global_offset : 0;
+
+        const BufferHot* uniform_buffer = (const BufferHot*)s_record.buffers.accessHot(draw.uniform_buffer);
+        *command++ = (uint64)(uintptr_t)pipeline->vk_pipeline_layout | uniform_buffer->global_offset;
+        *command++ = draw.index_count;
+    }
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// Setup and teardown run outside of the measured passes.
+struct Benchmark
+{
+    const char* name;
+    const char* variant;
+    BenchFunction function;
+    uint32 count;
+    BenchFunction setup = nullptr;
+    BenchFunction teardown = nullptr;
+    // Runs on the job system started with this many threads, 0 for none.
+    uint32 threads = 0;
+}; // struct Benchmark
+
+#define POOL_BENCHMARKS(threads, suffix) \
+    {"resource_pool_contention_" suffix, "mutex", PoolMutexBench, POOL_CONTENTION_COUNT, PoolMutexSetup, PoolTeardown, threads}, \
+    {"resource_pool_contention_" suffix, "lockfree", PoolLockFreeBench, POOL_CONTENTION_COUNT, PoolLockFreeSetup, PoolTeardown, threads}
+
+static const Benchmark s_benchmarks[] =
+{
+    {"command_record_50k", "whole", RecordWholeBench, RECORD_DRAW_COUNT, RecordSetup, RecordTeardown},
+    {"command_record_50k", "hot", RecordHotBench, RECORD_DRAW_COUNT, RecordSetup, RecordTeardown},
+
+    POOL_BENCHMARKS(1, "1t"),
+    POOL_BENCHMARKS(2, "2t"),
+    POOL_BENCHMARKS(4, "4t"),
+    POOL_BENCHMARKS(8, "8t"),
+    POOL_BENCHMARKS(16, "16t"),
+    POOL_BENCHMARKS(32, "32t"),
+};
+
+static const uint32 BENCHMARK_COUNT = sizeof(s_benchmarks) / sizeof(s_benchmarks[0]);
+
+// Runner ----------------------------------------------------------------------
+
+struct BenchResult
+{
+    const Benchmark* benchmark;
+    uint64 passes;
+    double best_ns;             // Per element, fastest repetition.
+    double median_ns;
+    double baseline_ns;         // Best of the first variant of the same name.
+}; // struct BenchResult
+
+static const uint32 MAX_REPETITIONS = 32;
+
+// Passes a repetition takes to last at least min_time, doubling from one.
+static uint64 CalibratePasses(const Benchmark& benchmark, double min_time)
+{
+    uint64 passes = 1;
+    while (true)
+    {
+        const int64 begin = Raptor::Core::Time::Now();
+        for (uint64 pass = 0; pass < passes; pass++)
+        {
+            benchmark.function(benchmark.count);
+            ClobberMemory();
+        }
+        const double seconds = Raptor::Core::Time::DeltaSeconds(begin, Raptor::Core::Time::Now());
+
+        if (seconds >= min_time)
+            return passes;
+
+        // Jump close to the target once the time is measurable.
+        if (seconds > min_time * 0.01)
+            passes = (uint64)(passes * min_time * 1.2 / seconds) + 1;
+        else
+            passes *= 10;
+    }
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    const double lhs = *(const double*)a;
+    const double rhs = *(const double*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static BenchResult Run(const Benchmark& benchmark, double min_time, uint32 repetitions)
+{
+    if (benchmark.threads > 1)
+        JobSystem::instance()->init(MallocAllocator::instance(), benchmark.threads - 1);
+    if (benchmark.setup)
+        benchmark.setup(benchmark.count);
+
+    // Warms the caches and the branch predictors.
+    benchmark.function(benchmark.count);
+
+    BenchResult result = {&benchmark, CalibratePasses(benchmark, min_time), 0.0, 0.0, 0.0};
+
+    double ns[MAX_REPETITIONS];
+    for (uint32 repetition = 0; repetition < repetitions; repetition++)
+    {
+        const int64 begin = Raptor::Core::Time::Now();
+        for (uint64 pass = 0; pass < result.passes; pass++)
+        {
+            benchmark.function(benchmark.count);
+            ClobberMemory();
+        }
+        const double seconds = Raptor::Core::Time::DeltaSeconds(begin, Raptor::Core::Time::Now());
+        ns[repetition] = seconds * 1e9 / ((double)result.passes * benchmark.count);
+    }
+
+    if (benchmark.teardown)
+        benchmark.teardown(benchmark.count);
+    if (benchmark.threads > 1)
+        JobSystem::instance()->shutdown();
+
+    qsort(ns, repetitions, sizeof(double), CompareDoubles);
+    result.best_ns = ns[0];
+    result.median_ns = ns[repetitions / 2];
+    return result;
+}
+
+// Checks ----------------------------------------------------------------------
+
+static uint32 s_failed_checks = 0;
+
+#define CHECK(condition) if (!(condition)) { printf("    Failed: %s (line %d)\n", #condition, __LINE__); s_failed_checks++; }
+
+static const uint32 CONCURRENT_THREAD_COUNT = 8;
+static const uint32 CONCURRENT_ROUND_COUNT = 20 * 1000;
+static const uint32 CONCURRENT_PAGE_SIZE = 16;
+
+// Slots of the concurrent pool are marked by whoever holds them.
+struct OwnedResource
+{
+    std::atomic<uint32> owner;
+}; // struct OwnedResource
+
+static std::atomic<uint32> s_double_hand_outs {0};
+static std::atomic<uint32> s_invalid_handles {0};
+static std::atomic<bool> s_pool_threads_running {false};
+// Kept so the checks of the reader are not optimized away.
+static std::atomic<uint32> s_reader_valid_handles {0};
+
+static void ConcurrentPoolThread(ResourcePool* pool, uint32 thread_index)
+{
+    const uint32 owner = thread_index + 1;
+    uint32 handles[POOL_HELD_SLOTS];
+    for (uint32 round = 0; round < CONCURRENT_ROUND_COUNT; round++)
+    {
+        // Held slots vary, so threads take and give back pages unevenly.
+        const uint32 held = 1 + (round + thread_index) % POOL_HELD_SLOTS;
+        for (uint32 slot = 0; slot < held; slot++)
+        {
+            handles[slot] = pool->obtainResource();
+            OwnedResource* resource = (OwnedResource*)pool->accessResource(handles[slot]);
+            if (!resource || !pool->isValid(handles[slot]))
+            {
+                s_invalid_handles.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (resource->owner.exchange(owner, std::memory_order_relaxed) != 0)
+                s_double_hand_outs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (uint32 slot = 0; slot < held; slot++)
+        {
+            OwnedResource* resource = (OwnedResource*)pool->accessResource(handles[slot]);
+            if (!resource)
+                continue;
+
+            if (resource->owner.exchange(0, std::memory_order_relaxed) != owner)
+                s_double_hand_outs.fetch_add(1, std::memory_order_relaxed);
+            pool->releaseResource(handles[slot]);
+        }
+    }
+}
+
+// Checks handles to slots other threads are releasing meanwhile, like code
+// testing whether a resource it was given is still alive.
+static void ConcurrentPoolReader(ResourcePool* pool)
+{
+    uint32 valid = 0;
+    while (s_pool_threads_running.load(std::memory_order_acquire))
+    {
+        const uint32 pool_size = pool->poolSize.load(std::memory_order_acquire);
+        for (uint32 i = 0; i < pool_size; i++)
+            valid += pool->isValid(pool->handleFromIndex(i));
+    }
+    s_reader_valid_handles.store(valid, std::memory_order_relaxed);
+}
+
+// Threads obtain and release slots of a concurrent pool that starts with one
+// small page. No slot may be handed to two threads, a handle stays valid
+// until it is released and stale handles are refused afterwards.
+static void CheckResourcePoolConcurrent()
+{
+    ResourcePool pool;
+    pool.initConcurrent(MallocAllocator::instance(), CONCURRENT_PAGE_SIZE, sizeof(OwnedResource), CONCURRENT_THREAD_COUNT * POOL_HELD_SLOTS);
+
+    s_double_hand_outs.store(0, std::memory_order_relaxed);
+    s_invalid_handles.store(0, std::memory_order_relaxed);
+
+    s_pool_threads_running.store(true, std::memory_order_relaxed);
+    std::thread reader(ConcurrentPoolReader, &pool);
+
+    std::thread threads[CONCURRENT_THREAD_COUNT];
+    for (uint32 i = 0; i < CONCURRENT_THREAD_COUNT; i++)
+        threads[i] = std::thread(ConcurrentPoolThread, &pool, i);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    s_pool_threads_running.store(false, std::memory_order_release);
+    reader.join();
+
+    CHECK(s_double_hand_outs.load() == 0);
+    CHECK(s_invalid_handles.load() == 0);
+
+    const ResourcePoolStatistics statistics = pool.getStatistics();
+    CHECK(statistics.used == 0);
+    CHECK(statistics.high_water_mark <= CONCURRENT_THREAD_COUNT * POOL_HELD_SLOTS);
+    CHECK(statistics.capacity <= CONCURRENT_THREAD_COUNT * POOL_HELD_SLOTS);
+
+    // Every slot is free again and its handles from the run are stale.
+    uint32 handles[CONCURRENT_THREAD_COUNT * POOL_HELD_SLOTS];
+    for (uint32& handle : handles)
+    {
+        handle = pool.obtainResource();
+        CHECK(pool.isValid(handle));
+    }
+    for (uint32 handle : handles)
+    {
+        pool.releaseResource(handle);
+        CHECK(!pool.isValid(handle));
+    }
+
+    pool.shutdown();
+}
+
+typedef void (*CheckFunction)();
+
+struct Check
+{
+    const char* name;
+    CheckFunction function;
+}; // struct Check
+
+static const Check s_checks[] =
+{
+    {"resource_pool_concurrent", CheckResourcePoolConcurrent},
+};
+
+static const uint32 CHECK_COUNT = sizeof(s_checks) / sizeof(s_checks[0]);
+
+static int RunChecks(const char* filter)
+{
+    for (uint32 i = 0; i < CHECK_COUNT; i++)
+    {
+        const Check& check = s_checks[i];
+        if (filter && !strstr(check.name, filter))
+            continue;
+
+        const uint32 failed_before = s_failed_checks;
+        check.function();
+        printf("%-28s %s\n", check.name, s_failed_checks == failed_before ? "ok" : "FAILED");
+    }
+
+    return s_failed_checks ? 1 : 0;
+}
+
+// Output ----------------------------------------------------------------------
+
+static double Speedup(const BenchResult& result)
+{
+    return result.baseline_ns / result.best_ns;
+}
+
+static bool WriteJSON(const char* filename, const BenchResult* results, uint32 count, const char* date, double min_time, uint32 repetitions)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+#if defined(NDEBUG)
+    fprintf(file, "    \"build\": \"release\",\n");
+#else
+    fprintf(file, "    \"build\": \"debug\",\n");
+#endif
+    fprintf(file, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(file, "    \"min_time\": %g,\n", min_time);
+    fprintf(file, "    \"repetitions\": %u\n", repetitions);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (uint32 i = 0; i < count; i++)
+    {
+        const BenchResult& result = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"variant\": \"%s\", \"count\": %u, \"ns_per_item\": %.4f, \"ns_per_item_median\": %.4f, "
+                      "\"items_per_second\": %.0f, \"baseline_ns_per_item\": %.4f, \"speedup\": %.3f}%s\n",
+                result.benchmark->name, result.benchmark->variant, result.benchmark->count, result.best_ns, result.median_ns,
+                1e9 / result.best_ns, result.baseline_ns, Speedup(result), i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    fclose(file);
+    return true;
+}
+
+static bool WriteCSV(const char* filename, const BenchResult* results, uint32 count)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "name,variant,count,ns_per_item,ns_per_item_median,items_per_second,baseline_ns_per_item,speedup\n");
+    for (uint32 i = 0; i < count; i++)
+    {
+        const BenchResult& result = results[i];
+        fprintf(file, "%s,%s,%u,%.4f,%.4f,%.0f,%.4f,%.3f\n", result.benchmark->name, result.benchmark->variant, result.benchmark->count,
+                result.best_ns, result.median_ns, 1e9 / result.best_ns, result.baseline_ns, Speedup(result));
+    }
+
+    fclose(file);
+    return true;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: RaptorGraphicsBench [--filter text] [--variant text] [--min-time seconds] [--repetitions n] [--threads n] [--json file] [--csv file]\n");
+    printf("       RaptorGraphicsBench --check [--filter text]\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    const char* variant = nullptr;
+    const char* json_filename = nullptr;
+    const char* csv_filename = nullptr;
+    double min_time = 0.1;
+    uint32 repetitions = 5;
+    bool check = false;
+    uint32 max_threads = std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--filter") && has_value)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--variant") && has_value)
+            variant = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && has_value)
+            min_time = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--repetitions") && has_value)
+            repetitions = (uint32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && has_value)
+            json_filename = argv[++i];
+        else if (!strcmp(argv[i], "--csv") && has_value)
+            csv_filename = argv[++i];
+        else if (!strcmp(argv[i], "--threads") && has_value)
+            max_threads = (uint32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (repetitions < 1)
+        repetitions = 1;
+    if (repetitions > MAX_REPETITIONS)
+        repetitions = MAX_REPETITIONS;
+    if (min_time <= 0.0)
+        min_time = 0.1;
+    if (max_threads < 1)
+        max_threads = 1;
+    if (max_threads > JobSystem::MAX_THREADS)
+        max_threads = JobSystem::MAX_THREADS;
+
+    Raptor::Core::Time::Init();
+
+    if (check)
+        return RunChecks(filter);
+
+    char date[32];
+    const time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+#if !defined(NDEBUG)
+    printf("Warning: debug build, the numbers are not representative.\n");
+#endif
+    printf("Hardware threads: %u, contention benchmarks up to %u threads\n\n", std::thread::hardware_concurrency(), max_threads);
+    printf("%-32s %-8s %9s %12s %12s %14s %8s\n", "name", "variant", "count", "ns/item", "median", "items/s", "speedup");
+
+    BenchResult results[BENCHMARK_COUNT];
+    uint32 result_count = 0;
+    for (uint32 i = 0; i < BENCHMARK_COUNT; i++)
+    {
+        const Benchmark& benchmark = s_benchmarks[i];
+        if (filter && !strstr(benchmark.name, filter))
+            continue;
+        if (variant && strcmp(benchmark.variant, variant))
+            continue;
+        if (benchmark.threads > max_threads)
+            continue;
+
+        BenchResult result = Run(benchmark, min_time, repetitions);
+
+        // The baseline variant of a name always comes first.
+        result.baseline_ns = result.best_ns;
+        for (uint32 r = 0; r < result_count; r++)
+        {
+            if (!strcmp(results[r].benchmark->name, benchmark.name))
+            {
+                result.baseline_ns = results[r].best_ns;
+                break;
+            }
+        }
+
+        printf("%-32s %-8s %9u %12.3f %12.3f %14.0f %7.2fx\n", benchmark.name, benchmark.variant, benchmark.count,
+               result.best_ns, result.median_ns, 1e9 / result.best_ns, Speedup(result));
+        results[result_count++] = result;
+    }
+
+    int exit_code = 0;
+    if (json_filename && !WriteJSON(json_filename, results, result_count, date, min_time, repetitions))
+    {
+        printf("Error: Could not write %s\n", json_filename);
+        exit_code = 1;
+    }
+    if (csv_filename && !WriteCSV(csv_filename, results, result_count))
+    {
+        printf("Error: Could not write %s\n", csv_filename);
+        exit_code = 1;
+    }
+
+    return exit_code;
+}
@@ -0,0 +1,774 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "Bounds.h"
+#include "Defines.h"
+#include "Matrix.h"
+#include "MatrixKernels.h"
+#include "TimeService.h"
+#include "TransformBatch.h"
+#include "Vector.h"
+
+// Microbenchmarks of the Math library.
+//
+//   RaptorMathBench [--filter text] [--min-time seconds] [--repetitions n]
+//                   [--json file] [--csv file]
+//   RaptorMathBench --check [--filter text]
+//
+// Every benchmark runs for at least min-time per repetition, the fastest
+// repetition is reported along with the median. Operations with a SIMD
+// version also run their scalar one, as the baseline the speedup is
+// measured against: the scalar templates of MatrixKernels.h for mat4, the
+// scalar level of TransformBatch.h for the batches. Build in release, the
+// numbers of a debug build say nothing.
+//
+// --check compares the float matrix kernels, scalar and SIMD, with the scalar
+// kernels run in double instead and exits with 1 if one is off by more than
+// its tolerance.
+
+using namespace Raptor::Math;
+
+// Keeps the compiler from dropping or hoisting the measured work.
+#if defined(__GNUC__) || defined(__clang__)
+static inline void ClobberMemory() { asm volatile("" : : : "memory"); }
+#elif defined(_MSC_VER)
+static inline void ClobberMemory() { _ReadWriteBarrier(); }
+#else
+static inline void ClobberMemory() {}
+#endif
+
+#if defined(RAPTOR_MATH_SSE)
+static const char* MATRIX_KERNELS = "sse";
+#elif defined(RAPTOR_MATH_NEON)
+static const char* MATRIX_KERNELS = "neon";
+#else
+static const char* MATRIX_KERNELS = "scalar";
+#endif
+
+// Data ------------------------------------------------------------------------
+
+// Small sets stay in L1, so single operations measure their math. Batches
+// run on a set that fits in L2 and on one that has to come from memory.
+static const uint32 SMALL_COUNT = 256;
+static const uint32 CACHE_COUNT = 4 * 1024;
+static const uint32 MEMORY_COUNT = 1024 * 1024;
+
+// Laid out like the UniformData of main.cpp, which is built for every draw
+// and copied with memcpy into the std140 block of its buffer.
+struct DrawUniformData
+{
+    mat4f m;
+    mat4f vp;
+    vec4f eye;
+    vec4f light;
+}; // struct DrawUniformData
+
+static_assert(std::is_trivially_copyable_v<DrawUniformData> && sizeof(DrawUniformData) == 160 && alignof(DrawUniformData) == 16,
+              "DrawUniformData matches the UniformData of main.cpp.");
+
+struct BenchData
+{
+    mat4f* matrices_a;
+    mat4f* matrices_b;
+    mat4f* matrices_out;
+    Transform* transforms;
+    vec3f* eyes;
+    vec3f* vectors;
+    vec3f* points;
+    vec3f* points_out;
+    float* soa_in[3];
+    float* soa_out[3];
+    AABB* boxes;
+    uint32* visible_indices;
+    // The mapped uniform buffers of the draws.
+    DrawUniformData* uniforms;
+    mat4f view_projection;
+    Frustum frustum;
+}; // struct BenchData
+
+static BenchData s_data;
+
+static float RandomFloat(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static vec3f RandomVec3(float min, float max)
+{
+    return vec3f(RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max));
+}
+
+static void InitData()
+{
+    srand(1);
+
+    s_data.matrices_a = new mat4f[SMALL_COUNT];
+    s_data.matrices_b = new mat4f[SMALL_COUNT];
+    s_data.matrices_out = new mat4f[MEMORY_COUNT];
+    s_data.transforms = new Transform[MEMORY_COUNT];
+    s_data.eyes = new vec3f[SMALL_COUNT];
+    s_data.vectors = new vec3f[SMALL_COUNT];
+    s_data.points = new vec3f[MEMORY_COUNT];
+    s_data.points_out = new vec3f[MEMORY_COUNT];
+    for (uint32 j = 0; j < 3; j++)
+    {
+        s_data.soa_in[j] = new float[CACHE_COUNT];
+        s_data.soa_out[j] = new float[CACHE_COUNT];
+    }
+    s_data.boxes = new AABB[CACHE_COUNT];
+    s_data.visible_indices = new uint32[CACHE_COUNT];
+    s_data.uniforms = new DrawUniformData[SMALL_COUNT];
+
+    // Affine matrices with some scale, invertible like the ones scenes have.
+    for (uint32 i = 0; i < MEMORY_COUNT; i++)
+    {
+        vec3f axis = RandomVec3(-1.f, 1.f);
+        axis.x += 0.01f;
+        axis.Normalize();
+
+        quatf rotation;
+        rotation.FromAxisAngle(axis, RandomFloat(-3.f, 3.f));
+        s_data.transforms[i] = Transform(RandomVec3(0.5f, 2.f), rotation, RandomVec3(-10.f, 10.f));
+        s_data.points[i] = RandomVec3(-10.f, 10.f);
+    }
+
+    for (uint32 i = 0; i < CACHE_COUNT; i++)
+    {
+        for (uint32 j = 0; j < 3; j++)
+            s_data.soa_in[j][i] = s_data.points[i][j];
+
+        const vec3f center = RandomVec3(-100.f, 100.f);
+        const vec3f extents = RandomVec3(0.1f, 5.f);
+        s_data.boxes[i] = AABB(center - extents, center + extents);
+    }
+
+    for (uint32 i = 0; i < SMALL_COUNT; i++)
+    {
+        s_data.matrices_a[i] = s_data.transforms[i].CalcMatrix();
+        s_data.matrices_b[i] = s_data.transforms[MEMORY_COUNT - 1 - i].CalcMatrix();
+        s_data.eyes[i] = RandomVec3(-10.f, 10.f);
+        s_data.vectors[i] = RandomVec3(-1.f, 1.f);
+    }
+
+    mat4f view;
+    view.LookAt(vec3f(0.f, 10.f, 50.f), vec3f(0.f, 0.f, 0.f), vec3f(0.f, 1.f, 0.f));
+    mat4f projection;
+    projection.FromPerspective(1.0472f, 16.f / 9.f, 0.1f, 1000.f);
+    s_data.view_projection = projection * view;
+    s_data.frustum.FromMatrix(s_data.view_projection);
+}
+
+static void ShutdownData()
+{
+    delete[] s_data.matrices_a;
+    delete[] s_data.matrices_b;
+    delete[] s_data.matrices_out;
+    delete[] s_data.transforms;
+    delete[] s_data.eyes;
+    delete[] s_data.vectors;
+    delete[] s_data.points;
+    delete[] s_data.points_out;
+    for (uint32 j = 0; j < 3; j++)
+    {
+        delete[] s_data.soa_in[j];
+        delete[] s_data.soa_out[j];
+    }
+    delete[] s_data.boxes;
+    delete[] s_data.visible_indices;
+    delete[] s_data.uniforms;
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// One call does a whole pass over the data set of the benchmark.
+typedef void (*BenchFunction)(uint32 count);
+
+static void Mat4MultiplyScalarBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        Mat4MultiplyScalar(s_data.matrices_a[i].i, s_data.matrices_b[i].i, s_data.matrices_out[i].i);
+}
+
+static void Mat4MultiplyBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i] = s_data.matrices_a[i] * s_data.matrices_b[i];
+}
+
+static void Mat4InverseScalarBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        Mat4InverseScalar(s_data.matrices_a[i].i, s_data.matrices_out[i].i);
+}
+
+static void Mat4InverseBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i] = s_data.matrices_a[i].Inverse();
+}
+
+static void Mat4InverseAffineScalarBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        Mat4InverseAffineScalar(s_data.matrices_a[i].i, s_data.matrices_out[i].i);
+}
+
+static void Mat4InverseAffineBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i] = s_data.matrices_a[i].InverseAffine();
+}
+
+static void Mat4TransposeScalarBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        Mat4TransposeScalar(s_data.matrices_a[i].i, s_data.matrices_out[i].i);
+}
+
+static void Mat4TransposeBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i] = s_data.matrices_a[i].Transpose();
+}
+
+static void Mat4LookAtBench(uint32 count)
+{
+    const vec3f up(0.f, 1.f, 0.f);
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i].LookAt(s_data.eyes[i], s_data.eyes[i] + s_data.vectors[i], up);
+}
+
+static void Mat4FromPerspectiveBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i].FromPerspective(1.f + s_data.vectors[i].x * 0.5f, 1.7f, 0.1f, 1000.f);
+}
+
+static void TransformCalcMatrixBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.matrices_out[i] = s_data.transforms[i].CalcMatrix();
+}
+
+static void TransformCalcMatricesBench(uint32 count)
+{
+    Transform::CalcMatrices(s_data.transforms, s_data.matrices_out, count);
+}
+
+static void TransformPointsBench(uint32 count)
+{
+    TransformPoints(s_data.matrices_b[0], s_data.points, s_data.points_out, count);
+}
+
+static void TransformPointsSoABench(uint32 count)
+{
+    const Vec3SoA in = {s_data.soa_in[0], s_data.soa_in[1], s_data.soa_in[2]};
+    const Vec3SoA out = {s_data.soa_out[0], s_data.soa_out[1], s_data.soa_out[2]};
+    TransformPoints(s_data.matrices_b[0], in, out, count);
+}
+
+static void CullAABBsBench(uint32 count)
+{
+    CullAABBs(s_data.frustum, s_data.boxes, count, s_data.visible_indices);
+}
+
+static void Vec3NormalizeBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        s_data.points_out[i] = s_data.points[i];
+        s_data.points_out[i].Normalize();
+    }
+}
+
+static void Vec3CrossBench(uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+        s_data.points_out[i] = cross(s_data.points[i], s_data.points[i + 1]);
+}
+
+// The uniforms of a draw as main.cpp builds them: the scene transform times
+// the model matrix, the camera, then a copy into the mapped buffer. The
+// scalar variant multiplies with the scalar kernel, the copies are the same.
+static void DrawUniformsScalarBench(uint32 count)
+{
+    const mat4f& global_model = s_data.matrices_b[0];
+    for (uint32 i = 0; i < count; i++)
+    {
+        DrawUniformData uniform_data {};
+        Mat4MultiplyScalar(global_model.i, s_data.matrices_a[i].i, uniform_data.m.i);
+        uniform_data.vp = s_data.view_projection;
+        uniform_data.eye = vec4f(s_data.eyes[i].x, s_data.eyes[i].y, s_data.eyes[i].z, 1.f);
+        uniform_data.light = vec4f(2.f, 2.f, 0.f, 1.f);
+
+        memcpy(&s_data.uniforms[i], &uniform_data, sizeof(DrawUniformData));
+    }
+}
+
+static void DrawUniformsBench(uint32 count)
+{
+    const mat4f& global_model = s_data.matrices_b[0];
+    for (uint32 i = 0; i < count; i++)
+    {
+        DrawUniformData uniform_data {};
+        uniform_data.m = global_model * s_data.matrices_a[i];
+        uniform_data.vp = s_data.view_projection;
+        uniform_data.eye = vec4f(s_data.eyes[i].x, s_data.eyes[i].y, s_data.eyes[i].z, 1.f);
+        uniform_data.light = vec4f(2.f, 2.f, 0.f, 1.f);
+
+        memcpy(&s_data.uniforms[i], &uniform_data, sizeof(DrawUniformData));
+    }
+}
+
+// A benchmark without a SIMD level runs as it is, the others switch the
+// TransformBatch level first and are skipped above the supported one.
+struct Benchmark
+{
+    const char* name;
+    const char* variant;
+    BenchFunction function;
+    uint32 count;
+    SIMDLevel level = SIMDLevel::Max;
+}; // struct Benchmark
+
+static const Benchmark s_benchmarks[] =
+{
+    {"vec3_normalize", "scalar", Vec3NormalizeBench, SMALL_COUNT},
+    {"vec3_cross", "scalar", Vec3CrossBench, SMALL_COUNT},
+
+    {"mat4_multiply", "scalar", Mat4MultiplyScalarBench, SMALL_COUNT},
+    {"mat4_multiply", MATRIX_KERNELS, Mat4MultiplyBench, SMALL_COUNT},
+    {"mat4_inverse", "scalar", Mat4InverseScalarBench, SMALL_COUNT},
+    {"mat4_inverse", MATRIX_KERNELS, Mat4InverseBench, SMALL_COUNT},
+    {"mat4_inverse_affine", "scalar", Mat4InverseAffineScalarBench, SMALL_COUNT},
+    {"mat4_inverse_affine", MATRIX_KERNELS, Mat4InverseAffineBench, SMALL_COUNT},
+    {"mat4_transpose", "scalar", Mat4TransposeScalarBench, SMALL_COUNT},
+    {"mat4_transpose", MATRIX_KERNELS, Mat4TransposeBench, SMALL_COUNT},
+    {"mat4_look_at", "scalar", Mat4LookAtBench, SMALL_COUNT},
+    {"mat4_from_perspective", "scalar", Mat4FromPerspectiveBench, SMALL_COUNT},
+
+    {"draw_uniforms", "scalar", DrawUniformsScalarBench, SMALL_COUNT},
+    {"draw_uniforms", MATRIX_KERNELS, DrawUniformsBench, SMALL_COUNT},
+
+    {"transform_calc_matrix", "scalar", TransformCalcMatrixBench, SMALL_COUNT},
+    {"transform_calc_matrices_4k", "scalar", TransformCalcMatricesBench, CACHE_COUNT, SIMDLevel::Scalar},
+    {"transform_calc_matrices_4k", "sse", TransformCalcMatricesBench, CACHE_COUNT, SIMDLevel::SSE},
+    {"transform_calc_matrices_4k", "avx2", TransformCalcMatricesBench, CACHE_COUNT, SIMDLevel::AVX2},
+    {"transform_calc_matrices_16k", "scalar", TransformCalcMatricesBench, 16 * 1024, SIMDLevel::Scalar},
+    {"transform_calc_matrices_16k", "sse", TransformCalcMatricesBench, 16 * 1024, SIMDLevel::SSE},
+    {"transform_calc_matrices_16k", "avx2", TransformCalcMatricesBench, 16 * 1024, SIMDLevel::AVX2},
+    {"transform_calc_matrices_64k", "scalar", TransformCalcMatricesBench, 64 * 1024, SIMDLevel::Scalar},
+    {"transform_calc_matrices_64k", "sse", TransformCalcMatricesBench, 64 * 1024, SIMDLevel::SSE},
+    {"transform_calc_matrices_64k", "avx2", TransformCalcMatricesBench, 64 * 1024, SIMDLevel::AVX2},
+    {"transform_calc_matrices_256k", "scalar", TransformCalcMatricesBench, 256 * 1024, SIMDLevel::Scalar},
+    {"transform_calc_matrices_256k", "sse", TransformCalcMatricesBench, 256 * 1024, SIMDLevel::SSE},
+    {"transform_calc_matrices_256k", "avx2", TransformCalcMatricesBench, 256 * 1024, SIMDLevel::AVX2},
+    {"transform_calc_matrices_1m", "scalar", TransformCalcMatricesBench, MEMORY_COUNT, SIMDLevel::Scalar},
+    {"transform_calc_matrices_1m", "sse", TransformCalcMatricesBench, MEMORY_COUNT, SIMDLevel::SSE},
+    {"transform_calc_matrices_1m", "avx2", TransformCalcMatricesBench, MEMORY_COUNT, SIMDLevel::AVX2},
+
+    {"transform_points_4k", "scalar", TransformPointsBench, CACHE_COUNT, SIMDLevel::Scalar},
+    {"transform_points_4k", "sse", TransformPointsBench, CACHE_COUNT, SIMDLevel::SSE},
+    {"transform_points_4k", "avx2", TransformPointsBench, CACHE_COUNT, SIMDLevel::AVX2},
+    {"transform_points_1m", "scalar", TransformPointsBench, MEMORY_COUNT, SIMDLevel::Scalar},
+    {"transform_points_1m", "sse", TransformPointsBench, MEMORY_COUNT, SIMDLevel::SSE},
+    {"transform_points_1m", "avx2", TransformPointsBench, MEMORY_COUNT, SIMDLevel::AVX2},
+    {"transform_points_soa_4k", "scalar", TransformPointsSoABench, CACHE_COUNT, SIMDLevel::Scalar},
+    {"transform_points_soa_4k", "sse", TransformPointsSoABench, CACHE_COUNT, SIMDLevel::SSE},
+    {"transform_points_soa_4k", "avx2", TransformPointsSoABench, CACHE_COUNT, SIMDLevel::AVX2},
+
+    {"cull_aabbs_4k", "scalar", CullAABBsBench, CACHE_COUNT, SIMDLevel::Scalar},
+    {"cull_aabbs_4k", "sse", CullAABBsBench, CACHE_COUNT, SIMDLevel::SSE},
+    {"cull_aabbs_4k", "avx2", CullAABBsBench, CACHE_COUNT, SIMDLevel::AVX2},
+};
+
+static const uint32 BENCHMARK_COUNT = sizeof(s_benchmarks) / sizeof(s_benchmarks[0]);
+
+// Runner ----------------------------------------------------------------------
+
+struct BenchResult
+{
+    const Benchmark* benchmark;
+    uint64 passes;
+    double best_ns;             // Per element, fastest repetition.
+    double median_ns;
+    double baseline_ns;         // Best of the scalar variant of the same name.
+}; // struct BenchResult
+
+static const uint32 MAX_REPETITIONS = 32;
+
+// Passes a repetition takes to last at least min_time, doubling from one.
+static uint64 CalibratePasses(const Benchmark& benchmark, double min_time)
+{
+    uint64 passes = 1;
+    while (true)
+    {
+        const int64 begin = Raptor::Core::Time::Now();
+        for (uint64 pass = 0; pass < passes; pass++)
+        {
+            benchmark.function(benchmark.count);
+            ClobberMemory();
+        }
+        const double seconds = Raptor::Core::Time::DeltaSeconds(begin, Raptor::Core::Time::Now());
+
+        if (seconds >= min_time)
+            return passes;
+
+        // Jump close to the target once the time is measurable.
+        if (seconds > min_time * 0.01)
+            passes = (uint64)(passes * min_time * 1.2 / seconds) + 1;
+        else
+            passes *= 10;
+    }
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    const double lhs = *(const double*)a;
+    const double rhs = *(const double*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static BenchResult Run(const Benchmark& benchmark, double min_time, uint32 repetitions)
+{
+    // Warms the caches and the branch predictors.
+    benchmark.function(benchmark.count);
+
+    BenchResult result = {&benchmark, CalibratePasses(benchmark, min_time), 0.0, 0.0, 0.0};
+
+    double ns[MAX_REPETITIONS];
+    for (uint32 repetition = 0; repetition < repetitions; repetition++)
+    {
+        const int64 begin = Raptor::Core::Time::Now();
+        for (uint64 pass = 0; pass < result.passes; pass++)
+        {
+            benchmark.function(benchmark.count);
+            ClobberMemory();
+        }
+        const double seconds = Raptor::Core::Time::DeltaSeconds(begin, Raptor::Core::Time::Now());
+        ns[repetition] = seconds * 1e9 / ((double)result.passes * benchmark.count);
+    }
+
+    qsort(ns, repetitions, sizeof(double), CompareDoubles);
+    result.best_ns = ns[0];
+    result.median_ns = ns[repetitions / 2];
+    return result;
+}
+
+// Checks ----------------------------------------------------------------------
+
+// Operands of a check come from the affine matrices of the benchmarks, the
+// results are written as floats, 16 for a matrix and 1 for a determinant.
+typedef void (*UnaryCheckFunction)(const mat4f& m, float* out);
+typedef void (*BinaryCheckFunction)(const mat4f& a, const mat4f& b, float* out);
+typedef void (*UnaryReferenceFunction)(const double* m, double* out);
+typedef void (*BinaryReferenceFunction)(const double* a, const double* b, double* out);
+
+static void Mat4MultiplyScalarCheck(const mat4f& a, const mat4f& b, float* out) { Mat4MultiplyScalar(a.i, b.i, out); }
+static void Mat4MultiplyCheck(const mat4f& a, const mat4f& b, float* out) { *(mat4f*)out = a * b; }
+static void Mat4MultiplyReference(const double* a, const double* b, double* out) { Mat4MultiplyScalar(a, b, out); }
+
+static void Mat4InverseScalarCheck(const mat4f& m, float* out) { Mat4InverseScalar(m.i, out); }
+static void Mat4InverseCheck(const mat4f& m, float* out) { *(mat4f*)out = m.Inverse(); }
+static void Mat4InverseReference(const double* m, double* out) { Mat4InverseScalar(m, out); }
+
+static void Mat4InverseAffineScalarCheck(const mat4f& m, float* out) { Mat4InverseAffineScalar(m.i, out); }
+static void Mat4InverseAffineCheck(const mat4f& m, float* out) { *(mat4f*)out = m.InverseAffine(); }
+// The general inverse, so the affine shortcut is measured as well.
+static void Mat4InverseAffineReference(const double* m, double* out) { Mat4InverseScalar(m, out); }
+
+static void Mat4TransposeScalarCheck(const mat4f& m, float* out) { Mat4TransposeScalar(m.i, out); }
+static void Mat4TransposeCheck(const mat4f& m, float* out) { *(mat4f*)out = m.Transpose(); }
+static void Mat4TransposeReference(const double* m, double* out) { Mat4TransposeScalar(m, out); }
+
+static void Mat4DeterminantScalarCheck(const mat4f& m, float* out) { *out = Mat4DeterminantScalar(m.i); }
+static void Mat4DeterminantCheck(const mat4f& m, float* out) { *out = m.Determinant(); }
+static void Mat4DeterminantReference(const double* m, double* out) { *out = Mat4DeterminantScalar(m); }
+
+// Errors are relative to the largest value of the reference result, entries
+// close to zero would fail any relative tolerance otherwise. Float rounds to
+// about 6e-8, the tolerances leave room for the operations of a kernel and
+// for the scale of the matrices. Transposing only moves values.
+struct PrecisionCheck
+{
+    const char* name;
+    const char* variant;
+    // Either the unary or the binary pair is set.
+    UnaryCheckFunction unary;
+    UnaryReferenceFunction unary_reference;
+    BinaryCheckFunction binary;
+    BinaryReferenceFunction binary_reference;
+    uint32 result_count;
+    double tolerance;
+}; // struct PrecisionCheck
+
+static constexpr PrecisionCheck UnaryCheck(const char* name, const char* variant, UnaryCheckFunction function,
+                                           UnaryReferenceFunction reference, uint32 result_count, double tolerance)
+{
+    return {name, variant, function, reference, nullptr, nullptr, result_count, tolerance};
+}
+
+static constexpr PrecisionCheck BinaryCheck(const char* name, const char* variant, BinaryCheckFunction function,
+                                            BinaryReferenceFunction reference, uint32 result_count, double tolerance)
+{
+    return {name, variant, nullptr, nullptr, function, reference, result_count, tolerance};
+}
+
+static const PrecisionCheck s_checks[] =
+{
+    BinaryCheck("mat4_multiply", "scalar", Mat4MultiplyScalarCheck, Mat4MultiplyReference, 16, 2e-6),
+    BinaryCheck("mat4_multiply", MATRIX_KERNELS, Mat4MultiplyCheck, Mat4MultiplyReference, 16, 2e-6),
+    UnaryCheck("mat4_inverse", "scalar", Mat4InverseScalarCheck, Mat4InverseReference, 16, 2e-6),
+    UnaryCheck("mat4_inverse", MATRIX_KERNELS, Mat4InverseCheck, Mat4InverseReference, 16, 2e-6),
+    UnaryCheck("mat4_inverse_affine", "scalar", Mat4InverseAffineScalarCheck, Mat4InverseAffineReference, 16, 2e-6),
+    UnaryCheck("mat4_inverse_affine", MATRIX_KERNELS, Mat4InverseAffineCheck, Mat4InverseAffineReference, 16, 2e-6),
+    UnaryCheck("mat4_transpose", "scalar", Mat4TransposeScalarCheck, Mat4TransposeReference, 16, 0.0),
+    UnaryCheck("mat4_transpose", MATRIX_KERNELS, Mat4TransposeCheck, Mat4TransposeReference, 16, 0.0),
+    UnaryCheck("mat4_determinant", "scalar", Mat4DeterminantScalarCheck, Mat4DeterminantReference, 1, 2e-6),
+    UnaryCheck("mat4_determinant", MATRIX_KERNELS, Mat4DeterminantCheck, Mat4DeterminantReference, 1, 2e-6),
+};
+
+static const uint32 CHECK_COUNT = sizeof(s_checks) / sizeof(s_checks[0]);
+
+static void ToDouble(const mat4f& m, double* out)
+{
+    for (uint32 i = 0; i < 16; i++)
+        out[i] = (double)m.i[i];
+}
+
+static int RunChecks(const char* filter)
+{
+    printf("Matrix kernels: %s, checked against the scalar kernels in double\n\n", MATRIX_KERNELS);
+    printf("%-28s %-8s %14s %14s %12s\n", "name", "variant", "max abs error", "max rel error", "tolerance");
+
+    uint32 failed_checks = 0;
+    for (uint32 c = 0; c < CHECK_COUNT; c++)
+    {
+        const PrecisionCheck& check = s_checks[c];
+        if (filter && !strstr(check.name, filter))
+            continue;
+
+        double max_absolute_error = 0.0;
+        double max_relative_error = 0.0;
+        for (uint32 i = 0; i < CACHE_COUNT; i++)
+        {
+            const mat4f a = s_data.transforms[i].CalcMatrix();
+            const mat4f b = s_data.transforms[MEMORY_COUNT - 1 - i].CalcMatrix();
+
+            alignas(16) float out[16];
+            double a_double[16];
+            double b_double[16];
+            double reference[16];
+            ToDouble(a, a_double);
+            ToDouble(b, b_double);
+            if (check.binary)
+            {
+                check.binary(a, b, out);
+                check.binary_reference(a_double, b_double, reference);
+            }
+            else
+            {
+                check.unary(a, out);
+                check.unary_reference(a_double, reference);
+            }
+
+            double magnitude = 0.0;
+            double error = 0.0;
+            for (uint32 j = 0; j < check.result_count; j++)
+            {
+                const double difference = (double)out[j] - reference[j];
+                error = MAX(error, difference < 0.0 ? -difference : difference);
+                magnitude = MAX(magnitude, reference[j] < 0.0 ? -reference[j] : reference[j]);
+            }
+
+            max_absolute_error = MAX(max_absolute_error, error);
+            max_relative_error = MAX(max_relative_error, error / magnitude);
+        }
+
+        const bool passed = max_relative_error <= check.tolerance;
+        if (!passed)
+            failed_checks++;
+
+        printf("%-28s %-8s %14.3e %14.3e %12.1e %s\n", check.name, check.variant, max_absolute_error, max_relative_error,
+               check.tolerance, passed ? "ok" : "FAILED");
+    }
+
+    return failed_checks ? 1 : 0;
+}
+
+// Output ----------------------------------------------------------------------
+
+static double Speedup(const BenchResult& result)
+{
+    return result.baseline_ns / result.best_ns;
+}
+
+static bool WriteJSON(const char* filename, const BenchResult* results, uint32 count, const char* date, double min_time, uint32 repetitions)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+#if defined(NDEBUG)
+    fprintf(file, "    \"build\": \"release\",\n");
+#else
+    fprintf(file, "    \"build\": \"debug\",\n");
+#endif
+    fprintf(file, "    \"matrix_kernels\": \"%s\",\n", MATRIX_KERNELS);
+    fprintf(file, "    \"supported_simd_level\": \"%s\",\n", ToString(GetSupportedSIMDLevel()));
+    fprintf(file, "    \"min_time\": %g,\n", min_time);
+    fprintf(file, "    \"repetitions\": %u\n", repetitions);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (uint32 i = 0; i < count; i++)
+    {
+        const BenchResult& result = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"variant\": \"%s\", \"count\": %u, \"ns_per_item\": %.4f, \"ns_per_item_median\": %.4f, "
+                      "\"items_per_second\": %.0f, \"baseline_ns_per_item\": %.4f, \"speedup\": %.3f}%s\n",
+                result.benchmark->name, result.benchmark->variant, result.benchmark->count, result.best_ns, result.median_ns,
+                1e9 / result.best_ns, result.baseline_ns, Speedup(result), i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    fclose(file);
+    return true;
+}
+
+static bool WriteCSV(const char* filename, const BenchResult* results, uint32 count)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "name,variant,count,ns_per_item,ns_per_item_median,items_per_second,baseline_ns_per_item,speedup\n");
+    for (uint32 i = 0; i < count; i++)
+    {
+        const BenchResult& result = results[i];
+        fprintf(file, "%s,%s,%u,%.4f,%.4f,%.0f,%.4f,%.3f\n", result.benchmark->name, result.benchmark->variant, result.benchmark->count,
+                result.best_ns, result.median_ns, 1e9 / result.best_ns, result.baseline_ns, Speedup(result));
+    }
+
+    fclose(file);
+    return true;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: RaptorMathBench [--filter text] [--min-time seconds] [--repetitions n] [--json file] [--csv file]\n");
+    printf("       RaptorMathBench --check [--filter text]\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    const char* json_filename = nullptr;
+    const char* csv_filename = nullptr;
+    double min_time = 0.1;
+    uint32 repetitions = 5;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--filter") && has_value)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && has_value)
+            min_time = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--repetitions") && has_value)
+            repetitions = (uint32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && has_value)
+            json_filename = argv[++i];
+        else if (!strcmp(argv[i], "--csv") && has_value)
+            csv_filename = argv[++i];
+        else if (!strcmp(argv[i], "--check"))
+            check = true;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (repetitions < 1)
+        repetitions = 1;
+    if (repetitions > MAX_REPETITIONS)
+        repetitions = MAX_REPETITIONS;
+    if (min_time <= 0.0)
+        min_time = 0.1;
+
+    Raptor::Core::Time::Init();
+    InitData();
+
+    if (check)
+    {
+        const int exit_code = RunChecks(filter);
+        ShutdownData();
+        return exit_code;
+    }
+
+    char date[32];
+    const time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+#if !defined(NDEBUG)
+    printf("Warning: debug build, the numbers are not representative.\n");
+#endif
+    printf("Matrix kernels: %s, supported SIMD level: %s\n\n", MATRIX_KERNELS, ToString(GetSupportedSIMDLevel()));
+    printf("%-28s %-8s %9s %12s %12s %14s %8s\n", "name", "variant", "count", "ns/item", "median", "items/s", "speedup");
+
+    const SIMDLevel supported = GetSupportedSIMDLevel();
+    BenchResult results[BENCHMARK_COUNT];
+    uint32 result_count = 0;
+    for (uint32 i = 0; i < BENCHMARK_COUNT; i++)
+    {
+        const Benchmark& benchmark = s_benchmarks[i];
+        if (filter && !strstr(benchmark.name, filter))
+            continue;
+        if (benchmark.level != SIMDLevel::Max && benchmark.level > supported)
+            continue;
+
+        SetSIMDLevel(benchmark.level);
+        BenchResult result = Run(benchmark, min_time, repetitions);
+
+        // The scalar variant of a name always comes first, operations without
+        // a SIMD version are their own baseline.
+        result.baseline_ns = result.best_ns;
+        for (uint32 r = 0; r < result_count; r++)
+        {
+            if (!strcmp(results[r].benchmark->name, benchmark.name) && !strcmp(results[r].benchmark->variant, "scalar"))
+                result.baseline_ns = results[r].best_ns;
+        }
+
+        printf("%-28s %-8s %9u %12.3f %12.3f %14.0f %7.2fx\n", benchmark.name, benchmark.variant, benchmark.count,
+               result.best_ns, result.median_ns, 1e9 / result.best_ns, Speedup(result));
+        results[result_count++] = result;
+    }
+    SetSIMDLevel(SIMDLevel::Max);
+
+    int exit_code = 0;
+    if (json_filename && !WriteJSON(json_filename, results, result_count, date, min_time, repetitions))
+    {
+        printf("Error: Could not write %s\n", json_filename);
+        exit_code = 1;
+    }
+    if (csv_filename && !WriteCSV(csv_filename, results, result_count))
+    {
+        printf("Error: Could not write %s\n", csv_filename);
+        exit_code = 1;
+    }
+
+    ShutdownData();
+    return exit_code;
+}
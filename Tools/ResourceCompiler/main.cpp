@@ -0,0 +1,397 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <EASTL/vector.h>
+
+#define TINYGLTF_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <tiny_gltf.h>
+
+#include "Allocator.h"
+#include "BuildCache.h"
+#include "Defines.h"
+#include "File.h"
+#include "Hash.h"
+#include "JobSystem.h"
+#include "Process.h"
+#include "ResourceManager.h"
+#include "Texture.h"
+
+// These new operators are required by EASTL
+void* __cdecl operator new[](size_t size, const char* pName, int flags, unsigned debugFlags, const char* file, int line)
+{
+    return new uint8_t[size];
+}
+
+void* __cdecl operator new[](size_t size, size_t alignment, size_t alignmentOffset, const char* pName, int flags, unsigned debugFlags, const char* file, int line)
+{
+    return new uint8_t[size];
+}
+
+using Raptor::Core::Allocator;
+using Raptor::Core::BuildCache;
+using Raptor::Core::ResourceCompiler;
+using Raptor::Core::ResourceManager;
+
+template<typename T>
+using Array = eastl::vector<T, Raptor::Core::ContainerAllocator>;
+
+static const char* COOKED_DIRECTORY = "cooked";
+
+// TextureCompiler ----------------------------
+// PNG/JPG to an RGBA8 mip chain, box filtered down to 1x1.
+struct TextureCompiler : public ResourceCompiler
+{
+    uint64 GetVersion() override { return Raptor::Graphics::CookedTextureHeader::VERSION; }
+    bool Compile(const char* source_filename, const char* output_filename, Allocator* allocator) override;
+}; // struct TextureCompiler
+
+bool TextureCompiler::Compile(const char* source_filename, const char* output_filename, Allocator* allocator)
+{
+    using Raptor::Graphics::CookedTextureHeader;
+
+    int comp, width, height;
+    uint8* pixels = stbi_load(source_filename, &width, &height, &comp, 4);
+    if (!pixels)
+    {
+        printf("Error: Could not decode %s: %s\n", source_filename, stbi_failure_reason());
+        return false;
+    }
+
+    if (width > 0xffff || height > 0xffff)
+    {
+        printf("Error: %s is too large (%dx%d).\n", source_filename, width, height);
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    uint32 mipmaps = 1;
+    while (mipmaps < Raptor::Graphics::MAX_TEXTURE_MIPMAPS && ((width >> mipmaps) || (height >> mipmaps)))
+        ++mipmaps;
+
+    CookedTextureHeader header {};
+    header.magic = CookedTextureHeader::MAGIC;
+    header.version = CookedTextureHeader::VERSION;
+    header.width = (uint16)width;
+    header.height = (uint16)height;
+    header.mipmaps = (uint8)mipmaps;
+    header.data_size = Raptor::Graphics::TextureMipChainSize(width, height, mipmaps);
+
+    const sizet output_size = sizeof(CookedTextureHeader) + header.data_size;
+    uint8* output = (uint8*)allocator->allocate(output_size, 16, 0, 0);
+    memcpy(output, &header, sizeof(CookedTextureHeader));
+
+    uint8* level = output + sizeof(CookedTextureHeader);
+    memcpy(level, pixels, (sizet)width * height * 4);
+    stbi_image_free(pixels);
+
+    uint32 level_width = width;
+    uint32 level_height = height;
+    for (uint32 mip = 1; mip < mipmaps; ++mip)
+    {
+        const uint32 next_width = MAX(level_width >> 1, 1u);
+        const uint32 next_height = MAX(level_height >> 1, 1u);
+        uint8* next_level = level + level_width * level_height * 4;
+
+        // Odd sizes clamp the last row and column, the 2x2 footprint stays inside the level.
+        for (uint32 y = 0; y < next_height; ++y)
+        {
+            const uint32 y0 = MIN(y * 2, level_height - 1);
+            const uint32 y1 = MIN(y * 2 + 1, level_height - 1);
+            for (uint32 x = 0; x < next_width; ++x)
+            {
+                const uint32 x0 = MIN(x * 2, level_width - 1);
+                const uint32 x1 = MIN(x * 2 + 1, level_width - 1);
+                for (uint32 c = 0; c < 4; ++c)
+                {
+                    const uint32 sum = level[(y0 * level_width + x0) * 4 + c] + level[(y0 * level_width + x1) * 4 + c] +
+                                       level[(y1 * level_width + x0) * 4 + c] + level[(y1 * level_width + x1) * 4 + c];
+                    next_level[(y * next_width + x) * 4 + c] = (uint8)((sum + 2) / 4);
+                }
+            }
+        }
+
+        level = next_level;
+        level_width = next_width;
+        level_height = next_height;
+    }
+
+    const bool written = Raptor::Core::FileWriteBinary(output_filename, output, output_size);
+    allocator->deallocate(output, output_size);
+
+    return written;
+}
+
+// ShaderCompiler ----------------------------
+// GLSL to SPIR-V through glslangValidator, the stage comes from the extension.
+// The version folds in the arguments and the version glslangValidator reports,
+// so changing either cooks the shaders again.
+struct ShaderCompiler : public ResourceCompiler
+{
+    // Bump when the output changes in a way neither of those shows.
+    static const uint64 VERSION = 1;
+    // Everything but the files.
+    static constexpr const char* ARGUMENTS = "-V --target-env vulkan1.2";
+
+    uint64 GetVersion() override;
+    bool Compile(const char* source_filename, const char* output_filename, Allocator* allocator) override;
+
+    uint64 version = 0;
+}; // struct ShaderCompiler
+
+static void ShaderCompilerPath(char* path, sizet size)
+{
+    const char* vulkan_sdk = getenv("VULKAN_SDK");
+#if defined(_MSC_VER)
+    snprintf(path, size, "%s\\Bin\\glslangValidator.exe", vulkan_sdk ? vulkan_sdk : "");
+#else
+    snprintf(path, size, "%s/bin/glslangValidator", vulkan_sdk ? vulkan_sdk : "/usr");
+#endif
+}
+
+// Asked for once, on the main thread before any cooking starts.
+uint64 ShaderCompiler::GetVersion()
+{
+    if (version)
+        return version;
+
+    version = Raptor::Core::HashString(ARGUMENTS, VERSION);
+
+    char compiler_path[Raptor::Core::MAX_FILENAME_LENGTH];
+    ShaderCompilerPath(compiler_path, sizeof(compiler_path));
+
+    Raptor::Core::Process* process = Raptor::Core::ProcessStart(".", compiler_path, "--version", Raptor::Core::MallocAllocator::instance());
+    if (!process)
+    {
+        // Compiling fails the same way, nothing gets cached with this version.
+        printf("Warning: Could not start %s to ask for its version\n", compiler_path);
+        return version;
+    }
+
+    Raptor::Core::ProcessWait(process);
+    version = Raptor::Core::HashString(Raptor::Core::ProcessGetOutput(process), version);
+    Raptor::Core::ProcessDestroy(process);
+
+    return version;
+}
+
+bool ShaderCompiler::Compile(const char* source_filename, const char* output_filename, Allocator* allocator)
+{
+    char compiler_path[Raptor::Core::MAX_FILENAME_LENGTH];
+    ShaderCompilerPath(compiler_path, sizeof(compiler_path));
+
+    char arguments[Raptor::Core::MAX_FILENAME_LENGTH * 2];
+    snprintf(arguments, sizeof(arguments), "%s -o %s %s", ARGUMENTS, output_filename, source_filename);
+
+    Raptor::Core::Process* process = Raptor::Core::ProcessStart(".", compiler_path, arguments, allocator);
+    if (!process)
+    {
+        printf("Error: Could not start %s\n", compiler_path);
+        return false;
+    }
+
+    Raptor::Core::ProcessWait(process);
+    const bool success = Raptor::Core::ProcessSucceeded(process, "ERROR");
+    if (!success)
+        printf("%s\n", Raptor::Core::ProcessGetOutput(process));
+
+    Raptor::Core::ProcessDestroy(process);
+    return success;
+}
+
+// Cooking ----------------------------
+struct CookTask
+{
+    const char* name;
+    ResourceCompiler* compiler;
+    uint64 key;
+    char output_filename[Raptor::Core::MAX_FILENAME_LENGTH];
+    bool success;
+}; // struct CookTask
+
+static bool HasExtension(const char* filename, const char* extension)
+{
+    const char* dot = strrchr(filename, '.');
+    if (!dot)
+        return false;
+
+    for (++dot; *dot && *extension; ++dot, ++extension)
+    {
+        if (tolower(*dot) != *extension)
+            return false;
+    }
+    return *dot == *extension;
+}
+
+static ResourceCompiler* FindCompiler(ResourceManager& resource_manager, const char* name)
+{
+    uint64 type_hash = 0;
+    if (HasExtension(name, "png") || HasExtension(name, "jpg") || HasExtension(name, "jpeg") || HasExtension(name, "tga") || HasExtension(name, "bmp"))
+        type_hash = Raptor::Graphics::TextureResource::type_hash;
+    else if (HasExtension(name, "vert") || HasExtension(name, "frag") || HasExtension(name, "comp") || HasExtension(name, "geom"))
+        type_hash = Raptor::Core::HashString("ShaderType");
+
+    auto it = resource_manager.compilers.find(type_hash);
+    return it != resource_manager.compilers.end() ? it->second : nullptr;
+}
+
+// Cooks the asset, or the images referenced by a glTF model, into the cooked
+// directory next to it. Names are relative to the asset's directory, the
+// same names the runtime loads them by.
+static void CookAsset(ResourceManager& resource_manager, const char* asset_path, Allocator* allocator, uint32& cooked_count, uint32& skipped_count, uint32& failed_count)
+{
+    char directory[Raptor::Core::MAX_FILENAME_LENGTH] {};
+    snprintf(directory, sizeof(directory), "%s", asset_path);
+    Raptor::Core::DirectoryFromPath(directory);
+
+    char filename[Raptor::Core::MAX_FILENAME_LENGTH] {};
+    snprintf(filename, sizeof(filename), "%s", asset_path);
+    Raptor::Core::FilenameFromPath(filename);
+
+    // A bare filename has no directory part.
+    if (strcmp(directory, asset_path) != 0)
+        Raptor::Core::ChangeDirectory(directory);
+
+    std::vector<std::string> names;
+    if (HasExtension(filename, "gltf") || HasExtension(filename, "glb"))
+    {
+        tinygltf::Model model;
+        tinygltf::TinyGLTF loader;
+        std::string err;
+        std::string warn;
+
+        const bool loaded = HasExtension(filename, "glb") ? loader.LoadBinaryFromFile(&model, &err, &warn, filename) : loader.LoadASCIIFromFile(&model, &err, &warn, filename);
+        if (!loaded)
+        {
+            printf("Error: Could not load %s: %s\n", asset_path, err.c_str());
+            ++failed_count;
+            return;
+        }
+
+        // Embedded images have no file to cook.
+        for (const tinygltf::Image& image : model.images)
+        {
+            if (!image.uri.empty() && image.uri.compare(0, 5, "data:") != 0)
+                names.push_back(image.uri);
+        }
+    }
+    else
+    {
+        names.push_back(filename);
+    }
+
+    if (!Raptor::Core::DirectoryCreate(COOKED_DIRECTORY))
+    {
+        printf("Error: Could not create %s%s\n", directory, COOKED_DIRECTORY);
+        failed_count += (uint32)names.size();
+        return;
+    }
+
+    BuildCache cache;
+    cache.init(allocator, COOKED_DIRECTORY);
+
+    Array<CookTask> tasks(*allocator);
+    tasks.reserve(names.size());
+    for (const std::string& name : names)
+    {
+        ResourceCompiler* compiler = FindCompiler(resource_manager, name.c_str());
+        if (!compiler)
+        {
+            printf("Warning: No compiler for %s\n", name.c_str());
+            continue;
+        }
+
+        sizet source_size = 0;
+        char* source_data = Raptor::Core::FileReadBinary(name.c_str(), allocator, &source_size);
+        if (!source_data)
+        {
+            printf("Error: Could not read %s\n", name.c_str());
+            ++failed_count;
+            continue;
+        }
+
+        CookTask task;
+        task.name = name.c_str();
+        task.compiler = compiler;
+        task.key = BuildCache::ComputeKey(source_data, source_size, compiler->GetVersion());
+        task.success = false;
+        Raptor::Core::CookedFilename(COOKED_DIRECTORY, task.name, task.output_filename, sizeof(task.output_filename));
+        allocator->deallocate(source_data, source_size + 1);
+
+        if (cache.IsUpToDate(task.output_filename, task.key))
+        {
+            ++skipped_count;
+            continue;
+        }
+
+        tasks.push_back(task);
+    }
+
+    // Compilers only touch their own source and output, so they run in parallel.
+    Raptor::Core::JobSystem::instance()->ParallelFor((uint32)tasks.size(), 1, [&](uint32 start, uint32 end)
+    {
+        for (uint32 i = start; i < end; ++i)
+        {
+            CookTask& task = tasks[i];
+            task.success = task.compiler->Compile(task.name, task.output_filename, Raptor::Core::MallocAllocator::instance());
+        }
+    });
+
+    for (const CookTask& task : tasks)
+    {
+        if (task.success)
+        {
+            printf("Cooked %s -> %s\n", task.name, task.output_filename);
+            cache.Set(task.output_filename, task.key);
+            ++cooked_count;
+        }
+        else
+        {
+            // A stale output would be loaded at runtime, the source is used instead.
+            Raptor::Core::FileDelete(task.output_filename);
+            cache.Remove(task.output_filename);
+            ++failed_count;
+        }
+    }
+
+    cache.shutdown();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s [glTF model or asset]...\n", argv[0]);
+        return 0;
+    }
+
+    Allocator* allocator = Raptor::Core::MallocAllocator::instance();
+    Raptor::Core::JobSystem::instance()->init(allocator);
+
+    TextureCompiler texture_compiler;
+    ShaderCompiler shader_compiler;
+
+    ResourceManager resource_manager {*allocator, nullptr};
+    resource_manager.SetCompiler(Raptor::Graphics::TextureResource::type_hash, &texture_compiler);
+    resource_manager.SetCompiler("ShaderType", &shader_compiler);
+
+    char cwd[Raptor::Core::MAX_FILENAME_LENGTH] {};
+    Raptor::Core::CurrentDirectory(cwd);
+
+    uint32 cooked_count = 0;
+    uint32 skipped_count = 0;
+    uint32 failed_count = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        CookAsset(resource_manager, argv[i], allocator, cooked_count, skipped_count, failed_count);
+        Raptor::Core::ChangeDirectory(cwd);
+    }
+
+    printf("%u cooked, %u up to date, %u failed.\n", cooked_count, skipped_count, failed_count);
+
+    Raptor::Core::JobSystem::instance()->shutdown();
+
+    return failed_count ? 1 : 0;
+}
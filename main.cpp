@@ -1,7 +1,7 @@
 #include <stdalign.h>
 
 #include <EASTL/version.h>
-#include <EASTL/allocator.h>
+#include <EASTL/vector.h>
 #include <EAStdC/EASprintf.h>
 
 #define TINYGLTF_IMPLEMENTATION
@@ -10,6 +10,14 @@
 #include <tiny_gltf.h>
 
 #include "Raptor.h"
+#include "Allocator.h"
+#include "AsyncIO.h"
+#include "Fiber.h"
+#include "FileWatcher.h"
+#include "HeapAllocator.h"
+#include "JobSystem.h"
+#include "NameTable.h"
+#include "Profiler.h"
 #include "Defines.h"
 #include "Window.h"
 #include "Input.h"
@@ -24,6 +32,7 @@
 #include "DebugUI.h"
 #include "File.h"
 #include "Mesh.h"
+#include "Bounds.h"
 #include "Matrix.h"
 #include "Vector.h"
 
@@ -50,9 +59,12 @@ void debug_print_versions()
     EA::StdC::Printf("Vulkan version: %d.%d.%d\n", VK_VERSION_MAJOR(instanceVersion), VK_VERSION_MINOR(instanceVersion), VK_VERSION_PATCH(instanceVersion));
 }
 
-static uint8* GetBufferData(std::vector<tinygltf::BufferView> buffer_views, uint32 buffer_index, eastl::vector<void*> buffers_data, uint32* buffer_size = nullptr, std::string* buffer_name = nullptr)
+template<typename T>
+using Array = eastl::vector<T, Raptor::Core::ContainerAllocator>;
+
+static uint8* GetBufferData(const std::vector<tinygltf::BufferView>& buffer_views, uint32 buffer_index, const Array<void*>& buffers_data, uint32* buffer_size = nullptr, std::string* buffer_name = nullptr)
 {
-    tinygltf::BufferView& buffer = buffer_views[buffer_index];
+    const tinygltf::BufferView& buffer = buffer_views[buffer_index];
 
     uint32 offset = buffer.byteOffset;
 
@@ -71,7 +83,6 @@ static uint8* GetBufferData(std::vector<tinygltf::BufferView> buffer_views, uint
     return data;
 }
 
-
 Raptor::Graphics::BufferHandle                    cube_vb;
 Raptor::Graphics::BufferHandle                    cube_ib;
 Raptor::Graphics::PipelineHandle                  cube_pipeline;
@@ -86,6 +97,9 @@ struct UniformData {
     Raptor::Math::vec4f light;
 };
 
+static_assert(std::is_trivially_copyable_v<UniformData> && sizeof(UniformData) == 160 && alignof(UniformData) == 16,
+              "UniformData is copied with memcpy into the std140 block of the shaders.");
+
 int main( int argc, char** argv)
 {
     debug_print_versions();
@@ -96,18 +110,35 @@ int main( int argc, char** argv)
         return 0;
     }
     
+    Raptor::Debug::LogInit();
     Raptor::Debug::Log("%s\n", argv[1]);
 
-    using Allocator = eastl::allocator;
-    Allocator allocator {};
+    Raptor::Core::HeapAllocator heap_allocator {Raptor::Core::MallocAllocator::instance(), 64 * 1024 * 1024};
+    heap_allocator.set_name("Raptor Heap");
+    Raptor::Core::TaggedAllocator allocator {heap_allocator, Raptor::Core::MemoryTag::Assets};
+    Raptor::Core::TaggedAllocator graphics_allocator {heap_allocator, Raptor::Core::MemoryTag::Graphics};
+    Raptor::Core::TaggedAllocator core_allocator {heap_allocator, Raptor::Core::MemoryTag::Core};
+    Raptor::Core::NameTable::instance()->init(&core_allocator);
+    // Before the job system, so its workers get a profiler thread each.
+    Raptor::Core::Profiler::instance()->init(&core_allocator);
+    Raptor::Core::Profiler::instance()->SetThreadName("Main");
+    Raptor::Core::AsyncIOService::instance()->init(&core_allocator);
+    Raptor::Core::JobSystem::instance()->init(&core_allocator);
+    Raptor::Core::FiberSystem::instance()->init(&core_allocator);
 
     Raptor::Application::Window window {1920, 1080, "Raptor"};
     Raptor::Application::Input input {window};
     Raptor::Core::Time::Init();
-    Raptor::Graphics::GPUDevice gpu_device {window, allocator};
-    Raptor::Core::ResourceManager resource_manager {allocator, nullptr};
-    Raptor::Graphics::GPUProfiler gpu_profiler {allocator, 100};
-    Raptor::Graphics::Renderer renderer {&gpu_device, &resource_manager, allocator};
+    Raptor::Graphics::GPUDevice gpu_device {window, graphics_allocator};
+    // Assets cooked by RaptorResourceCompiler are found next to the model, after the directory change below.
+    Raptor::Core::CookedFilenameResolver cooked_resolver {"cooked"};
+    Raptor::Core::ResourceManager resource_manager {core_allocator, &cooked_resolver};
+    Raptor::Graphics::GPUProfiler gpu_profiler {graphics_allocator, 100};
+    Raptor::Graphics::Renderer renderer {&gpu_device, &resource_manager, graphics_allocator};
+    // Edited textures are reloaded in place from Update() while running.
+    Raptor::Core::FileWatcher file_watcher;
+    file_watcher.init(&core_allocator);
+    resource_manager.EnableHotReload(&file_watcher);
     //Raptor::Debug::UI::DebugUI debugUI {window, gpu_device};
 
     char cwd[Raptor::Core::MAX_FILENAME_LENGTH] {};
@@ -130,15 +161,36 @@ int main( int argc, char** argv)
     
     loader.LoadASCIIFromFile(&model, &err, &warn, gltf_file);
 
-    eastl::vector<Raptor::Graphics::TextureResource> images(model.images.size(), allocator);
+    // Each primitive gets a material buffer and a descriptor set, plus a few dummies.
+    uint32 primitive_count = 0;
+    for (uint32 i = 0; i < model.meshes.size(); i++)
+        primitive_count += (uint32)model.meshes[i].primitives.size();
+
+    renderer.ReserveResources((uint32)model.bufferViews.size() + primitive_count + 1, (uint32)model.images.size() + 1,
+        (uint32)model.samplers.size() + 1, primitive_count);
+
+    // Every image load is started up front. Files are read and decoded in the
+    // background and uploaded on the main thread, so startup waits for the
+    // slowest image rather than the sum of them.
+    Array<Raptor::Graphics::TextureResource*> image_loads(model.images.size(), allocator);
     for (uint32 i = 0; i < model.images.size(); i++)
     {
-        tinygltf::Image& image = model.images[i];
-        Raptor::Graphics::TextureResource* tr = renderer.CreateTexture(image.uri.data(), image.uri.data());
+        image_loads[i] = resource_manager.LoadAsync<Raptor::Graphics::TextureResource>(model.images[i].uri.data());
+    }
+    resource_manager.WaitForLoads();
+
+    Array<Raptor::Graphics::TextureResource> images(model.images.size(), allocator);
+    for (uint32 i = 0; i < model.images.size(); i++)
+    {
+        Raptor::Graphics::TextureResource* tr = image_loads[i];
         ASSERT(tr != nullptr);
 
+        if (tr->state == Raptor::Core::ResourceState::Failed)
+            Raptor::Debug::LogWarning("Warning: Texture %s failed to load, using the dummy texture.\n", tr->name);
+
         images[i] = *tr;
     }
+    image_loads.clear();
 
     Raptor::Graphics::CreateTextureParams texture_params {};
     uint32 zero_value = 0;
@@ -152,7 +204,7 @@ int main( int argc, char** argv)
     sampler_params.address_mode_v = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     Raptor::Graphics::SamplerHandle dummy_sampler = gpu_device.CreateSampler(sampler_params);
 
-    eastl::vector<Raptor::Graphics::SamplerResource> samplers(model.samplers.size(), allocator);
+    Array<Raptor::Graphics::SamplerResource> samplers(model.samplers.size(), allocator);
     for (uint32 i = 0; i < model.samplers.size(); i++)
     {
         tinygltf::Sampler& sampler = model.samplers[i];
@@ -171,18 +223,30 @@ int main( int argc, char** argv)
         samplers[i] = *sr;
     }
 
-    eastl::vector<void*> buffers_data(model.buffers.size(), allocator);
-    eastl::vector<sizet> buffers_size(model.buffers.size(), allocator);
+    // Buffers are mapped rather than read, the views are handed straight to the uploads.
+    // tinygltf has no way to skip buffers and has read them into the model already,
+    // that copy is dropped once the mapping is open so the scene is resident once
+    // while it uploads rather than twice. Embedded buffers can not be mapped and
+    // are used from the copy.
+    Array<Raptor::Core::MappedFile> mapped_buffers(model.buffers.size(), allocator);
+    Array<void*> buffers_data(model.buffers.size(), allocator);
     for (uint32 i = 0; i < model.buffers.size(); i++)
     {
         tinygltf::Buffer& buffer = model.buffers[i];
 
-        Raptor::Core::FileReadResult buffer_data = Raptor::Core::FileReadBinary(buffer.uri.data(), &allocator);
-        buffers_data[i] = buffer_data.data;
-        buffers_size[i] = buffer_data.size;
+        const bool embedded = buffer.uri.empty() || buffer.uri.compare(0, 5, "data:") == 0;
+        if (!embedded && mapped_buffers[i].Open(buffer.uri.data(), Raptor::Core::FileAccessHint::Sequential))
+        {
+            buffers_data[i] = (void*)mapped_buffers[i].data;
+            std::vector<unsigned char>().swap(buffer.data);
+        }
+        else
+        {
+            buffers_data[i] = buffer.data.data();
+        }
     }
 
-    eastl::vector<Raptor::Graphics::BufferResource> buffers(model.bufferViews.size(), allocator);
+    Array<Raptor::Graphics::BufferResource> buffers(model.bufferViews.size(), allocator);
     for (uint32 i = 0; i < model.bufferViews.size(); i++)
     {
         char buffer_name[64];
@@ -209,8 +273,10 @@ int main( int argc, char** argv)
 
     Raptor::Core::ChangeDirectory(cwd);
 
-    eastl::vector<Raptor::Graphics::MeshDraw> mesh_draws(allocator);
-    eastl::vector<Raptor::Graphics::BufferHandle> custom_mesh_buffers(8, allocator);
+    Array<Raptor::Graphics::MeshDraw> mesh_draws(allocator);
+    // Box of each draw in the space of the scene, culled every frame.
+    Array<Raptor::Math::AABB> mesh_bounds(allocator);
+    Array<Raptor::Graphics::BufferHandle> custom_mesh_buffers(8, allocator);
 
     Raptor::Math::vec4f dummy_data[3] {};
     Raptor::Graphics::CreateBufferParams buffer_params{};
@@ -534,65 +600,69 @@ void main() {
 
         tinygltf::Scene& root_gltf_scene = model.scenes[model.defaultScene];
 
-        eastl::vector<int32> node_parents(model.nodes.size(), allocator);
-        eastl::vector<uint32> node_stack(allocator);
-        eastl::vector<Raptor::Math::mat4f> node_matrix(model.nodes.size(), allocator);
-
-        for (uint32 node_index = 0; node_index < root_gltf_scene.nodes.size(); ++node_index)
-        {
-            uint32 root_node = root_gltf_scene.nodes[node_index];
-            node_parents[root_node] = -1;
-            node_stack.push_back(root_node);
-        }
+        Array<int32> node_parents(model.nodes.size(), allocator);
+        Array<uint32> node_stack(allocator);
+        Array<Raptor::Math::mat4f> node_matrix(model.nodes.size(), allocator);
 
-        while (node_stack.size() > 0)
+        // Local matrices of every node up front, the ones given as scale,
+        // rotation and translation are built in one batch.
+        Array<Raptor::Math::Transform> node_transforms(model.nodes.size(), allocator);
+        for (uint32 node_index = 0; node_index < model.nodes.size(); node_index++)
         {
-            uint32 node_index = node_stack.back();
-            node_stack.pop_back();
             tinygltf::Node& node = model.nodes[node_index];
 
-            Raptor::Math::mat4f local_matrix{};
+            Raptor::Math::vec3f node_scale {1.f, 1.f, 1.f};
+            if (node.scale.size() > 0)
+            {
+                ASSERT(node.scale.size() == 3);
+                node_scale = Raptor::Math::vec3f(node.scale[0], node.scale[1], node.scale[2]);
+            }
 
-            if (node.matrix.size() > 0)
+            Raptor::Math::vec3f node_translation {0.f, 0.f, 0.f};
+            if (node.translation.size() > 0)
             {
-                for (uint32 idx = 0; idx < 16; idx++)
-                {
-                    local_matrix.i[idx] = (float)node.matrix[idx];
-                }
+                ASSERT(node.translation.size() == 3);
+                node_translation = Raptor::Math::vec3f(node.translation[0], node.translation[1], node.translation[2]);
             }
-            else
+
+            Raptor::Math::quatf node_rotation {0.f, 0.f, 0.f, 1.f};
+            if (node.rotation.size() > 0)
             {
-                Raptor::Math::vec3f node_scale {1.f, 1.f, 1.f};
-                if (node.scale.size() > 0)
-                {
-                    ASSERT(node.scale.size() == 3);
-                    node_scale = Raptor::Math::vec3f(node.scale[0], node.scale[1], node.scale[2]);
-                }
+                ASSERT(node.rotation.size() == 4);
+                node_rotation = Raptor::Math::quatf(node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]);
+            }
 
-                Raptor::Math::vec3f node_translation {0.f, 0.f, 0.f};
-                if (node.translation.size() > 0)
-                {
-                    ASSERT(node.translation.size() == 3);
-                    node_translation = Raptor::Math::vec3f(node.translation[0], node.translation[1], node.translation[2]);
-                }
+            node_transforms[node_index] = Raptor::Math::Transform(node_scale, node_rotation, node_translation);
+        }
 
-                Raptor::Math::vec4f node_rotation {0.f, 0.f, 0.f, 1.f};
-                if (node.rotation.size() > 0)
+        Raptor::Math::Transform::CalcMatrices(node_transforms.data(), node_matrix.data(), node_transforms.size());
+
+        for (uint32 node_index = 0; node_index < model.nodes.size(); node_index++)
+        {
+            tinygltf::Node& node = model.nodes[node_index];
+            if (node.matrix.size() > 0)
+            {
+                for (uint32 idx = 0; idx < 16; idx++)
                 {
-                    ASSERT(node.rotation.size() == 4);
-                    node_rotation = Raptor::Math::vec4f(node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]);
+                    node_matrix[node_index].i[idx] = (float)node.matrix[idx];
                 }
+            }
+        }
 
-                Raptor::Math::Transform transform {};
-                transform.translation = node_translation;
-                transform.scale = node_scale;
-                transform.rotation = node_rotation;
-
-                local_matrix = transform.CalcMatrix();
+        for (uint32 node_index = 0; node_index < root_gltf_scene.nodes.size(); ++node_index)
+        {
+            uint32 root_node = root_gltf_scene.nodes[node_index];
+            node_parents[root_node] = -1;
+            node_stack.push_back(root_node);
+        }
 
-            }
+        while (node_stack.size() > 0)
+        {
+            uint32 node_index = node_stack.back();
+            node_stack.pop_back();
+            tinygltf::Node& node = model.nodes[node_index];
 
-            node_matrix[node_index] = local_matrix;
+            const Raptor::Math::mat4f& local_matrix = node_matrix[node_index];
 
             for (uint32 child_index = 0; child_index < node.children.size(); child_index++)
             {
@@ -638,6 +708,7 @@ void main() {
                 int32 texcoord_accessor_index = mesh_prim.attributes["TEXCOORD_0"];
 
                 Raptor::Math::vec3f* position_data = nullptr;
+                Raptor::Math::AABB draw_bounds;
                 uint32* index_data_32 = (uint32*)GetBufferData(model.bufferViews, indices_accessor.bufferView, buffers_data);
                 uint16* index_data_16 = (uint16*)index_data_32;
                 uint32 vertex_count = 0;
@@ -654,6 +725,26 @@ void main() {
                     mesh_draw.position_offset = (position_accessor.byteOffset < 0) ? 0 : position_accessor.byteOffset;
                     
                     position_data = (Raptor::Math::vec3f*)GetBufferData(model.bufferViews, position_accessor.bufferView, buffers_data);
+
+                    // glTF requires min and max on positions, files without them get a box from the vertices.
+                    Raptor::Math::AABB position_bounds;
+                    if (position_accessor.minValues.size() == 3 && position_accessor.maxValues.size() == 3)
+                    {
+                        position_bounds.min = Raptor::Math::vec3f(position_accessor.minValues[0], position_accessor.minValues[1], position_accessor.minValues[2]);
+                        position_bounds.max = Raptor::Math::vec3f(position_accessor.maxValues[0], position_accessor.maxValues[1], position_accessor.maxValues[2]);
+                    }
+                    else
+                    {
+                        const uint8* vertex_data = (const uint8*)position_data + mesh_draw.position_offset;
+                        const int32 vertex_stride = position_accessor.ByteStride(position_buffer_view);
+                        ASSERT(vertex_stride > 0);
+                        for (uint32 vertex_index = 0; vertex_index < vertex_count; vertex_index++)
+                        {
+                            position_bounds.Add(*(const Raptor::Math::vec3f*)(vertex_data + vertex_index * vertex_stride));
+                        }
+                    }
+
+                    draw_bounds = position_bounds.Transformed(final_matrix);
                 }
                 else
                 {
@@ -838,18 +929,16 @@ void main() {
 
                 mesh_draw.descriptor_set = gpu_device.CreateDescriptorSet(ds_params);
                 mesh_draws.push_back(mesh_draw);
+                mesh_bounds.push_back(draw_bounds);
             }
         }
     }
     
-    for (uint32 buffer_index = 0; buffer_index < model.buffers.size(); buffer_index++)
-    {
-        void* buffer = buffers_data[buffer_index];
-        allocator.deallocate(buffer, buffers_size[buffer_index]);
-    }
-
     buffers_data.clear();
-    buffers_size.clear();
+    mapped_buffers.clear();
+
+    heap_allocator.LogStatistics();
+    gpu_device.LogPoolStatistics();
 
     int64 begin_frame_tick = Raptor::Core::Time::Now();
 
@@ -862,8 +951,20 @@ void main() {
     float pitch = 0.f;
     float model_scale = 1.f;
 
+    // P captures the next frames into a trace for chrome://tracing or Perfetto.
+    static const uint32 PROFILER_CAPTURE_FRAMES = 120;
+    uint32 profiler_capture_frames = 0;
+    bool profiler_key_down = false;
+
+    // Counts and cull time of frustum culling are logged once a second.
+    int64 cull_stats_begin_tick = begin_frame_tick;
+    double cull_stats_seconds = 0.0;
+    uint32 cull_stats_frames = 0;
+
     while (!window.ShouldClose())
     {
+        PROFILE_ZONE("Frame");
+
         //if (!window.minimized)
             gpu_device.NewFrame();
 
@@ -882,10 +983,26 @@ void main() {
         input.NewFrame();
         input.Update(delta_time);
 
+        const bool profiler_key_pressed = input.KeyPress(Raptor::Application::Key::KEY_P);
+        if (profiler_key_pressed && !profiler_key_down && !profiler_capture_frames)
+        {
+            Raptor::Core::Profiler::instance()->BeginCapture();
+            profiler_capture_frames = PROFILER_CAPTURE_FRAMES;
+        }
+        profiler_key_down = profiler_key_pressed;
+
+        {
+            PROFILE_ZONE("ResourceManager::Update");
+            resource_manager.Update();
+        }
+
         // TODO ImGui
 
         Raptor::Math::mat4f global_model; global_model.Identity();
+        // Stays zero, with every draw visible, when the uniforms can't be updated.
+        Raptor::Math::Frustum frustum;
         {
+            PROFILE_ZONE("Update Uniforms");
             Raptor::Graphics::MapBufferParams cb_map = {cube_cb, 0, 0};
             float* cb_data = (float*)gpu_device.MapBuffer(cb_map);
             if (cb_data)
@@ -937,7 +1054,10 @@ void main() {
                 Raptor::Math::mat4f sm; sm.Identity(); sm.Scale({model_scale, model_scale, model_scale});
                 global_model = rym * sm;
 
-                UniformData alignas(16) uniform_data {};
+                // The boxes are in the space of the scene, so are these planes.
+                frustum.FromMatrix(view_projection * global_model);
+
+                UniformData uniform_data {};
                 uniform_data.m = global_model;
                 uniform_data.vp = view_projection;
                 uniform_data.eye = Raptor::Math::vec4f(eye.x, eye.y, eye.z, 1.f);
@@ -949,6 +1069,31 @@ void main() {
             }
         }
 
+        // Indices of the draws that pass culling. They only live for this
+        // frame, so they come from the frame allocator that NewFrame rewinds.
+        uint32* visible_draws = nullptr;
+        uint32 visible_draw_count = 0;
+        {
+            PROFILE_ZONE("Frustum Culling");
+            const int64 cull_begin_tick = Raptor::Core::Time::Now();
+            if (!mesh_bounds.empty())
+            {
+                visible_draws = (uint32*)gpu_device.frame_allocator.allocate(mesh_bounds.size() * sizeof(uint32), alignof(uint32), 0);
+                visible_draw_count = Raptor::Math::CullAABBs(frustum, mesh_bounds.data(), (uint32)mesh_bounds.size(), visible_draws);
+            }
+            cull_stats_seconds += Raptor::Core::Time::DeltaSeconds(cull_begin_tick, Raptor::Core::Time::Now());
+            cull_stats_frames++;
+
+            if (Raptor::Core::Time::DeltaSeconds(cull_stats_begin_tick, current_tick) >= 1.0)
+            {
+                Raptor::Debug::Log("Culling: %u visible, %u culled, %.3f ms per frame\n", visible_draw_count,
+                                   (uint32)mesh_draws.size() - visible_draw_count, cull_stats_seconds * 1000.0 / cull_stats_frames);
+                cull_stats_begin_tick = current_tick;
+                cull_stats_seconds = 0.0;
+                cull_stats_frames = 0;
+            }
+        }
+
         //if (!window.minimized)
         {
             Raptor::Graphics::CommandBuffer* commands = gpu_device.GetCommandBuffer(Raptor::Graphics::QueueType::Graphics, true);
@@ -960,34 +1105,47 @@ void main() {
             commands->SetScissor(nullptr);
             commands->SetViewport(nullptr);
 
-            for (uint32 iMesh = 0; iMesh < mesh_draws.size(); iMesh++)
             {
-                Raptor::Graphics::MeshDraw mesh_draw = mesh_draws[iMesh];
-                mesh_draw.material_data.model_inv = (global_model * mesh_draw.material_data.model).Transpose().Inverse();
+                PROFILE_ZONE("Update Materials");
+                for (uint32 iVisible = 0; iVisible < visible_draw_count; iVisible++)
+                {
+                    Raptor::Graphics::MeshDraw& mesh_draw = mesh_draws[visible_draws[iVisible]];
+                    Raptor::Graphics::MaterialData material_data = mesh_draw.material_data;
+                    // Model matrices are affine, inverting before transposing takes the cheaper path.
+                    material_data.model_inv = (global_model * material_data.model).InverseAffine().Transpose();
 
-                Raptor::Graphics::MapBufferParams material_map = {mesh_draw.material_buffer, 0, 0};
-                Raptor::Graphics::MaterialData* material_buffer_data = (Raptor::Graphics::MaterialData*)gpu_device.MapBuffer(material_map);
+                    Raptor::Graphics::MapBufferParams material_map = {mesh_draw.material_buffer, 0, 0};
+                    Raptor::Graphics::MaterialData* material_buffer_data = (Raptor::Graphics::MaterialData*)gpu_device.MapBuffer(material_map);
 
-                memcpy(material_buffer_data, &mesh_draw.material_data, sizeof(Raptor::Graphics::MaterialData));
+                    memcpy(material_buffer_data, &material_data, sizeof(Raptor::Graphics::MaterialData));
 
-                gpu_device.UnmapBuffer(material_map);
+                    gpu_device.UnmapBuffer(material_map);
+                }
+            }
 
-                commands->BindVertexBuffer(mesh_draw.position_buffer, 0, mesh_draw.position_offset);
-                commands->BindVertexBuffer(mesh_draw.normal_buffer, 2, mesh_draw.normal_offset);
+            {
+                PROFILE_ZONE("Record Draws");
+                for (uint32 iVisible = 0; iVisible < visible_draw_count; iVisible++)
+                {
+                    Raptor::Graphics::MeshDraw& mesh_draw = mesh_draws[visible_draws[iVisible]];
 
-                if (mesh_draw.material_data.flags & Raptor::Graphics::MaterialFeatures::TangentVertexAttribute)
-                    commands->BindVertexBuffer(mesh_draw.tangent_buffer, 1, mesh_draw.tangent_offset);
-                else
-                    commands->BindVertexBuffer(dummy_attribute_buffer, 1, 0);
+                    commands->BindVertexBuffer(mesh_draw.position_buffer, 0, mesh_draw.position_offset);
+                    commands->BindVertexBuffer(mesh_draw.normal_buffer, 2, mesh_draw.normal_offset);
 
-                if (mesh_draw.material_data.flags & Raptor::Graphics::MaterialFeatures::TexcoordVertexAttribute)
-                    commands->BindVertexBuffer(mesh_draw.texcoord_buffer, 3, mesh_draw.texcoord_offset);
-                else
-                    commands->BindVertexBuffer(dummy_attribute_buffer, 3, 0);
+                    if (mesh_draw.material_data.flags & Raptor::Graphics::MaterialFeatures::TangentVertexAttribute)
+                        commands->BindVertexBuffer(mesh_draw.tangent_buffer, 1, mesh_draw.tangent_offset);
+                    else
+                        commands->BindVertexBuffer(dummy_attribute_buffer, 1, 0);
+
+                    if (mesh_draw.material_data.flags & Raptor::Graphics::MaterialFeatures::TexcoordVertexAttribute)
+                        commands->BindVertexBuffer(mesh_draw.texcoord_buffer, 3, mesh_draw.texcoord_offset);
+                    else
+                        commands->BindVertexBuffer(dummy_attribute_buffer, 3, 0);
 
-                commands->BindIndexBuffer(mesh_draw.index_buffer, mesh_draw.index_offset, mesh_draw.vk_index_type);
-                commands->BindDescriptorSet(&mesh_draw.descriptor_set, 1, nullptr, 0);
-                commands->DrawIndexed(Raptor::Graphics::TopologyType::Triangle, mesh_draw.count, 1, 0, 0, 0);
+                    commands->BindIndexBuffer(mesh_draw.index_buffer, mesh_draw.index_offset, mesh_draw.vk_index_type);
+                    commands->BindDescriptorSet(&mesh_draw.descriptor_set, 1, nullptr, 0);
+                    commands->DrawIndexed(Raptor::Graphics::TopologyType::Triangle, mesh_draw.count, 1, 0, 0, 0);
+                }
             }
 
             //debugUI.Render();
@@ -1008,6 +1166,12 @@ void main() {
         //debugUI.Update();
 
         // TODO
+
+        if (profiler_capture_frames && --profiler_capture_frames == 0)
+        {
+            Raptor::Core::Profiler::instance()->EndCapture();
+            Raptor::Core::Profiler::instance()->WriteChromeTrace("raptor_trace.json");
+        }
     }
 
     for (uint32 mesh_index = 0; mesh_index < mesh_draws.size(); mesh_index++)
@@ -1017,6 +1181,7 @@ void main() {
         //gpu_device.DestroyBuffer(mesh_draw.material_buffer);
     }
     mesh_draws.clear();
+    mesh_bounds.clear();
 
     for (uint32 i = 0; i < custom_mesh_buffers.size(); i++)
     {
@@ -1030,6 +1195,13 @@ void main() {
 
     // TODO
 
+    file_watcher.shutdown();
+    Raptor::Core::FiberSystem::instance()->shutdown();
+    Raptor::Core::JobSystem::instance()->shutdown();
+    Raptor::Core::AsyncIOService::instance()->shutdown();
+    Raptor::Core::Profiler::instance()->shutdown();
+    Raptor::Core::NameTable::instance()->shutdown();
+    Raptor::Debug::LogShutdown();
 
     return 0;
 }